@@ -181,6 +181,10 @@ public:
   /// empty - Returns true if there are no nodes in the folding set.
   bool empty() const { return NumNodes == 0; }
 
+  /// getMemorySize - Returns the size in bytes of the bucket array.  The nodes
+  /// themselves are owned by the client and are not included.
+  size_t getMemorySize() const { return (NumBuckets + 1) * sizeof(void *); }
+
 private:
   /// GrowHashTable - Double the size of the hash table and rehash everything.
   ///
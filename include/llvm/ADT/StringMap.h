@@ -99,6 +99,14 @@ public:
   unsigned getNumBuckets() const { return NumBuckets; }
   unsigned getNumItems() const { return NumItems; }
 
+  /// getMemorySize - Return the size in bytes of the hash table itself, not
+  /// counting the separately allocated entries.
+  size_t getMemorySize() const {
+    if (!TheTable)
+      return 0;
+    return (NumBuckets + 1) * (sizeof(StringMapEntryBase *) + sizeof(unsigned));
+  }
+
   bool empty() const { return NumItems == 0; }
   unsigned size() const { return NumItems; }
 
@@ -253,6 +261,15 @@ public:
   AllocatorTy &getAllocator() { return Allocator; }
   const AllocatorTy &getAllocator() const { return Allocator; }
 
+  /// getTotalMemorySize - Return the size in bytes of the hash table plus
+  /// its entries and their keys.
+  size_t getTotalMemorySize() const {
+    size_t Size = getMemorySize();
+    for (const auto &Entry : *this)
+      Size += sizeof(Entry) + Entry.getKeyLength() + 1;
+    return Size;
+  }
+
   typedef const char* key_type;
   typedef ValueTy mapped_type;
   typedef StringMapEntry<ValueTy> value_type;
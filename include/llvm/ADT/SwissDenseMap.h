@@ -0,0 +1,711 @@
+//===- llvm/ADT/SwissDenseMap.h - Group-probed hash table -------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the SwissDenseMap class, an open-addressing hash table with
+// the same interface as DenseMap that keeps one control byte per bucket in a
+// separate array.
+//
+// A control byte is either "empty", "deleted", or holds 7 bits of the key's
+// hash.  Lookups compare a whole group of control bytes against the hash bits
+// at once (16 bytes with SSE2, 8 bytes with plain 64-bit arithmetic
+// elsewhere) and only touch the buckets whose control byte matches.  For maps
+// with large buckets this means a miss rarely reads a bucket at all, and
+// because a lookup stops at the first group with an empty byte, erased
+// entries only lengthen probe sequences when their group was already full.
+//
+// Unlike DenseMap, keys do not need reserved empty and tombstone values; only
+// KeyInfoT::getHashValue and KeyInfoT::isEqual are used.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_ADT_SWISSDENSEMAP_H
+#define LLVM_ADT_SWISSDENSEMAP_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseMapInfo.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/MathExtras.h"
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                    \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LLVM_SWISSDENSEMAP_SSE2 1
+#endif
+
+namespace llvm {
+
+namespace swiss_detail {
+
+typedef int8_t ctrl_t;
+
+/// Control byte values.  Full buckets store the low 7 bits of the hash, so
+/// they are always non-negative; the special values all have the top bit set.
+enum : ctrl_t {
+  CtrlEmpty = -128,  // 0b10000000
+  CtrlDeleted = -2,  // 0b11111110
+};
+
+inline bool isFull(ctrl_t C) { return C >= 0; }
+
+/// A set of matching positions within a group of \c Width control bytes.
+/// Each position owns (1 << \c Shift) consecutive bits of the mask, and one of
+/// them is set iff that position matched.
+template <unsigned Width, unsigned Shift> class GroupMask {
+  uint64_t Mask;
+
+public:
+  explicit GroupMask(uint64_t Mask) : Mask(Mask) {}
+
+  explicit operator bool() const { return Mask != 0; }
+
+  /// Return the lowest matching position.
+  unsigned lowest() const {
+    return countTrailingZeros(Mask, ZB_Undefined) >> Shift;
+  }
+
+  /// Return the number of positions before the first match, or \c Width if
+  /// nothing matched.
+  unsigned trailingZeros() const {
+    return Mask ? lowest() : Width;
+  }
+
+  /// Return the number of positions after the last match, or \c Width if
+  /// nothing matched.
+  unsigned leadingZeros() const {
+    if (!Mask)
+      return Width;
+    // Position bits occupy the low Width << Shift bits of the mask.
+    unsigned Extra = 64 - (Width << Shift);
+    return (countLeadingZeros(Mask, ZB_Undefined) - Extra) >> Shift;
+  }
+
+  /// Drop the lowest matching position.
+  void clearLowest() { Mask &= Mask - 1; }
+};
+
+#ifdef LLVM_SWISSDENSEMAP_SSE2
+/// A group of 16 control bytes compared with SSE2 byte-wise compares.
+struct Group {
+  enum { Width = 16 };
+  typedef GroupMask<Width, 0> MaskT;
+
+  __m128i Ctrl;
+
+  explicit Group(const ctrl_t *Pos)
+      : Ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i *>(Pos))) {}
+
+  /// Return the positions whose control byte is \p H2.
+  MaskT match(ctrl_t H2) const {
+    __m128i Match = _mm_set1_epi8(H2);
+    return MaskT(
+        static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(Match, Ctrl))));
+  }
+
+  /// Return the positions that are empty.
+  MaskT matchEmpty() const { return match(CtrlEmpty); }
+
+  /// Return the positions that are empty or deleted.
+  MaskT matchEmptyOrDeleted() const {
+    // Only empty and deleted have the sign bit set.
+    return MaskT(static_cast<uint16_t>(_mm_movemask_epi8(Ctrl)));
+  }
+};
+#else
+/// A group of 8 control bytes compared with 64-bit arithmetic.  Each
+/// position's result lands in the top bit of its byte.
+struct Group {
+  enum { Width = 8 };
+  typedef GroupMask<Width, 3> MaskT;
+
+  uint64_t Ctrl;
+
+  explicit Group(const ctrl_t *Pos) {
+    uint8_t Bytes[8];
+    std::memcpy(Bytes, Pos, 8);
+    // Assemble in little-endian order so that position I is byte I of Ctrl.
+    Ctrl = 0;
+    for (unsigned I = 0; I != 8; ++I)
+      Ctrl |= uint64_t(Bytes[I]) << (I * 8);
+  }
+
+  MaskT match(ctrl_t H2) const {
+    const uint64_t Lsbs = 0x0101010101010101ULL;
+    const uint64_t Msbs = 0x8080808080808080ULL;
+    uint64_t X = Ctrl ^ (Lsbs * uint8_t(H2));
+    // A borrow out of a matching byte can also flag the next byte when it
+    // differs from H2 only in the lowest bit.  That byte is always a full
+    // bucket, and callers confirm every candidate with KeyInfoT::isEqual.
+    return MaskT((X - Lsbs) & ~X & Msbs);
+  }
+
+  MaskT matchEmpty() const {
+    const uint64_t Msbs = 0x8080808080808080ULL;
+    // Empty is the only value with the top bit set and bit 1 clear.
+    return MaskT((Ctrl & (~Ctrl << 6)) & Msbs);
+  }
+
+  MaskT matchEmptyOrDeleted() const {
+    const uint64_t Msbs = 0x8080808080808080ULL;
+    return MaskT(Ctrl & Msbs);
+  }
+};
+#endif
+
+/// Walks the groups of a table with triangular strides.  Because the number of
+/// buckets is a power of two no smaller than the group width, this visits
+/// every group exactly once before repeating.
+class ProbeSeq {
+  size_t Mask;
+  size_t Offset;
+  size_t Index;
+
+public:
+  ProbeSeq(size_t Hash, size_t Mask) : Mask(Mask), Offset(Hash & Mask),
+                                       Index(0) {}
+
+  size_t offset() const { return Offset; }
+  size_t offset(unsigned I) const { return (Offset + I) & Mask; }
+
+  void next() {
+    Index += Group::Width;
+    Offset = (Offset + Index) & Mask;
+  }
+
+  size_t index() const { return Index; }
+};
+
+} // end namespace swiss_detail
+
+template <typename KeyT, typename ValueT, typename KeyInfoT = DenseMapInfo<KeyT>,
+          typename BucketT = detail::DenseMapPair<KeyT, ValueT>,
+          bool IsConst = false>
+class SwissDenseMapIterator;
+
+template <typename KeyT, typename ValueT,
+          typename KeyInfoT = DenseMapInfo<KeyT>,
+          typename BucketT = detail::DenseMapPair<KeyT, ValueT>>
+class SwissDenseMap : public DebugEpochBase {
+  typedef swiss_detail::ctrl_t ctrl_t;
+  typedef swiss_detail::Group Group;
+
+public:
+  typedef unsigned size_type;
+  typedef KeyT key_type;
+  typedef ValueT mapped_type;
+  typedef BucketT value_type;
+
+  typedef SwissDenseMapIterator<KeyT, ValueT, KeyInfoT, BucketT> iterator;
+  typedef SwissDenseMapIterator<KeyT, ValueT, KeyInfoT, BucketT, true>
+      const_iterator;
+
+private:
+  /// Control bytes.  There are NumBuckets + Group::Width of them; the last
+  /// Group::Width mirror the first ones so that a group can be loaded at any
+  /// bucket without wrapping around.
+  ctrl_t *Ctrl;
+  BucketT *Buckets;
+  unsigned NumEntries;
+  unsigned NumDeleted;
+  unsigned NumBuckets;
+
+public:
+  /// Create a SwissDenseMap with room for at least \p InitialReserve entries
+  /// before it grows.
+  explicit SwissDenseMap(unsigned InitialReserve = 0)
+      : Ctrl(nullptr), Buckets(nullptr), NumEntries(0), NumDeleted(0),
+        NumBuckets(0) {
+    if (InitialReserve)
+      init(getMinBucketsForEntries(InitialReserve));
+  }
+
+  SwissDenseMap(const SwissDenseMap &Other) : SwissDenseMap() {
+    copyFrom(Other);
+  }
+
+  SwissDenseMap(SwissDenseMap &&Other) : SwissDenseMap() { swap(Other); }
+
+  template <typename InputIt>
+  SwissDenseMap(const InputIt &I, const InputIt &E) : SwissDenseMap() {
+    insert(I, E);
+  }
+
+  ~SwissDenseMap() {
+    destroyAll();
+    operator delete(Buckets);
+  }
+
+  SwissDenseMap &operator=(const SwissDenseMap &Other) {
+    if (&Other != this)
+      copyFrom(Other);
+    return *this;
+  }
+
+  SwissDenseMap &operator=(SwissDenseMap &&Other) {
+    destroyAll();
+    operator delete(Buckets);
+    Ctrl = nullptr;
+    Buckets = nullptr;
+    NumEntries = NumDeleted = NumBuckets = 0;
+    swap(Other);
+    return *this;
+  }
+
+  void swap(SwissDenseMap &RHS) {
+    this->incrementEpoch();
+    RHS.incrementEpoch();
+    std::swap(Ctrl, RHS.Ctrl);
+    std::swap(Buckets, RHS.Buckets);
+    std::swap(NumEntries, RHS.NumEntries);
+    std::swap(NumDeleted, RHS.NumDeleted);
+    std::swap(NumBuckets, RHS.NumBuckets);
+  }
+
+  inline iterator begin() {
+    return empty() ? end() : iterator(Ctrl, Buckets, Ctrl + NumBuckets, *this);
+  }
+  inline iterator end() {
+    return iterator(Ctrl + NumBuckets, Buckets + NumBuckets, Ctrl + NumBuckets,
+                    *this, true);
+  }
+  inline const_iterator begin() const {
+    return empty() ? end()
+                   : const_iterator(Ctrl, Buckets, Ctrl + NumBuckets, *this);
+  }
+  inline const_iterator end() const {
+    return const_iterator(Ctrl + NumBuckets, Buckets + NumBuckets,
+                          Ctrl + NumBuckets, *this, true);
+  }
+
+  bool LLVM_ATTRIBUTE_UNUSED_RESULT empty() const { return NumEntries == 0; }
+  unsigned size() const { return NumEntries; }
+
+  /// Grow the map so that it can hold at least \p NumEntries entries without
+  /// growing again.
+  void resize(size_type NumEntries) {
+    incrementEpoch();
+    unsigned NewNumBuckets = getMinBucketsForEntries(NumEntries);
+    if (NewNumBuckets > NumBuckets)
+      rehash(NewNumBuckets);
+  }
+
+  void clear() {
+    incrementEpoch();
+    if (NumEntries == 0 && NumDeleted == 0)
+      return;
+    destroyAll();
+    std::memset(Ctrl, swiss_detail::CtrlEmpty, NumBuckets + Group::Width);
+    NumEntries = 0;
+    NumDeleted = 0;
+  }
+
+  /// Return 1 if the specified key is in the map, 0 otherwise.
+  size_type count(const KeyT &Val) const {
+    return findBucketIndex(Val) != NumBuckets ? 1 : 0;
+  }
+
+  iterator find(const KeyT &Val) { return makeIterator(findBucketIndex(Val)); }
+  const_iterator find(const KeyT &Val) const {
+    return makeConstIterator(findBucketIndex(Val));
+  }
+
+  /// Alternate version of find() which allows a different, and possibly
+  /// less expensive, key type.
+  /// The DenseMapInfo is responsible for supplying methods
+  /// getHashValue(LookupKeyT) and isEqual(LookupKeyT, KeyT) for each key
+  /// type used.
+  template <class LookupKeyT> iterator find_as(const LookupKeyT &Val) {
+    return makeIterator(findBucketIndex(Val));
+  }
+  template <class LookupKeyT>
+  const_iterator find_as(const LookupKeyT &Val) const {
+    return makeConstIterator(findBucketIndex(Val));
+  }
+
+  /// Return the entry for the specified key, or a default constructed value
+  /// if no such entry exists.
+  ValueT lookup(const KeyT &Val) const {
+    unsigned I = findBucketIndex(Val);
+    if (I != NumBuckets)
+      return Buckets[I].getSecond();
+    return ValueT();
+  }
+
+  // Inserts key,value pair into the map if the key isn't already in the map.
+  // If the key is already in the map, it returns false and doesn't update the
+  // value.
+  std::pair<iterator, bool> insert(const std::pair<KeyT, ValueT> &KV) {
+    std::pair<unsigned, bool> R = findOrPrepareInsert(KV.first);
+    if (R.second)
+      constructBucket(R.first, KV.first, KV.second);
+    return std::make_pair(makeIterator(R.first), R.second);
+  }
+
+  // Inserts key,value pair into the map if the key isn't already in the map.
+  // If the key is already in the map, it returns false and doesn't update the
+  // value.
+  std::pair<iterator, bool> insert(std::pair<KeyT, ValueT> &&KV) {
+    std::pair<unsigned, bool> R = findOrPrepareInsert(KV.first);
+    if (R.second)
+      constructBucket(R.first, std::move(KV.first), std::move(KV.second));
+    return std::make_pair(makeIterator(R.first), R.second);
+  }
+
+  /// insert - Range insertion of pairs.
+  template <typename InputIt> void insert(InputIt I, InputIt E) {
+    for (; I != E; ++I)
+      insert(*I);
+  }
+
+  bool erase(const KeyT &Val) {
+    unsigned I = findBucketIndex(Val);
+    if (I == NumBuckets)
+      return false;
+    eraseBucket(I);
+    return true;
+  }
+  void erase(iterator I) {
+    assert(I.isHandleInSync() && "invalid iterator access!");
+    eraseBucket(I.Bucket - Buckets);
+  }
+
+  value_type &FindAndConstruct(const KeyT &Key) {
+    std::pair<unsigned, bool> R = findOrPrepareInsert(Key);
+    if (R.second)
+      constructBucket(R.first, Key, ValueT());
+    return Buckets[R.first];
+  }
+
+  ValueT &operator[](const KeyT &Key) {
+    return FindAndConstruct(Key).second;
+  }
+
+  value_type &FindAndConstruct(KeyT &&Key) {
+    std::pair<unsigned, bool> R = findOrPrepareInsert(Key);
+    if (R.second)
+      constructBucket(R.first, std::move(Key), ValueT());
+    return Buckets[R.first];
+  }
+
+  ValueT &operator[](KeyT &&Key) {
+    return FindAndConstruct(std::move(Key)).second;
+  }
+
+  /// Return the approximate size (in bytes) of the actual map.
+  /// This is just the raw memory used by the map.
+  /// If entries are pointers to objects, the size of the referenced objects
+  /// are not included.
+  size_t getMemorySize() const {
+    return NumBuckets ? getAllocationSize(NumBuckets) : 0;
+  }
+
+  unsigned getNumBuckets() const { return NumBuckets; }
+
+private:
+  static size_t getAllocationSize(unsigned NumBuckets) {
+    return sizeof(BucketT) * NumBuckets + NumBuckets + Group::Width;
+  }
+
+  /// Return the number of buckets needed to hold \p NumEntries entries while
+  /// keeping the load factor at or below 7/8.
+  static unsigned getMinBucketsForEntries(unsigned NumEntries) {
+    if (NumEntries == 0)
+      return 0;
+    unsigned Needed = NumEntries + (NumEntries + 6) / 7;
+    return std::max<unsigned>(Group::Width, NextPowerOf2(Needed - 1));
+  }
+
+  /// Split a hash into the bucket index part and the 7 bits stored in the
+  /// control byte.  DenseMapInfo hashes are often weak in their low bits
+  /// (pointers are only shifted), so mix them first.
+  static size_t getH1(uint64_t Hash) { return Hash >> 7; }
+  static ctrl_t getH2(uint64_t Hash) { return ctrl_t(Hash & 0x7f); }
+  template <class LookupKeyT> static uint64_t getHash(const LookupKeyT &Val) {
+    uint64_t H = uint64_t(KeyInfoT::getHashValue(Val)) * 0x9E3779B97F4A7C15ULL;
+    return H ^ (H >> 32);
+  }
+
+  void setCtrl(unsigned I, ctrl_t C) {
+    Ctrl[I] = C;
+    if (I < unsigned(Group::Width))
+      Ctrl[NumBuckets + I] = C;
+  }
+
+  void init(unsigned InitBuckets) {
+    assert(isPowerOf2_32(InitBuckets) && InitBuckets >= unsigned(Group::Width));
+    NumBuckets = InitBuckets;
+    char *Mem = static_cast<char *>(operator new(getAllocationSize(NumBuckets)));
+    Buckets = reinterpret_cast<BucketT *>(Mem);
+    Ctrl = reinterpret_cast<ctrl_t *>(Mem + sizeof(BucketT) * NumBuckets);
+    std::memset(Ctrl, swiss_detail::CtrlEmpty, NumBuckets + Group::Width);
+    NumEntries = 0;
+    NumDeleted = 0;
+  }
+
+  void destroyAll() {
+    if (NumEntries == 0)
+      return;
+    for (unsigned I = 0; I != NumBuckets; ++I)
+      if (swiss_detail::isFull(Ctrl[I]))
+        Buckets[I].~BucketT();
+  }
+
+  void copyFrom(const SwissDenseMap &Other) {
+    destroyAll();
+    operator delete(Buckets);
+    Ctrl = nullptr;
+    Buckets = nullptr;
+    NumEntries = NumDeleted = NumBuckets = 0;
+    if (Other.NumBuckets == 0)
+      return;
+
+    init(Other.NumBuckets);
+    std::memcpy(Ctrl, Other.Ctrl, NumBuckets + Group::Width);
+    for (unsigned I = 0; I != NumBuckets; ++I)
+      if (swiss_detail::isFull(Ctrl[I]))
+        new (&Buckets[I]) BucketT(Other.Buckets[I]);
+    NumEntries = Other.NumEntries;
+    NumDeleted = Other.NumDeleted;
+  }
+
+  template <class LookupKeyT>
+  unsigned findBucketIndex(const LookupKeyT &Val) const {
+    if (NumBuckets == 0)
+      return 0;
+    uint64_t Hash = getHash(Val);
+    ctrl_t H2 = getH2(Hash);
+    swiss_detail::ProbeSeq Seq(getH1(Hash), NumBuckets - 1);
+    while (true) {
+      Group G(Ctrl + Seq.offset());
+      for (auto M = G.match(H2); M; M.clearLowest()) {
+        unsigned I = Seq.offset(M.lowest());
+        if (LLVM_LIKELY(KeyInfoT::isEqual(Val, Buckets[I].getFirst())))
+          return I;
+      }
+      if (G.matchEmpty())
+        return NumBuckets;
+      Seq.next();
+      assert(Seq.index() < NumBuckets && "Full table!");
+    }
+  }
+
+  /// Return the first empty or deleted bucket on the probe sequence for
+  /// \p Hash.
+  unsigned findFirstNonFull(uint64_t Hash) const {
+    swiss_detail::ProbeSeq Seq(getH1(Hash), NumBuckets - 1);
+    while (true) {
+      Group G(Ctrl + Seq.offset());
+      if (auto M = G.matchEmptyOrDeleted())
+        return Seq.offset(M.lowest());
+      Seq.next();
+      assert(Seq.index() < NumBuckets && "Full table!");
+    }
+  }
+
+  /// Return the bucket holding \p Key and false, or a bucket whose control
+  /// byte has been claimed for \p Key and true.  In the latter case the
+  /// caller must construct the bucket.
+  template <class LookupKeyT>
+  std::pair<unsigned, bool> findOrPrepareInsert(const LookupKeyT &Key) {
+    unsigned I = findBucketIndex(Key);
+    if (NumBuckets && I != NumBuckets)
+      return std::make_pair(I, false);
+
+    incrementEpoch();
+    uint64_t Hash = getHash(Key);
+    // Grow when the table would exceed a 7/8 load factor.  If many of the
+    // used buckets only hold deleted markers, rehash in place instead.
+    if (NumBuckets == 0 ||
+        (NumEntries + NumDeleted + 1) * 8 > NumBuckets * 7) {
+      if (NumBuckets && NumEntries * 32 <= NumBuckets * 25)
+        rehash(NumBuckets);
+      else
+        rehash(NumBuckets ? NumBuckets * 2 : unsigned(Group::Width));
+    }
+
+    I = findFirstNonFull(Hash);
+    if (Ctrl[I] == swiss_detail::CtrlDeleted)
+      --NumDeleted;
+    ++NumEntries;
+    setCtrl(I, getH2(Hash));
+    return std::make_pair(I, true);
+  }
+
+  template <typename KeyArg, typename ValueArg>
+  void constructBucket(unsigned I, KeyArg &&Key, ValueArg &&Value) {
+    BucketT *B = &Buckets[I];
+    new (&B->getFirst()) KeyT(std::forward<KeyArg>(Key));
+    new (&B->getSecond()) ValueT(std::forward<ValueArg>(Value));
+  }
+
+  void eraseBucket(unsigned I) {
+    assert(swiss_detail::isFull(Ctrl[I]) && "Erasing an empty bucket!");
+    Buckets[I].~BucketT();
+    --NumEntries;
+
+    // If no probe sequence could have passed through this bucket while it was
+    // full, it can go back to empty: that is the case when the window of
+    // Group::Width buckets around it was never entirely full.
+    unsigned Before = (I - Group::Width) & (NumBuckets - 1);
+    auto EmptyAfter = Group(Ctrl + I).matchEmpty();
+    auto EmptyBefore = Group(Ctrl + Before).matchEmpty();
+    bool WasNeverFull =
+        EmptyBefore && EmptyAfter &&
+        EmptyAfter.trailingZeros() + EmptyBefore.leadingZeros() <
+            unsigned(Group::Width);
+    if (WasNeverFull) {
+      setCtrl(I, swiss_detail::CtrlEmpty);
+    } else {
+      setCtrl(I, swiss_detail::CtrlDeleted);
+      ++NumDeleted;
+    }
+  }
+
+  void rehash(unsigned NewNumBuckets) {
+    ctrl_t *OldCtrl = Ctrl;
+    BucketT *OldBuckets = Buckets;
+    unsigned OldNumBuckets = NumBuckets;
+    unsigned OldNumEntries = NumEntries;
+
+    init(NewNumBuckets);
+    for (unsigned I = 0; I != OldNumBuckets; ++I) {
+      if (!swiss_detail::isFull(OldCtrl[I]))
+        continue;
+      BucketT &B = OldBuckets[I];
+      uint64_t Hash = getHash(B.getFirst());
+      unsigned Dest = findFirstNonFull(Hash);
+      setCtrl(Dest, getH2(Hash));
+      constructBucket(Dest, std::move(B.getFirst()), std::move(B.getSecond()));
+      B.~BucketT();
+    }
+    NumEntries = OldNumEntries;
+    operator delete(OldBuckets);
+  }
+
+  iterator makeIterator(unsigned I) {
+    if (I >= NumBuckets)
+      return end();
+    return iterator(Ctrl + I, Buckets + I, Ctrl + NumBuckets, *this, true);
+  }
+  const_iterator makeConstIterator(unsigned I) const {
+    if (I >= NumBuckets)
+      return end();
+    return const_iterator(Ctrl + I, Buckets + I, Ctrl + NumBuckets, *this,
+                          true);
+  }
+
+  friend class SwissDenseMapIterator<KeyT, ValueT, KeyInfoT, BucketT, false>;
+  friend class SwissDenseMapIterator<KeyT, ValueT, KeyInfoT, BucketT, true>;
+};
+
+template <typename KeyT, typename ValueT, typename KeyInfoT, typename BucketT>
+inline void swap(SwissDenseMap<KeyT, ValueT, KeyInfoT, BucketT> &LHS,
+                 SwissDenseMap<KeyT, ValueT, KeyInfoT, BucketT> &RHS) {
+  LHS.swap(RHS);
+}
+
+template <typename KeyT, typename ValueT, typename KeyInfoT, typename BucketT,
+          bool IsConst>
+class SwissDenseMapIterator : DebugEpochBase::HandleBase {
+  typedef SwissDenseMapIterator<KeyT, ValueT, KeyInfoT, BucketT, true>
+      ConstIterator;
+  friend class SwissDenseMapIterator<KeyT, ValueT, KeyInfoT, BucketT, true>;
+  friend class SwissDenseMapIterator<KeyT, ValueT, KeyInfoT, BucketT, false>;
+  friend class SwissDenseMap<KeyT, ValueT, KeyInfoT, BucketT>;
+
+public:
+  typedef ptrdiff_t difference_type;
+  typedef typename std::conditional<IsConst, const BucketT, BucketT>::type
+      value_type;
+  typedef value_type *pointer;
+  typedef value_type &reference;
+  typedef std::forward_iterator_tag iterator_category;
+
+private:
+  const swiss_detail::ctrl_t *CtrlPtr, *CtrlEnd;
+  pointer Bucket;
+
+public:
+  SwissDenseMapIterator() : CtrlPtr(nullptr), CtrlEnd(nullptr),
+                            Bucket(nullptr) {}
+
+  SwissDenseMapIterator(const swiss_detail::ctrl_t *CtrlPtr, pointer Bucket,
+                        const swiss_detail::ctrl_t *CtrlEnd,
+                        const DebugEpochBase &Epoch, bool NoAdvance = false)
+      : DebugEpochBase::HandleBase(&Epoch), CtrlPtr(CtrlPtr), CtrlEnd(CtrlEnd),
+        Bucket(Bucket) {
+    assert(isHandleInSync() && "invalid construction!");
+    if (!NoAdvance)
+      AdvancePastEmptyBuckets();
+  }
+
+  // If IsConst is true this is a converting constructor from iterator to
+  // const_iterator and the default copy constructor is used.
+  // Otherwise this is a copy constructor for iterator.
+  SwissDenseMapIterator(
+      const SwissDenseMapIterator<KeyT, ValueT, KeyInfoT, BucketT, false> &I)
+      : DebugEpochBase::HandleBase(I), CtrlPtr(I.CtrlPtr), CtrlEnd(I.CtrlEnd),
+        Bucket(I.Bucket) {}
+
+  reference operator*() const {
+    assert(isHandleInSync() && "invalid iterator access!");
+    return *Bucket;
+  }
+  pointer operator->() const {
+    assert(isHandleInSync() && "invalid iterator access!");
+    return Bucket;
+  }
+
+  bool operator==(const ConstIterator &RHS) const {
+    assert((!CtrlPtr || isHandleInSync()) && "handle not in sync!");
+    assert((!RHS.CtrlPtr || RHS.isHandleInSync()) && "handle not in sync!");
+    assert(getEpochAddress() == RHS.getEpochAddress() &&
+           "comparing incomparable iterators!");
+    return CtrlPtr == RHS.CtrlPtr;
+  }
+  bool operator!=(const ConstIterator &RHS) const { return !(*this == RHS); }
+
+  inline SwissDenseMapIterator &operator++() { // Preincrement
+    assert(isHandleInSync() && "invalid iterator access!");
+    ++CtrlPtr;
+    ++Bucket;
+    AdvancePastEmptyBuckets();
+    return *this;
+  }
+  SwissDenseMapIterator operator++(int) { // Postincrement
+    assert(isHandleInSync() && "invalid iterator access!");
+    SwissDenseMapIterator tmp = *this;
+    ++*this;
+    return tmp;
+  }
+
+private:
+  void AdvancePastEmptyBuckets() {
+    while (CtrlPtr != CtrlEnd && !swiss_detail::isFull(*CtrlPtr)) {
+      ++CtrlPtr;
+      ++Bucket;
+    }
+  }
+};
+
+template <typename KeyT, typename ValueT, typename KeyInfoT, typename BucketT>
+static inline size_t
+capacity_in_bytes(const SwissDenseMap<KeyT, ValueT, KeyInfoT, BucketT> &X) {
+  return X.getMemorySize();
+}
+
+} // end namespace llvm
+
+#endif
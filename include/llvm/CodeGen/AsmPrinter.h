@@ -521,6 +521,10 @@ private:
   /// This method emits the header for the current function.
   virtual void EmitFunctionHeader();
 
+  /// End the hot part of a split function and start its cold part in the
+  /// cold section. Returns the symbol of the cold part.
+  MCSymbol *emitColdSectionStart();
+
   /// Emit a blob of inline asm to the output streamer.
   void
   EmitInlineAsm(StringRef Str, const MCSubtargetInfo &STI,
@@ -316,6 +316,21 @@ extern cl::opt<bool> UseSegmentSetForPhysRegs;
                                 MachineBasicBlock::iterator End,
                                 ArrayRef<unsigned> OrigRegs);
 
+    /// recomputeVirtRegIntervals - Throw away the live intervals of the
+    /// virtual registers in Regs and compute them again from their current
+    /// defs and uses. Every other live interval is left alone, so this costs
+    /// a few walks over the use lists rather than a whole new LiveIntervals.
+    /// It is meant for transforms that change a register in ways that are
+    /// hard to patch into its live interval by hand.
+    void recomputeVirtRegIntervals(ArrayRef<unsigned> Regs);
+
+    /// verifyUpdatedIntervals - When -verify-liveinterval-updates is given,
+    /// compute the live interval of every virtual register from scratch and
+    /// check that the incrementally updated interval and its subranges are
+    /// live at exactly the same points. A failure is reported as a fatal error
+    /// naming Banner. Does nothing otherwise.
+    void verifyUpdatedIntervals(const char *Banner);
+
     // Register mask functions.
     //
     // Machine instructions may use a register mask operand to indicate that a
@@ -120,6 +120,10 @@ private:
   /// Indicate that this basic block is the entry block of a cleanup funclet.
   bool IsCleanupFuncletEntry = false;
 
+  /// Indicate that this basic block is the first of the blocks at the end of
+  /// the function that are emitted in a separate cold section.
+  bool IsColdSectionStart = false;
+
   /// \brief since getSymbol is a relatively heavy-weight operation, the symbol
   /// is only computed once and is cached.
   mutable MCSymbol *CachedMCSymbol = nullptr;
@@ -417,6 +421,12 @@ public:
   /// Indicates if this is the entry block of a cleanup funclet.
   void setIsCleanupFuncletEntry(bool V = true) { IsCleanupFuncletEntry = V; }
 
+  /// Returns true if this block starts the cold part of a split function.
+  bool isColdSectionStart() const { return IsColdSectionStart; }
+
+  /// Indicates that this block starts the cold part of a split function.
+  void setIsColdSectionStart(bool V = true) { IsColdSectionStart = V; }
+
   // Code Layout methods.
 
   /// Move 'this' block before or after the specified block.  This only moves
@@ -37,6 +37,7 @@ class MachineConstantPool;
 class MachineJumpTableInfo;
 class MachineModuleInfo;
 class MCContext;
+class MemoryUsageReport;
 class Pass;
 class PseudoSourceValueManager;
 class TargetMachine;
@@ -336,6 +337,10 @@ public:
   /// verifier, useful for debugger use.
   void verify(Pass *p = nullptr, const char *Banner = nullptr) const;
 
+  /// getMemoryUsage - Append the bytes held by this function's allocator and
+  /// per-block and per-register tables to \p Report.
+  void getMemoryUsage(MemoryUsageReport &Report) const;
+
   // Provide accessors for the MachineBasicBlock list...
   typedef BasicBlockListType::iterator iterator;
   typedef BasicBlockListType::const_iterator const_iterator;
@@ -562,6 +562,14 @@ namespace llvm {
   /// memory operations.
   extern char &ImplicitNullChecksID;
 
+  /// MachineOutliner - This pass replaces repeated instruction sequences with
+  /// calls to a single copy of the sequence.
+  extern char &MachineOutlinerID;
+
+  /// MachineFunctionSplitter - This pass moves blocks that profile data shows
+  /// to be cold into a separate section.
+  extern char &MachineFunctionSplitterID;
+
   /// MachineLICM - This pass performs LICM on machine instructions.
   extern char &MachineLICMID;
 
@@ -15,6 +15,7 @@
 #ifndef LLVM_CODEGEN_SELECTIONDAGISEL_H
 #define LLVM_CODEGEN_SELECTIONDAGISEL_H
 
+#include "llvm/ADT/StringMap.h"
 #include "llvm/CodeGen/MachineFunctionPass.h"
 #include "llvm/CodeGen/SelectionDAG.h"
 #include "llvm/IR/BasicBlock.h"
@@ -66,6 +67,8 @@ public:
 
   bool runOnMachineFunction(MachineFunction &MF) override;
 
+  bool doFinalization(Module &M) override;
+
   virtual void EmitFunctionEntryCode() {}
 
   /// PreprocessISelDAG - This hook allows targets to hack on the graph before
@@ -284,6 +287,14 @@ private:
 
   void ComputeLiveOutVRegInfo();
 
+  /// The number of times fast isel fell back to SelectionDAG in the module,
+  /// by the kind of instruction it failed on, with -fast-isel-report.
+  StringMap<unsigned> FastISelFallbacks;
+
+  /// Record a fallback from fast isel to SelectionDAG, on instruction \p I or
+  /// on the arguments of the function if \p I is null.
+  void recordFastISelFallback(const Instruction *I);
+
   /// Create the scheduler. If a specific scheduler was specified
   /// via the SchedulerRegistry, use it, otherwise select the
   /// one preferred by the target.
@@ -125,6 +125,7 @@ enum DIDumpType {
   DIDT_AppleTypes,
   DIDT_AppleNamespaces,
   DIDT_AppleObjC,
+  DIDT_DebugNames,
   DIDT_CUIndex,
   DIDT_TUIndex,
 };
@@ -14,6 +14,8 @@
 #include "llvm/DebugInfo/DWARF/DWARFFormValue.h"
 #include "llvm/DebugInfo/DWARF/DWARFRelocMap.h"
 #include <cstdint>
+#include <map>
+#include <vector>
 
 namespace llvm {
 
@@ -49,6 +51,97 @@ public:
   void dump(raw_ostream &OS) const;
 };
 
+/// The DWARF v5 name index (.debug_names). A linked binary usually holds one
+/// index per object file, one after the other.
+class DWARFDebugNames {
+public:
+  /// A DIE found through the index.
+  struct Entry {
+    uint32_t Tag;
+    /// Offset of the header of the unit holding the DIE in .debug_info.
+    uint32_t CUOffset;
+    /// Offset of the DIE relative to the start of its unit.
+    uint32_t DIEOffset;
+  };
+
+  /// One name index of the section.
+  class NameIndex {
+    struct Header {
+      uint32_t UnitLength;
+      uint16_t Version;
+      uint16_t Padding;
+      uint32_t CompUnitCount;
+      uint32_t LocalTypeUnitCount;
+      uint32_t ForeignTypeUnitCount;
+      uint32_t BucketCount;
+      uint32_t NameCount;
+      uint32_t AbbrevTableSize;
+      uint32_t AugmentationStringSize;
+    };
+
+    struct Abbrev {
+      uint32_t Code;
+      uint32_t Tag;
+      SmallVector<std::pair<uint16_t, uint16_t>, 2> Attributes;
+    };
+
+    const DWARFDebugNames &Section;
+    uint32_t Base;
+    Header Hdr;
+    uint32_t CUsBase;
+    uint32_t BucketsBase;
+    uint32_t HashesBase;
+    uint32_t StringOffsetsBase;
+    uint32_t EntryOffsetsBase;
+    uint32_t EntriesBase;
+    uint32_t End;
+    std::map<uint32_t, Abbrev> Abbrevs;
+
+    uint32_t getCUOffset(uint32_t CU) const;
+    uint32_t getHash(uint32_t Index) const;
+    uint32_t getStringOffset(uint32_t Index) const;
+    /// Read the next entry of a name. Returns false at the end of the list or
+    /// on malformed input.
+    bool extractEntry(uint32_t *Offset, Entry &E) const;
+    void dumpName(raw_ostream &OS, uint32_t Index) const;
+
+  public:
+    NameIndex(const DWARFDebugNames &Section, uint32_t Base)
+        : Section(Section), Base(Base) {}
+
+    bool extract();
+    uint32_t getNextOffset() const { return End; }
+    void dump(raw_ostream &OS) const;
+    /// Append the entries for Name to Result, probing the hash table.
+    void lookup(StringRef Name, std::vector<Entry> &Result) const;
+  };
+
+private:
+  DataExtractor NamesSection;
+  DataExtractor StringSection;
+  const RelocAddrMap &Relocs;
+  std::vector<NameIndex> Indices;
+
+  uint32_t getRelocatedU32(uint32_t Offset) const;
+
+  DWARFDebugNames(const DWARFDebugNames &) = delete;
+  void operator=(const DWARFDebugNames &) = delete;
+
+public:
+  DWARFDebugNames(DataExtractor NamesSection, DataExtractor StringSection,
+                  const RelocAddrMap &Relocs)
+      : NamesSection(NamesSection), StringSection(StringSection),
+        Relocs(Relocs) {}
+
+  /// Parse the name indices of the section. Returns false if an index could
+  /// not be parsed; the ones before it remain usable.
+  bool extract();
+  void dump(raw_ostream &OS) const;
+  /// Return the entries for Name from all the name indices.
+  std::vector<Entry> lookup(StringRef Name) const;
+  bool empty() const { return Indices.empty(); }
+};
+
 }
 
 #endif
@@ -22,6 +22,7 @@
 namespace llvm {
 
 class LLVMContextImpl;
+class MemoryUsageReport;
 class StringRef;
 class Twine;
 class Instruction;
@@ -93,6 +94,11 @@ public:
   /// tag registered with an LLVMContext has an unique ID.
   uint32_t getOperandBundleTagID(StringRef Tag) const;
 
+  /// getMemoryUsage - Append the number of bytes held by each of the
+  /// context's type, constant, metadata and attribute uniquing tables, and by
+  /// its allocators, to \p Report.
+  void getMemoryUsage(MemoryUsageReport &Report) const;
+
   typedef void (*InlineAsmDiagHandlerTy)(const SMDiagnostic&, void *Context,
                                          unsigned LocCookie);
 
@@ -32,6 +32,7 @@ namespace llvm {
 class FunctionType;
 class GVMaterializer;
 class LLVMContext;
+class MemoryUsageReport;
 class RandomNumberGenerator;
 class StructType;
 
@@ -583,6 +584,12 @@ public:
   /// be called where all uses of the LLVMContext are understood.
   void dropTriviallyDeadConstantArrays();
 
+  /// Append an estimate of the bytes held by this module's globals,
+  /// functions, instructions and symbol tables to \p Report.  Types,
+  /// constants and metadata are owned by the LLVMContext and are reported by
+  /// LLVMContext::getMemoryUsage instead.
+  void getMemoryUsage(MemoryUsageReport &Report) const;
+
 /// @}
 /// @name Utility functions for printing and dumping Module objects
 /// @{
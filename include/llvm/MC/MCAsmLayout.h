@@ -55,6 +55,12 @@ public:
   /// its bundle padding will be recomputed.
   void invalidateFragmentsFrom(MCFragment *F);
 
+  /// \brief Recompute the offset of the valid fragment F from its predecessor,
+  /// leaving the fragments after it valid with their current offsets. This is
+  /// used during relaxation, which recomputes the offsets of all the fragments
+  /// after a relaxed one in order.
+  void relayoutFragment(MCFragment *F);
+
   /// \brief Perform layout for a single fragment, assuming that the previous
   /// fragment has already been laid out correctly, and the parent section has
   /// been initialized.
@@ -216,6 +216,12 @@ public:
   void writeSectionData(const MCSection *Section,
                         const MCAsmLayout &Layout) const;
 
+  /// Free the contents and fixups of the fragments of \p Section once they
+  /// have been written out, so that an object writer does not hold both the
+  /// fragments and the object in memory. Neither the section data nor the
+  /// size of the section can be computed from the fragments afterwards.
+  void releaseSectionData(MCSection *Section);
+
   /// Check whether a given symbol has been flagged with .thumb_func.
   bool isThumbFunc(const MCSymbol *Func) const;
 
@@ -106,6 +106,10 @@ protected:
   MCSection *DwarfAccelNamespaceSection;
   MCSection *DwarfAccelTypesSection;
 
+  /// The DWARF v5 name index, the standard counterpart of the accelerator
+  /// tables above.
+  MCSection *DwarfDebugNamesSection;
+
   // These are used for the Fission separate debug information files.
   MCSection *DwarfInfoDWOSection;
   MCSection *DwarfTypesDWOSection;
@@ -257,6 +261,9 @@ public:
   MCSection *getDwarfAccelTypesSection() const {
     return DwarfAccelTypesSection;
   }
+  MCSection *getDwarfDebugNamesSection() const {
+    return DwarfDebugNamesSection;
+  }
   MCSection *getDwarfInfoDWOSection() const { return DwarfInfoDWOSection; }
   MCSection *getDwarfTypesSection(uint64_t Hash) const;
   MCSection *getDwarfTypesDWOSection() const { return DwarfTypesDWOSection; }
@@ -369,6 +369,11 @@ protected:
 /// @brief This is the storage for the -time-passes option.
 extern bool TimePassesIsEnabled;
 
+/// If the user specifies the -print-memory-usage argument on an LLVM tool
+/// command line then the value of this boolean will be true, otherwise false.
+/// @brief This is the storage for the -print-memory-usage option.
+extern bool PrintMemoryUsageIsEnabled;
+
 } // End llvm namespace
 
 // Include support files that contain important APIs commonly used by Passes,
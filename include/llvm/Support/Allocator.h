@@ -189,12 +189,12 @@ public:
   void Reset() {
     DeallocateCustomSizedSlabs();
     CustomSizedSlabs.clear();
+    BytesAllocated = 0;
 
     if (Slabs.empty())
       return;
 
     // Reset the state.
-    BytesAllocated = 0;
     CurPtr = (char *)Slabs.front();
     End = CurPtr + SlabSize;
 
@@ -268,6 +268,10 @@ public:
 
   size_t GetNumSlabs() const { return Slabs.size() + CustomSizedSlabs.size(); }
 
+  /// \brief Return the number of bytes handed out by Allocate() since the last
+  /// Reset(), excluding alignment padding and unused slab space.
+  size_t getBytesAllocated() const { return BytesAllocated; }
+
   size_t getTotalMemory() const {
     size_t TotalMemory = 0;
     for (auto I = Slabs.begin(), E = Slabs.end(); I != E; ++I)
@@ -19,6 +19,7 @@
 namespace llvm {
 template <typename T> class SmallVectorImpl;
 class StringRef;
+class ThreadPool;
 
 namespace zlib {
 
@@ -43,6 +44,29 @@ bool isAvailable();
 Status compress(StringRef InputBuffer, SmallVectorImpl<char> &CompressedBuffer,
                 CompressionLevel Level = DefaultCompression);
 
+/// Compress \p InputBuffer into a single zlib stream, like compress(), but
+/// deflate it as independent chunks of \p ChunkSize bytes on up to
+/// \p NumThreads threads (zero means one per hardware thread).
+///
+/// Each chunk is primed with the 32K of input preceding it, so the ratio
+/// stays close to that of compress().  The result only depends on the input,
+/// \p Level and \p ChunkSize, never on the number of threads, so it is
+/// suitable for reproducible builds.  Inputs no larger than \p ChunkSize
+/// produce exactly the output of compress().
+Status compressParallel(StringRef InputBuffer,
+                        SmallVectorImpl<char> &CompressedBuffer,
+                        CompressionLevel Level = DefaultCompression,
+                        unsigned NumThreads = 0,
+                        size_t ChunkSize = 1024 * 1024);
+
+/// Like the above, but deflate the chunks on \p Pool, so that callers
+/// compressing many buffers do not start new threads for each of them.
+Status compressParallel(StringRef InputBuffer,
+                        SmallVectorImpl<char> &CompressedBuffer,
+                        ThreadPool &Pool,
+                        CompressionLevel Level = DefaultCompression,
+                        size_t ChunkSize = 1024 * 1024);
+
 Status uncompress(StringRef InputBuffer,
                   SmallVectorImpl<char> &UncompressedBuffer,
                   size_t UncompressedSize);
@@ -587,6 +587,17 @@ enum AcceleratorTable {
   DW_hash_function_djb = 0u
 };
 
+// Constants for the DWARF v5 name index (.debug_names).
+enum NameIndexAttribute : uint16_t {
+  DW_IDX_compile_unit = 0x01, // Index of the CU containing the entry.
+  DW_IDX_type_unit = 0x02,    // Index of the TU containing the entry.
+  DW_IDX_die_offset = 0x03,   // Offset of the DIE within its unit.
+  DW_IDX_parent = 0x04,       // Index entry of the parent DIE.
+  DW_IDX_type_hash = 0x05,    // Hash of the type declaration.
+  DW_IDX_lo_user = 0x2000,
+  DW_IDX_hi_user = 0x3fff
+};
+
 // Constants for the GNU pubnames/pubtypes extensions supporting gdb index.
 enum GDBIndexEntryKind {
   GIEK_NONE,
@@ -634,6 +645,7 @@ const char *MacinfoString(unsigned Encoding);
 const char *CallFrameString(unsigned Encoding);
 const char *ApplePropertyString(unsigned);
 const char *AtomTypeString(unsigned Atom);
+const char *IndexString(unsigned Idx);
 const char *GDBIndexEntryKindString(GDBIndexEntryKind Kind);
 const char *GDBIndexEntryLinkageString(GDBIndexEntryLinkage Linkage);
 /// @}
@@ -660,6 +672,18 @@ unsigned getMacinfo(StringRef MacinfoString);
 /// for attribute Attr.
 const char *AttributeValueString(uint16_t Attr, unsigned Val);
 
+/// \brief Hash a name for the DWARF v5 name index (.debug_names).
+///
+/// This is the Bernstein hash used by the Apple accelerator tables, computed
+/// over the name with upper case ASCII letters folded to lower case, so that
+/// consumers can look names up case-insensitively.
+///
+/// DWARF v5 asks for Unicode full case folding, but only ASCII is folded
+/// here; the bytes of other UTF-8 characters are hashed unchanged. Names with
+/// non-ASCII upper case letters therefore hash differently than in a consumer
+/// that folds them, and such a consumer will not find them.
+uint32_t NameIndexHash(StringRef Name);
+
 /// \brief Decsribes an entry of the various gnu_pub* debug sections.
 ///
 /// The gnu_pub* kind looks like:
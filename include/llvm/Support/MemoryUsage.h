@@ -0,0 +1,82 @@
+//===- llvm/Support/MemoryUsage.h - Memory accounting reports ---*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+///
+/// This file defines MemoryUsageReport, a flat list of named byte counts that
+/// long-lived data structures (allocators, uniquing tables, per-module and
+/// per-function storage) append to so that clients can find out where memory
+/// is held and enforce per-job limits.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_MEMORYUSAGE_H
+#define LLVM_SUPPORT_MEMORYUSAGE_H
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace llvm {
+
+class raw_ostream;
+
+/// \brief A list of (name, bytes) pairs describing the memory held by a set
+/// of data structures.
+///
+/// Byte counts are the memory owned by a structure itself (bucket arrays,
+/// allocator slabs); they do not include objects that are separately
+/// accounted for under another name.
+class MemoryUsageReport {
+public:
+  typedef std::pair<std::string, size_t> Entry;
+  typedef std::vector<Entry>::const_iterator const_iterator;
+
+private:
+  std::vector<Entry> Entries;
+
+public:
+  /// \brief Record that the structure called \p Name holds \p Bytes bytes.
+  void add(const Twine &Name, size_t Bytes) {
+    Entries.push_back(Entry(Name.str(), Bytes));
+  }
+
+  /// \brief Record the slabs owned by an LLVM-style allocator which provides
+  /// \c getTotalMemory(), such as \c BumpPtrAllocator.
+  template <typename AllocatorT>
+  void addAllocator(const Twine &Name, const AllocatorT &Allocator) {
+    add(Name, Allocator.getTotalMemory());
+  }
+
+  /// \brief Append every entry of \p Other, with each name prefixed by
+  /// \p Prefix.
+  void append(StringRef Prefix, const MemoryUsageReport &Other);
+
+  const_iterator begin() const { return Entries.begin(); }
+  const_iterator end() const { return Entries.end(); }
+  size_t size() const { return Entries.size(); }
+  bool empty() const { return Entries.empty(); }
+  void clear() { Entries.clear(); }
+
+  /// \brief Return the bytes recorded for \p Name, or zero if there is no
+  /// such entry.
+  size_t getBytes(StringRef Name) const;
+
+  /// \brief Return the sum of all recorded byte counts.
+  size_t getTotalBytes() const;
+
+  /// \brief Print the report, largest entries first, under the heading
+  /// \p Title.
+  void print(raw_ostream &OS, StringRef Title) const;
+};
+
+} // end namespace llvm
+
+#endif
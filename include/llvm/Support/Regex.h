@@ -22,6 +22,7 @@
 struct llvm_regex;
 
 namespace llvm {
+  class RegexDFA;
   class StringRef;
   template<typename T> class SmallVectorImpl;
 
@@ -49,12 +50,15 @@ namespace llvm {
     Regex &operator=(Regex regex) {
       std::swap(preg, regex.preg);
       std::swap(error, regex.error);
+      std::swap(dfa, regex.dfa);
       return *this;
     }
     Regex(Regex &&regex) {
       preg = regex.preg;
       error = regex.error;
+      dfa = regex.dfa;
       regex.preg = nullptr;
+      regex.dfa = nullptr;
     }
     ~Regex();
 
@@ -99,6 +103,10 @@ namespace llvm {
   private:
     struct llvm_regex *preg;
     int error;
+    /// A DFA for the pattern, used in front of \c preg to decide quickly
+    /// whether and where there is a match. Null for patterns it cannot handle,
+    /// such as those with back-references.
+    RegexDFA *dfa;
   };
 }
 
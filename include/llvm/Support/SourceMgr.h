@@ -49,13 +49,30 @@ private:
     /// The memory buffer for the file.
     std::unique_ptr<MemoryBuffer> Buffer;
 
+    /// A sorted vector of the offsets of every '\n' in the buffer, built
+    /// lazily on the first line number query.  The element type is the
+    /// narrowest of uint8_t, uint16_t, uint32_t and uint64_t that can hold
+    /// any offset into the buffer, so the index stays small for small files.
+    mutable void *OffsetCache;
+
+    /// Return the 1-based line number of \p Ptr, which must point into (or
+    /// one past the end of) this buffer.
+    unsigned getLineNumber(const char *Ptr) const;
+    template <typename T>
+    unsigned getLineNumberImpl(const char *Ptr) const;
+
     /// This is the location of the parent include, or null if at the top level.
     SMLoc IncludeLoc;
 
-    SrcBuffer() {}
+    SrcBuffer() : OffsetCache(nullptr) {}
 
     SrcBuffer(SrcBuffer &&O)
-        : Buffer(std::move(O.Buffer)), IncludeLoc(O.IncludeLoc) {}
+        : Buffer(std::move(O.Buffer)), OffsetCache(O.OffsetCache),
+          IncludeLoc(O.IncludeLoc) {
+      O.OffsetCache = nullptr;
+    }
+
+    ~SrcBuffer();
   };
 
   /// This is all of the buffers that we are reading from.
@@ -64,10 +81,6 @@ private:
   // This is the list of directories we should search for include files in.
   std::vector<std::string> IncludeDirectories;
 
-  /// This is a cache for line number queries, its implementation is really
-  /// private to SourceMgr.cpp.
-  mutable void *LineNoCache;
-
   DiagHandlerTy DiagHandler;
   void *DiagContext;
 
@@ -76,9 +89,7 @@ private:
   SourceMgr(const SourceMgr&) = delete;
   void operator=(const SourceMgr&) = delete;
 public:
-  SourceMgr()
-    : LineNoCache(nullptr), DiagHandler(nullptr), DiagContext(nullptr) {}
-  ~SourceMgr();
+  SourceMgr() : DiagHandler(nullptr), DiagContext(nullptr) {}
 
   void setIncludeDirs(const std::vector<std::string> &Dirs) {
     IncludeDirectories = Dirs;
@@ -0,0 +1,48 @@
+//===- llvm/Support/xxhash.h - Stable 64-bit hashing ------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+///
+/// This file implements the xxHash64 algorithm by Yann Collet.
+///
+/// Unlike hash_value and hash_combine in ADT/Hashing.h, which are seeded per
+/// execution and must never be persisted, xxHash64 is fully specified: the
+/// result for a given input is the same on every host, every run and every
+/// LLVM version.  Use it for hashes that are written to disk, such as cache
+/// keys and profile data.  It also processes long inputs 32 bytes at a time
+/// with four independent accumulators, which keeps it fast on large buffers.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SUPPORT_XXHASH_H
+#define LLVM_SUPPORT_XXHASH_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/DataTypes.h"
+
+namespace llvm {
+
+/// \brief Compute the xxHash64 of \p Data with the given \p Seed.  The
+/// default seed of zero gives the canonical, stable hash.
+uint64_t xxHash64(StringRef Data, uint64_t Seed = 0);
+
+/// \brief Compute the xxHash64 of \p Data with the given \p Seed.
+inline uint64_t xxHash64(ArrayRef<uint8_t> Data, uint64_t Seed = 0) {
+  return xxHash64(
+      StringRef(reinterpret_cast<const char *>(Data.data()), Data.size()),
+      Seed);
+}
+
+/// \brief Compute a stable hash of a single 64-bit integer.  The result is
+/// the xxHash64 of its eight little-endian bytes, computed without a buffer.
+uint64_t xxHash64(uint64_t Value, uint64_t Seed = 0);
+
+} // end namespace llvm
+
+#endif
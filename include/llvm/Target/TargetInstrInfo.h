@@ -25,6 +25,7 @@
 namespace llvm {
 
 class InstrItineraryData;
+class LivePhysRegs;
 class LiveVariables;
 class MCAsmInfo;
 class MachineMemOperand;
@@ -1403,6 +1404,57 @@ public:
     return None;
   }
 
+  /// How the machine outliner treats an instruction.
+  enum MachineOutlinerInstrType {
+    /// The instruction may be part of an outlined sequence.
+    MachineOutlinerLegal,
+    /// The instruction is never outlined, and no sequence spans it.
+    MachineOutlinerIllegal,
+    /// The instruction emits no code (e.g. DBG_VALUE). It is ignored when
+    /// comparing sequences and is deleted along with the sequence it is in.
+    MachineOutlinerInvisible
+  };
+
+  /// Return true if the machine outliner may factor sequences out of \p MF.
+  virtual bool isFunctionSafeToOutlineFrom(const MachineFunction &MF) const {
+    return false;
+  }
+
+  /// Return how the machine outliner should treat \p MI. A legal instruction
+  /// must behave the same when it runs in an outlined subroutine, entered
+  /// through the call built by insertOutlinedCall, as it does in place.
+  virtual MachineOutlinerInstrType
+  getOutliningType(const MachineInstr &MI) const {
+    return MachineOutlinerIllegal;
+  }
+
+  /// Return true if a call to an outlined subroutine may be inserted at a
+  /// point where the registers in \p LiveRegs are live.
+  virtual bool isOutlinedCallLegal(const LivePhysRegs &LiveRegs) const {
+    return true;
+  }
+
+  /// Insert a call to the outlined subroutine that starts at \p Callee into
+  /// \p MBB before \p It, and return the call.
+  virtual MachineInstr *insertOutlinedCall(MachineBasicBlock &MBB,
+                                           MachineBasicBlock::iterator It,
+                                           MachineBasicBlock &Callee) const {
+    llvm_unreachable("Target didn't implement insertOutlinedCall!");
+  }
+
+  /// Append the return from an outlined subroutine to \p MBB.
+  virtual void insertOutlinedReturn(MachineBasicBlock &MBB) const {
+    llvm_unreachable("Target didn't implement insertOutlinedReturn!");
+  }
+
+  /// Return true if the cold blocks of \p MF may be emitted in a separate
+  /// section from the rest of the function. Branches between the two parts
+  /// are resolved by the linker, so every branch the target may use for them
+  /// must be able to reach any address.
+  virtual bool isFunctionSafeToSplit(const MachineFunction &MF) const {
+    return false;
+  }
+
 private:
   unsigned CallFrameSetupOpcode, CallFrameDestroyOpcode;
   unsigned CatchRetOpcode;
@@ -903,7 +903,12 @@ void AsmPrinter::EmitFunctionBody() {
 
   // Print out code for the function.
   bool HasAnyRealCode = false;
+  MCSymbol *ColdFnSym = nullptr;
   for (auto &MBB : *MF) {
+    // The blocks from here on go to the cold section.
+    if (MBB.isColdSectionStart())
+      ColdFnSym = emitColdSectionStart();
+
     // Print a label for the basic block.
     EmitBasicBlockStart(MBB);
     for (auto &MI : MBB) {
@@ -1010,11 +1015,14 @@ void AsmPrinter::EmitFunctionBody() {
   // it.
   if (MAI->hasDotTypeDotSizeDirective()) {
     // We can get the size as difference between the function label and the
-    // temp label.
+    // temp label. For a split function, this is the size of the cold part.
+    MCSymbol *SizeSym = ColdFnSym ? ColdFnSym : CurrentFnSym;
     const MCExpr *SizeExp = MCBinaryExpr::createSub(
         MCSymbolRefExpr::create(CurrentFnEnd, OutContext),
-        MCSymbolRefExpr::create(CurrentFnSymForSize, OutContext), OutContext);
-    if (auto Sym = dyn_cast<MCSymbolELF>(CurrentFnSym))
+        MCSymbolRefExpr::create(ColdFnSym ? ColdFnSym : CurrentFnSymForSize,
+                                OutContext),
+        OutContext);
+    if (auto Sym = dyn_cast<MCSymbolELF>(SizeSym))
       OutStreamer->emitELFSize(Sym, SizeExp);
   }
 
@@ -1036,6 +1044,49 @@ void AsmPrinter::EmitFunctionBody() {
   OutStreamer->AddBlankLine();
 }
 
+MCSymbol *AsmPrinter::emitColdSectionStart() {
+  bool EmitCFI =
+      MAI->getExceptionHandlingType() == ExceptionHandling::DwarfCFI &&
+      needsCFIMoves() != CFI_M_None;
+
+  // The hot part ends here, so emit its size and close its frame description.
+  if (MAI->hasDotTypeDotSizeDirective()) {
+    MCSymbol *HotEnd = createTempSymbol("hot_end");
+    OutStreamer->EmitLabel(HotEnd);
+    const MCExpr *SizeExp = MCBinaryExpr::createSub(
+        MCSymbolRefExpr::create(HotEnd, OutContext),
+        MCSymbolRefExpr::create(CurrentFnSymForSize, OutContext), OutContext);
+    if (auto Sym = dyn_cast<MCSymbolELF>(CurrentFnSym))
+      OutStreamer->emitELFSize(Sym, SizeExp);
+  }
+  if (EmitCFI)
+    OutStreamer->EmitCFIEndProc();
+
+  MCSection *ColdSection =
+      getObjFileLowering().getSectionForColdCode(*MF->getFunction(), *Mang, TM);
+  assert(ColdSection && "Split a function without a cold section!");
+  OutStreamer->SwitchSection(ColdSection);
+
+  // Give the cold part a local symbol of its own, so that profilers and
+  // debuggers can attribute it to the function.
+  MCSymbol *ColdFnSym =
+      OutContext.getOrCreateSymbol(CurrentFnSym->getName() + ".cold");
+  if (MAI->hasDotTypeDotSizeDirective())
+    OutStreamer->EmitSymbolAttribute(ColdFnSym, MCSA_ELF_TypeFunction);
+  EmitAlignment(MF->getAlignment());
+  OutStreamer->EmitLabel(ColdFnSym);
+
+  // The cold part is only entered from the body of the function, after the
+  // prologue has run, so its frame is described by the prologue's CFI.
+  if (EmitCFI) {
+    OutStreamer->EmitCFIStartProc(/*IsSimple=*/false);
+    for (const MachineInstr &MI : MF->front())
+      if (MI.isCFIInstruction())
+        emitCFIInstruction(MI);
+  }
+  return ColdFnSym;
+}
+
 /// \brief Compute the number of Global Variables that uses a Constant.
 static unsigned getNumGlobalVariableUses(const Constant *C) {
   if (!C)
@@ -2495,8 +2546,9 @@ void AsmPrinter::EmitBasicBlockStart(const MachineBasicBlock &MBB) const {
       OutStreamer->AddComment("Block address taken");
 
     // MBBs can have their address taken as part of CodeGen without having
-    // their corresponding BB's address taken in IR
-    if (BB->hasAddressTaken())
+    // their corresponding BB's address taken in IR, or without having a
+    // corresponding BB at all.
+    if (BB && BB->hasAddressTaken())
       for (MCSymbol *Sym : MMI->getAddrLabelSymbolToEmit(BB))
         OutStreamer->EmitLabel(Sym);
   }
@@ -2514,7 +2566,7 @@ void AsmPrinter::EmitBasicBlockStart(const MachineBasicBlock &MBB) const {
   }
 
   // Print the main label for the block.
-  if (MBB.pred_empty() ||
+  if ((MBB.pred_empty() && !MBB.hasAddressTaken()) ||
       (isBlockOnlyReachableByFallthrough(&MBB) && !MBB.isEHFuncletEntry())) {
     if (isVerbose()) {
       // NOTE: Want this comment at start of line, don't emit with AddComment.
@@ -108,6 +108,36 @@ void DIEAbbrev::print(raw_ostream &O) {
 LLVM_DUMP_METHOD
 void DIEAbbrev::dump() { print(dbgs()); }
 
+//===----------------------------------------------------------------------===//
+// DIEValueList Implementation
+//===----------------------------------------------------------------------===//
+
+DIEValue *DIEValueList::allocateValue(BumpPtrAllocator &Alloc) {
+  static_assert(sizeof(Run) == sizeof(DIEValue) &&
+                    sizeof(Run) % AlignOf<DIEValue>::Alignment == 0,
+                "Run headers and values must be interchangeable");
+
+  void *Mem = Alloc.Allocate(sizeof(DIEValue), alignOf<DIEValue>());
+  if (!List.empty() && Mem == List.back().end()) {
+    ++List.back().NumValues;
+    return static_cast<DIEValue *>(Mem);
+  }
+
+  // Something else was allocated since the last value, so start a new run
+  // and use the memory we just got as its header.  If the allocator has to
+  // move on to a new slab before the first value, the header is wasted and
+  // we try again from there.
+  while (true) {
+    Run *R = new (Mem) Run();
+    Mem = Alloc.Allocate(sizeof(DIEValue), alignOf<DIEValue>());
+    if (Mem == R->end()) {
+      R->NumValues = 1;
+      List.push_back(*R);
+      return static_cast<DIEValue *>(Mem);
+    }
+  }
+}
+
 DIEAbbrev DIE::generateAbbrev() const {
   DIEAbbrev Abbrev(Tag, hasChildren());
   for (const DIEValue &V : values())
@@ -14,6 +14,7 @@
 #include "DwarfAccelTable.h"
 #include "DwarfCompileUnit.h"
 #include "DwarfDebug.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/Twine.h"
 #include "llvm/CodeGen/AsmPrinter.h"
@@ -258,6 +259,169 @@ void DwarfAccelTable::emit(AsmPrinter *Asm, const MCSymbol *SecBegin,
   EmitData(Asm, D);
 }
 
+// Emit the names as a DWARF v5 name index.
+void DwarfAccelTable::emitDebugNames(AsmPrinter *Asm,
+                                     ArrayRef<DwarfCompileUnit *> CUs) {
+  assert(Data.empty() && "Already finalized!");
+  DenseMap<const DIE *, unsigned> CUIndex;
+  for (unsigned i = 0, e = CUs.size(); i < e; ++i)
+    CUIndex[&CUs[i]->getUnitDie()] = i;
+
+  // Unique the entries as FinalizeTable does, and collect the tags that need
+  // an abbreviation. The tag doubles as the abbreviation code.
+  SmallVector<unsigned, 8> Tags;
+  Data.reserve(Entries.size());
+  for (auto &E : Entries) {
+    std::vector<HashDataContents *> &Values = E.second.Values;
+    // Only the compile units are listed in the index. Type units live in
+    // .debug_types, which a DWARF v5 name index cannot refer to, so the names
+    // of their DIEs are left out.
+    Values.erase(std::remove_if(Values.begin(), Values.end(),
+                                [&](const HashDataContents *HD) {
+                                  return !CUIndex.count(HD->Die->getUnit());
+                                }),
+                 Values.end());
+    if (Values.empty())
+      continue;
+    std::stable_sort(Values.begin(), Values.end(), compareDIEs);
+    Values.erase(std::unique(Values.begin(), Values.end()), Values.end());
+    for (HashDataContents *HD : Values)
+      Tags.push_back(HD->Die->getTag());
+    Data.push_back(new (Allocator) HashData(E.getKey(), E.second,
+                                            dwarf::NameIndexHash(E.getKey())));
+  }
+  array_pod_sort(Tags.begin(), Tags.end());
+  Tags.erase(std::unique(Tags.begin(), Tags.end()), Tags.end());
+
+  ComputeBucketCount();
+  Buckets.resize(Header.bucket_count);
+  for (HashData *HD : Data) {
+    Buckets[HD->HashValue % Header.bucket_count].push_back(HD);
+    HD->Sym = Asm->createTempSymbol("names_entry");
+  }
+  for (HashList &Bucket : Buckets)
+    std::stable_sort(Bucket.begin(), Bucket.end(),
+                     [](HashData *LHS, HashData *RHS) {
+                       return LHS->HashValue < RHS->HashValue;
+                     });
+
+  // The compile unit index is only needed to tell several units apart.
+  dwarf::Form CUForm = dwarf::DW_FORM_data4;
+  if (CUs.size() <= 1)
+    CUForm = dwarf::Form(0);
+  else if (CUs.size() <= UINT8_MAX + 1)
+    CUForm = dwarf::DW_FORM_data1;
+  else if (CUs.size() <= UINT16_MAX + 1)
+    CUForm = dwarf::DW_FORM_data2;
+
+  MCSymbol *BeginLabel = Asm->createTempSymbol("names_start");
+  MCSymbol *EndLabel = Asm->createTempSymbol("names_end");
+  MCSymbol *AbbrevStart = Asm->createTempSymbol("names_abbrev_start");
+  MCSymbol *AbbrevEnd = Asm->createTempSymbol("names_abbrev_end");
+  MCSymbol *EntryPool = Asm->createTempSymbol("names_entries");
+
+  // Emit the header.
+  Asm->OutStreamer->AddComment("Header: unit length");
+  Asm->EmitLabelDifference(EndLabel, BeginLabel, sizeof(uint32_t));
+  Asm->OutStreamer->EmitLabel(BeginLabel);
+  Asm->OutStreamer->AddComment("Header: version");
+  Asm->EmitInt16(5);
+  Asm->OutStreamer->AddComment("Header: padding");
+  Asm->EmitInt16(0);
+  Asm->OutStreamer->AddComment("Header: compilation unit count");
+  Asm->EmitInt32(CUs.size());
+  Asm->OutStreamer->AddComment("Header: local type unit count");
+  Asm->EmitInt32(0);
+  Asm->OutStreamer->AddComment("Header: foreign type unit count");
+  Asm->EmitInt32(0);
+  Asm->OutStreamer->AddComment("Header: bucket count");
+  Asm->EmitInt32(Header.bucket_count);
+  Asm->OutStreamer->AddComment("Header: name count");
+  Asm->EmitInt32(Data.size());
+  Asm->OutStreamer->AddComment("Header: abbreviation table size");
+  Asm->EmitLabelDifference(AbbrevEnd, AbbrevStart, sizeof(uint32_t));
+  Asm->OutStreamer->AddComment("Header: augmentation string size");
+  Asm->EmitInt32(0);
+
+  // Emit the compile unit list.
+  for (size_t i = 0, e = CUs.size(); i < e; ++i) {
+    Asm->OutStreamer->AddComment("Compilation unit " + Twine(i));
+    Asm->emitDwarfSymbolReference(CUs[i]->getLabelBegin());
+  }
+
+  // Emit the buckets, then the hashes, string offsets and entry offsets of
+  // the names in bucket order.
+  unsigned Index = 1;
+  for (size_t i = 0, e = Buckets.size(); i < e; ++i) {
+    Asm->OutStreamer->AddComment("Bucket " + Twine(i));
+    Asm->EmitInt32(Buckets[i].empty() ? 0 : Index);
+    Index += Buckets[i].size();
+  }
+  for (size_t i = 0, e = Buckets.size(); i < e; ++i)
+    for (HashData *HD : Buckets[i]) {
+      Asm->OutStreamer->AddComment("Hash in Bucket " + Twine(i));
+      Asm->EmitInt32(HD->HashValue);
+    }
+  for (size_t i = 0, e = Buckets.size(); i < e; ++i)
+    for (HashData *HD : Buckets[i]) {
+      Asm->OutStreamer->AddComment("String in Bucket " + Twine(i) + ": " +
+                                   HD->Str);
+      Asm->emitDwarfStringOffset(HD->Data.Name);
+    }
+  for (size_t i = 0, e = Buckets.size(); i < e; ++i)
+    for (HashData *HD : Buckets[i]) {
+      Asm->OutStreamer->AddComment("Offset in Bucket " + Twine(i));
+      Asm->EmitLabelDifference(HD->Sym, EntryPool, sizeof(uint32_t));
+    }
+
+  // Emit the abbreviations.
+  Asm->OutStreamer->EmitLabel(AbbrevStart);
+  for (unsigned Tag : Tags) {
+    Asm->EmitULEB128(Tag, "Abbrev code");
+    Asm->EmitULEB128(Tag, dwarf::TagString(Tag));
+    if (CUForm) {
+      Asm->EmitULEB128(dwarf::DW_IDX_compile_unit,
+                       dwarf::IndexString(dwarf::DW_IDX_compile_unit));
+      Asm->EmitULEB128(CUForm, dwarf::FormEncodingString(CUForm));
+    }
+    Asm->EmitULEB128(dwarf::DW_IDX_die_offset,
+                     dwarf::IndexString(dwarf::DW_IDX_die_offset));
+    Asm->EmitULEB128(dwarf::DW_FORM_ref4,
+                     dwarf::FormEncodingString(dwarf::DW_FORM_ref4));
+    Asm->EmitULEB128(0, "End of abbrev");
+    Asm->EmitULEB128(0, "End of abbrev");
+  }
+  Asm->EmitULEB128(0, "End of abbrev list");
+  Asm->OutStreamer->EmitLabel(AbbrevEnd);
+
+  // Emit the entries of each name.
+  Asm->OutStreamer->EmitLabel(EntryPool);
+  for (const HashList &Bucket : Buckets)
+    for (HashData *HD : Bucket) {
+      Asm->OutStreamer->EmitLabel(HD->Sym);
+      for (HashDataContents *C : HD->Data.Values) {
+        Asm->EmitULEB128(C->Die->getTag(), dwarf::TagString(C->Die->getTag()));
+        if (CUForm) {
+          assert(CUIndex.count(C->Die->getUnit()) &&
+                 "Indexed DIE should belong to a CU.");
+          unsigned CU = CUIndex.lookup(C->Die->getUnit());
+          Asm->OutStreamer->AddComment("Compilation unit " + Twine(CU));
+          if (CUForm == dwarf::DW_FORM_data1)
+            Asm->EmitInt8(CU);
+          else if (CUForm == dwarf::DW_FORM_data2)
+            Asm->EmitInt16(CU);
+          else
+            Asm->EmitInt32(CU);
+        }
+        Asm->OutStreamer->AddComment("DIE offset");
+        Asm->EmitInt32(C->Die->getOffset());
+      }
+      Asm->OutStreamer->AddComment("End of list: " + HD->Str);
+      Asm->EmitULEB128(0);
+    }
+  Asm->OutStreamer->EmitLabel(EndLabel);
+}
+
 #ifndef NDEBUG
 void DwarfAccelTable::print(raw_ostream &O) {
 
@@ -58,10 +58,39 @@
 // as the hash value is still the same modulo result (bucket value) as earlier.
 // If we have a match we look at that same entry in the offsets table and
 // grab the offset in the data for our final match.
+//
+// The same names can also be emitted as a DWARF v5 name index (.debug_names).
+// It has the same buckets, but one entry per name rather than per hash:
+//
+// .-------------------.
+// |  HEADER           |
+// |-------------------|
+// |  CU OFFSETS       |
+// |-------------------|
+// |  BUCKETS          |
+// |-------------------|
+// |  HASHES           |
+// |-------------------|
+// |  STRING OFFSETS   |
+// |-------------------|
+// |  ENTRY OFFSETS    |
+// |-------------------|
+// |  ABBREVIATIONS    |
+// |-------------------|
+// |  ENTRY POOL       |
+// `-------------------'
+//
+// Buckets hold the 1-based index of the first name in the bucket, or 0 if the
+// bucket is empty, and names are hashed with dwarf::NameIndexHash. Each name
+// has a list of entries in the entry pool, one per DIE, terminated by a 0
+// abbreviation code. An entry is described by the abbreviation for its tag and
+// holds the index of its compile unit (when there is more than one) and the
+// offset of the DIE within it.
 
 namespace llvm {
 
 class AsmPrinter;
+class DwarfCompileUnit;
 class DwarfDebug;
 
 class DwarfAccelTable {
@@ -194,6 +223,8 @@ private:
         : Str(S), Data(Data) {
       HashValue = DwarfAccelTable::HashDJB(S);
     }
+    HashData(StringRef S, DwarfAccelTable::DataArray &Data, uint32_t HashValue)
+        : Str(S), HashValue(HashValue), Data(Data) {}
 #ifndef NDEBUG
     void print(raw_ostream &O) {
       O << "Name: " << Str << "\n";
@@ -247,6 +278,10 @@ public:
   void AddName(DwarfStringPoolEntryRef Name, const DIE *Die, char Flags = 0);
   void FinalizeTable(AsmPrinter *, StringRef);
   void emit(AsmPrinter *, const MCSymbol *, DwarfDebug *);
+
+  /// Emit the names as a DWARF v5 name index. This replaces FinalizeTable and
+  /// emit; all the DIEs must belong to one of \p CUs.
+  void emitDebugNames(AsmPrinter *Asm, ArrayRef<DwarfCompileUnit *> CUs);
 #ifndef NDEBUG
   void print(raw_ostream &O);
   void dump() { print(dbgs()); }
@@ -89,6 +89,14 @@ DwarfAccelTables("dwarf-accel-tables", cl::Hidden,
                             clEnumVal(Disable, "Disabled"), clEnumValEnd),
                  cl::init(Default));
 
+static cl::opt<DefaultOnOff>
+DwarfDebugNames("dwarf-debug-names", cl::Hidden,
+                cl::desc("Output the DWARF v5 name index (.debug_names)."),
+                cl::values(clEnumVal(Default, "Default for platform"),
+                           clEnumVal(Enable, "Enabled"),
+                           clEnumVal(Disable, "Disabled"), clEnumValEnd),
+                cl::init(Default));
+
 static cl::opt<DefaultOnOff>
 SplitDwarf("split-dwarf", cl::Hidden,
            cl::desc("Output DWARF5 split debug info."),
@@ -211,7 +219,10 @@ DwarfDebug::DwarfDebug(AsmPrinter *A, Module *M)
                                       dwarf::DW_FORM_data4)),
       AccelNamespace(DwarfAccelTable::Atom(dwarf::DW_ATOM_die_offset,
                                            dwarf::DW_FORM_data4)),
-      AccelTypes(TypeAtoms), DebuggerTuning(DebuggerKind::Default) {
+      AccelTypes(TypeAtoms),
+      AccelDebugNames(DwarfAccelTable::Atom(dwarf::DW_ATOM_die_offset,
+                                            dwarf::DW_FORM_data4)),
+      DebuggerTuning(DebuggerKind::Default) {
 
   CurFn = nullptr;
   CurMI = nullptr;
@@ -267,6 +278,14 @@ DwarfDebug::DwarfDebug(AsmPrinter *A, Module *M)
 
   Asm->OutStreamer->getContext().setDwarfVersion(DwarfVersion);
 
+  // The name index is part of DWARF v5; LLDB reads the Apple tables instead.
+  // FIXME: Index the units in the .dwo file under split DWARF.
+  if (DwarfDebugNames == Default)
+    HasDwarfDebugNames = DwarfVersion >= 5 && !tuneForLLDB();
+  else
+    HasDwarfDebugNames = DwarfDebugNames == Enable;
+  HasDwarfDebugNames &= !HasSplitDwarf;
+
   {
     NamedRegionTimer T(DbgTimerName, DWARFGroupName, TimePassesIsEnabled);
     beginModule();
@@ -673,6 +692,10 @@ void DwarfDebug::endModule() {
     emitAccelTypes();
   }
 
+  // Emit the DWARF v5 name index.
+  if (useDwarfDebugNames())
+    emitDebugNames();
+
   // Emit the pubnames and pubtypes sections if requested.
   if (HasDwarfPubSections) {
     emitDebugPubNames(GenerateGnuPubSections);
@@ -1339,6 +1362,21 @@ void DwarfDebug::emitAccelTypes() {
             "types");
 }
 
+// Emit the DWARF v5 name index for the compile units.
+void DwarfDebug::emitDebugNames() {
+  MCSection *Section = Asm->getObjFileLowering().getDwarfDebugNamesSection();
+  if (!Section)
+    return;
+
+  SmallVector<DwarfCompileUnit *, 4> CUs;
+  for (const auto &U : getUnits())
+    if (DwarfCompileUnit *CU = lookupUnit(&U->getUnitDie()))
+      CUs.push_back(CU);
+
+  Asm->OutStreamer->SwitchSection(Section);
+  AccelDebugNames.emitDebugNames(Asm, CUs);
+}
+
 // Public name handling.
 // The format for the various pubnames:
 //
@@ -1994,9 +2032,13 @@ void DwarfDebug::addDwarfTypeUnitType(DwarfCompileUnit &CU,
 // to reference is in the string table. We do this since the names we
 // add may not only be identical to the names in the DIE.
 void DwarfDebug::addAccelName(StringRef Name, const DIE &Die) {
-  if (!useDwarfAccelTables())
+  if (!useDwarfAccelTables() && !useDwarfDebugNames())
     return;
-  AccelNames.AddName(InfoHolder.getStringPool().getEntry(*Asm, Name), &Die);
+  DwarfStringPoolEntryRef Ref = InfoHolder.getStringPool().getEntry(*Asm, Name);
+  if (useDwarfAccelTables())
+    AccelNames.AddName(Ref, &Die);
+  if (useDwarfDebugNames())
+    AccelDebugNames.AddName(Ref, &Die);
 }
 
 void DwarfDebug::addAccelObjC(StringRef Name, const DIE &Die) {
@@ -2006,13 +2048,21 @@ void DwarfDebug::addAccelObjC(StringRef Name, const DIE &Die) {
 }
 
 void DwarfDebug::addAccelNamespace(StringRef Name, const DIE &Die) {
-  if (!useDwarfAccelTables())
+  if (!useDwarfAccelTables() && !useDwarfDebugNames())
     return;
-  AccelNamespace.AddName(InfoHolder.getStringPool().getEntry(*Asm, Name), &Die);
+  DwarfStringPoolEntryRef Ref = InfoHolder.getStringPool().getEntry(*Asm, Name);
+  if (useDwarfAccelTables())
+    AccelNamespace.AddName(Ref, &Die);
+  if (useDwarfDebugNames())
+    AccelDebugNames.AddName(Ref, &Die);
 }
 
 void DwarfDebug::addAccelType(StringRef Name, const DIE &Die, char Flags) {
-  if (!useDwarfAccelTables())
+  if (!useDwarfAccelTables() && !useDwarfDebugNames())
     return;
-  AccelTypes.AddName(InfoHolder.getStringPool().getEntry(*Asm, Name), &Die);
+  DwarfStringPoolEntryRef Ref = InfoHolder.getStringPool().getEntry(*Asm, Name);
+  if (useDwarfAccelTables())
+    AccelTypes.AddName(Ref, &Die);
+  if (useDwarfDebugNames())
+    AccelDebugNames.AddName(Ref, &Die);
 }
@@ -292,6 +292,7 @@ class DwarfDebug : public AsmPrinterHandler {
   /// DWARF5 Experimental Options
   /// @{
   bool HasDwarfAccelTables;
+  bool HasDwarfDebugNames;
   bool HasSplitDwarf;
 
   /// Separated Dwarf Variables
@@ -320,6 +321,8 @@ class DwarfDebug : public AsmPrinterHandler {
   DwarfAccelTable AccelObjC;
   DwarfAccelTable AccelNamespace;
   DwarfAccelTable AccelTypes;
+  /// The DWARF v5 name index, indexing the same names as the tables above.
+  DwarfAccelTable AccelDebugNames;
 
   // Identify a debugger for "tuning" the debug info.
   DebuggerKind DebuggerTuning;
@@ -381,6 +384,9 @@ class DwarfDebug : public AsmPrinterHandler {
   /// Emit type dies into a hashed accelerator table.
   void emitAccelTypes();
 
+  /// Emit the DWARF v5 name index (.debug_names).
+  void emitDebugNames();
+
   /// Emit visible names into a debug pubnames section.
   /// \param GnuStyle determines whether or not we want to emit
   /// additional information into the table ala newer gcc for gdb
@@ -545,6 +551,9 @@ public:
   /// use to accelerate lookup.
   bool useDwarfAccelTables() const { return HasDwarfAccelTables; }
 
+  /// Returns whether to emit the DWARF v5 name index.
+  bool useDwarfDebugNames() const { return HasDwarfDebugNames; }
+
   /// Returns whether or not to change the current debug info for the
   /// split dwarf proposal support.
   bool useSplitDwarf() const { return HasSplitDwarf; }
@@ -0,0 +1,433 @@
+//===-- ExtTSPLayout.cpp - Extended TSP code layout -----------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the Ext-TSP layout solver declared in ExtTSPLayout.h.
+//
+// Chains of nodes are connected by chain edges, which collect every jump
+// between the two chains. Each chain edge caches the best way of merging its
+// two chains and the gain in score that merge would bring, and the edges are
+// kept in a set ordered by that gain. Merging two chains only changes the
+// gains of the edges of the merged chain, so only those are recomputed, which
+// keeps the solver fast on functions with tens of thousands of blocks.
+//
+//===----------------------------------------------------------------------===//
+
+#include "ExtTSPLayout.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/CommandLine.h"
+#include <algorithm>
+#include <memory>
+#include <set>
+
+using namespace llvm;
+
+static cl::opt<unsigned> ChainSplitThreshold(
+    "ext-tsp-chain-split-threshold", cl::Hidden, cl::init(32),
+    cl::desc("Only try splitting chains of at most this many blocks when "
+             "merging them in the Ext-TSP layout"));
+
+static cl::opt<unsigned> MaxChainSize(
+    "ext-tsp-max-chain-size", cl::Hidden, cl::init(512),
+    cl::desc("The maximum number of blocks in a chain built by the Ext-TSP "
+             "layout"));
+
+// The weights of fallthroughs and of the longest-scoring jumps, and the
+// distances in bytes beyond which forward and backward jumps no longer score.
+static const double FallthroughWeight = 1.0;
+static const double JumpWeight = 0.1;
+static const uint64_t ForwardDistance = 1024;
+static const uint64_t BackwardDistance = 640;
+
+/// Return the score of a jump of weight \p Weight from a block ending at
+/// \p SrcEnd to a block starting at \p DstStart.
+static double jumpScore(uint64_t SrcEnd, uint64_t DstStart, uint64_t Weight) {
+  if (SrcEnd == DstStart)
+    return FallthroughWeight * Weight;
+  if (SrcEnd < DstStart) {
+    uint64_t Dist = DstStart - SrcEnd;
+    if (Dist <= ForwardDistance)
+      return JumpWeight * Weight * (1.0 - double(Dist) / ForwardDistance);
+    return 0;
+  }
+  uint64_t Dist = SrcEnd - DstStart;
+  if (Dist <= BackwardDistance)
+    return JumpWeight * Weight * (1.0 - double(Dist) / BackwardDistance);
+  return 0;
+}
+
+double llvm::computeExtTSPScore(ArrayRef<unsigned> Order,
+                                ArrayRef<uint64_t> NodeSizes,
+                                ArrayRef<ExtTSPJump> Jumps) {
+  std::vector<uint64_t> Addr(NodeSizes.size());
+  uint64_t Cur = 0;
+  for (unsigned N : Order) {
+    Addr[N] = Cur;
+    Cur += NodeSizes[N];
+  }
+  double Score = 0;
+  for (const ExtTSPJump &J : Jumps)
+    if (J.Src != J.Dst)
+      Score += jumpScore(Addr[J.Src] + NodeSizes[J.Src], Addr[J.Dst], J.Weight);
+  return Score;
+}
+
+namespace {
+
+struct ChainEdge;
+
+/// A sequence of nodes that will be laid out contiguously.
+struct Chain {
+  unsigned Id;
+  std::vector<unsigned> Nodes;
+  /// The jumps between nodes of this chain.
+  std::vector<const ExtTSPJump *> Jumps;
+  uint64_t Size = 0;
+  uint64_t Count = 0;
+  double Score = 0;
+  bool HasEntry = false;
+  DenseMap<Chain *, ChainEdge *> Edges;
+};
+
+/// How two chains X and Y are combined. X may be split into X1 and X2.
+enum MergeType { X_Y, X1_Y_X2, X2_X1_Y, Y_X2_X1 };
+
+/// All jumps between two chains, and the best way found to merge them.
+struct ChainEdge {
+  unsigned Id;
+  Chain *A;
+  Chain *B;
+  std::vector<const ExtTSPJump *> Jumps;
+  /// The best merge found: Y merged into X with the given split and type.
+  double Gain = 0;
+  Chain *X = nullptr;
+  Chain *Y = nullptr;
+  unsigned Split = 0;
+  MergeType Type = X_Y;
+};
+
+struct EdgeCompare {
+  bool operator()(const ChainEdge *A, const ChainEdge *B) const {
+    if (A->Gain != B->Gain)
+      return A->Gain > B->Gain;
+    return A->Id < B->Id;
+  }
+};
+
+class ExtTSPSolver {
+public:
+  ExtTSPSolver(ArrayRef<uint64_t> NodeSizes, ArrayRef<uint64_t> NodeCounts,
+               ArrayRef<ExtTSPJump> Jumps, ArrayRef<bool> FallsThrough)
+      : NodeSizes(NodeSizes), NodeCounts(NodeCounts), Jumps(Jumps),
+        FallsThrough(FallsThrough), Offset(NodeSizes.size()),
+        Succs(NodeSizes.size()), ChainOfNode(NodeSizes.size()) {}
+
+  std::vector<unsigned> run();
+
+private:
+  void initialize();
+  void computeGain(ChainEdge *E);
+  void evaluate(ChainEdge *E, Chain *X, Chain *Y);
+  void buildOrder(const Chain *X, const Chain *Y, unsigned Split,
+                  MergeType Type, std::vector<unsigned> &Order) const;
+  void merge(ChainEdge *E);
+
+  ArrayRef<uint64_t> NodeSizes;
+  ArrayRef<uint64_t> NodeCounts;
+  ArrayRef<ExtTSPJump> Jumps;
+  ArrayRef<bool> FallsThrough;
+
+  std::vector<Chain> Chains;
+  std::vector<std::unique_ptr<ChainEdge>> ChainEdges;
+  std::set<ChainEdge *, EdgeCompare> Queue;
+
+  /// The nodes each node has a jump to.
+  std::vector<SmallVector<unsigned, 2>> Succs;
+
+  /// The offset of each node from the start of its chain, and its chain.
+  std::vector<uint64_t> Offset;
+  std::vector<Chain *> ChainOfNode;
+};
+
+} // end anonymous namespace
+
+void ExtTSPSolver::initialize() {
+  unsigned NumNodes = NodeSizes.size();
+  Chains.reserve(NumNodes);
+  for (unsigned N = 0; N != NumNodes; ++N) {
+    assert(NodeSizes[N] != 0 && "Nodes must have a size");
+    // A node that must fall through joins the chain of its predecessor.
+    if (N == 0 || !FallsThrough[N - 1]) {
+      Chains.emplace_back();
+      Chains.back().Id = N;
+    }
+    Chain &C = Chains.back();
+    ChainOfNode[N] = &C;
+    Offset[N] = C.Size;
+    C.Nodes.push_back(N);
+    C.Size += NodeSizes[N];
+    C.Count += NodeCounts[N];
+    C.HasEntry |= N == 0;
+  }
+
+  for (const ExtTSPJump &J : Jumps) {
+    if (J.Src == J.Dst || J.Weight == 0)
+      continue;
+    Succs[J.Src].push_back(J.Dst);
+    Chain *A = ChainOfNode[J.Src];
+    Chain *B = ChainOfNode[J.Dst];
+    if (A == B) {
+      A->Jumps.push_back(&J);
+      A->Score += jumpScore(Offset[J.Src] + NodeSizes[J.Src], Offset[J.Dst],
+                            J.Weight);
+      continue;
+    }
+    ChainEdge *&E = A->Edges[B];
+    if (!E) {
+      ChainEdges.emplace_back(new ChainEdge());
+      E = ChainEdges.back().get();
+      E->Id = ChainEdges.size() - 1;
+      E->A = A;
+      E->B = B;
+      B->Edges[A] = E;
+    }
+    E->Jumps.push_back(&J);
+  }
+
+  for (const auto &E : ChainEdges) {
+    computeGain(E.get());
+    Queue.insert(E.get());
+  }
+}
+
+void ExtTSPSolver::buildOrder(const Chain *X, const Chain *Y, unsigned Split,
+                              MergeType Type,
+                              std::vector<unsigned> &Order) const {
+  auto XBegin = X->Nodes.begin(), XSplit = XBegin + Split,
+       XEnd = X->Nodes.end();
+  Order.clear();
+  switch (Type) {
+  case X_Y:
+    Order.insert(Order.end(), XBegin, XEnd);
+    Order.insert(Order.end(), Y->Nodes.begin(), Y->Nodes.end());
+    break;
+  case X1_Y_X2:
+    Order.insert(Order.end(), XBegin, XSplit);
+    Order.insert(Order.end(), Y->Nodes.begin(), Y->Nodes.end());
+    Order.insert(Order.end(), XSplit, XEnd);
+    break;
+  case X2_X1_Y:
+    Order.insert(Order.end(), XSplit, XEnd);
+    Order.insert(Order.end(), XBegin, XSplit);
+    Order.insert(Order.end(), Y->Nodes.begin(), Y->Nodes.end());
+    break;
+  case Y_X2_X1:
+    Order.insert(Order.end(), Y->Nodes.begin(), Y->Nodes.end());
+    Order.insert(Order.end(), XSplit, XEnd);
+    Order.insert(Order.end(), XBegin, XSplit);
+    break;
+  }
+}
+
+/// Try the ways of merging Y into X, and record the best in E if it beats
+/// what E has.
+///
+/// Only the jumps whose length changes are scored: the jumps between X and Y,
+/// and, if X is split, the jumps within X. Y is never split, so the jumps
+/// within it keep their score.
+void ExtTSPSolver::evaluate(ChainEdge *E, Chain *X, Chain *Y) {
+  // Bounding the size of chains bounds the cost of each merge, and jumps
+  // across that many blocks hardly score anyway.
+  if (X->Nodes.size() + Y->Nodes.size() > MaxChainSize)
+    return;
+
+  auto Try = [&](unsigned Split, MergeType Type) {
+    // X1 is X[0, Split) and X2 is X[Split, end), or X1 is all of X if there
+    // is no split.
+    uint64_t X1Size = Split ? Offset[X->Nodes[Split]] : X->Size;
+    uint64_t X2Size = X->Size - X1Size;
+    uint64_t X1Base = 0, X2Base = 0, YBase = 0;
+    unsigned First = 0;
+    switch (Type) {
+    case X_Y:
+      X1Base = 0, X2Base = X1Size, YBase = X->Size;
+      First = X->Nodes.front();
+      break;
+    case X1_Y_X2:
+      X1Base = 0, YBase = X1Size, X2Base = X1Size + Y->Size;
+      First = X->Nodes.front();
+      break;
+    case X2_X1_Y:
+      X2Base = 0, X1Base = X2Size, YBase = X->Size;
+      First = X->Nodes[Split];
+      break;
+    case Y_X2_X1:
+      YBase = 0, X2Base = Y->Size, X1Base = Y->Size + X2Size;
+      First = Y->Nodes.front();
+      break;
+    }
+    // The entry must stay at the front.
+    if ((X->HasEntry || Y->HasEntry) && First != 0)
+      return;
+
+    auto Addr = [&](unsigned N) {
+      if (ChainOfNode[N] == Y)
+        return YBase + Offset[N];
+      if (Offset[N] < X1Size)
+        return X1Base + Offset[N];
+      return X2Base + Offset[N] - X1Size;
+    };
+    double Gain = 0;
+    for (const ExtTSPJump *J : E->Jumps)
+      Gain += jumpScore(Addr(J->Src) + NodeSizes[J->Src], Addr(J->Dst),
+                        J->Weight);
+    if (Split) {
+      for (const ExtTSPJump *J : X->Jumps)
+        Gain += jumpScore(Addr(J->Src) + NodeSizes[J->Src], Addr(J->Dst),
+                          J->Weight);
+      Gain -= X->Score;
+    }
+    if (Gain > E->Gain) {
+      E->Gain = Gain;
+      E->X = X;
+      E->Y = Y;
+      E->Split = Split;
+      E->Type = Type;
+    }
+  };
+
+  Try(0, X_Y);
+  if (X->Nodes.size() > ChainSplitThreshold)
+    return;
+  // Do not split X along a jump that already falls through; the merges
+  // without a split may still break it if that makes a better fallthrough.
+  // Nodes that must fall through stay with their successors.
+  for (unsigned Split = 1, Size = X->Nodes.size(); Split != Size; ++Split) {
+    unsigned Prev = X->Nodes[Split - 1], Next = X->Nodes[Split];
+    if (FallsThrough[Prev] || std::find(Succs[Prev].begin(), Succs[Prev].end(),
+                                        Next) != Succs[Prev].end())
+      continue;
+    Try(Split, X1_Y_X2);
+    Try(Split, X2_X1_Y);
+    Try(Split, Y_X2_X1);
+  }
+}
+
+void ExtTSPSolver::computeGain(ChainEdge *E) {
+  E->Gain = 0;
+  E->X = E->Y = nullptr;
+  evaluate(E, E->A, E->B);
+  evaluate(E, E->B, E->A);
+}
+
+void ExtTSPSolver::merge(ChainEdge *E) {
+  Chain *X = E->X, *Y = E->Y;
+  for (auto &P : X->Edges)
+    Queue.erase(P.second);
+  for (auto &P : Y->Edges)
+    Queue.erase(P.second);
+
+  if (E->Type == X_Y) {
+    // X does not move, so only the nodes of Y need new offsets.
+    for (unsigned N : Y->Nodes) {
+      Offset[N] += X->Size;
+      ChainOfNode[N] = X;
+    }
+    X->Nodes.insert(X->Nodes.end(), Y->Nodes.begin(), Y->Nodes.end());
+  } else {
+    std::vector<unsigned> Order;
+    buildOrder(X, Y, E->Split, E->Type, Order);
+    uint64_t Cur = 0;
+    for (unsigned N : Order) {
+      Offset[N] = Cur;
+      ChainOfNode[N] = X;
+      Cur += NodeSizes[N];
+    }
+    X->Nodes = std::move(Order);
+  }
+  X->Score += Y->Score + E->Gain;
+  X->Jumps.insert(X->Jumps.end(), Y->Jumps.begin(), Y->Jumps.end());
+  X->Jumps.insert(X->Jumps.end(), E->Jumps.begin(), E->Jumps.end());
+  X->Size += Y->Size;
+  X->Count += Y->Count;
+  X->HasEntry |= Y->HasEntry;
+
+  // Move the edges of Y over to X, combining them with the edges X already
+  // has to the same chains.
+  X->Edges.erase(Y);
+  Y->Edges.erase(X);
+  for (auto &P : Y->Edges) {
+    Chain *Z = P.first;
+    ChainEdge *YZ = P.second;
+    Z->Edges.erase(Y);
+    auto It = X->Edges.find(Z);
+    if (It != X->Edges.end()) {
+      ChainEdge *XZ = It->second;
+      XZ->Jumps.insert(XZ->Jumps.end(), YZ->Jumps.begin(), YZ->Jumps.end());
+      continue;
+    }
+    (YZ->A == Y ? YZ->A : YZ->B) = X;
+    X->Edges[Z] = YZ;
+    Z->Edges[X] = YZ;
+  }
+  Y->Edges.clear();
+  Y->Nodes.clear();
+  Y->Jumps.clear();
+
+  for (auto &P : X->Edges) {
+    computeGain(P.second);
+    Queue.insert(P.second);
+  }
+}
+
+std::vector<unsigned> ExtTSPSolver::run() {
+  initialize();
+
+  // Merge chains for as long as that improves the score.
+  while (!Queue.empty()) {
+    ChainEdge *Best = *Queue.begin();
+    if (Best->Gain <= 0)
+      break;
+    merge(Best);
+  }
+
+  // Lay out what is left with the entry first, then by decreasing execution
+  // density, so that the hot chains end up close together.
+  std::vector<Chain *> Sorted;
+  for (Chain &C : Chains)
+    if (!C.Nodes.empty())
+      Sorted.push_back(&C);
+  std::stable_sort(Sorted.begin(), Sorted.end(),
+                   [](const Chain *A, const Chain *B) {
+    if (A->HasEntry != B->HasEntry)
+      return A->HasEntry;
+    double DA = double(A->Count) / std::max<uint64_t>(A->Size, 1);
+    double DB = double(B->Count) / std::max<uint64_t>(B->Size, 1);
+    if (DA != DB)
+      return DA > DB;
+    return A->Id < B->Id;
+  });
+
+  std::vector<unsigned> Order;
+  Order.reserve(NodeSizes.size());
+  for (const Chain *C : Sorted)
+    Order.insert(Order.end(), C->Nodes.begin(), C->Nodes.end());
+  return Order;
+}
+
+std::vector<unsigned> llvm::computeExtTSPLayout(ArrayRef<uint64_t> NodeSizes,
+                                                ArrayRef<uint64_t> NodeCounts,
+                                                ArrayRef<ExtTSPJump> Jumps,
+                                                ArrayRef<bool> FallsThrough) {
+  assert(NodeSizes.size() == NodeCounts.size() &&
+         NodeSizes.size() == FallsThrough.size() && "Mismatched node data");
+  if (NodeSizes.empty())
+    return std::vector<unsigned>();
+  return ExtTSPSolver(NodeSizes, NodeCounts, Jumps, FallsThrough).run();
+}
@@ -0,0 +1,59 @@
+//===-- ExtTSPLayout.h - Extended TSP code layout --------------*- C++ -*--===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares a solver for the Extended TSP (Ext-TSP) formulation of
+// basic block layout. Given the sizes and execution counts of the blocks of a
+// function and the frequencies of the jumps between them, it looks for an
+// order that maximizes
+//
+//   sum over jumps of Weight(Jump) * Score(distance of the jump)
+//
+// where a fallthrough scores 1, and forward and backward jumps score up to 0.1,
+// decreasing linearly with their length up to a cut-off distance. This rewards
+// fallthroughs first and short jumps second, and so models both the branch
+// cost and the instruction cache footprint of a layout.
+//
+// The solver starts from one chain per block and greedily merges the pair of
+// chains that increases the score the most, possibly splitting one of them
+// into two and putting the other in between, until no merge helps.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIB_CODEGEN_EXTTSPLAYOUT_H
+#define LLVM_LIB_CODEGEN_EXTTSPLAYOUT_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include <cstdint>
+#include <vector>
+
+namespace llvm {
+
+/// A jump between two nodes of the graph being laid out.
+struct ExtTSPJump {
+  unsigned Src;
+  unsigned Dst;
+  uint64_t Weight;
+};
+
+/// Compute an order of the nodes that maximizes the Ext-TSP score. Node 0 is
+/// the entry and stays first. If \p FallsThrough[I] is set, node I + 1 stays
+/// immediately after node I. Returns the node indices in their new order.
+std::vector<unsigned> computeExtTSPLayout(ArrayRef<uint64_t> NodeSizes,
+                                          ArrayRef<uint64_t> NodeCounts,
+                                          ArrayRef<ExtTSPJump> Jumps,
+                                          ArrayRef<bool> FallsThrough);
+
+/// Return the Ext-TSP score of the layout \p Order.
+double computeExtTSPScore(ArrayRef<unsigned> Order,
+                          ArrayRef<uint64_t> NodeSizes,
+                          ArrayRef<ExtTSPJump> Jumps);
+
+} // end namespace llvm
+
+#endif
@@ -62,6 +62,11 @@ static cl::opt<bool> EnablePrecomputePhysRegs(
 static bool EnablePrecomputePhysRegs = false;
 #endif // NDEBUG
 
+static cl::opt<bool> VerifyUpdates(
+  "verify-liveinterval-updates", cl::Hidden,
+  cl::desc("Check incrementally updated live intervals against a full "
+           "recomputation after the passes that update them"));
+
 static cl::opt<bool> EnableSubRegLiveness(
   "enable-subreg-liveness", cl::Hidden, cl::init(true),
   cl::desc("Enable subregister liveness tracking."));
@@ -1404,21 +1409,115 @@ LiveIntervals::repairIntervalsInRange(MachineBasicBlock *MBB,
     }
   }
 
+  SmallVector<unsigned, 4> GainedDefs;
   for (unsigned i = 0, e = OrigRegs.size(); i != e; ++i) {
     unsigned Reg = OrigRegs[i];
     if (!TargetRegisterInfo::isVirtualRegister(Reg))
       continue;
 
     LiveInterval &LI = getInterval(Reg);
-    // FIXME: Should we support undefs that gain defs?
-    if (!LI.hasAtLeastOneValue())
+    // An undef register that gained defs in the range has no values to
+    // repair; compute it from scratch instead.
+    if (!LI.hasAtLeastOneValue()) {
+      if (!MRI->def_empty(Reg))
+        GainedDefs.push_back(Reg);
       continue;
+    }
 
     for (LiveInterval::SubRange &S : LI.subranges()) {
       repairOldRegInRange(Begin, End, endIdx, S, Reg, S.LaneMask);
     }
     repairOldRegInRange(Begin, End, endIdx, LI, Reg);
   }
+  recomputeVirtRegIntervals(GainedDefs);
+}
+
+void LiveIntervals::recomputeVirtRegIntervals(ArrayRef<unsigned> Regs) {
+  for (unsigned Reg : Regs) {
+    if (!TargetRegisterInfo::isVirtualRegister(Reg))
+      continue;
+    if (hasInterval(Reg))
+      removeInterval(Reg);
+    if (!MRI->reg_nodbg_empty(Reg))
+      createAndComputeVirtRegInterval(Reg);
+  }
+}
+
+/// Remove the segments of PHI values that are not live past their def. The
+/// live range calculation keeps them; computeDeadValues() and shrinkToUses()
+/// remove them.
+static void removeDeadPHIValues(LiveRange &LR) {
+  for (VNInfo *VNI : LR.valnos) {
+    if (VNI->isUnused() || !VNI->isPHIDef())
+      continue;
+    LiveRange::iterator I = LR.FindSegmentContaining(VNI->def);
+    if (I != LR.end() && I->end == VNI->def.getDeadSlot())
+      LR.removeSegment(I);
+  }
+}
+
+/// Return true if \p Updated and \p Fresh are live at the same points,
+/// ignoring dead PHI values and value numbering. Print both otherwise.
+static bool checkUpdatedRange(const LiveRange &Updated, LiveRange &Fresh,
+                              BumpPtrAllocator &Alloc, const char *What) {
+  LiveRange Pruned(Updated, Alloc);
+  removeDeadPHIValues(Pruned);
+  removeDeadPHIValues(Fresh);
+  bool Under = !Pruned.covers(Fresh);
+  bool Over = !Fresh.covers(Pruned);
+  if (!Under && !Over)
+    return true;
+  errs() << "*** " << What << " is "
+         << (Under ? "missing live segments" : "live past its uses")
+         << " ***\n"
+         << "Updated:    " << Updated << '\n'
+         << "Recomputed: " << Fresh << '\n';
+  return false;
+}
+
+void LiveIntervals::verifyUpdatedIntervals(const char *Banner) {
+  if (!VerifyUpdates)
+    return;
+  unsigned NumErrors = 0;
+  for (unsigned i = 0, e = MRI->getNumVirtRegs(); i != e; ++i) {
+    unsigned Reg = TargetRegisterInfo::index2VirtReg(i);
+    if (MRI->reg_nodbg_empty(Reg))
+      continue;
+    if (!hasInterval(Reg)) {
+      errs() << "*** Missing live interval for " << PrintReg(Reg) << " ***\n";
+      ++NumErrors;
+      continue;
+    }
+
+    // Recompute the interval without computeDeadValues(), which would change
+    // operand flags, and compare both ways so that stale segments are caught
+    // as well as missing ones.
+    const LiveInterval &LI = getInterval(Reg);
+    LiveInterval Fresh(Reg, 0.0f);
+    LRCalc->reset(MF, getSlotIndexes(), DomTree, &getVNInfoAllocator());
+    LRCalc->calculate(Fresh, LI.hasSubRanges());
+    if (!checkUpdatedRange(LI, Fresh, getVNInfoAllocator(), "Live interval"))
+      ++NumErrors;
+
+    // A lane covered by both an updated and a recomputed subrange has the
+    // liveness of each, so the two must agree. Without recomputed subranges
+    // every lane is live in the main range.
+    for (const LiveInterval::SubRange &S : LI.subranges()) {
+      bool Matches = true;
+      if (!Fresh.hasSubRanges())
+        Matches = checkUpdatedRange(S, Fresh, getVNInfoAllocator(),
+                                    "Live subrange");
+      for (LiveInterval::SubRange &T : Fresh.subranges())
+        if (Matches && (S.LaneMask & T.LaneMask))
+          Matches = checkUpdatedRange(S, T, getVNInfoAllocator(),
+                                      "Live subrange");
+      if (!Matches)
+        ++NumErrors;
+    }
+  }
+  if (NumErrors)
+    report_fatal_error("Found " + Twine(NumErrors) +
+                       " stale live intervals " + Banner);
 }
 
 void LiveIntervals::removePhysRegDefAt(unsigned Reg, SlotIndex Pos) {
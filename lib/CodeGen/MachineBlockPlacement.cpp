@@ -26,6 +26,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/CodeGen/Passes.h"
+#include "ExtTSPLayout.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
@@ -109,6 +110,13 @@ static cl::opt<unsigned> JumpInstCost("jump-inst-cost",
                                       cl::desc("Cost of jump instructions."),
                                       cl::init(1), cl::Hidden);
 
+static cl::opt<bool> ExtTSPBlockPlacement(
+    "ext-tsp-block-placement",
+    cl::desc("Lay out blocks to maximize the Extended TSP score of the "
+             "function, weighted by edge frequencies, instead of building "
+             "chains greedily"),
+    cl::init(false), cl::Hidden);
+
 namespace {
 class BlockChain;
 /// \brief Type for our function-wide basic block -> block chain mapping.
@@ -281,6 +289,8 @@ class MachineBlockPlacement : public MachineFunctionPass {
   void rotateLoopWithProfile(BlockChain &LoopChain, MachineLoop &L,
                              const BlockFilterSet &LoopBlockSet);
   void buildCFGChains(MachineFunction &F);
+  void buildExtTSPOrder(MachineFunction &F,
+                        SmallVectorImpl<MachineBasicBlock *> &BlockOrder);
 
 public:
   static char ID; // Pass identification, replacement for typeid
@@ -1237,11 +1247,16 @@ void MachineBlockPlacement::buildCFGChains(MachineFunction &F) {
     assert(!BadFunc && "Detected problems with the block placement.");
   });
 
+  SmallVector<MachineBasicBlock *, 16> BlockOrder(FunctionChain.begin(),
+                                                  FunctionChain.end());
+  if (ExtTSPBlockPlacement)
+    buildExtTSPOrder(F, BlockOrder);
+
   // Splice the blocks into place.
   MachineFunction::iterator InsertPos = F.begin();
-  for (MachineBasicBlock *ChainBB : FunctionChain) {
-    DEBUG(dbgs() << (ChainBB == *FunctionChain.begin() ? "Placing chain "
-                                                       : "          ... ")
+  for (MachineBasicBlock *ChainBB : BlockOrder) {
+    DEBUG(dbgs() << (ChainBB == BlockOrder.front() ? "Placing chain "
+                                                   : "          ... ")
                  << getBlockName(ChainBB) << "\n");
     if (InsertPos != MachineFunction::iterator(ChainBB))
       F.splice(InsertPos, ChainBB);
@@ -1249,7 +1264,7 @@ void MachineBlockPlacement::buildCFGChains(MachineFunction &F) {
       ++InsertPos;
 
     // Update the terminator of the previous block.
-    if (ChainBB == *FunctionChain.begin())
+    if (ChainBB == BlockOrder.front())
       continue;
     MachineBasicBlock *PrevBB = &*std::prev(MachineFunction::iterator(ChainBB));
 
@@ -1316,14 +1331,14 @@ void MachineBlockPlacement::buildCFGChains(MachineFunction &F) {
   // FIXME: Use Function::optForSize().
   if (F.getFunction()->hasFnAttribute(Attribute::OptimizeForSize))
     return;
-  if (FunctionChain.begin() == FunctionChain.end())
+  if (BlockOrder.empty())
     return; // Empty chain.
 
   const BranchProbability ColdProb(1, 5); // 20%
   BlockFrequency EntryFreq = MBFI->getBlockFreq(&F.front());
   BlockFrequency WeightedEntryFreq = EntryFreq * ColdProb;
-  for (MachineBasicBlock *ChainBB : FunctionChain) {
-    if (ChainBB == *FunctionChain.begin())
+  for (MachineBasicBlock *ChainBB : BlockOrder) {
+    if (ChainBB == BlockOrder.front())
       continue;
 
     // Don't align non-looping basic blocks. These are unlikely to execute
@@ -1380,6 +1395,65 @@ void MachineBlockPlacement::buildCFGChains(MachineFunction &F) {
   }
 }
 
+/// Replace \p BlockOrder with the order of the blocks of \p F that maximizes
+/// the Ext-TSP score, using the block frequencies as execution counts. Blocks
+/// that cannot be analyzed keep falling through to their layout successors.
+void MachineBlockPlacement::buildExtTSPOrder(
+    MachineFunction &F, SmallVectorImpl<MachineBasicBlock *> &BlockOrder) {
+  DenseMap<const MachineBasicBlock *, unsigned> Index;
+  SmallVector<MachineBasicBlock *, 16> Blocks;
+  for (MachineBasicBlock &MBB : F) {
+    Index[&MBB] = Blocks.size();
+    Blocks.push_back(&MBB);
+  }
+
+  // Instruction sizes are not known this early, so estimate four bytes for
+  // each instruction that will be emitted.
+  std::vector<uint64_t> Sizes, Counts;
+  SmallVector<bool, 16> FallsThrough;
+  std::vector<ExtTSPJump> Jumps;
+  SmallVector<MachineOperand, 4> Cond; // For AnalyzeBranch.
+  for (MachineBasicBlock *MBB : Blocks) {
+    uint64_t Size = 0;
+    for (const MachineInstr &MI : *MBB)
+      if (!MI.isDebugValue() && !MI.isPosition() && !MI.isImplicitDef() &&
+          !MI.isKill())
+        Size += 4;
+    Sizes.push_back(std::max<uint64_t>(Size, 1));
+
+    BlockFrequency Freq = MBFI->getBlockFreq(MBB);
+    Counts.push_back(Freq.getFrequency());
+    for (MachineBasicBlock *Succ : MBB->successors()) {
+      BlockFrequency EdgeFreq = Freq * MBPI->getEdgeProbability(MBB, Succ);
+      Jumps.push_back({Index[MBB], Index[Succ], EdgeFreq.getFrequency()});
+    }
+
+    Cond.clear();
+    MachineBasicBlock *TBB = nullptr, *FBB = nullptr; // For AnalyzeBranch.
+    FallsThrough.push_back(TII->AnalyzeBranch(*MBB, TBB, FBB, Cond) &&
+                           MBB->canFallThrough());
+  }
+
+  std::vector<unsigned> Order =
+      computeExtTSPLayout(Sizes, Counts, Jumps, FallsThrough);
+  DEBUG({
+    std::vector<unsigned> Original;
+    std::vector<unsigned> Greedy;
+    for (unsigned I = 0, E = Blocks.size(); I != E; ++I)
+      Original.push_back(I);
+    for (MachineBasicBlock *MBB : BlockOrder)
+      Greedy.push_back(Index[MBB]);
+    dbgs() << "Ext-TSP score of " << F.getName() << ": original "
+           << computeExtTSPScore(Original, Sizes, Jumps) << ", chains "
+           << computeExtTSPScore(Greedy, Sizes, Jumps) << ", Ext-TSP "
+           << computeExtTSPScore(Order, Sizes, Jumps) << "\n";
+  });
+
+  BlockOrder.clear();
+  for (unsigned I : Order)
+    BlockOrder.push_back(Blocks[I]);
+}
+
 bool MachineBlockPlacement::runOnMachineFunction(MachineFunction &F) {
   // Check for single-block functions and skip them.
   if (std::next(F.begin()) == F.end())
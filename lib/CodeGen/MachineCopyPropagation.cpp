@@ -9,17 +9,27 @@
 //
 // This is an extremely simple MachineInstr-level copy propagation pass.
 //
+// Within a basic block, it deletes copies that copy a value back to a
+// register that still holds it, and copies whose destination is never read.
+// With -machine-cp-global, it also computes which copies are available at the
+// start of each block, so that copies back can be deleted across blocks, and
+// uses the live-in lists of successors to delete copies whose destination is
+// dead at the end of a block.
+//
 //===----------------------------------------------------------------------===//
 
 #include "llvm/CodeGen/Passes.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/PostOrderIterator.h"
 #include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/CodeGen/MachineFunction.h"
 #include "llvm/CodeGen/MachineFunctionPass.h"
 #include "llvm/CodeGen/MachineRegisterInfo.h"
 #include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
@@ -31,6 +41,21 @@ using namespace llvm;
 #define DEBUG_TYPE "codegen-cp"
 
 STATISTIC(NumDeletes, "Number of dead copies deleted");
+STATISTIC(NumGlobalNopDeletes,
+          "Number of copies deleted using copies from predecessors");
+STATISTIC(NumGlobalDeadDeletes,
+          "Number of copies deleted as dead on exit from their block");
+
+static cl::opt<bool>
+EnableGlobalCopyProp("machine-cp-global", cl::Hidden, cl::init(false),
+                     cl::desc("Propagate copies across basic blocks"));
+
+static cl::opt<unsigned>
+GlobalCopyPropMaxBlocks("machine-cp-global-max-blocks", cl::Hidden,
+                        cl::init(2000),
+                        cl::desc("Only propagate copies across basic blocks "
+                                 "in functions with at most this many "
+                                 "blocks"));
 
 namespace {
   class MachineCopyPropagation : public MachineFunctionPass {
@@ -50,10 +75,26 @@ namespace {
     typedef SmallVector<unsigned, 4> DestList;
     typedef DenseMap<unsigned, DestList> SourceMap;
 
+    /// Copies Def = COPY Src known to have been executed on every path to
+    /// some point, with neither register clobbered since, as a Def -> Src
+    /// map.
+    typedef DenseMap<unsigned, unsigned> CopySet;
+
+    /// The copies available on entry to each block, indexed by block
+    /// number. Empty unless copies are propagated across blocks.
+    std::vector<CopySet> AvailIn;
+
     void SourceNoLongerAvailable(unsigned Reg,
                                  SourceMap &SrcMap,
                                  DenseMap<unsigned, MachineInstr*> &AvailCopyMap);
     bool CopyPropagateBlock(MachineBasicBlock &MBB);
+
+    void computeAvailableCopies(MachineFunction &MF);
+    void clobberCopies(CopySet &Copies, unsigned Reg) const;
+    void transferCopies(const MachineInstr &MI, CopySet &Copies) const;
+    void extendLiveRange(unsigned Reg, unsigned CopyDef,
+                         MachineInstr &MI) const;
+    bool isLiveOut(const MachineBasicBlock &MBB, unsigned Reg) const;
   };
 }
 char MachineCopyPropagation::ID = 0;
@@ -126,12 +167,182 @@ static bool isNopCopy(MachineInstr *CopyMI, unsigned Def, unsigned Src,
   return false;
 }
 
+/// Forget the copies that define or read a register overlapping \p Reg.
+void MachineCopyPropagation::clobberCopies(CopySet &Copies,
+                                           unsigned Reg) const {
+  SmallVector<unsigned, 4> Clobbered;
+  for (const auto &Copy : Copies)
+    if (TRI->regsOverlap(Copy.first, Reg) || TRI->regsOverlap(Copy.second, Reg))
+      Clobbered.push_back(Copy.first);
+  for (unsigned Def : Clobbered)
+    Copies.erase(Def);
+}
+
+/// Update \p Copies, the copies available before \p MI, to the copies
+/// available after it.
+void MachineCopyPropagation::transferCopies(const MachineInstr &MI,
+                                            CopySet &Copies) const {
+  if (MI.isCopy()) {
+    unsigned Def = MI.getOperand(0).getReg();
+    unsigned Src = MI.getOperand(1).getReg();
+    clobberCopies(Copies, Def);
+    // Reserved registers may change behind our back, so leave them alone.
+    if (!MRI->isReserved(Def) && !MRI->isReserved(Src) &&
+        !TRI->regsOverlap(Def, Src))
+      Copies[Def] = Src;
+    return;
+  }
+
+  for (const MachineOperand &MO : MI.operands()) {
+    if (MO.isRegMask()) {
+      SmallVector<unsigned, 4> Clobbered;
+      for (const auto &Copy : Copies)
+        if (MO.clobbersPhysReg(Copy.first) || MO.clobbersPhysReg(Copy.second))
+          Clobbered.push_back(Copy.first);
+      for (unsigned Def : Clobbered)
+        Copies.erase(Def);
+      continue;
+    }
+    // Undef uses are treated like defs, as in CopyPropagateBlock.
+    if (MO.isReg() && MO.getReg() && (MO.isDef() || MO.isUndef()))
+      clobberCopies(Copies, MO.getReg());
+  }
+}
+
+/// Compute the copies available on entry to each block, as the intersection
+/// of the copies available on exit from its predecessors.
+void MachineCopyPropagation::computeAvailableCopies(MachineFunction &MF) {
+  unsigned NumBlocks = MF.getNumBlockIDs();
+  AvailIn.assign(NumBlocks, CopySet());
+  std::vector<CopySet> AvailOut(NumBlocks);
+  // Blocks not visited yet are treated as making every copy available.
+  std::vector<bool> Visited(NumBlocks);
+
+  ReversePostOrderTraversal<MachineFunction *> RPOT(&MF);
+  bool Changed = true;
+  while (Changed) {
+    Changed = false;
+    for (MachineBasicBlock *MBB : RPOT) {
+      unsigned Num = MBB->getNumber();
+      // Nothing is known on entry to the function, and the unwinder clobbers
+      // registers on the way to a landing pad.
+      CopySet In;
+      if (MBB != &MF.front() && !MBB->isEHPad()) {
+        bool First = true;
+        for (MachineBasicBlock *Pred : MBB->predecessors()) {
+          const CopySet &PredOut = AvailOut[Pred->getNumber()];
+          if (!Visited[Pred->getNumber()])
+            continue;
+          if (First) {
+            In = PredOut;
+            First = false;
+            continue;
+          }
+          SmallVector<unsigned, 4> Missing;
+          for (const auto &Copy : In) {
+            CopySet::const_iterator PI = PredOut.find(Copy.first);
+            if (PI == PredOut.end() || PI->second != Copy.second)
+              Missing.push_back(Copy.first);
+          }
+          for (unsigned Def : Missing)
+            In.erase(Def);
+        }
+      }
+
+      CopySet Out = In;
+      for (const MachineInstr &MI : *MBB)
+        transferCopies(MI, Out);
+
+      CopySet &OldOut = AvailOut[Num];
+      bool OutChanged = !Visited[Num] || Out.size() != OldOut.size();
+      for (auto I = Out.begin(), E = Out.end(); I != E && !OutChanged; ++I) {
+        CopySet::const_iterator OI = OldOut.find(I->first);
+        OutChanged = OI == OldOut.end() || OI->second != I->second;
+      }
+      Visited[Num] = true;
+      AvailIn[Num] = std::move(In);
+      if (OutChanged) {
+        OldOut = std::move(Out);
+        Changed = true;
+      }
+    }
+  }
+}
+
+/// Make \p Reg live from the copies CopyDef = COPY Reg available before
+/// \p MI down to \p MI, by adding it to the live-ins of the blocks in
+/// between and clearing its kills.
+void MachineCopyPropagation::extendLiveRange(unsigned Reg, unsigned CopyDef,
+                                             MachineInstr &MI) const {
+  auto AddLiveIn = [&](MachineBasicBlock &MBB) {
+    for (MCSuperRegIterator SR(Reg, TRI, /*IncludeSelf=*/true); SR.isValid();
+         ++SR)
+      if (MBB.isLiveIn(*SR))
+        return;
+    MBB.addLiveIn(Reg);
+  };
+
+  MachineBasicBlock *MBB = MI.getParent();
+  for (MachineBasicBlock::iterator I = MBB->begin(), E = MI; I != E; ++I)
+    I->clearRegisterKills(Reg, TRI);
+  AddLiveIn(*MBB);
+
+  SmallVector<MachineBasicBlock *, 8> Worklist(MBB->pred_begin(),
+                                               MBB->pred_end());
+  SmallPtrSet<MachineBasicBlock *, 8> Visited;
+  while (!Worklist.empty()) {
+    MachineBasicBlock *Pred = Worklist.pop_back_val();
+    if (!Visited.insert(Pred).second)
+      continue;
+
+    // Find the last copy in Pred that makes the copy available. If MI is in
+    // Pred, the copy must be after MI.
+    MachineBasicBlock::iterator Begin =
+        Pred == MBB ? std::next(MachineBasicBlock::iterator(MI))
+                    : Pred->begin();
+    MachineBasicBlock::iterator I = Pred->end();
+    bool Found = false;
+    while (I != Begin) {
+      --I;
+      if (I->isCopy() && I->getOperand(0).getReg() == CopyDef &&
+          I->getOperand(1).getReg() == Reg) {
+        Found = true;
+        break;
+      }
+    }
+
+    for (MachineBasicBlock::iterator E = Pred->end(); I != E; ++I)
+      I->clearRegisterKills(Reg, TRI);
+    if (Found)
+      continue;
+    AddLiveIn(*Pred);
+    Worklist.append(Pred->pred_begin(), Pred->pred_end());
+  }
+}
+
+/// Return true if a register overlapping \p Reg is live into a successor of
+/// \p MBB.
+bool MachineCopyPropagation::isLiveOut(const MachineBasicBlock &MBB,
+                                       unsigned Reg) const {
+  for (const MachineBasicBlock *Succ : MBB.successors())
+    for (const auto &LI : Succ->liveins())
+      if (TRI->regsOverlap(LI.PhysReg, Reg))
+        return true;
+  return false;
+}
+
 bool MachineCopyPropagation::CopyPropagateBlock(MachineBasicBlock &MBB) {
   SmallSetVector<MachineInstr*, 8> MaybeDeadCopies;  // Candidates for deletion
   DenseMap<unsigned, MachineInstr*> AvailCopyMap;    // Def -> available copies map
   DenseMap<unsigned, MachineInstr*> CopyMap;         // Def -> copies map
   SourceMap SrcMap; // Src -> Def map
 
+  // Copies available from the predecessors, when propagating across blocks.
+  bool Global = !AvailIn.empty();
+  CopySet Inherited;
+  if (Global)
+    Inherited = AvailIn[MBB.getNumber()];
+
   DEBUG(dbgs() << "MCP: CopyPropagateBlock " << MBB.getName() << "\n");
 
   bool Changed = false;
@@ -182,6 +393,25 @@ bool MachineCopyPropagation::CopyPropagateBlock(MachineBasicBlock &MBB) {
         }
       }
 
+      // The same, for a copy made before this block. e.g.
+      //  %ECX<def> = COPY %EAX<kill>
+      //  JMP <BB#1>
+      // BB#1:
+      //  %EAX<def> = COPY %ECX
+      CopySet::iterator II = Inherited.find(Src);
+      if (II != Inherited.end() && II->second == Def) {
+        DEBUG(dbgs() << "MCP: copy is a NOP across blocks, removing: ";
+              MI->dump());
+        extendLiveRange(Def, Src, *MI);
+        MI->eraseFromParent();
+        Changed = true;
+        ++NumDeletes;
+        ++NumGlobalNopDeletes;
+        continue;
+      }
+      if (Global)
+        transferCopies(*MI, Inherited);
+
       // If Src is defined by a previous copy, it cannot be eliminated.
       for (MCRegAliasIterator AI(Src, TRI, true); AI.isValid(); ++AI) {
         CI = CopyMap.find(*AI);
@@ -228,6 +458,8 @@ bool MachineCopyPropagation::CopyPropagateBlock(MachineBasicBlock &MBB) {
     }
 
     // Not a copy.
+    if (Global)
+      transferCopies(*MI, Inherited);
     SmallVector<unsigned, 2> Defs;
     int RegMaskOpNum = -1;
     for (unsigned i = 0, e = MI->getNumOperands(); i != e; ++i) {
@@ -324,6 +556,19 @@ bool MachineCopyPropagation::CopyPropagateBlock(MachineBasicBlock &MBB) {
         ++NumDeletes;
       }
     }
+  } else if (Global) {
+    // When propagating across blocks, the live-in lists are trusted after
+    // all.
+    for (MachineInstr *Copy : MaybeDeadCopies) {
+      unsigned Def = Copy->getOperand(0).getReg();
+      if (MRI->isReserved(Def) || isLiveOut(MBB, Def))
+        continue;
+      DEBUG(dbgs() << "MCP: copy is dead on exit, removing: "; Copy->dump());
+      Copy->eraseFromParent();
+      Changed = true;
+      ++NumDeletes;
+      ++NumGlobalDeadDeletes;
+    }
   }
 
   return Changed;
@@ -339,8 +584,16 @@ bool MachineCopyPropagation::runOnMachineFunction(MachineFunction &MF) {
   TII = MF.getSubtarget().getInstrInfo();
   MRI = &MF.getRegInfo();
 
+  // Copies are only propagated across blocks when the live-in lists can be
+  // trusted, and the function is small enough for the dataflow to be cheap.
+  AvailIn.clear();
+  if (EnableGlobalCopyProp && MRI->tracksLiveness() &&
+      MF.size() <= GlobalCopyPropMaxBlocks)
+    computeAvailableCopies(MF);
+
   for (MachineFunction::iterator I = MF.begin(), E = MF.end(); I != E; ++I)
     Changed |= CopyPropagateBlock(*I);
 
+  AvailIn.clear();
   return Changed;
 }
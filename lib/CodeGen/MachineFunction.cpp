@@ -38,6 +38,7 @@
 #include "llvm/MC/MCContext.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/GraphWriter.h"
+#include "llvm/Support/MemoryUsage.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetFrameLowering.h"
 #include "llvm/Target/TargetLowering.h"
@@ -412,6 +413,21 @@ void MachineFunction::print(raw_ostream &OS, SlotIndexes *Indexes) const {
   OS << "\n# End machine code for function " << getName() << ".\n\n";
 }
 
+void MachineFunction::getMemoryUsage(MemoryUsageReport &Report) const {
+  // MachineInstrs, MachineBasicBlocks, operand arrays and memoperands are all
+  // carved out of Allocator, so its slabs account for the bulk of the IR.
+  Report.addAllocator("machine-function.allocator", Allocator);
+  Report.add("machine-function.block-numbering",
+             MBBNumbering.capacity() * sizeof(MachineBasicBlock *));
+  if (RegInfo) {
+    size_t PerVReg = sizeof(std::pair<const TargetRegisterClass *,
+                                      MachineOperand *>) +
+                     sizeof(std::pair<unsigned, unsigned>);
+    Report.add("machine-function.virtual-registers",
+               RegInfo->getNumVirtRegs() * PerVReg);
+  }
+}
+
 namespace llvm {
   template<>
   struct DOTGraphTraits<const MachineFunction*> : public DefaultDOTGraphTraits {
@@ -21,11 +21,14 @@
 #include "llvm/Analysis/MemoryDependenceAnalysis.h"
 #include "llvm/Analysis/ScalarEvolution.h"
 #include "llvm/Analysis/ScalarEvolutionAliasAnalysis.h"
+#include "llvm/CodeGen/MachineFunction.h"
 #include "llvm/CodeGen/MachineFunctionAnalysis.h"
 #include "llvm/CodeGen/Passes.h"
 #include "llvm/CodeGen/StackProtector.h"
 #include "llvm/IR/Dominators.h"
 #include "llvm/IR/Function.h"
+#include "llvm/Support/MemoryUsage.h"
+#include "llvm/Support/raw_ostream.h"
 using namespace llvm;
 
 Pass *MachineFunctionPass::createPrinterPass(raw_ostream &O,
@@ -40,7 +43,16 @@ bool MachineFunctionPass::runOnFunction(Function &F) {
     return false;
 
   MachineFunction &MF = getAnalysis<MachineFunctionAnalysis>().getMF();
-  return runOnMachineFunction(MF);
+  bool Changed = runOnMachineFunction(MF);
+
+  if (PrintMemoryUsageIsEnabled) {
+    MemoryUsageReport Report;
+    MF.getMemoryUsage(Report);
+    Report.print(errs(), (Twine("Machine function memory usage after '") +
+                          getPassName() + "' on '" + MF.getName() + "'")
+                             .str());
+  }
+  return Changed;
 }
 
 void MachineFunctionPass::getAnalysisUsage(AnalysisUsage &AU) const {
@@ -0,0 +1,218 @@
+//===-- MachineFunctionSplitter.cpp - Split cold blocks into a section ----===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass uses profile data to find the blocks of a function that are
+// (almost) never executed, moves them to the end of the function, and marks
+// the first of them so that the AsmPrinter emits the rest of the function in
+// a separate cold section. Keeping the cold code out of the way packs the hot
+// code of a large program onto fewer pages and cache lines.
+//
+// The cold part gets its own symbol and its own frame description, built by
+// replaying the prologue's CFI. Functions whose cold part would need more
+// than that are left alone: functions with debug info, with jump tables, or
+// whose prologue was shrink-wrapped away from the entry block.
+//
+// Exception handling is not supported: functions with a personality or with
+// landing pads are never split. The LSDA that EHStreamer emits describes call
+// sites and landing pads as offsets from a single function start, so a cold
+// fragment in another section would need its own call-site table, and landing
+// pads would have to stay in the section of the code that unwinds to them.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/CodeGen/MachineBlockFrequencyInfo.h"
+#include "llvm/CodeGen/MachineFrameInfo.h"
+#include "llvm/CodeGen/MachineFunction.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineJumpTableInfo.h"
+#include "llvm/CodeGen/MachineModuleInfo.h"
+#include "llvm/CodeGen/Passes.h"
+#include "llvm/IR/Function.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetInstrInfo.h"
+#include "llvm/Target/TargetMachine.h"
+#include "llvm/Target/TargetSubtargetInfo.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "machine-function-splitter"
+
+STATISTIC(NumSplitFunctions, "Number of functions split");
+STATISTIC(NumColdBlocks, "Number of blocks moved to a cold section");
+
+static cl::opt<unsigned> ColdCountThreshold(
+    "mfs-count-threshold", cl::Hidden, cl::init(0),
+    cl::desc("Blocks whose estimated execution count is at most this value "
+             "are moved to the cold section"));
+
+namespace {
+
+class MachineFunctionSplitter : public MachineFunctionPass {
+public:
+  static char ID;
+  MachineFunctionSplitter() : MachineFunctionPass(ID) {
+    initializeMachineFunctionSplitterPass(*PassRegistry::getPassRegistry());
+  }
+
+  bool runOnMachineFunction(MachineFunction &MF) override;
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.addRequired<MachineBlockFrequencyInfo>();
+    MachineFunctionPass::getAnalysisUsage(AU);
+  }
+
+private:
+  bool canSplit(MachineFunction &MF) const;
+  bool isCold(const MachineBasicBlock &MBB, uint64_t EntryCount) const;
+
+  const TargetInstrInfo *TII;
+  const MachineBlockFrequencyInfo *MBFI;
+};
+
+} // end anonymous namespace
+
+char MachineFunctionSplitter::ID = 0;
+char &llvm::MachineFunctionSplitterID = MachineFunctionSplitter::ID;
+
+INITIALIZE_PASS_BEGIN(MachineFunctionSplitter, "machine-function-splitter",
+                      "Split cold blocks into a separate section", false,
+                      false)
+INITIALIZE_PASS_DEPENDENCY(MachineBlockFrequencyInfo)
+INITIALIZE_PASS_END(MachineFunctionSplitter, "machine-function-splitter",
+                    "Split cold blocks into a separate section", false, false)
+
+/// Return true if the cold blocks of \p MF can be emitted in a section of
+/// their own without the AsmPrinter having to describe anything but the frame
+/// for them.
+bool MachineFunctionSplitter::canSplit(MachineFunction &MF) const {
+  const Function *F = MF.getFunction();
+  if (!MF.getTarget().getTargetTriple().isOSBinFormatELF() ||
+      !TII->isFunctionSafeToSplit(MF))
+    return false;
+
+  // Respect an explicit placement of the function.
+  if (F->hasSection())
+    return false;
+
+  // The call-site table of an LSDA only covers one range of code, and the
+  // debug info for a subprogram assumes it is contiguous.
+  if (F->hasPersonalityFn() || MF.getMMI().hasDebugInfo())
+    return false;
+
+  // Jump table entries may be label differences, which cannot cross
+  // sections.
+  const MachineJumpTableInfo *JTI = MF.getJumpTableInfo();
+  if (JTI && !JTI->isEmpty())
+    return false;
+
+  // The frame description of the cold part replays the CFI of the entry
+  // block, which only describes the rest of the function if the prologue is
+  // there.
+  const MachineBasicBlock *SavePoint = MF.getFrameInfo()->getSavePoint();
+  if (SavePoint && SavePoint != &MF.front())
+    return false;
+
+  // Moving blocks requires rewriting the branches of any block that may fall
+  // through.
+  for (MachineBasicBlock &MBB : MF) {
+    if (MBB.isEHPad())
+      return false;
+    MachineBasicBlock *TBB = nullptr, *FBB = nullptr;
+    SmallVector<MachineOperand, 4> Cond;
+    if (TII->AnalyzeBranch(MBB, TBB, FBB, Cond) && MBB.canFallThrough())
+      return false;
+  }
+  return true;
+}
+
+/// Return true if the estimated execution count of \p MBB, scaled from the
+/// profiled entry count of the function, is at most the threshold.
+bool MachineFunctionSplitter::isCold(const MachineBasicBlock &MBB,
+                                     uint64_t EntryCount) const {
+  uint64_t EntryFreq = MBFI->getEntryFreq();
+  uint64_t Freq = MBFI->getBlockFreq(&MBB).getFrequency();
+  // Count = EntryCount * Freq / EntryFreq, compared without dividing.
+  uint64_t Limit =
+      SaturatingMultiply<uint64_t>(ColdCountThreshold + 1, EntryFreq);
+  return SaturatingMultiply(EntryCount, Freq) < Limit;
+}
+
+bool MachineFunctionSplitter::runOnMachineFunction(MachineFunction &MF) {
+  if (skipOptnoneFunction(*MF.getFunction()))
+    return false;
+
+  // Only split with real profile data. A function that never ran at all
+  // would be left with just its entry block in the hot section, which helps
+  // nobody, so those are left alone too.
+  Optional<uint64_t> EntryCount = MF.getFunction()->getEntryCount();
+  if (!EntryCount || *EntryCount == 0 || MF.size() < 2)
+    return false;
+
+  TII = MF.getSubtarget().getInstrInfo();
+  MBFI = &getAnalysis<MachineBlockFrequencyInfo>();
+  if (!canSplit(MF))
+    return false;
+
+  SmallVector<MachineBasicBlock *, 16> ColdBlocks;
+  for (MachineBasicBlock &MBB : MF)
+    if (&MBB != &MF.front() && isCold(MBB, *EntryCount))
+      ColdBlocks.push_back(&MBB);
+  if (ColdBlocks.empty())
+    return false;
+
+  DEBUG(dbgs() << "Splitting " << ColdBlocks.size() << " cold blocks out of "
+               << MF.getName() << '\n');
+
+  // Move the cold blocks to the end of the function, keeping their order,
+  // then fix up the branches of every block whose layout successor changed.
+  MachineBasicBlock *LastHot = nullptr;
+  for (MachineBasicBlock *MBB : ColdBlocks)
+    MBB->moveAfter(&MF.back());
+  for (MachineBasicBlock &MBB : MF) {
+    if (&MBB == ColdBlocks.front())
+      break;
+    LastHot = &MBB;
+  }
+
+  for (MachineBasicBlock &MBB : MF) {
+    MachineBasicBlock *TBB = nullptr, *FBB = nullptr;
+    SmallVector<MachineOperand, 4> Cond;
+    if (!TII->AnalyzeBranch(MBB, TBB, FBB, Cond))
+      MBB.updateTerminator();
+  }
+
+  // The hot part must not fall through into the cold part, which is emitted
+  // somewhere else.
+  MachineBasicBlock *ColdStart = ColdBlocks.front();
+  if (LastHot->isSuccessor(ColdStart) && LastHot->canFallThrough()) {
+    MachineBasicBlock *TBB = nullptr, *FBB = nullptr;
+    SmallVector<MachineOperand, 4> Cond;
+    bool Unanalyzable = TII->AnalyzeBranch(*LastHot, TBB, FBB, Cond);
+    (void)Unanalyzable;
+    assert(!Unanalyzable && "Fallthrough from an unanalyzable block!");
+    DebugLoc DL;
+    if (!TBB) {
+      TII->InsertBranch(*LastHot, ColdStart, nullptr, Cond, DL);
+    } else {
+      assert(!Cond.empty() && !FBB && "Expected a conditional fallthrough");
+      TII->RemoveBranch(*LastHot);
+      TII->InsertBranch(*LastHot, TBB, ColdStart, Cond, DL);
+    }
+  }
+
+  ColdStart->setIsColdSectionStart();
+  ++NumSplitFunctions;
+  NumColdBlocks += ColdBlocks.size();
+  return true;
+}
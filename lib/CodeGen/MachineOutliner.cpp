@@ -0,0 +1,490 @@
+//===-- MachineOutliner.cpp - Outline repeated instruction sequences ------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass replaces repeated sequences of machine instructions with calls to
+// a single copy of the sequence, to reduce code size.
+//
+// Each instruction the target allows to be outlined is mapped to an integer,
+// identical instructions to the same integer, and the function is turned into
+// a string of those integers in which every other instruction and every block
+// boundary is a unique separator. Repeated substrings are then found with a
+// suffix tree. Candidates are taken greedily by the number of instructions
+// they save; each chosen sequence is moved into a subroutine block at the end
+// of the function, which ends in a return, and every non-overlapping
+// occurrence is replaced by a call to it.
+//
+// Code generation runs one function at a time, so sequences are only shared
+// within a function. Blocks that run more often than the function entry, such
+// as loop bodies, are left alone so that hot code is not slowed down by the
+// extra call and return.
+//
+// Call frame information is never outlined. Targets classify CFI instructions
+// as illegal, so they split sequences like any other illegal instruction, and
+// the code around them is still outlined from. The subroutine has no call
+// frame information of its own; it makes no calls, so only an asynchronous
+// unwinder can stop inside it.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/CodeGen/LivePhysRegs.h"
+#include "llvm/CodeGen/MachineBlockFrequencyInfo.h"
+#include "llvm/CodeGen/MachineFunction.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineInstr.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/Passes.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetInstrInfo.h"
+#include "llvm/Target/TargetRegisterInfo.h"
+#include "llvm/Target/TargetSubtargetInfo.h"
+#include <algorithm>
+#include <map>
+
+using namespace llvm;
+
+#define DEBUG_TYPE "machine-outliner"
+
+STATISTIC(NumOutlinedSequences, "Number of sequences outlined");
+STATISTIC(NumOutlinedCalls, "Number of calls to outlined sequences inserted");
+STATISTIC(NumInstrsSaved, "Number of instructions saved by outlining");
+
+static cl::opt<unsigned> MinBenefit(
+    "machine-outliner-min-benefit", cl::Hidden, cl::init(1),
+    cl::desc("Minimum number of instructions an outlined sequence must save"));
+
+static cl::opt<unsigned> MaxRelativeFreq(
+    "machine-outliner-max-relative-freq", cl::Hidden, cl::init(100),
+    cl::desc("Only outline from blocks whose frequency is at most this "
+             "percentage of the function entry frequency"));
+
+namespace {
+
+/// A suffix tree over a string of unsigned integers, built with Ukkonen's
+/// algorithm. The last character of the string must be unique.
+class SuffixTree {
+  struct Node {
+    /// The edge into this node is labelled Str[Start..End], inclusive. Leaves
+    /// have End == ~0U and extend to the current end of the string.
+    unsigned Start;
+    unsigned End;
+    /// For leaves, the start of the suffix the leaf represents.
+    unsigned SuffixIdx;
+    unsigned Link;
+    std::map<unsigned, unsigned> Children;
+  };
+
+  ArrayRef<unsigned> Str;
+  std::vector<Node> Nodes;
+  unsigned LeafEnd = 0;
+
+  unsigned newNode(unsigned Start, unsigned End, unsigned SuffixIdx) {
+    Node N;
+    N.Start = Start;
+    N.End = End;
+    N.SuffixIdx = SuffixIdx;
+    N.Link = 0;
+    Nodes.push_back(N);
+    return Nodes.size() - 1;
+  }
+
+  unsigned getEnd(const Node &N) const {
+    return N.End == ~0U ? LeafEnd : N.End;
+  }
+
+public:
+  /// A repeated substring: its length and the start of each occurrence.
+  struct RepeatedSubstring {
+    unsigned Length;
+    std::vector<unsigned> Starts;
+  };
+
+  explicit SuffixTree(ArrayRef<unsigned> Str) : Str(Str) {
+    unsigned Root = newNode(~0U, ~0U, ~0U);
+    unsigned ActiveNode = Root, ActiveEdge = 0, ActiveLength = 0;
+    unsigned Remaining = 0;
+    for (unsigned I = 0, E = Str.size(); I != E; ++I) {
+      LeafEnd = I;
+      ++Remaining;
+      unsigned LastInternal = 0;
+      while (Remaining) {
+        if (ActiveLength == 0)
+          ActiveEdge = I;
+        auto Child = Nodes[ActiveNode].Children.find(Str[ActiveEdge]);
+        if (Child == Nodes[ActiveNode].Children.end()) {
+          unsigned Leaf = newNode(I, ~0U, I - Remaining + 1);
+          Nodes[ActiveNode].Children[Str[ActiveEdge]] = Leaf;
+          if (LastInternal) {
+            Nodes[LastInternal].Link = ActiveNode;
+            LastInternal = 0;
+          }
+        } else {
+          unsigned Next = Child->second;
+          unsigned EdgeLength = getEnd(Nodes[Next]) - Nodes[Next].Start + 1;
+          if (ActiveLength >= EdgeLength) {
+            ActiveEdge += EdgeLength;
+            ActiveLength -= EdgeLength;
+            ActiveNode = Next;
+            continue;
+          }
+          if (Str[Nodes[Next].Start + ActiveLength] == Str[I]) {
+            if (LastInternal && ActiveNode != Root) {
+              Nodes[LastInternal].Link = ActiveNode;
+              LastInternal = 0;
+            }
+            ++ActiveLength;
+            break;
+          }
+          // Split the edge into Next.
+          unsigned SplitStart = Nodes[Next].Start;
+          unsigned Split =
+              newNode(SplitStart, SplitStart + ActiveLength - 1, ~0U);
+          Nodes[ActiveNode].Children[Str[ActiveEdge]] = Split;
+          unsigned Leaf = newNode(I, ~0U, I - Remaining + 1);
+          Nodes[Split].Children[Str[I]] = Leaf;
+          Nodes[Next].Start += ActiveLength;
+          Nodes[Split].Children[Str[Nodes[Next].Start]] = Next;
+          if (LastInternal)
+            Nodes[LastInternal].Link = Split;
+          LastInternal = Split;
+        }
+        --Remaining;
+        if (ActiveNode == Root && ActiveLength > 0) {
+          --ActiveLength;
+          ActiveEdge = I - Remaining + 1;
+        } else if (ActiveNode != Root) {
+          ActiveNode = Nodes[ActiveNode].Link;
+        }
+      }
+    }
+  }
+
+  /// Return every substring of at least \p MinLength characters that is the
+  /// path to an internal node, i.e. occurs at least twice and cannot be
+  /// extended to the right without losing an occurrence.
+  std::vector<RepeatedSubstring> getRepeatedSubstrings(unsigned MinLength) {
+    // Walk the tree depth first with an explicit stack, since its depth grows
+    // with the length of the repeats. The suffixes below a node form the run
+    // of Leaves that was appended between the first and the second visit of
+    // that node.
+    struct WorkItem {
+      unsigned Node;
+      unsigned Depth;
+      unsigned LeafBegin;
+      bool Visited;
+    };
+    std::vector<RepeatedSubstring> Result;
+    std::vector<unsigned> Leaves;
+    SmallVector<WorkItem, 32> Worklist;
+    Worklist.push_back({0, 0, 0, false});
+    while (!Worklist.empty()) {
+      WorkItem W = Worklist.pop_back_val();
+      const Node &Nd = Nodes[W.Node];
+      if (Nd.Children.empty()) {
+        Leaves.push_back(Nd.SuffixIdx);
+        continue;
+      }
+      if (!W.Visited) {
+        Worklist.push_back({W.Node, W.Depth, unsigned(Leaves.size()), true});
+        // Push the children in reverse so they are visited in key order.
+        for (auto C = Nd.Children.rbegin(), E = Nd.Children.rend(); C != E;
+             ++C) {
+          const Node &Child = Nodes[C->second];
+          unsigned ChildDepth = W.Depth + getEnd(Child) - Child.Start + 1;
+          Worklist.push_back({C->second, ChildDepth, 0, false});
+        }
+        continue;
+      }
+      if (W.Node != 0 && W.Depth >= MinLength) {
+        RepeatedSubstring RS;
+        RS.Length = W.Depth;
+        RS.Starts.assign(Leaves.begin() + W.LeafBegin, Leaves.end());
+        std::sort(RS.Starts.begin(), RS.Starts.end());
+        Result.push_back(std::move(RS));
+      }
+    }
+    return Result;
+  }
+};
+
+class MachineOutliner : public MachineFunctionPass {
+  const TargetInstrInfo *TII;
+
+  /// The instruction string and, for each character that stands for an
+  /// outlinable instruction, that instruction.
+  std::vector<unsigned> Str;
+  std::vector<MachineInstr *> StrInstrs;
+
+  /// A sequence chosen for outlining: its length and the occurrences that
+  /// will be replaced.
+  struct Candidate {
+    unsigned Length;
+    std::vector<unsigned> Starts;
+  };
+
+  bool isColdEnough(const MachineBasicBlock &MBB,
+                    const MachineBlockFrequencyInfo &MBFI) const;
+  void buildString(MachineFunction &MF);
+  void filterIllegalCalls(MachineFunction &MF, std::vector<bool> &CallOK);
+  void outline(MachineFunction &MF, const Candidate &C);
+
+public:
+  static char ID;
+
+  MachineOutliner() : MachineFunctionPass(ID) {
+    initializeMachineOutlinerPass(*PassRegistry::getPassRegistry());
+  }
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.addRequired<MachineBlockFrequencyInfo>();
+    MachineFunctionPass::getAnalysisUsage(AU);
+  }
+
+  bool runOnMachineFunction(MachineFunction &MF) override;
+};
+
+} // end anonymous namespace
+
+char MachineOutliner::ID = 0;
+char &llvm::MachineOutlinerID = MachineOutliner::ID;
+
+INITIALIZE_PASS_BEGIN(MachineOutliner, "machine-outliner",
+                      "Machine Function Outliner", false, false)
+INITIALIZE_PASS_DEPENDENCY(MachineBlockFrequencyInfo)
+INITIALIZE_PASS_END(MachineOutliner, "machine-outliner",
+                    "Machine Function Outliner", false, false)
+
+bool MachineOutliner::isColdEnough(
+    const MachineBasicBlock &MBB,
+    const MachineBlockFrequencyInfo &MBFI) const {
+  double Entry = MBFI.getEntryFreq();
+  double Freq = MBFI.getBlockFreq(&MBB).getFrequency();
+  return Freq * 100 <= Entry * MaxRelativeFreq;
+}
+
+void MachineOutliner::buildString(MachineFunction &MF) {
+  auto &MBFI = getAnalysis<MachineBlockFrequencyInfo>();
+  DenseMap<MachineInstr *, unsigned, MachineInstrExpressionTrait> Ids;
+  // Legal instructions are numbered from 0 up, separators from ~0U down, so
+  // the two never meet in practice.
+  unsigned NextId = 0, NextSeparator = ~0U;
+  auto AddSeparator = [&]() {
+    if (Str.empty() || StrInstrs.back()) {
+      Str.push_back(NextSeparator--);
+      StrInstrs.push_back(nullptr);
+    }
+  };
+
+  for (MachineBasicBlock &MBB : MF) {
+    AddSeparator();
+    if (!isColdEnough(MBB, MBFI))
+      continue;
+    for (MachineInstr &MI : MBB) {
+      switch (TII->getOutliningType(MI)) {
+      case TargetInstrInfo::MachineOutlinerInvisible:
+        continue;
+      case TargetInstrInfo::MachineOutlinerIllegal:
+        AddSeparator();
+        continue;
+      case TargetInstrInfo::MachineOutlinerLegal:
+        break;
+      }
+      auto Ins = Ids.insert(std::make_pair(&MI, NextId));
+      if (Ins.second)
+        ++NextId;
+      Str.push_back(Ins.first->second);
+      StrInstrs.push_back(&MI);
+    }
+  }
+  // The suffix tree needs a unique terminator.
+  Str.push_back(NextSeparator--);
+  StrInstrs.push_back(nullptr);
+}
+
+/// Clear CallOK[I] for every string position I where the target does not
+/// allow a call to be inserted.
+void MachineOutliner::filterIllegalCalls(MachineFunction &MF,
+                                         std::vector<bool> &CallOK) {
+  const TargetRegisterInfo *TRI = MF.getSubtarget().getRegisterInfo();
+  DenseMap<const MachineInstr *, unsigned> Position;
+  for (unsigned I = 0, E = StrInstrs.size(); I != E; ++I)
+    if (StrInstrs[I])
+      Position[StrInstrs[I]] = I;
+
+  LivePhysRegs LiveRegs(TRI);
+  for (MachineBasicBlock &MBB : MF) {
+    LiveRegs.clear();
+    LiveRegs.addLiveOuts(&MBB, /*AddPristinesAndCSRs=*/true);
+    for (MachineInstr &MI : make_range(MBB.rbegin(), MBB.rend())) {
+      LiveRegs.stepBackward(MI);
+      auto P = Position.find(&MI);
+      if (P != Position.end() && !TII->isOutlinedCallLegal(LiveRegs))
+        CallOK[P->second] = false;
+    }
+  }
+}
+
+void MachineOutliner::outline(MachineFunction &MF, const Candidate &C) {
+  const TargetRegisterInfo *TRI = MF.getSubtarget().getRegisterInfo();
+
+  // Build the subroutine from the first occurrence.
+  MachineBasicBlock *Body = MF.CreateMachineBasicBlock();
+  MF.push_back(Body);
+  Body->setHasAddressTaken();
+  for (unsigned I = 0; I != C.Length; ++I) {
+    MachineInstr *NewMI = MF.CloneMachineInstr(StrInstrs[C.Starts[0] + I]);
+    NewMI->dropMemRefs();
+    Body->push_back(NewMI);
+  }
+  TII->insertOutlinedReturn(*Body);
+
+  LivePhysRegs LiveRegs(TRI);
+  for (MachineInstr &MI : make_range(Body->rbegin(), Body->rend()))
+    LiveRegs.stepBackward(MI);
+  for (unsigned Reg : LiveRegs)
+    Body->addLiveIn(Reg);
+
+  // Collect the registers the subroutine reads before writing them, and the
+  // registers it writes.
+  SmallVector<unsigned, 8> Uses, Defs;
+  for (MachineInstr &MI : *Body) {
+    if (MI.isReturn())
+      continue;
+    for (const MachineOperand &MO : MI.operands()) {
+      if (!MO.isReg() || !MO.getReg())
+        continue;
+      if (MO.isDef()) {
+        if (std::find(Defs.begin(), Defs.end(), MO.getReg()) == Defs.end())
+          Defs.push_back(MO.getReg());
+      } else if (MO.readsReg() && LiveRegs.contains(MO.getReg()) &&
+                 std::find(Uses.begin(), Uses.end(), MO.getReg()) ==
+                     Uses.end()) {
+        Uses.push_back(MO.getReg());
+      }
+    }
+  }
+
+  for (unsigned Start : C.Starts) {
+    MachineInstr *First = StrInstrs[Start];
+    MachineInstr *Last = StrInstrs[Start + C.Length - 1];
+    MachineBasicBlock *MBB = First->getParent();
+
+    // Only the registers that are live into the sequence and the registers it
+    // writes that are live out of it need to be carried by the call.
+    SmallVector<unsigned, 8> CallUses, CallDefs;
+    LivePhysRegs CallLiveRegs(TRI);
+    CallLiveRegs.addLiveOuts(MBB, /*AddPristinesAndCSRs=*/true);
+    MachineBasicBlock::reverse_iterator I = MBB->rbegin();
+    for (; &*I != Last; ++I)
+      CallLiveRegs.stepBackward(*I);
+    for (unsigned Reg : Defs)
+      for (MCSubRegIterator SR(Reg, TRI, /*IncludeSelf=*/true); SR.isValid();
+           ++SR)
+        if (CallLiveRegs.contains(*SR)) {
+          CallDefs.push_back(Reg);
+          break;
+        }
+    for (;; ++I) {
+      CallLiveRegs.stepBackward(*I);
+      if (&*I == First)
+        break;
+    }
+    for (unsigned Reg : Uses)
+      if (CallLiveRegs.contains(Reg))
+        CallUses.push_back(Reg);
+
+    MachineInstr *Call = TII->insertOutlinedCall(*MBB, First, *Body);
+    MachineInstrBuilder MIB(MF, Call);
+    for (unsigned Reg : CallUses)
+      MIB.addReg(Reg, RegState::Implicit);
+    for (unsigned Reg : CallDefs)
+      MIB.addReg(Reg, RegState::Implicit | RegState::Define);
+    MBB->erase(MachineBasicBlock::iterator(First),
+               std::next(MachineBasicBlock::iterator(Last)));
+    for (unsigned I = 0; I != C.Length; ++I)
+      StrInstrs[Start + I] = nullptr;
+    ++NumOutlinedCalls;
+  }
+
+  ++NumOutlinedSequences;
+  NumInstrsSaved += C.Length * C.Starts.size() - C.Starts.size() - C.Length - 1;
+}
+
+bool MachineOutliner::runOnMachineFunction(MachineFunction &MF) {
+  TII = MF.getSubtarget().getInstrInfo();
+  if (!TII->isFunctionSafeToOutlineFrom(MF))
+    return false;
+  for (const MachineBasicBlock &MBB : MF)
+    if (MBB.isEHPad() || MBB.isEHFuncletEntry())
+      return false;
+
+  Str.clear();
+  StrInstrs.clear();
+  buildString(MF);
+
+  std::vector<bool> CallOK(Str.size(), true);
+  filterIllegalCalls(MF, CallOK);
+
+  // Outlining a sequence of length L found at N places replaces N * L
+  // instructions with N calls, plus a body of L instructions and a return.
+  auto Benefit = [](unsigned Length, size_t Count) -> int64_t {
+    return int64_t(Length) * Count - int64_t(Count) - Length - 1;
+  };
+
+  // Keep the occurrences of each repeated substring that do not overlap each
+  // other, then take the substrings that save the most first.
+  std::vector<Candidate> Candidates;
+  SuffixTree ST(Str);
+  for (auto &RS : ST.getRepeatedSubstrings(/*MinLength=*/2)) {
+    Candidate C;
+    C.Length = RS.Length;
+    for (unsigned Start : RS.Starts) {
+      if (!CallOK[Start])
+        continue;
+      if (!C.Starts.empty() && Start < C.Starts.back() + C.Length)
+        continue;
+      C.Starts.push_back(Start);
+    }
+    if (C.Starts.size() >= 2 &&
+        Benefit(C.Length, C.Starts.size()) >= int64_t(MinBenefit))
+      Candidates.push_back(std::move(C));
+  }
+  std::stable_sort(Candidates.begin(), Candidates.end(),
+                   [&](const Candidate &LHS, const Candidate &RHS) {
+                     return Benefit(LHS.Length, LHS.Starts.size()) >
+                            Benefit(RHS.Length, RHS.Starts.size());
+                   });
+
+  bool Changed = false;
+  for (Candidate &C : Candidates) {
+    // Drop the occurrences that an earlier candidate has already replaced.
+    C.Starts.erase(std::remove_if(C.Starts.begin(), C.Starts.end(),
+                                  [&](unsigned Start) {
+                                    for (unsigned I = 0; I != C.Length; ++I)
+                                      if (!StrInstrs[Start + I])
+                                        return true;
+                                    return false;
+                                  }),
+                   C.Starts.end());
+    if (C.Starts.size() < 2 ||
+        Benefit(C.Length, C.Starts.size()) < int64_t(MinBenefit))
+      continue;
+    DEBUG(dbgs() << "Outlining " << C.Length << " instructions at "
+                 << C.Starts.size() << " places in " << MF.getName() << ":\n";
+          for (unsigned I = 0; I != C.Length; ++I)
+            dbgs() << "  " << *StrInstrs[C.Starts[0] + I]);
+    outline(MF, C);
+    Changed = true;
+  }
+  return Changed;
+}
@@ -343,6 +343,7 @@ bool MachineScheduler::runOnMachineFunction(MachineFunction &mf) {
   scheduleRegions(*Scheduler, false);
 
   DEBUG(LIS->dump());
+  LIS->verifyUpdatedIntervals("after machine scheduling");
   if (VerifyScheduling)
     MF->verify(this, "After machine scheduling.");
   return true;
@@ -74,6 +74,14 @@ static cl::opt<bool> DisableCopyProp("disable-copyprop", cl::Hidden,
     cl::desc("Disable Copy Propagation pass"));
 static cl::opt<bool> DisablePartialLibcallInlining("disable-partial-libcall-inlining",
     cl::Hidden, cl::desc("Disable Partial Libcall Inlining"));
+static cl::opt<bool> EnableMachineOutliner(
+    "enable-machine-outliner", cl::Hidden, cl::init(false),
+    cl::desc("Replace repeated instruction sequences with calls to a "
+             "shared copy"));
+static cl::opt<bool> EnableMachineFunctionSplitter(
+    "split-machine-functions", cl::Hidden, cl::init(false),
+    cl::desc("Move blocks that profile data shows to be cold into a "
+             "separate section"));
 static cl::opt<bool> EnableImplicitNullChecks(
     "enable-implicit-null-checks",
     cl::desc("Fold null checks into faulting memory operations"),
@@ -592,11 +600,17 @@ void TargetPassConfig::addMachinePasses() {
   }
 
   // Basic block placement.
-  if (getOptLevel() != CodeGenOpt::None)
+  if (getOptLevel() != CodeGenOpt::None) {
     addBlockPlacement();
+    if (EnableMachineFunctionSplitter)
+      addPass(&MachineFunctionSplitterID);
+  }
 
   addPreEmitPass();
 
+  if (EnableMachineOutliner && getOptLevel() != CodeGenOpt::None)
+    addPass(&MachineOutlinerID);
+
   addPass(&FuncletLayoutID, false);
 
   addPass(&StackMapLivenessID, false);
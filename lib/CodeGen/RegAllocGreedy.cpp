@@ -36,6 +36,7 @@
 #include "llvm/CodeGen/RegAllocRegistry.h"
 #include "llvm/CodeGen/RegisterClassInfo.h"
 #include "llvm/CodeGen/VirtRegMap.h"
+#include "llvm/IR/DiagnosticInfo.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/PassAnalysisSupport.h"
 #include "llvm/Support/BranchProbability.h"
@@ -54,6 +55,7 @@ using namespace llvm;
 STATISTIC(NumGlobalSplits, "Number of split global live ranges");
 STATISTIC(NumLocalSplits,  "Number of split local live ranges");
 STATISTIC(NumEvicted,      "Number of interferences evicted");
+STATISTIC(NumOverBudget,   "Number of functions that exceeded the budget");
 
 static cl::opt<SplitEditor::ComplementSpillMode>
 SplitSpillMode("split-spill-mode", cl::Hidden,
@@ -100,6 +102,13 @@ CSRFirstTimeCost("regalloc-csr-first-time-cost",
               cl::desc("Cost for first time use of callee-saved register."),
               cl::init(0), cl::Hidden);
 
+static cl::opt<unsigned> WorkBudget(
+    "regalloc-greedy-budget", cl::Hidden,
+    cl::desc("Amount of interference checks and split candidates the greedy "
+             "allocator may examine in a function before falling back to "
+             "spilling (0 = unlimited)"),
+    cl::init(0));
+
 static RegisterRegAlloc greedyRegAlloc("greedy", "greedy register allocator",
                                        createGreedyRegisterAllocator);
 
@@ -191,6 +200,12 @@ class RAGreedy : public MachineFunctionPass,
 
   uint8_t CutOffInfo;
 
+  // Work done so far in the current function, in the units of WorkBudget.
+  // Once it goes over the budget, OverBudget is set and the allocator stops
+  // evicting and splitting spillable ranges and spills them instead.
+  unsigned WorkDone;
+  bool OverBudget;
+
 #ifndef NDEBUG
   static const char *const StageName[];
 #endif
@@ -397,6 +412,7 @@ private:
                                SmallVirtRegSet &, unsigned);
   void tryHintRecoloring(LiveInterval &);
   void tryHintsRecoloring();
+  void chargeWork(unsigned Units);
 
   /// Model the information carried by one end of a copy.
   struct HintInfo {
@@ -901,6 +917,7 @@ unsigned RAGreedy::tryEvict(LiveInterval &VirtReg,
       continue;
     }
 
+    chargeWork(1);
     if (!canEvictInterference(VirtReg, PhysReg, false, BestCost))
       continue;
 
@@ -1406,6 +1423,7 @@ unsigned RAGreedy::calculateRegionSplitCost(LiveInterval &VirtReg,
     GlobalSplitCandidate &Cand = GlobalCand[NumCands];
     Cand.reset(IntfCache, PhysReg);
 
+    chargeWork(1 + SA->getUseBlocks().size());
     SpillPlacer->prepare(Cand.LiveBundles);
     BlockFrequency Cost;
     if (!addSplitConstraints(Cand.Intf, Cost)) {
@@ -2100,6 +2118,7 @@ unsigned RAGreedy::tryLastChanceRecoloring(LiveInterval &VirtReg,
                  << PrintReg(PhysReg, TRI) << '\n');
     RecoloringCandidates.clear();
     VirtRegToPhysReg.clear();
+    chargeWork(1);
 
     // It is only possible to recolor virtual register interference.
     if (Matrix->checkInterference(VirtReg, PhysReg) >
@@ -2205,6 +2224,24 @@ bool RAGreedy::tryRecoloringCandidates(PQueue &RecoloringQueue,
 //                            Main Entry Point
 //===----------------------------------------------------------------------===//
 
+/// chargeWork - Account for \p Units of work done on the current function.
+/// The first time the total goes over -regalloc-greedy-budget, report it
+/// with an analysis remark; allocation then continues in the cheaper mode.
+void RAGreedy::chargeWork(unsigned Units) {
+  WorkDone += Units;
+  if (!WorkBudget || OverBudget || WorkDone <= WorkBudget)
+    return;
+  OverBudget = true;
+  ++NumOverBudget;
+  DEBUG(dbgs() << "Work budget of " << WorkBudget << " exceeded in "
+               << MF->getName() << ", spilling instead of splitting\n");
+  const Function &Fn = *MF->getFunction();
+  emitOptimizationRemarkAnalysis(
+      Fn.getContext(), DEBUG_TYPE, Fn, DebugLoc(),
+      "register allocation exceeded its budget of " + Twine(WorkBudget) +
+          " work units; remaining live ranges are spilled instead of split");
+}
+
 unsigned RAGreedy::selectOrSplit(LiveInterval &VirtReg,
                                  SmallVectorImpl<unsigned> &NewVRegs) {
   CutOffInfo = CO_None;
@@ -2494,8 +2531,9 @@ unsigned RAGreedy::selectOrSplitImpl(LiveInterval &VirtReg,
 
   // Try to evict a less worthy live range, but only for ranges from the primary
   // queue. The RS_Split ranges already failed to do this, and they should not
-  // get a second chance until they have been split.
-  if (Stage != RS_Split)
+  // get a second chance until they have been split. Over budget, spillable
+  // ranges don't evict anything either, which cuts eviction chains short.
+  if (Stage != RS_Split && !(OverBudget && VirtReg.isSpillable()))
     if (unsigned PhysReg =
             tryEvict(VirtReg, Order, NewVRegs, CostPerUseLimit)) {
       unsigned Hint = MRI->getSimpleHint(VirtReg.reg);
@@ -2527,10 +2565,13 @@ unsigned RAGreedy::selectOrSplitImpl(LiveInterval &VirtReg,
     return tryLastChanceRecoloring(VirtReg, Order, NewVRegs, FixedRegisters,
                                    Depth);
 
-  // Try splitting VirtReg or interferences.
-  unsigned PhysReg = trySplit(VirtReg, Order, NewVRegs);
-  if (PhysReg || !NewVRegs.empty())
-    return PhysReg;
+  // Try splitting VirtReg or interferences, unless we have already spent
+  // the budget for this function.
+  if (!OverBudget) {
+    unsigned PhysReg = trySplit(VirtReg, Order, NewVRegs);
+    if (PhysReg || !NewVRegs.empty())
+      return PhysReg;
+  }
 
   // Finally spill VirtReg itself.
   if (EnableDeferredSpilling && getStage(VirtReg) < RS_Memory) {
@@ -2598,9 +2639,12 @@ bool RAGreedy::runOnMachineFunction(MachineFunction &mf) {
   IntfCache.init(MF, Matrix->getLiveUnions(), Indexes, LIS, TRI);
   GlobalCand.resize(32);  // This will grow as needed.
   SetOfBrokenHints.clear();
+  WorkDone = 0;
+  OverBudget = false;
 
   allocatePhysRegs();
-  tryHintsRecoloring();
+  if (!OverBudget)
+    tryHintsRecoloring();
   releaseMemory();
   return true;
 }
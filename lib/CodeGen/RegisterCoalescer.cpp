@@ -2975,6 +2975,7 @@ bool RegisterCoalescer::runOnMachineFunction(MachineFunction &fn) {
   }
 
   DEBUG(dump());
+  LIS->verifyUpdatedIntervals("after register coalescing");
   if (VerifyCoalescing)
     MF->verify(this, "After register coalescing");
   return true;
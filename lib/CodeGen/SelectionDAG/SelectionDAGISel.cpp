@@ -48,6 +48,7 @@
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetInstrInfo.h"
@@ -170,6 +171,11 @@ static cl::opt<bool>
 EnableFastISelVerbose("fast-isel-verbose", cl::Hidden,
           cl::desc("Enable verbose messages in the \"fast\" "
                    "instruction selector"));
+static cl::opt<std::string> FastISelReport(
+    "fast-isel-report", cl::Hidden, cl::value_desc("filename"),
+    cl::desc("Append to this file how many times fast instruction selection "
+             "fell back to SelectionDAG, by instruction kind, type and "
+             "intrinsic"));
 static cl::opt<int> EnableFastISelAbort(
     "fast-isel-abort", cl::Hidden,
     cl::desc("Enable abort calls when \"fast\" instruction selection "
@@ -373,6 +379,58 @@ SelectionDAGISel::~SelectionDAGISel() {
   delete FuncInfo;
 }
 
+/// Print the fast isel fallbacks of the module, one "<count>\t<kind>" line per
+/// kind of instruction, most frequent first. The reports of a whole build can
+/// be appended to the same file and summed up by kind.
+bool SelectionDAGISel::doFinalization(Module &M) {
+  if (FastISelFallbacks.empty())
+    return false;
+
+  std::vector<std::pair<unsigned, StringRef>> Fallbacks;
+  for (const auto &Fallback : FastISelFallbacks)
+    Fallbacks.emplace_back(Fallback.getValue(), Fallback.getKey());
+  std::sort(Fallbacks.begin(), Fallbacks.end(),
+            [](const std::pair<unsigned, StringRef> &A,
+               const std::pair<unsigned, StringRef> &B) {
+              return A.first != B.first ? A.first > B.first
+                                        : A.second < B.second;
+            });
+
+  std::error_code EC;
+  raw_fd_ostream OS(FastISelReport, EC, sys::fs::F_Append | sys::fs::F_Text);
+  if (EC)
+    report_fatal_error("could not open fast isel report '" + FastISelReport +
+                       "': " + EC.message());
+  for (const auto &Fallback : Fallbacks)
+    OS << Fallback.first << '\t' << Fallback.second << '\n';
+
+  FastISelFallbacks.clear();
+  return false;
+}
+
+void SelectionDAGISel::recordFastISelFallback(const Instruction *I) {
+  if (FastISelReport.empty())
+    return;
+  if (!I) {
+    ++FastISelFallbacks["arguments"];
+    return;
+  }
+
+  // Describe the instruction by its opcode, the intrinsic it calls, and its
+  // type, or the type of the value it stores or returns.
+  std::string Kind;
+  raw_string_ostream OS(Kind);
+  OS << I->getOpcodeName();
+  if (const auto *II = dyn_cast<IntrinsicInst>(I))
+    OS << ' ' << Intrinsic::getName(II->getIntrinsicID());
+  Type *Ty = I->getType();
+  if ((isa<StoreInst>(I) || isa<ReturnInst>(I)) && I->getNumOperands())
+    Ty = I->getOperand(0)->getType();
+  if (!Ty->isVoidTy())
+    OS << ' ' << *Ty;
+  ++FastISelFallbacks[OS.str()];
+}
+
 void SelectionDAGISel::getAnalysisUsage(AnalysisUsage &AU) const {
   AU.addRequired<AAResultsWrapperPass>();
   AU.addRequired<GCModuleInfo>();
@@ -1214,6 +1272,7 @@ void SelectionDAGISel::SelectAllBasicBlocks(const Function &Fn) {
         if (!FastIS->lowerArguments()) {
           // Fast isel failed to lower these arguments
           ++NumFastIselFailLowerArguments;
+          recordFastISelFallback(nullptr);
           if (EnableFastISelAbort > 1)
             report_fatal_error("FastISel didn't lower all arguments");
 
@@ -1276,6 +1335,7 @@ void SelectionDAGISel::SelectAllBasicBlocks(const Function &Fn) {
         if (EnableFastISelVerbose2)
           collectFailStats(Inst);
 #endif
+        recordFastISelFallback(Inst);
 
         // Then handle certain instructions as single-LLVM-Instruction blocks.
         if (isa<CallInst>(Inst)) {
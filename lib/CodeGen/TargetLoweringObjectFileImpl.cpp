@@ -336,6 +336,33 @@ MCSection *TargetLoweringObjectFileELF::getSectionForJumpTable(
                                    &NextUniqueID);
 }
 
+MCSection *TargetLoweringObjectFileELF::getSectionForColdCode(
+    const Function &F, Mangler &Mang, const TargetMachine &TM) const {
+  // Cold code goes to .text.unlikely, where linkers gather it away from the
+  // hot text. It must be discarded along with the rest of the function, so it
+  // joins the function's group and gets its own section under
+  // -ffunction-sections.
+  unsigned Flags = ELF::SHF_ALLOC | ELF::SHF_EXECINSTR;
+  StringRef Group = "";
+  if (const Comdat *C = getELFComdat(&F)) {
+    Flags |= ELF::SHF_GROUP;
+    Group = C->getName();
+  }
+
+  SmallString<128> Name(".text.unlikely");
+  unsigned UniqueID = ~0;
+  if (TM.getFunctionSections()) {
+    if (TM.getUniqueSectionNames()) {
+      Name.push_back('.');
+      TM.getNameWithPrefix(Name, &F, Mang, true);
+    } else {
+      UniqueID = NextUniqueID++;
+    }
+  }
+  return getContext().getELFSection(Name, ELF::SHT_PROGBITS, Flags,
+                                    /*EntrySize=*/0, Group, UniqueID);
+}
+
 bool TargetLoweringObjectFileELF::shouldPutJumpTableInFunctionSection(
     bool UsesLabelDifference, const Function &F) const {
   // We can always create relative relocations, so use another section
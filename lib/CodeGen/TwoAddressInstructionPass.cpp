@@ -693,6 +693,13 @@ TwoAddressInstructionPass::convertInstTo3Addr(MachineBasicBlock::iterator &mi,
                                               MachineBasicBlock::iterator &nmi,
                                               unsigned RegA, unsigned RegB,
                                               unsigned Dist) {
+  // convertToThreeAddress may emit more than the new instruction, such as a
+  // copy into a wider register. Targets insert everything next to mi, so
+  // remember its neighbours to tell the new instructions apart afterwards.
+  MachineBasicBlock::iterator Prev =
+      mi == MBB->begin() ? MBB->end() : std::prev(mi);
+  MachineBasicBlock::iterator Next = std::next(mi);
+
   // FIXME: Why does convertToThreeAddress() need an iterator reference?
   MachineFunction::iterator MFI = MBB->getIterator();
   MachineInstr *NewMI = TII->convertToThreeAddress(MFI, mi, LV);
@@ -705,9 +712,32 @@ TwoAddressInstructionPass::convertInstTo3Addr(MachineBasicBlock::iterator &mi,
   DEBUG(dbgs() << "2addr:         TO 3-ADDR: " << *NewMI);
   bool Sunk = false;
 
-  if (LIS)
+  // Index the other new instructions too. They define or read registers in
+  // place of mi and NewMI, so recompute the intervals of every register the
+  // group mentions once the old instruction is gone.
+  SmallVector<unsigned, 8> Regs;
+  if (LIS) {
     LIS->ReplaceMachineInstrInMaps(mi, NewMI);
 
+    MachineBasicBlock::iterator Begin =
+        Prev == MBB->end() ? MBB->begin() : std::next(Prev);
+    bool Inserted = false;
+    for (MachineBasicBlock::iterator I = Begin; I != Next; ++I) {
+      if (I == mi || &*I == NewMI || I->isDebugValue())
+        continue;
+      LIS->InsertMachineInstrInMaps(I);
+      Inserted = true;
+    }
+    if (Inserted)
+      for (MachineBasicBlock::iterator I = Begin; I != Next; ++I) {
+        if (I->isDebugValue())
+          continue;
+        for (const MachineOperand &MO : I->operands())
+          if (MO.isReg() && TargetRegisterInfo::isVirtualRegister(MO.getReg()))
+            Regs.push_back(MO.getReg());
+      }
+  }
+
   if (NewMI->findRegisterUseOperand(RegB, false, TRI))
     // FIXME: Temporary workaround. If the new instruction doesn't
     // uses RegB, convertToThreeAddress must have created more
@@ -716,6 +746,9 @@ TwoAddressInstructionPass::convertInstTo3Addr(MachineBasicBlock::iterator &mi,
 
   MBB->erase(mi); // Nuke the old inst.
 
+  if (!Regs.empty())
+    LIS->recomputeVirtRegIntervals(Regs);
+
   if (!Sunk) {
     DistanceMap.insert(std::make_pair(NewMI, Dist));
     mi = NewMI;
@@ -1580,8 +1613,11 @@ TwoAddressInstructionPass::processTiedPairs(MachineInstr *MI,
       LV->addVirtualRegisterKilled(RegB, PrevMI);
     }
 
-    // Update LiveIntervals.
-    if (LIS) {
+    // Update LiveIntervals. Trimming the main range by hand would leave the
+    // subranges stale, so recompute an interval that has them.
+    if (LIS && LIS->getInterval(RegB).hasSubRanges()) {
+      LIS->recomputeVirtRegIntervals(RegB);
+    } else if (LIS) {
       LiveInterval &LI = LIS->getInterval(RegB);
       SlotIndex MIIdx = LIS->getInstructionIndex(MI);
       LiveInterval::const_iterator I = LI.find(MIIdx);
@@ -1714,8 +1750,10 @@ bool TwoAddressInstructionPass::runOnMachineFunction(MachineFunction &Func) {
     }
   }
 
-  if (LIS)
+  if (LIS) {
+    LIS->verifyUpdatedIntervals("after two-address instruction pass");
     MF->verify(this, "After two-address instruction pass");
+  }
 
   return MadeChange;
 }
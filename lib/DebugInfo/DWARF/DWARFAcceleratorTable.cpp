@@ -10,6 +10,7 @@
 #include "llvm/DebugInfo/DWARF/DWARFAcceleratorTable.h"
 #include "llvm/Support/Dwarf.h"
 #include "llvm/Support/Format.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/Support/raw_ostream.h"
 
 namespace llvm {
@@ -129,4 +130,297 @@ void DWARFAcceleratorTable::dump(raw_ostream &OS) const {
     }
   }
 }
+
+//===----------------------------------------------------------------------===//
+// DWARFDebugNames Implementation
+//===----------------------------------------------------------------------===//
+
+uint32_t DWARFDebugNames::getRelocatedU32(uint32_t Offset) const {
+  uint32_t Value = NamesSection.getU32(&Offset);
+  RelocAddrMap::const_iterator Reloc = Relocs.find(Offset - 4);
+  if (Reloc != Relocs.end())
+    Value += Reloc->second.second;
+  return Value;
+}
+
+bool DWARFDebugNames::extract() {
+  uint32_t Offset = 0;
+  while (NamesSection.isValidOffset(Offset)) {
+    NameIndex Index(*this, Offset);
+    if (!Index.extract())
+      return false;
+    Offset = Index.getNextOffset();
+    Indices.push_back(Index);
+  }
+  return true;
+}
+
+void DWARFDebugNames::dump(raw_ostream &OS) const {
+  for (const NameIndex &Index : Indices)
+    Index.dump(OS);
+}
+
+std::vector<DWARFDebugNames::Entry>
+DWARFDebugNames::lookup(StringRef Name) const {
+  std::vector<Entry> Result;
+  for (const NameIndex &Index : Indices)
+    Index.lookup(Name, Result);
+  return Result;
+}
+
+bool DWARFDebugNames::NameIndex::extract() {
+  const DataExtractor &Data = Section.NamesSection;
+  uint32_t Offset = Base;
+
+  // Check that we can at least read the header, then that the whole index
+  // fits in the section. 64-bit DWARF is not supported.
+  if (!Data.isValidOffsetForDataOfSize(Offset, 36))
+    return false;
+  Hdr.UnitLength = Data.getU32(&Offset);
+  if (Hdr.UnitLength >= 0xfffffff0 ||
+      !Data.isValidOffsetForDataOfSize(Offset, Hdr.UnitLength))
+    return false;
+  End = Offset + Hdr.UnitLength;
+  Hdr.Version = Data.getU16(&Offset);
+  Hdr.Padding = Data.getU16(&Offset);
+  Hdr.CompUnitCount = Data.getU32(&Offset);
+  Hdr.LocalTypeUnitCount = Data.getU32(&Offset);
+  Hdr.ForeignTypeUnitCount = Data.getU32(&Offset);
+  Hdr.BucketCount = Data.getU32(&Offset);
+  Hdr.NameCount = Data.getU32(&Offset);
+  Hdr.AbbrevTableSize = Data.getU32(&Offset);
+  Hdr.AugmentationStringSize = Data.getU32(&Offset);
+  if (Hdr.Version != 5)
+    return false;
+
+  // Compute where the tables start. The hashes are only present along with
+  // the buckets.
+  uint64_t Pos = Offset + RoundUpToAlignment(Hdr.AugmentationStringSize, 4);
+  CUsBase = Pos;
+  Pos += 4 * (uint64_t(Hdr.CompUnitCount) + Hdr.LocalTypeUnitCount) +
+         8 * uint64_t(Hdr.ForeignTypeUnitCount);
+  BucketsBase = Pos;
+  Pos += 4 * uint64_t(Hdr.BucketCount);
+  HashesBase = Pos;
+  if (Hdr.BucketCount)
+    Pos += 4 * uint64_t(Hdr.NameCount);
+  StringOffsetsBase = Pos;
+  Pos += 4 * uint64_t(Hdr.NameCount);
+  EntryOffsetsBase = Pos;
+  Pos += 4 * uint64_t(Hdr.NameCount);
+  uint32_t AbbrevBase = Pos;
+  Pos += Hdr.AbbrevTableSize;
+  EntriesBase = Pos;
+  if (Pos > End)
+    return false;
+
+  // Read the abbreviations.
+  Offset = AbbrevBase;
+  while (Offset < EntriesBase) {
+    Abbrev A;
+    A.Code = Data.getULEB128(&Offset);
+    if (!A.Code)
+      break;
+    A.Tag = Data.getULEB128(&Offset);
+    while (Offset < EntriesBase) {
+      uint16_t Index = Data.getULEB128(&Offset);
+      uint16_t Form = Data.getULEB128(&Offset);
+      if (!Index && !Form)
+        break;
+      A.Attributes.push_back(std::make_pair(Index, Form));
+    }
+    Abbrevs[A.Code] = A;
+  }
+  return true;
+}
+
+uint32_t DWARFDebugNames::NameIndex::getCUOffset(uint32_t CU) const {
+  return Section.getRelocatedU32(CUsBase + 4 * CU);
+}
+
+uint32_t DWARFDebugNames::NameIndex::getHash(uint32_t Index) const {
+  uint32_t Offset = HashesBase + 4 * (Index - 1);
+  return Section.NamesSection.getU32(&Offset);
+}
+
+uint32_t DWARFDebugNames::NameIndex::getStringOffset(uint32_t Index) const {
+  return Section.getRelocatedU32(StringOffsetsBase + 4 * (Index - 1));
+}
+
+// Read a value of one of the forms an index attribute can have.
+static bool extractIndexValue(const DataExtractor &Data, uint32_t *Offset,
+                              uint16_t Form, uint64_t &Value) {
+  switch (Form) {
+  case dwarf::DW_FORM_data1:
+  case dwarf::DW_FORM_ref1:
+  case dwarf::DW_FORM_flag:
+    Value = Data.getU8(Offset);
+    return true;
+  case dwarf::DW_FORM_data2:
+  case dwarf::DW_FORM_ref2:
+    Value = Data.getU16(Offset);
+    return true;
+  case dwarf::DW_FORM_data4:
+  case dwarf::DW_FORM_ref4:
+    Value = Data.getU32(Offset);
+    return true;
+  case dwarf::DW_FORM_data8:
+  case dwarf::DW_FORM_ref8:
+  case dwarf::DW_FORM_ref_sig8:
+    Value = Data.getU64(Offset);
+    return true;
+  case dwarf::DW_FORM_udata:
+  case dwarf::DW_FORM_ref_udata:
+    Value = Data.getULEB128(Offset);
+    return true;
+  case dwarf::DW_FORM_flag_present:
+    Value = 1;
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool DWARFDebugNames::NameIndex::extractEntry(uint32_t *Offset,
+                                              Entry &E) const {
+  const DataExtractor &Data = Section.NamesSection;
+  if (*Offset >= End)
+    return false;
+  uint32_t Code = Data.getULEB128(Offset);
+  if (!Code)
+    return false;
+  auto A = Abbrevs.find(Code);
+  if (A == Abbrevs.end())
+    return false;
+
+  E.Tag = A->second.Tag;
+  E.CUOffset = Hdr.CompUnitCount == 1 ? getCUOffset(0) : -1U;
+  E.DIEOffset = -1U;
+  for (const auto &Attr : A->second.Attributes) {
+    uint64_t Value;
+    if (!extractIndexValue(Data, Offset, Attr.second, Value) || *Offset > End)
+      return false;
+    if (Attr.first == dwarf::DW_IDX_compile_unit && Value < Hdr.CompUnitCount)
+      E.CUOffset = getCUOffset(Value);
+    else if (Attr.first == dwarf::DW_IDX_die_offset)
+      E.DIEOffset = Value;
+  }
+  return true;
+}
+
+void DWARFDebugNames::NameIndex::dumpName(raw_ostream &OS,
+                                          uint32_t Index) const {
+  uint32_t StringOffset = getStringOffset(Index);
+  uint32_t StrOffset = StringOffset;
+  OS << format("  Name %u {", Index);
+  if (Hdr.BucketCount)
+    OS << format("Hash: 0x%08x ", getHash(Index));
+  OS << format("String: 0x%08x \"%s\"}\n", StringOffset,
+               Section.StringSection.getCStr(&StrOffset));
+
+  uint32_t EntryOffsetPos = EntryOffsetsBase + 4 * (Index - 1);
+  uint32_t Offset =
+      EntriesBase + Section.NamesSection.getU32(&EntryOffsetPos);
+  Entry E;
+  while (extractEntry(&Offset, E)) {
+    OS << "    Entry: ";
+    if (const char *TagString = dwarf::TagString(E.Tag))
+      OS << TagString;
+    else
+      OS << format("DW_TAG_Unknown_0x%x", E.Tag);
+    OS << format(" CU: 0x%08x DIE: 0x%08x\n", E.CUOffset, E.DIEOffset);
+  }
+}
+
+void DWARFDebugNames::NameIndex::dump(raw_ostream &OS) const {
+  OS << format("Name index @ 0x%08x\n", Base)
+     << "Version = " << Hdr.Version << '\n'
+     << "CU count = " << Hdr.CompUnitCount << '\n'
+     << "Local TU count = " << Hdr.LocalTypeUnitCount << '\n'
+     << "Foreign TU count = " << Hdr.ForeignTypeUnitCount << '\n'
+     << "Bucket count = " << Hdr.BucketCount << '\n'
+     << "Name count = " << Hdr.NameCount << '\n'
+     << "Abbreviations table size = " << Hdr.AbbrevTableSize << '\n';
+
+  for (uint32_t CU = 0; CU < Hdr.CompUnitCount; ++CU)
+    OS << format("CU[%u] = 0x%08x\n", CU, getCUOffset(CU));
+
+  for (const auto &A : Abbrevs) {
+    OS << format("Abbrev[0x%x] ", A.first);
+    if (const char *TagString = dwarf::TagString(A.second.Tag))
+      OS << TagString;
+    else
+      OS << format("DW_TAG_Unknown_0x%x", A.second.Tag);
+    for (const auto &Attr : A.second.Attributes) {
+      OS << ' ';
+      if (const char *IndexString = dwarf::IndexString(Attr.first))
+        OS << IndexString;
+      else
+        OS << format("DW_IDX_Unknown_0x%x", Attr.first);
+      OS << ':';
+      if (const char *FormString = dwarf::FormEncodingString(Attr.second))
+        OS << FormString;
+      else
+        OS << format("DW_FORM_Unknown_0x%x", Attr.second);
+    }
+    OS << '\n';
+  }
+
+  // Without a hash table, the names are just listed.
+  if (!Hdr.BucketCount) {
+    for (uint32_t Index = 1; Index <= Hdr.NameCount; ++Index)
+      dumpName(OS, Index);
+    return;
+  }
+
+  for (uint32_t Bucket = 0; Bucket < Hdr.BucketCount; ++Bucket) {
+    uint32_t BucketOffset = BucketsBase + 4 * Bucket;
+    uint32_t Index = Section.NamesSection.getU32(&BucketOffset);
+
+    OS << format("Bucket[%u]\n", Bucket);
+    if (!Index) {
+      OS << "  EMPTY\n";
+      continue;
+    }
+    for (; Index <= Hdr.NameCount; ++Index) {
+      if (getHash(Index) % Hdr.BucketCount != Bucket)
+        break;
+      dumpName(OS, Index);
+    }
+  }
+}
+
+void DWARFDebugNames::NameIndex::lookup(StringRef Name,
+                                        std::vector<Entry> &Result) const {
+  uint32_t Hash = dwarf::NameIndexHash(Name);
+  uint32_t Index = 1;
+  if (Hdr.BucketCount) {
+    uint32_t BucketOffset = BucketsBase + 4 * (Hash % Hdr.BucketCount);
+    Index = Section.NamesSection.getU32(&BucketOffset);
+    if (!Index)
+      return;
+  }
+
+  for (; Index <= Hdr.NameCount; ++Index) {
+    if (Hdr.BucketCount) {
+      uint32_t NameHash = getHash(Index);
+      if (NameHash % Hdr.BucketCount != Hash % Hdr.BucketCount)
+        break;
+      if (NameHash != Hash)
+        continue;
+    }
+    uint32_t StrOffset = getStringOffset(Index);
+    if (!Section.StringSection.isValidOffset(StrOffset) ||
+        Name != Section.StringSection.getCStr(&StrOffset))
+      continue;
+
+    uint32_t EntryOffsetPos = EntryOffsetsBase + 4 * (Index - 1);
+    uint32_t Offset =
+        EntriesBase + Section.NamesSection.getU32(&EntryOffsetPos);
+    Entry E;
+    while (extractEntry(&Offset, E))
+      Result.push_back(E);
+  }
+}
+
 }
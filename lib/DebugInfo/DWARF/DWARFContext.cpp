@@ -264,6 +264,12 @@ void DWARFContext::dump(raw_ostream &OS, DIDumpType DumpType) {
   if (DumpType == DIDT_All || DumpType == DIDT_AppleObjC)
     dumpAccelSection(OS, "apple_objc", getAppleObjCSection(),
                      getStringSection(), isLittleEndian());
+
+  if ((DumpType == DIDT_All || DumpType == DIDT_DebugNames) &&
+      !getDebugNamesSection().Data.empty()) {
+    OS << "\n.debug_names contents:\n";
+    getDebugNames().dump(OS);
+  }
 }
 
 const DWARFUnitIndex &DWARFContext::getCUIndex() {
@@ -288,6 +294,18 @@ const DWARFUnitIndex &DWARFContext::getTUIndex() {
   return *TUIndex;
 }
 
+const DWARFDebugNames &DWARFContext::getDebugNames() {
+  if (DebugNames)
+    return *DebugNames;
+
+  DataExtractor NamesData(getDebugNamesSection().Data, isLittleEndian(), 0);
+  DataExtractor StrData(getStringSection(), isLittleEndian(), 0);
+  DebugNames = llvm::make_unique<DWARFDebugNames>(
+      NamesData, StrData, getDebugNamesSection().Relocs);
+  DebugNames->extract();
+  return *DebugNames;
+}
+
 const DWARFDebugAbbrev *DWARFContext::getDebugAbbrev() {
   if (Abbrev)
     return Abbrev.get();
@@ -660,6 +678,7 @@ DWARFContextInMemory::DWARFContextInMemory(const object::ObjectFile &Obj,
             .Case("apple_namespaces", &AppleNamespacesSection.Data)
             .Case("apple_namespac", &AppleNamespacesSection.Data)
             .Case("apple_objc", &AppleObjCSection.Data)
+            .Case("debug_names", &DebugNamesSection.Data)
             .Case("debug_cu_index", &CUIndexSection)
             .Case("debug_tu_index", &TUIndexSection)
             // Any more debug info sections go here.
@@ -714,6 +733,7 @@ DWARFContextInMemory::DWARFContextInMemory(const object::ObjectFile &Obj,
         .Case("apple_namespaces", &AppleNamespacesSection.Relocs)
         .Case("apple_namespac", &AppleNamespacesSection.Relocs)
         .Case("apple_objc", &AppleObjCSection.Relocs)
+        .Case("debug_names", &DebugNamesSection.Relocs)
         .Default(nullptr);
     if (!Map) {
       // Find debug_types relocs by section rather than name as there are
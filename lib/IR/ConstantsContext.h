@@ -590,6 +590,10 @@ public:
   typename MapTy::iterator map_begin() { return Map.begin(); }
   typename MapTy::iterator map_end() { return Map.end(); }
 
+  /// Return the size in bytes of the uniquing table, not counting the
+  /// constants it points to.
+  size_t getMemorySize() const { return Map.getMemorySize(); }
+
   void freeConstants() {
     for (auto &I : Map)
       // Asserts that use_empty().
@@ -304,3 +304,7 @@ void LLVMContext::getOperandBundleTags(SmallVectorImpl<StringRef> &Tags) const {
 uint32_t LLVMContext::getOperandBundleTagID(StringRef Tag) const {
   return pImpl->getOperandBundleTagID(Tag);
 }
+
+void LLVMContext::getMemoryUsage(MemoryUsageReport &Report) const {
+  pImpl->getMemoryUsage(Report);
+}
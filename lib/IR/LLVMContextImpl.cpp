@@ -16,6 +16,7 @@
 #include "llvm/IR/Attributes.h"
 #include "llvm/IR/DiagnosticInfo.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Support/MemoryUsage.h"
 #include <algorithm>
 using namespace llvm;
 
@@ -236,6 +237,59 @@ uint32_t LLVMContextImpl::getOperandBundleTagID(StringRef Tag) const {
   return I->second;
 }
 
+void LLVMContextImpl::getMemoryUsage(MemoryUsageReport &Report) const {
+  // Constants.
+  Report.add("constants.int", IntConstants.getMemorySize());
+  Report.add("constants.fp", FPConstants.getMemorySize());
+  Report.add("constants.aggregate-zero", CAZConstants.getMemorySize());
+  Report.add("constants.array", ArrayConstants.getMemorySize());
+  Report.add("constants.struct", StructConstants.getMemorySize());
+  Report.add("constants.vector", VectorConstants.getMemorySize());
+  Report.add("constants.pointer-null", CPNConstants.getMemorySize());
+  Report.add("constants.undef", UVConstants.getMemorySize());
+  Report.add("constants.data-sequential", CDSConstants.getTotalMemorySize());
+  Report.add("constants.block-address", BlockAddresses.getMemorySize());
+  Report.add("constants.expr", ExprConstants.getMemorySize());
+  Report.add("constants.inline-asm", InlineAsms.getMemorySize());
+
+  // Types.
+  Report.addAllocator("types.allocator", TypeAllocator);
+  Report.add("types.integer", IntegerTypes.getMemorySize());
+  Report.add("types.function", FunctionTypes.getMemorySize());
+  Report.add("types.anon-struct", AnonStructTypes.getMemorySize());
+  Report.add("types.named-struct", NamedStructTypes.getTotalMemorySize());
+  Report.add("types.array", ArrayTypes.getMemorySize());
+  Report.add("types.vector", VectorTypes.getMemorySize());
+  Report.add("types.pointer",
+             PointerTypes.getMemorySize() + ASPointerTypes.getMemorySize());
+
+  // Attributes.
+  Report.add("attributes.attrs", AttrsSet.getMemorySize());
+  Report.add("attributes.lists", AttrsLists.getMemorySize());
+  Report.add("attributes.nodes", AttrsSetNodes.getMemorySize());
+
+  // Metadata.
+  Report.add("metadata.strings", MDStringCache.getTotalMemorySize());
+  Report.add("metadata.values-as-metadata", ValuesAsMetadata.getMemorySize());
+  Report.add("metadata.metadata-as-values", MetadataAsValues.getMemorySize());
+#define HANDLE_MDNODE_LEAF_UNIQUABLE(CLASS)                                    \
+  Report.add("metadata." #CLASS, CLASS##s.getMemorySize());
+#include "llvm/IR/Metadata.def"
+  Report.add("metadata.distinct-nodes",
+             DistinctMDNodes.size() * sizeof(MDNode *));
+  Report.add("metadata.instruction-attachments",
+             InstructionMetadata.getMemorySize());
+  Report.add("metadata.function-attachments",
+             FunctionMetadata.getMemorySize());
+  Report.add("metadata.kind-names", CustomMDKindNames.getTotalMemorySize());
+
+  // Everything else.
+  Report.add("value-names", ValueNames.getMemorySize());
+  Report.add("value-handles", ValueHandles.getMemorySize());
+  Report.add("discriminators", DiscriminatorTable.getMemorySize());
+  Report.add("bundle-tags", BundleTagCache.getTotalMemorySize());
+}
+
 // ConstantsContext anchors
 void UnaryConstantExpr::anchor() { }
 
@@ -43,6 +43,7 @@ class DiagnosticInfoOptimizationRemarkMissed;
 class DiagnosticInfoOptimizationRemarkAnalysis;
 class GCStrategy;
 class LLVMContext;
+class MemoryUsageReport;
 class Type;
 class Value;
 
@@ -1032,6 +1033,9 @@ public:
 
   /// Destroy the ConstantArrays if they are not used.
   void dropTriviallyDeadConstantArrays();
+
+  /// Append the size of each uniquing table and allocator to \p Report.
+  void getMemoryUsage(MemoryUsageReport &Report) const;
 };
 
 }
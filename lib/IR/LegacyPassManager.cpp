@@ -22,6 +22,7 @@
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MemoryUsage.h"
 #include "llvm/Support/Mutex.h"
 #include "llvm/Support/TimeValue.h"
 #include "llvm/Support/Timer.h"
@@ -109,6 +110,24 @@ static bool ShouldPrintAfterPass(const PassInfo *PI) {
   return PrintAfterAll || ShouldPrintBeforeOrAfterPass(PI, PrintAfter);
 }
 
+bool llvm::PrintMemoryUsageIsEnabled = false;
+static cl::opt<bool, true>
+PrintMemoryUsage("print-memory-usage", cl::location(PrintMemoryUsageIsEnabled),
+                 cl::desc("Print the memory held by the LLVMContext and the "
+                          "module after each pass"),
+                 cl::Hidden);
+
+/// Print the memory held by M and its context after pass P ran on the unit
+/// called Name.
+static void printMemoryUsageAfterPass(Pass *P, const Module &M,
+                                      StringRef Name) {
+  MemoryUsageReport Report;
+  M.getContext().getMemoryUsage(Report);
+  M.getMemoryUsage(Report);
+  Report.print(errs(), (Twine("Memory usage after '") + P->getPassName() + "' on '" +
+                        Name + "'").str());
+}
+
 /// isPassDebuggingExecutionsOrMore - Return true if -debug-pass=Executions
 /// or higher is specified.
 bool PMDataManager::isPassDebuggingExecutionsOrMore() const {
@@ -1540,6 +1559,8 @@ bool FPPassManager::runOnFunction(Function &F) {
     Changed |= LocalChanged;
     if (LocalChanged)
       dumpPassInfo(FP, MODIFICATION_MSG, ON_FUNCTION_MSG, F.getName());
+    if (PrintMemoryUsageIsEnabled)
+      printMemoryUsageAfterPass(FP, *F.getParent(), F.getName());
     dumpPreservedSet(FP);
     dumpUsedSet(FP);
 
@@ -1618,6 +1639,8 @@ MPPassManager::runOnModule(Module &M) {
     if (LocalChanged)
       dumpPassInfo(MP, MODIFICATION_MSG, ON_MODULE_MSG,
                    M.getModuleIdentifier());
+    if (PrintMemoryUsageIsEnabled)
+      printMemoryUsageAfterPass(MP, M, M.getModuleIdentifier());
     dumpPreservedSet(MP);
     dumpUsedSet(MP);
 
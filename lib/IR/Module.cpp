@@ -24,6 +24,7 @@
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/TypeFinder.h"
 #include "llvm/Support/Dwarf.h"
+#include "llvm/Support/MemoryUsage.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/RandomNumberGenerator.h"
 #include <algorithm>
@@ -440,6 +441,44 @@ void Module::dropAllReferences() {
     GA.dropAllReferences();
 }
 
+void Module::getMemoryUsage(MemoryUsageReport &Report) const {
+  size_t GlobalBytes = 0;
+  for (const GlobalVariable &GV : globals())
+    GlobalBytes += sizeof(GlobalVariable) + GV.getNumOperands() * sizeof(Use);
+  GlobalBytes += alias_size() * (sizeof(GlobalAlias) + sizeof(Use));
+
+  size_t FunctionBytes = 0, BlockBytes = 0, InstBytes = 0, ArgBytes = 0;
+  for (const Function &F : *this) {
+    FunctionBytes += sizeof(Function) + F.getNumOperands() * sizeof(Use);
+    if (F.isDeclaration())
+      continue;
+    ArgBytes += F.arg_size() * sizeof(Argument);
+    for (const BasicBlock &BB : F) {
+      BlockBytes += sizeof(BasicBlock);
+      // Instruction subclasses only add a few fields to Instruction, so the
+      // base size plus the operand list is a close estimate.
+      for (const Instruction &I : BB)
+        InstBytes += sizeof(Instruction) + I.getNumOperands() * sizeof(Use);
+    }
+  }
+
+  Report.add("module.globals", GlobalBytes);
+  Report.add("module.functions", FunctionBytes);
+  Report.add("module.arguments", ArgBytes);
+  Report.add("module.basic-blocks", BlockBytes);
+  Report.add("module.instructions", InstBytes);
+
+  size_t SymTabBytes = ValSymTab->size() * sizeof(ValueName);
+  for (const auto &Entry : *ValSymTab)
+    SymTabBytes += Entry.getKeyLength() + 1;
+  Report.add("module.value-symbol-table", SymTabBytes);
+  Report.add("module.comdats", ComdatSymTab.getTotalMemorySize());
+  Report.add("module.named-metadata",
+             static_cast<StringMap<NamedMDNode *> *>(NamedMDSymTab)
+                     ->getTotalMemorySize() +
+                 named_metadata_size() * sizeof(NamedMDNode));
+}
+
 unsigned Module::getDwarfVersion() const {
   auto *Val = cast_or_null<ConstantAsMetadata>(getModuleFlag("Dwarf Version"));
   if (!Val)
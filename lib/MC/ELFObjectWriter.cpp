@@ -34,6 +34,7 @@
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/StringSaver.h"
+#include "llvm/Support/ThreadPool.h"
 #include <vector>
 using namespace llvm;
 
@@ -98,6 +99,11 @@ class ELFObjectWriter : public MCObjectWriter {
     /// The target specific ELF writer instance.
     std::unique_ptr<MCELFObjectTargetWriter> TargetObjectWriter;
 
+    /// The threads that deflate large debug sections. They are started for
+    /// the first section that is split into several chunks and shared by all
+    /// the others.
+    std::unique_ptr<ThreadPool> CompressionPool;
+
     DenseMap<const MCSymbolELF *, const MCSymbolELF *> Renames;
 
     llvm::DenseMap<const MCSectionELF *, std::vector<ELFRelocationEntry>>
@@ -1011,9 +1017,20 @@ void ELFObjectWriter::writeSectionData(const MCAssembler &Asm, MCSection &Sec,
   setStream(OldStream);
 
   SmallVector<char, 128> CompressedContents;
-  zlib::Status Success = zlib::compress(
-      StringRef(UncompressedData.data(), UncompressedData.size()),
-      CompressedContents);
+  // Large debug sections are deflated in chunks on all available cores; the
+  // output does not depend on the thread count.
+  const size_t ChunkSize = 1024 * 1024;
+  StringRef Uncompressed(UncompressedData.data(), UncompressedData.size());
+  zlib::Status Success;
+  if (Uncompressed.size() > ChunkSize) {
+    if (!CompressionPool)
+      CompressionPool = llvm::make_unique<ThreadPool>();
+    Success = zlib::compressParallel(Uncompressed, CompressedContents,
+                                     *CompressionPool,
+                                     zlib::DefaultCompression, ChunkSize);
+  } else {
+    Success = zlib::compress(Uncompressed, CompressedContents);
+  }
   if (Success != zlib::StatusOK) {
     getStream() << UncompressedData;
     return;
@@ -1090,6 +1107,9 @@ void ELFObjectWriter::writeRelocations(const MCAssembler &Asm,
         write(uint32_t(Entry.Addend));
     }
   }
+
+  // The relocations are not needed anymore.
+  std::vector<ELFRelocationEntry>().swap(Relocs);
 }
 
 const MCSectionELF *ELFObjectWriter::createStringTable(MCContext &Ctx) {
@@ -1207,6 +1227,8 @@ void ELFObjectWriter::writeObject(MCAssembler &Asm,
 
     const MCSymbolELF *SignatureSymbol = Section.getGroup();
     writeSectionData(Asm, Section, Layout);
+    // The size of the section is taken from its offsets from now on.
+    Asm.releaseSectionData(&Section);
 
     uint64_t SecEnd = getStream().tell();
     SectionOffsets[&Section] = std::make_pair(SecStart, SecEnd);
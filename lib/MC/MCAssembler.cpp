@@ -54,6 +54,8 @@ STATISTIC(FragmentLayouts, "Number of fragment layouts");
 STATISTIC(ObjectBytes, "Number of emitted object file bytes");
 STATISTIC(RelaxationSteps, "Number of assembler layout and relaxation steps");
 STATISTIC(RelaxedInstructions, "Number of relaxed instructions");
+STATISTIC(ReleasedFragmentBytes,
+          "Number of fragment bytes freed once written out");
 }
 }
 
@@ -598,6 +600,25 @@ void MCAssembler::writeSectionData(const MCSection *Sec,
          Layout.getSectionAddressSize(Sec));
 }
 
+void MCAssembler::releaseSectionData(MCSection *Sec) {
+  // Virtual sections keep their (zero) contents, which still give their size.
+  if (Sec->isVirtualSection())
+    return;
+
+  // Moving the contents and fixups out into temporaries frees their buffers.
+  for (MCFragment &F : *Sec) {
+    if (auto *DF = dyn_cast<MCDataFragment>(&F)) {
+      SmallVector<char, 0> Contents(std::move(DF->getContents()));
+      SmallVector<MCFixup, 0> Fixups(std::move(DF->getFixups()));
+      stats::ReleasedFragmentBytes += Contents.size();
+    } else if (auto *RF = dyn_cast<MCRelaxableFragment>(&F)) {
+      SmallVector<char, 0> Contents(std::move(RF->getContents()));
+      SmallVector<MCFixup, 0> Fixups(std::move(RF->getFixups()));
+      stats::ReleasedFragmentBytes += Contents.size();
+    }
+  }
+}
+
 std::pair<uint64_t, bool> MCAssembler::handleFixup(const MCAsmLayout &Layout,
                                                    MCFragment &F,
                                                    const MCFixup &Fixup) {
@@ -813,14 +834,22 @@ bool MCAssembler::relaxDwarfCallFrameFragment(MCAsmLayout &Layout,
 }
 
 bool MCAssembler::layoutSectionOnce(MCAsmLayout &Layout, MCSection &Sec) {
-  // Holds the first fragment which needed relaxing during this layout. It will
-  // remain NULL if none were relaxed.
-  // When a fragment is relaxed, all the fragments following it should get
-  // invalidated because their offset is going to change.
-  MCFragment *FirstRelaxedFragment = nullptr;
+  // Lay out the whole section, then attempt to relax its fragments in order.
+  // Once a fragment has been relaxed, the fragments after it are not
+  // invalidated, which would make every later query lay them out again;
+  // instead each one's offset is recomputed from its predecessor when the walk
+  // reaches it. References to earlier fragments thus see the new offsets
+  // immediately, while references to later fragments see the offsets from the
+  // previous walk, which keeps a walk linear in the size of the section. The
+  // section is done after a walk that relaxes nothing, in which every offset
+  // was exact.
+  Layout.getFragmentOffset(&*Sec.rbegin());
 
-  // Attempt to relax all the fragments in the section.
+  bool WasRelaxed = false;
   for (MCSection::iterator I = Sec.begin(), IE = Sec.end(); I != IE; ++I) {
+    if (WasRelaxed)
+      Layout.relayoutFragment(&*I);
+
     // Check if this is a fragment that needs relaxation.
     bool RelaxedFrag = false;
     switch(I->getKind()) {
@@ -844,14 +873,13 @@ bool MCAssembler::layoutSectionOnce(MCAsmLayout &Layout, MCSection &Sec) {
       RelaxedFrag = relaxLEB(Layout, *cast<MCLEBFragment>(I));
       break;
     }
-    if (RelaxedFrag && !FirstRelaxedFragment)
-      FirstRelaxedFragment = &*I;
-  }
-  if (FirstRelaxedFragment) {
-    Layout.invalidateFragmentsFrom(FirstRelaxedFragment);
-    return true;
+    if (RelaxedFrag) {
+      // The bundle padding of the fragment depends on its new size.
+      Layout.relayoutFragment(&*I);
+      WasRelaxed = true;
+    }
   }
-  return false;
+  return WasRelaxed;
 }
 
 bool MCAssembler::layoutOnce(MCAsmLayout &Layout) {
@@ -59,6 +59,15 @@ void MCAsmLayout::invalidateFragmentsFrom(MCFragment *F) {
   LastValidFragment[F->getParent()] = F->getPrevNode();
 }
 
+void MCAsmLayout::relayoutFragment(MCFragment *F) {
+  assert(isFragmentValid(F) && "Attempt to relayout an invalid fragment!");
+  MCSection *Sec = F->getParent();
+  MCFragment *LastValid = LastValidFragment[Sec];
+  LastValidFragment[Sec] = F->getPrevNode();
+  layoutFragment(F);
+  LastValidFragment[Sec] = LastValid;
+}
+
 void MCAsmLayout::ensureValid(const MCFragment *F) const {
   MCSection *Sec = F->getParent();
   MCSection::iterator I;
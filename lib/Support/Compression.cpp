@@ -17,6 +17,10 @@
 #include "llvm/Config/config.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/ThreadPool.h"
+#include <algorithm>
+#include <thread>
+#include <vector>
 #if LLVM_ENABLE_ZLIB == 1 && HAVE_ZLIB_H
 #include <zlib.h>
 #endif
@@ -62,6 +66,154 @@ zlib::Status zlib::compress(StringRef InputBuffer,
   return Res;
 }
 
+namespace {
+/// The deflated form of one chunk of a parallel compression.
+struct CompressedChunk {
+  SmallVector<char, 0> Data;
+  uLong Adler;
+  int Result;
+};
+}
+
+/// Deflate \p Input to a raw deflate stream (no zlib header or trailer).
+/// Unless \p Last is set, the stream ends with a sync flush so that the next
+/// chunk can be appended at a byte boundary.  \p Dictionary is the input that
+/// precedes this chunk and seeds the compressor's window.
+static void deflateChunk(StringRef Input, StringRef Dictionary, int CLevel,
+                         bool Last, CompressedChunk &Out) {
+  Out.Adler = ::adler32(::adler32(0L, Z_NULL, 0), (const Bytef *)Input.data(),
+                        Input.size());
+
+  z_stream Stream;
+  Stream.zalloc = Z_NULL;
+  Stream.zfree = Z_NULL;
+  Stream.opaque = Z_NULL;
+  // Negative window bits select a raw deflate stream.
+  Out.Result = ::deflateInit2(&Stream, CLevel, Z_DEFLATED, -15, 8,
+                              Z_DEFAULT_STRATEGY);
+  if (Out.Result != Z_OK)
+    return;
+
+  if (!Dictionary.empty())
+    ::deflateSetDictionary(&Stream, (const Bytef *)Dictionary.data(),
+                           Dictionary.size());
+
+  // A sync flush appends at most a few bytes over deflateBound.
+  Out.Data.resize(::deflateBound(&Stream, Input.size()) + 16);
+  Stream.next_in = (Bytef *)Input.data();
+  Stream.avail_in = Input.size();
+  Stream.next_out = (Bytef *)Out.Data.data();
+  Stream.avail_out = Out.Data.size();
+  int Res = ::deflate(&Stream, Last ? Z_FINISH : Z_SYNC_FLUSH);
+  if (Res == Z_STREAM_END || (!Last && Res == Z_OK && Stream.avail_in == 0))
+    Out.Result = Z_OK;
+  else
+    Out.Result = Res == Z_OK ? Z_BUF_ERROR : Res;
+  __msan_unpoison(Out.Data.data(), Stream.total_out);
+  Out.Data.resize(Stream.total_out);
+  ::deflateEnd(&Stream);
+}
+
+/// Implements both forms of compressParallel().  The chunks are deflated on
+/// \p Pool if it is given, and otherwise on a pool of at most \p NumThreads
+/// threads created for this call.
+static zlib::Status compressChunks(StringRef InputBuffer,
+                                   SmallVectorImpl<char> &CompressedBuffer,
+                                   zlib::CompressionLevel Level,
+                                   ThreadPool *Pool, unsigned NumThreads,
+                                   size_t ChunkSize) {
+  if (ChunkSize == 0)
+    return zlib::StatusInvalidArg;
+  if (InputBuffer.size() <= ChunkSize)
+    return zlib::compress(InputBuffer, CompressedBuffer, Level);
+
+  const size_t DictSize = 32 * 1024;
+  int CLevel = encodeZlibCompressionLevel(Level);
+  size_t NumChunks = (InputBuffer.size() + ChunkSize - 1) / ChunkSize;
+  std::vector<CompressedChunk> Chunks(NumChunks);
+  auto CompressChunk = [&](size_t I) {
+    size_t Begin = I * ChunkSize;
+    StringRef Dictionary =
+        InputBuffer.slice(Begin - std::min(Begin, DictSize), Begin);
+    deflateChunk(InputBuffer.substr(Begin, ChunkSize), Dictionary, CLevel,
+                 I + 1 == NumChunks, Chunks[I]);
+  };
+
+  if (Pool) {
+    // The pool may be running other work, so only wait for our own chunks.
+    std::vector<std::shared_future<ThreadPool::VoidTy>> Futures;
+    Futures.reserve(NumChunks);
+    for (size_t I = 0; I != NumChunks; ++I)
+      Futures.push_back(Pool->async(CompressChunk, I));
+    for (auto &F : Futures)
+      F.wait();
+  } else {
+    if (NumThreads == 0)
+      NumThreads = std::max(1U, std::thread::hardware_concurrency());
+    NumThreads = std::min<size_t>(NumThreads, NumChunks);
+    if (NumThreads == 1) {
+      for (size_t I = 0; I != NumChunks; ++I)
+        CompressChunk(I);
+    } else {
+      ThreadPool LocalPool(NumThreads);
+      for (size_t I = 0; I != NumChunks; ++I)
+        LocalPool.async(CompressChunk, I);
+      LocalPool.wait();
+    }
+  }
+
+  // Stitch the chunks together behind a zlib header, and append the Adler-32
+  // of the whole input, combined from the per-chunk checksums.
+  size_t TotalSize = 2 + 4;
+  for (const CompressedChunk &C : Chunks) {
+    if (C.Result != Z_OK)
+      return encodeZlibReturnValue(C.Result);
+    TotalSize += C.Data.size();
+  }
+  CompressedBuffer.clear();
+  CompressedBuffer.reserve(TotalSize);
+
+  // CMF: deflate with a 32K window.  FLG: the FLEVEL hint zlib itself would
+  // write for this level, and a check value making the header a multiple
+  // of 31.
+  int EffectiveLevel = CLevel == Z_DEFAULT_COMPRESSION ? 6 : CLevel;
+  unsigned FLevel = EffectiveLevel < 2 ? 0
+                    : EffectiveLevel < 6 ? 1
+                    : EffectiveLevel == 6 ? 2 : 3;
+  unsigned Header = (0x78 << 8) | (FLevel << 6);
+  if (Header % 31)
+    Header += 31 - Header % 31;
+  CompressedBuffer.push_back(char(Header >> 8));
+  CompressedBuffer.push_back(char(Header & 0xff));
+
+  uLong Adler = ::adler32(0L, Z_NULL, 0);
+  for (size_t I = 0; I != NumChunks; ++I) {
+    const CompressedChunk &C = Chunks[I];
+    CompressedBuffer.append(C.Data.begin(), C.Data.end());
+    size_t Len = std::min(ChunkSize, InputBuffer.size() - I * ChunkSize);
+    Adler = ::adler32_combine(Adler, C.Adler, Len);
+  }
+  for (int Shift = 24; Shift >= 0; Shift -= 8)
+    CompressedBuffer.push_back(char((Adler >> Shift) & 0xff));
+  return zlib::StatusOK;
+}
+
+zlib::Status zlib::compressParallel(StringRef InputBuffer,
+                                    SmallVectorImpl<char> &CompressedBuffer,
+                                    CompressionLevel Level,
+                                    unsigned NumThreads, size_t ChunkSize) {
+  return compressChunks(InputBuffer, CompressedBuffer, Level, nullptr,
+                        NumThreads, ChunkSize);
+}
+
+zlib::Status zlib::compressParallel(StringRef InputBuffer,
+                                    SmallVectorImpl<char> &CompressedBuffer,
+                                    ThreadPool &Pool, CompressionLevel Level,
+                                    size_t ChunkSize) {
+  return compressChunks(InputBuffer, CompressedBuffer, Level, &Pool, 0,
+                        ChunkSize);
+}
+
 zlib::Status zlib::uncompress(StringRef InputBuffer,
                               SmallVectorImpl<char> &UncompressedBuffer,
                               size_t UncompressedSize) {
@@ -87,6 +239,18 @@ zlib::Status zlib::compress(StringRef InputBuffer,
                             CompressionLevel Level) {
   return zlib::StatusUnsupported;
 }
+zlib::Status zlib::compressParallel(StringRef InputBuffer,
+                                    SmallVectorImpl<char> &CompressedBuffer,
+                                    CompressionLevel Level,
+                                    unsigned NumThreads, size_t ChunkSize) {
+  return zlib::StatusUnsupported;
+}
+zlib::Status zlib::compressParallel(StringRef InputBuffer,
+                                    SmallVectorImpl<char> &CompressedBuffer,
+                                    ThreadPool &Pool, CompressionLevel Level,
+                                    size_t ChunkSize) {
+  return zlib::StatusUnsupported;
+}
 zlib::Status zlib::uncompress(StringRef InputBuffer,
                               SmallVectorImpl<char> &UncompressedBuffer,
                               size_t UncompressedSize) {
@@ -566,6 +566,22 @@ const char *llvm::dwarf::AtomTypeString(unsigned AT) {
   return nullptr;
 }
 
+const char *llvm::dwarf::IndexString(unsigned Idx) {
+  switch (Idx) {
+  case DW_IDX_compile_unit:
+    return "DW_IDX_compile_unit";
+  case DW_IDX_type_unit:
+    return "DW_IDX_type_unit";
+  case DW_IDX_die_offset:
+    return "DW_IDX_die_offset";
+  case DW_IDX_parent:
+    return "DW_IDX_parent";
+  case DW_IDX_type_hash:
+    return "DW_IDX_type_hash";
+  }
+  return nullptr;
+}
+
 const char *llvm::dwarf::GDBIndexEntryKindString(GDBIndexEntryKind Kind) {
   switch (Kind) {
   case GIEK_NONE:
@@ -628,3 +644,13 @@ const char *llvm::dwarf::AttributeValueString(uint16_t Attr, unsigned Val) {
 
   return nullptr;
 }
+
+uint32_t llvm::dwarf::NameIndexHash(StringRef Name) {
+  uint32_t H = 5381;
+  for (char C : Name) {
+    if (C >= 'A' && C <= 'Z')
+      C += 'a' - 'A';
+    H = ((H << 5) + H) + static_cast<unsigned char>(C);
+  }
+  return H;
+}
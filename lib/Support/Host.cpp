@@ -502,6 +502,13 @@ StringRef sys::getHostCPUName() {
         if (!HasAVX) // If the OS doesn't support AVX provide a sane fallback.
           return "btver1";
         return "btver2";
+      case 23:
+        // If the OS doesn't support AVX, fall back to the newest CPU whose
+        // features are all in Zen's SSE4.2 subset. No AMD CPU qualifies:
+        // btver1 lacks SSE4.1 and SSE4.2, and the later ones all have AVX.
+        if (!HasAVX)
+          return "westmere";
+        return "znver1";
     default:
       return "generic";
     }
@@ -0,0 +1,60 @@
+//===-- MemoryUsage.cpp - Memory accounting reports -----------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/MemoryUsage.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+
+using namespace llvm;
+
+void MemoryUsageReport::append(StringRef Prefix,
+                               const MemoryUsageReport &Other) {
+  for (const Entry &E : Other)
+    add(Prefix + E.first, E.second);
+}
+
+size_t MemoryUsageReport::getBytes(StringRef Name) const {
+  for (const Entry &E : Entries)
+    if (E.first == Name)
+      return E.second;
+  return 0;
+}
+
+size_t MemoryUsageReport::getTotalBytes() const {
+  size_t Total = 0;
+  for (const Entry &E : Entries)
+    Total += E.second;
+  return Total;
+}
+
+void MemoryUsageReport::print(raw_ostream &OS, StringRef Title) const {
+  std::vector<const Entry *> Sorted;
+  Sorted.reserve(Entries.size());
+  for (const Entry &E : Entries)
+    Sorted.push_back(&E);
+  std::stable_sort(Sorted.begin(), Sorted.end(),
+                   [](const Entry *LHS, const Entry *RHS) {
+                     return LHS->second > RHS->second;
+                   });
+
+  size_t Total = getTotalBytes();
+  OS << "===" << std::string(73, '-') << "===\n";
+  OS << "  " << Title << '\n';
+  OS << "===" << std::string(73, '-') << "===\n";
+  OS << format("  Total: %zu bytes\n\n", Total);
+  for (const Entry *E : Sorted) {
+    if (!E->second)
+      continue;
+    OS << format("  %12zu  (%5.1f%%)  ", E->second,
+                 Total ? E->second * 100.0 / Total : 0.0)
+       << E->first << '\n';
+  }
+  OS << '\n';
+}
@@ -12,10 +12,12 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Support/Regex.h"
+#include "RegexDFA.h"
 #include "regex_impl.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Twine.h"
+#include <mutex>
 #include <string>
 using namespace llvm;
 
@@ -30,6 +32,13 @@ Regex::Regex(StringRef regex, unsigned Flags) {
   if (!(Flags & BasicRegex))
     flags |= REG_EXTENDED;
   error = llvm_regcomp(preg, regex.data(), flags|REG_PEND);
+
+  // The DFA only understands extended regexes. It is only built for patterns
+  // the BSD engine accepted, so it never has to diagnose errors itself.
+  dfa = nullptr;
+  if (!error && !(Flags & BasicRegex))
+    dfa = RegexDFA::compile(regex, Flags & IgnoreCase, Flags & Newline)
+              .release();
 }
 
 Regex::~Regex() {
@@ -37,6 +46,7 @@ Regex::~Regex() {
     llvm_regfree(preg);
     delete preg;
   }
+  delete dfa;
 }
 
 bool Regex::isValid(std::string &Error) {
@@ -65,6 +75,24 @@ bool Regex::match(StringRef String, SmallVectorImpl<StringRef> *Matches){
   pm[0].rm_so = 0;
   pm[0].rm_eo = String.size();
 
+  // Let the DFA answer whether there is a match at all, and narrow down the
+  // part of the string the BSD engine has to search to find the positions.
+  // The DFA builds its states as it goes, so only one thread can search with
+  // it at a time; the others do not wait for it and use the BSD engine alone,
+  // which never modifies preg.
+  if (dfa) {
+    std::unique_lock<std::mutex> Lock(dfa->getMutex(), std::try_to_lock);
+    if (Lock.owns_lock()) {
+      size_t Begin, End;
+      if (!dfa->find(String, Begin, End))
+        return false;
+      if (!Matches)
+        return true;
+      pm[0].rm_so = Begin;
+      pm[0].rm_eo = End;
+    }
+  }
+
   int rc = llvm_regexec(preg, String.data(), nmatch, pm.data(), REG_STARTEND);
 
   if (rc == REG_NOMATCH)
@@ -0,0 +1,747 @@
+//===-- RegexDFA.cpp - Lazily built DFA for extended regexes --------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements RegexDFA. The parser follows the grammar and quirks of
+// the BSD engine in regcomp.c, so that for every pattern it accepts the two
+// engines agree on whether, and where, a string matches.
+//
+//===----------------------------------------------------------------------===//
+
+#include "RegexDFA.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/ErrorHandling.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <map>
+
+using namespace llvm;
+
+/// Upper bound on the number of NFA nodes a pattern may compile to. Larger
+/// patterns (typically deeply nested bounded repetitions) are left to the BSD
+/// engine.
+static const unsigned MaxNFANodes = 100000;
+
+/// Upper bound on the total number of NFA nodes held by cached DFA states.
+/// When a search would exceed it the cache is thrown away and rebuilt.
+static const size_t MaxCachedNodes = 1 << 20;
+
+/// The largest count allowed in a bound, RE_DUP_MAX in the BSD engine.
+static const int MaxRepeat = 255;
+
+namespace {
+struct RegexAST {
+  enum KindTy { Set, Cat, Alt, Repeat, Bol, Eol, Empty } Kind;
+  unsigned SetIdx = 0;
+  int Min = 0, Max = 0; // Max is -1 for an unbounded repetition.
+  std::vector<std::unique_ptr<RegexAST>> Kids;
+
+  explicit RegexAST(KindTy K) : Kind(K) {}
+};
+} // end anonymous namespace
+
+namespace llvm {
+class RegexDFAParser {
+  RegexDFA &DFA;
+  StringRef P;
+  size_t Pos = 0;
+  bool IgnoreCase;
+  bool Newline;
+  bool Failed = false;
+
+  bool more() const { return Pos < P.size(); }
+  bool more2() const { return Pos + 1 < P.size(); }
+  unsigned char peek() const { return P[Pos]; }
+  unsigned char peek2() const { return P[Pos + 1]; }
+  unsigned char next() { return P[Pos++]; }
+  bool see(char C) const { return more() && P[Pos] == C; }
+  bool seeTwo(char C1, char C2) const {
+    return more2() && P[Pos] == C1 && P[Pos + 1] == C2;
+  }
+
+  std::unique_ptr<RegexAST> fail() {
+    Failed = true;
+    return nullptr;
+  }
+
+  unsigned addSet(const std::bitset<256> &Set);
+  std::unique_ptr<RegexAST> makeChar(unsigned char C);
+  std::unique_ptr<RegexAST> parseAlt();
+  std::unique_ptr<RegexAST> parseBranch();
+  std::unique_ptr<RegexAST> parseExp();
+  bool parseBracket(std::bitset<256> &Set);
+  bool parseClassName(std::bitset<256> &Set);
+  bool parseBound(int &Min, int &Max);
+
+  unsigned addNode(RegexDFA::NFANode::KindTy Kind, unsigned Out,
+                   unsigned Out1 = 0, unsigned Set = 0);
+  unsigned compile(const RegexAST &N, unsigned Next);
+
+public:
+  RegexDFAParser(RegexDFA &DFA, StringRef P, bool IgnoreCase, bool Newline)
+      : DFA(DFA), P(P), IgnoreCase(IgnoreCase), Newline(Newline) {}
+
+  bool run();
+};
+} // end namespace llvm
+
+static unsigned char otherCase(unsigned char C) {
+  if (isupper(C))
+    return tolower(C);
+  if (islower(C))
+    return toupper(C);
+  return C;
+}
+
+unsigned RegexDFAParser::addSet(const std::bitset<256> &Set) {
+  for (unsigned I = 0, E = DFA.Sets.size(); I != E; ++I)
+    if (DFA.Sets[I] == Set)
+      return I;
+  DFA.Sets.push_back(Set);
+  return DFA.Sets.size() - 1;
+}
+
+std::unique_ptr<RegexAST> RegexDFAParser::makeChar(unsigned char C) {
+  std::bitset<256> Set;
+  Set.set(C);
+  if (IgnoreCase && isalpha(C))
+    Set.set(otherCase(C));
+  auto N = make_unique<RegexAST>(RegexAST::Set);
+  N->SetIdx = addSet(Set);
+  return N;
+}
+
+std::unique_ptr<RegexAST> RegexDFAParser::parseAlt() {
+  auto Branch = parseBranch();
+  if (!Branch || !see('|'))
+    return Branch;
+  auto N = make_unique<RegexAST>(RegexAST::Alt);
+  N->Kids.push_back(std::move(Branch));
+  while (see('|')) {
+    next();
+    Branch = parseBranch();
+    if (!Branch)
+      return nullptr;
+    N->Kids.push_back(std::move(Branch));
+  }
+  return N;
+}
+
+std::unique_ptr<RegexAST> RegexDFAParser::parseBranch() {
+  // Empty branches are an error in the BSD engine.
+  if (!more() || see('|') || see(')'))
+    return fail();
+  auto N = make_unique<RegexAST>(RegexAST::Cat);
+  while (more() && !see('|') && !see(')')) {
+    auto Exp = parseExp();
+    if (!Exp)
+      return nullptr;
+    N->Kids.push_back(std::move(Exp));
+  }
+  if (N->Kids.size() == 1)
+    return std::move(N->Kids[0]);
+  return N;
+}
+
+std::unique_ptr<RegexAST> RegexDFAParser::parseExp() {
+  std::unique_ptr<RegexAST> N;
+  unsigned char C = next();
+  switch (C) {
+  case '(':
+    if (!more())
+      return fail();
+    if (see(')')) {
+      N = make_unique<RegexAST>(RegexAST::Empty);
+    } else {
+      N = parseAlt();
+      if (!N)
+        return nullptr;
+    }
+    if (!see(')'))
+      return fail();
+    next();
+    break;
+  case ')':
+  case '|':
+  case '*':
+  case '+':
+  case '?':
+    return fail();
+  case '^':
+    N = make_unique<RegexAST>(RegexAST::Bol);
+    DFA.HasBol = true;
+    break;
+  case '$':
+    N = make_unique<RegexAST>(RegexAST::Eol);
+    break;
+  case '.': {
+    std::bitset<256> Set;
+    Set.set();
+    if (Newline)
+      Set.reset('\n');
+    N = make_unique<RegexAST>(RegexAST::Set);
+    N->SetIdx = addSet(Set);
+    break;
+  }
+  case '[': {
+    std::bitset<256> Set;
+    if (!parseBracket(Set))
+      return fail();
+    N = make_unique<RegexAST>(RegexAST::Set);
+    N->SetIdx = addSet(Set);
+    break;
+  }
+  case '\\':
+    if (!more())
+      return fail();
+    C = next();
+    // Back-references need the BSD engine.
+    if (C >= '1' && C <= '9')
+      return fail();
+    N = makeChar(C);
+    break;
+  case '{':
+    if (more() && isdigit(peek()))
+      return fail();
+    N = makeChar(C);
+    break;
+  default:
+    N = makeChar(C);
+    break;
+  }
+
+  if (!more())
+    return N;
+  C = peek();
+  if (!(C == '*' || C == '+' || C == '?' ||
+        (C == '{' && more2() && isdigit(peek2()))))
+    return N;
+  next();
+  if (N->Kind == RegexAST::Bol)
+    return fail();
+
+  int Min, Max;
+  switch (C) {
+  case '*': Min = 0; Max = -1; break;
+  case '+': Min = 1; Max = -1; break;
+  case '?': Min = 0; Max = 1; break;
+  default:
+    if (!parseBound(Min, Max))
+      return fail();
+    break;
+  }
+  auto R = make_unique<RegexAST>(RegexAST::Repeat);
+  R->Min = Min;
+  R->Max = Max;
+  R->Kids.push_back(std::move(N));
+
+  // A repetition of a repetition is an error in the BSD engine.
+  if (more()) {
+    C = peek();
+    if (C == '*' || C == '+' || C == '?' ||
+        (C == '{' && more2() && isdigit(peek2())))
+      return fail();
+  }
+  return R;
+}
+
+bool RegexDFAParser::parseBound(int &Min, int &Max) {
+  auto ParseCount = [&](int &Count) {
+    Count = 0;
+    if (!more() || !isdigit(peek()))
+      return false;
+    while (more() && isdigit(peek())) {
+      Count = Count * 10 + (next() - '0');
+      if (Count > MaxRepeat)
+        return false;
+    }
+    return true;
+  };
+  if (!ParseCount(Min))
+    return false;
+  Max = Min;
+  if (see(',')) {
+    next();
+    if (more() && isdigit(peek())) {
+      if (!ParseCount(Max) || Max < Min)
+        return false;
+    } else {
+      Max = -1;
+    }
+  }
+  if (!see('}'))
+    return false;
+  next();
+  return true;
+}
+
+bool RegexDFAParser::parseClassName(std::bitset<256> &Set) {
+  size_t End = P.find(":]", Pos);
+  if (End == StringRef::npos)
+    return false;
+  StringRef Name = P.slice(Pos, End);
+  Pos = End + 2;
+
+  int (*Pred)(int);
+  if (Name == "alnum") Pred = isalnum;
+  else if (Name == "alpha") Pred = isalpha;
+  else if (Name == "blank") Pred = isblank;
+  else if (Name == "cntrl") Pred = iscntrl;
+  else if (Name == "digit") Pred = isdigit;
+  else if (Name == "graph") Pred = isgraph;
+  else if (Name == "lower") Pred = islower;
+  else if (Name == "print") Pred = isprint;
+  else if (Name == "punct") Pred = ispunct;
+  else if (Name == "space") Pred = isspace;
+  else if (Name == "upper") Pred = isupper;
+  else if (Name == "xdigit") Pred = isxdigit;
+  else
+    return false;
+
+  for (unsigned C = 0; C != 256; ++C)
+    if (Pred(C))
+      Set.set(C);
+  return true;
+}
+
+bool RegexDFAParser::parseBracket(std::bitset<256> &Set) {
+  // Word boundaries are spelled as bracket expressions.
+  if (P.substr(Pos).startswith("[:<:]]") || P.substr(Pos).startswith("[:>:]]"))
+    return false;
+
+  bool Invert = false;
+  if (see('^')) {
+    next();
+    Invert = true;
+  }
+  if (see(']')) {
+    next();
+    Set.set(']');
+  } else if (see('-')) {
+    next();
+    Set.set('-');
+  }
+
+  while (more() && !see(']') && !seeTwo('-', ']')) {
+    if (seeTwo('[', ':')) {
+      Pos += 2;
+      if (!parseClassName(Set))
+        return false;
+      continue;
+    }
+    // Collating elements and equivalence classes are left to the BSD engine.
+    if (seeTwo('[', '.') || seeTwo('[', '='))
+      return false;
+    unsigned char Start = next();
+    if (Start == '-')
+      return false;
+    unsigned char End = Start;
+    if (see('-') && more2() && peek2() != ']') {
+      next();
+      if (seeTwo('[', '.') || seeTwo('[', '='))
+        return false;
+      End = next();
+    }
+    if (Start > End)
+      return false;
+    for (unsigned C = Start; C <= End; ++C)
+      Set.set(C);
+  }
+  if (see('-')) {
+    next();
+    Set.set('-');
+  }
+  if (!see(']'))
+    return false;
+  next();
+
+  if (IgnoreCase) {
+    std::bitset<256> Folded = Set;
+    for (unsigned C = 0; C != 256; ++C)
+      if (Set.test(C) && isalpha(C))
+        Folded.set(otherCase(C));
+    Set = Folded;
+  }
+  if (Invert) {
+    Set.flip();
+    if (Newline)
+      Set.reset('\n');
+  }
+  return true;
+}
+
+unsigned RegexDFAParser::addNode(RegexDFA::NFANode::KindTy Kind, unsigned Out,
+                                 unsigned Out1, unsigned Set) {
+  if (DFA.NFA.size() >= MaxNFANodes)
+    Failed = true;
+  RegexDFA::NFANode N;
+  N.Kind = Kind;
+  N.Set = Set;
+  N.Out = Out;
+  N.Out1 = Out1;
+  DFA.NFA.push_back(N);
+  return DFA.NFA.size() - 1;
+}
+
+static bool containsAnchor(const RegexAST &N) {
+  if (N.Kind == RegexAST::Bol || N.Kind == RegexAST::Eol)
+    return true;
+  for (const auto &Kid : N.Kids)
+    if (containsAnchor(*Kid))
+      return true;
+  return false;
+}
+
+/// Compile \p N so that it continues with node \p Next, and return its entry
+/// node. Nodes are created back to front, so every Out edge is known when its
+/// node is made except for the loop of an unbounded repetition.
+unsigned RegexDFAParser::compile(const RegexAST &N, unsigned Next) {
+  typedef RegexDFA::NFANode NFANode;
+  if (Failed)
+    return Next;
+  switch (N.Kind) {
+  case RegexAST::Set:
+    return addNode(NFANode::Char, Next, 0, N.SetIdx);
+  case RegexAST::Bol:
+    return addNode(NFANode::Bol, Next);
+  case RegexAST::Eol:
+    return addNode(NFANode::Eol, Next);
+  case RegexAST::Empty:
+    return Next;
+  case RegexAST::Cat:
+    for (const auto &Kid : make_range(N.Kids.rbegin(), N.Kids.rend()))
+      Next = compile(*Kid, Next);
+    return Next;
+  case RegexAST::Alt: {
+    unsigned Entry = compile(*N.Kids.back(), Next);
+    for (unsigned I = N.Kids.size() - 1; I != 0; --I)
+      Entry = addNode(NFANode::Split, compile(*N.Kids[I - 1], Next), Entry);
+    return Entry;
+  }
+  case RegexAST::Repeat: {
+    const RegexAST &Kid = *N.Kids[0];
+    // The BSD engine does not treat repeated anchors consistently; leave them
+    // to it so that both engines always agree.
+    if (containsAnchor(Kid)) {
+      Failed = true;
+      return Next;
+    }
+    unsigned Tail = Next;
+    if (N.Max < 0) {
+      unsigned Loop = addNode(NFANode::Split, 0, Next);
+      unsigned Body = compile(Kid, Loop);
+      if (Failed)
+        return Next;
+      DFA.NFA[Loop].Out = Body;
+      Tail = Loop;
+    } else {
+      for (int I = N.Min; I != N.Max && !Failed; ++I)
+        Tail = addNode(NFANode::Split, compile(Kid, Tail), Next);
+    }
+    for (int I = 0; I != N.Min && !Failed; ++I)
+      Tail = compile(Kid, Tail);
+    return Tail;
+  }
+  }
+  llvm_unreachable("unknown regex node");
+}
+
+/// Find the longest run of plain characters in the top-level concatenation of
+/// \p N; every match must contain it.
+static std::string getRequiredLiteral(const RegexAST &N,
+                                      ArrayRef<std::bitset<256>> Sets) {
+  auto GetChar = [&](const RegexAST &K) -> int {
+    if (K.Kind != RegexAST::Set || Sets[K.SetIdx].count() != 1)
+      return -1;
+    for (unsigned C = 0; C != 256; ++C)
+      if (Sets[K.SetIdx].test(C))
+        return C;
+    return -1;
+  };
+
+  std::string Best, Run;
+  if (N.Kind != RegexAST::Cat)
+    return Best;
+  for (const auto &Kid : N.Kids) {
+    int C = GetChar(*Kid);
+    if (C < 0) {
+      if (Run.size() > Best.size())
+        Best.swap(Run);
+      Run.clear();
+      continue;
+    }
+    Run += char(C);
+  }
+  if (Run.size() > Best.size())
+    Best.swap(Run);
+  return Best;
+}
+
+bool RegexDFAParser::run() {
+  auto AST = parseAlt();
+  if (!AST || Failed || more())
+    return false;
+
+  unsigned MatchNode = addNode(RegexDFA::NFANode::Match, 0);
+  DFA.StartNode = compile(*AST, MatchNode);
+  if (Failed)
+    return false;
+
+  DFA.LineConfined = Newline;
+  for (const RegexDFA::NFANode &N : DFA.NFA)
+    if (N.Kind == RegexDFA::NFANode::Char && DFA.Sets[N.Set].test('\n'))
+      DFA.LineConfined = false;
+
+  // A single character is found faster through FirstByte.
+  DFA.RequiredLiteral = getRequiredLiteral(*AST, DFA.Sets);
+  if (DFA.RequiredLiteral.size() < 2)
+    DFA.RequiredLiteral.clear();
+  return true;
+}
+
+std::unique_ptr<RegexDFA> RegexDFA::compile(StringRef Pattern,
+                                            bool IgnoreCase, bool Newline) {
+  std::unique_ptr<RegexDFA> DFA(new RegexDFA());
+  DFA->Newline = Newline;
+  RegexDFAParser Parser(*DFA, Pattern, IgnoreCase, Newline);
+  if (!Parser.run())
+    return nullptr;
+
+  DFA->Mark.assign(DFA->NFA.size(), 0);
+  DFA->computeByteClasses();
+
+  // If the start state can only move forward on one byte, searches skip
+  // ahead to that byte with memchr.
+  const State &Start = DFA->States[DFA->getStartState()];
+  std::bitset<256> FirstBytes;
+  bool CanSkip = !DFA->HasBol;
+  for (unsigned N : Start.Nodes) {
+    if (DFA->NFA[N].Kind != NFANode::Char)
+      CanSkip = false;
+    else
+      FirstBytes |= DFA->Sets[DFA->NFA[N].Set];
+  }
+  if (CanSkip && FirstBytes.count() == 1)
+    for (unsigned C = 0; C != 256; ++C)
+      if (FirstBytes.test(C))
+        DFA->FirstByte = C;
+  return DFA;
+}
+
+void RegexDFA::computeByteClasses() {
+  // Two bytes are in the same class if every set contains both or neither.
+  // In newline-sensitive mode the anchors also distinguish '\n'.
+  std::map<std::vector<bool>, unsigned> Classes;
+  std::vector<bool> Signature(Sets.size() + 1);
+  for (unsigned C = 0; C != 256; ++C) {
+    for (unsigned I = 0, E = Sets.size(); I != E; ++I)
+      Signature[I] = Sets[I].test(C);
+    Signature.back() = Newline && C == '\n';
+    auto Ins = Classes.insert(std::make_pair(Signature, ClassRep.size()));
+    if (Ins.second)
+      ClassRep.push_back(C);
+    ClassOf[C] = Ins.first->second;
+  }
+}
+
+/// Compute the epsilon closure of \p Seeds into \p Result, as a sorted list of
+/// the Char, Match and pending Eol nodes reached. Bol and Eol nodes are passed
+/// through only if the position is at the start or the end of a line.
+void RegexDFA::closure(std::vector<unsigned> &Seeds, bool AtBOL, bool AtEOL,
+                       std::vector<unsigned> &Result) {
+  if (++MarkGen == 0) {
+    std::fill(Mark.begin(), Mark.end(), 0);
+    MarkGen = 1;
+  }
+  Result.clear();
+  Worklist.assign(Seeds.begin(), Seeds.end());
+  while (!Worklist.empty()) {
+    unsigned N = Worklist.back();
+    Worklist.pop_back();
+    if (Mark[N] == MarkGen)
+      continue;
+    Mark[N] = MarkGen;
+    const NFANode &Node = NFA[N];
+    switch (Node.Kind) {
+    case NFANode::Char:
+    case NFANode::Match:
+      Result.push_back(N);
+      break;
+    case NFANode::Split:
+      Worklist.push_back(Node.Out1);
+      Worklist.push_back(Node.Out);
+      break;
+    case NFANode::Bol:
+      if (AtBOL)
+        Worklist.push_back(Node.Out);
+      break;
+    case NFANode::Eol:
+      if (AtEOL)
+        Worklist.push_back(Node.Out);
+      else
+        Result.push_back(N);
+      break;
+    }
+  }
+  std::sort(Result.begin(), Result.end());
+}
+
+unsigned RegexDFA::getState(std::vector<unsigned> &Nodes, bool AtBOL) {
+  // Whether a state is at the start of a line only matters to '^'.
+  if (!HasBol)
+    AtBOL = false;
+
+  std::string Key(1, AtBOL);
+  Key.append(reinterpret_cast<const char *>(Nodes.data()),
+             Nodes.size() * sizeof(unsigned));
+  auto I = StateMap.find(Key);
+  if (I != StateMap.end())
+    return I->second;
+
+  if (CachedNodes + Nodes.size() > MaxCachedNodes) {
+    States.clear();
+    Trans.clear();
+    StateMap.clear();
+    CachedNodes = 0;
+    StartState = -1;
+    ++NumFlushes;
+  }
+
+  State S;
+  S.Nodes = Nodes;
+  S.AtBOL = AtBOL;
+  S.Accept = false;
+  for (unsigned N : Nodes)
+    if (NFA[N].Kind == NFANode::Match)
+      S.Accept = true;
+  std::vector<unsigned> AtEOL;
+  closure(Nodes, AtBOL, /*AtEOL=*/true, AtEOL);
+  S.AcceptAtEOL = false;
+  for (unsigned N : AtEOL)
+    if (NFA[N].Kind == NFANode::Match)
+      S.AcceptAtEOL = true;
+
+  CachedNodes += Nodes.size();
+  States.push_back(std::move(S));
+  Trans.resize(Trans.size() + ClassRep.size(), -1);
+  StateMap[Key] = States.size() - 1;
+  return States.size() - 1;
+}
+
+unsigned RegexDFA::getStartState() {
+  if (StartState < 0) {
+    std::vector<unsigned> Seeds(1, StartNode), Nodes;
+    closure(Seeds, /*AtBOL=*/true, /*AtEOL=*/false, Nodes);
+    StartState = getState(Nodes, /*AtBOL=*/true);
+  }
+  return StartState;
+}
+
+unsigned RegexDFA::computeTransition(unsigned S, unsigned Class) {
+  unsigned char C = ClassRep[Class];
+  bool IsNewline = Newline && C == '\n';
+
+  // A newline ends the line, so pending '$' anchors are satisfied before it
+  // is consumed.
+  std::vector<unsigned> Current;
+  if (IsNewline)
+    closure(States[S].Nodes, States[S].AtBOL, /*AtEOL=*/true, Current);
+  else
+    Current = States[S].Nodes;
+
+  // The search is unanchored, so a new match attempt starts at every
+  // position.
+  std::vector<unsigned> Seeds(1, StartNode);
+  for (unsigned N : Current)
+    if (NFA[N].Kind == NFANode::Char && Sets[NFA[N].Set].test(C))
+      Seeds.push_back(NFA[N].Out);
+
+  std::vector<unsigned> Nodes;
+  closure(Seeds, IsNewline, /*AtEOL=*/false, Nodes);
+  unsigned Flushes = NumFlushes;
+  unsigned T = getState(Nodes, IsNewline);
+  // If the cache was flushed, S no longer names the state we came from.
+  if (Flushes == NumFlushes)
+    Trans[S * ClassRep.size() + Class] = T;
+  return T;
+}
+
+/// Run the automaton over [\p Begin, \p End) of \p String and return the
+/// position at which the earliest-ending match ends, or npos.
+size_t RegexDFA::scan(StringRef String, size_t Begin, size_t End) {
+  const unsigned char *Str =
+      reinterpret_cast<const unsigned char *>(String.data());
+  unsigned NumClasses = ClassRep.size();
+  // Every scan starts at the start of the string or of a line.
+  unsigned S = getStartState();
+  for (size_t I = Begin; I != End; ++I) {
+    unsigned char C = Str[I];
+    const State &St = States[S];
+    if (St.Accept || (St.AcceptAtEOL && Newline && C == '\n'))
+      return I;
+    int T = Trans[S * NumClasses + ClassOf[C]];
+    if (T < 0)
+      T = computeTransition(S, ClassOf[C]);
+    S = T;
+    if (FirstByte >= 0 && int(S) == StartState) {
+      const void *P = memchr(Str + I + 1, FirstByte, End - I - 1);
+      if (!P)
+        return StringRef::npos;
+      I = static_cast<const unsigned char *>(P) - Str - 1;
+    }
+  }
+  return States[S].AcceptAtEOL ? End : StringRef::npos;
+}
+
+bool RegexDFA::find(StringRef String, size_t &Begin, size_t &End) {
+  if (!RequiredLiteral.empty()) {
+    size_t P = String.find(RequiredLiteral);
+    if (P == StringRef::npos)
+      return false;
+    // Only lines that contain the literal can contain a match.
+    if (LineConfined) {
+      size_t From = 0;
+      while (P != StringRef::npos) {
+        size_t LineBegin = String.rfind('\n', P);
+        LineBegin = LineBegin == StringRef::npos || LineBegin < From
+                        ? From
+                        : LineBegin + 1;
+        size_t LineEnd = String.find('\n', P + RequiredLiteral.size());
+        if (LineEnd == StringRef::npos)
+          LineEnd = String.size();
+        if (scan(String, LineBegin, LineEnd) != StringRef::npos) {
+          Begin = LineBegin;
+          End = LineEnd;
+          return true;
+        }
+        if (LineEnd == String.size())
+          return false;
+        From = LineEnd + 1;
+        P = String.find(RequiredLiteral, From);
+      }
+      return false;
+    }
+  }
+
+  size_t MatchEnd = scan(String, 0, String.size());
+  if (MatchEnd == StringRef::npos)
+    return false;
+  Begin = 0;
+  End = String.size();
+  // The leftmost match is on the same line as the earliest-ending one: a
+  // match on an earlier line would have to end earlier.
+  if (LineConfined) {
+    size_t LineBegin = String.rfind('\n', MatchEnd);
+    if (LineBegin != StringRef::npos)
+      Begin = LineBegin + 1;
+    End = std::min(String.find('\n', MatchEnd), String.size());
+  }
+  return true;
+}
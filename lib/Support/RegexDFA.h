@@ -0,0 +1,119 @@
+//===-- RegexDFA.h - Lazily built DFA for extended regexes ------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares RegexDFA, the matcher llvm::Regex uses in front of the
+// BSD regex engine. It compiles the subset of POSIX extended regular
+// expressions that has no back-references into a Thompson NFA, and runs it
+// as a DFA whose states are built on demand and cached across searches.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIB_SUPPORT_REGEXDFA_H
+#define LLVM_LIB_SUPPORT_REGEXDFA_H
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include <bitset>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace llvm {
+
+class RegexDFA {
+public:
+  /// Compile \p Pattern, which must already have been accepted by the BSD
+  /// engine as an extended regex with the same flags. Returns null if the
+  /// pattern uses something the DFA does not handle (back-references,
+  /// collating elements, equivalence classes, word boundaries) or would be
+  /// too large.
+  static std::unique_ptr<RegexDFA> compile(StringRef Pattern, bool IgnoreCase,
+                                           bool Newline);
+
+  /// Search \p String for a match. Returns false if there is none. Otherwise
+  /// sets [\p Begin, \p End) to a range of \p String that contains the
+  /// leftmost-longest match, such that matching only that range (treating its
+  /// ends as the ends of the string) finds the same match and sub-matches as
+  /// matching all of \p String.
+  ///
+  /// find() extends the cached automaton, so the caller must hold the lock
+  /// returned by getMutex().
+  bool find(StringRef String, size_t &Begin, size_t &End);
+
+  std::mutex &getMutex() { return Mutex; }
+
+private:
+  struct NFANode {
+    enum KindTy { Char, Split, Bol, Eol, Match } Kind;
+    unsigned Set;
+    unsigned Out, Out1;
+  };
+
+  struct State {
+    std::vector<unsigned> Nodes;
+    bool AtBOL;
+    bool Accept;
+    bool AcceptAtEOL;
+  };
+
+  /// The character sets referenced by Char nodes.
+  std::vector<std::bitset<256>> Sets;
+  std::vector<NFANode> NFA;
+  unsigned StartNode;
+  bool Newline;
+  bool HasBol = false;
+
+  /// True if no match can contain a newline, so that every match is confined
+  /// to a single line of the subject string.
+  bool LineConfined = false;
+
+  /// A literal that every match contains, or empty if there is none worth
+  /// searching for.
+  std::string RequiredLiteral;
+
+  /// If every match starts with the same byte, that byte; otherwise -1.
+  int FirstByte = -1;
+
+  /// Bytes partitioned into classes that no character set distinguishes.
+  unsigned char ClassOf[256];
+  std::vector<unsigned char> ClassRep;
+
+  /// The lazily built automaton. Trans holds ClassRep.size() entries per
+  /// state, -1 for transitions not computed yet.
+  std::vector<State> States;
+  std::vector<int> Trans;
+  StringMap<unsigned> StateMap;
+  size_t CachedNodes = 0;
+  unsigned NumFlushes = 0;
+  int StartState = -1;
+
+  /// Guards the automaton and the scratch space below.
+  std::mutex Mutex;
+
+  /// Scratch space for computing epsilon closures.
+  std::vector<unsigned> Mark;
+  unsigned MarkGen = 0;
+  std::vector<unsigned> Worklist;
+
+  RegexDFA() = default;
+
+  void computeByteClasses();
+  void closure(std::vector<unsigned> &Seeds, bool AtBOL, bool AtEOL,
+               std::vector<unsigned> &Result);
+  unsigned getState(std::vector<unsigned> &Nodes, bool AtBOL);
+  unsigned getStartState();
+  unsigned computeTransition(unsigned S, unsigned Class);
+  size_t scan(StringRef String, size_t Begin, size_t End);
+
+  friend class RegexDFAParser;
+};
+
+} // end namespace llvm
+
+#endif
@@ -19,27 +19,59 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
 using namespace llvm;
 
 static const size_t TabStop = 8;
 
-namespace {
-  struct LineNoCacheTy {
-    unsigned LastQueryBufferID;
-    const char *LastQuery;
-    unsigned LineNoOfQuery;
-  };
-}
+template <typename T>
+unsigned SourceMgr::SrcBuffer::getLineNumberImpl(const char *Ptr) const {
+  std::vector<T> *Offsets = static_cast<std::vector<T> *>(OffsetCache);
+  StringRef S = Buffer->getBuffer();
+  if (!Offsets) {
+    // Build the index with memchr, which the C library vectorizes, rather
+    // than looking at one character at a time.
+    Offsets = new std::vector<T>();
+    OffsetCache = Offsets;
+    const char *Start = S.data(), *End = S.data() + S.size();
+    for (const char *P = Start;
+         (P = static_cast<const char *>(memchr(P, '\n', End - P))); ++P)
+      Offsets->push_back(static_cast<T>(P - Start));
+  }
 
-static LineNoCacheTy *getCache(void *Ptr) {
-  return (LineNoCacheTy*)Ptr;
+  // The line number is one plus the number of newlines before Ptr.
+  assert(Ptr >= S.begin() && Ptr <= S.end() && "Location not in buffer!");
+  T PtrOffset = static_cast<T>(Ptr - S.data());
+  return std::lower_bound(Offsets->begin(), Offsets->end(), PtrOffset) -
+         Offsets->begin() + 1;
 }
 
+unsigned SourceMgr::SrcBuffer::getLineNumber(const char *Ptr) const {
+  size_t Sz = Buffer->getBufferSize();
+  if (Sz <= std::numeric_limits<uint8_t>::max())
+    return getLineNumberImpl<uint8_t>(Ptr);
+  if (Sz <= std::numeric_limits<uint16_t>::max())
+    return getLineNumberImpl<uint16_t>(Ptr);
+  if (Sz <= std::numeric_limits<uint32_t>::max())
+    return getLineNumberImpl<uint32_t>(Ptr);
+  return getLineNumberImpl<uint64_t>(Ptr);
+}
 
-SourceMgr::~SourceMgr() {
-  // Delete the line # cache if allocated.
-  if (LineNoCacheTy *Cache = getCache(LineNoCache))
-    delete Cache;
+SourceMgr::SrcBuffer::~SrcBuffer() {
+  if (!OffsetCache)
+    return;
+  // The buffer is still owned here, so its size selects the index type.
+  size_t Sz = Buffer->getBufferSize();
+  if (Sz <= std::numeric_limits<uint8_t>::max())
+    delete static_cast<std::vector<uint8_t> *>(OffsetCache);
+  else if (Sz <= std::numeric_limits<uint16_t>::max())
+    delete static_cast<std::vector<uint16_t> *>(OffsetCache);
+  else if (Sz <= std::numeric_limits<uint32_t>::max())
+    delete static_cast<std::vector<uint32_t> *>(OffsetCache);
+  else
+    delete static_cast<std::vector<uint64_t> *>(OffsetCache);
 }
 
 unsigned SourceMgr::AddIncludeFile(const std::string &Filename,
@@ -79,40 +111,14 @@ SourceMgr::getLineAndColumn(SMLoc Loc, unsigned BufferID) const {
     BufferID = FindBufferContainingLoc(Loc);
   assert(BufferID && "Invalid Location!");
 
-  const MemoryBuffer *Buff = getMemoryBuffer(BufferID);
-
-  // Count the number of \n's between the start of the file and the specified
-  // location.
-  unsigned LineNo = 1;
+  const SrcBuffer &SB = getBufferInfo(BufferID);
+  const char *BufStart = SB.Buffer->getBufferStart();
+  const char *Ptr = Loc.getPointer();
 
-  const char *BufStart = Buff->getBufferStart();
-  const char *Ptr = BufStart;
+  // Look the line up in the buffer's newline index.  Queries can come in any
+  // order, so this is a binary search rather than a scan from the last query.
+  unsigned LineNo = SB.getLineNumber(Ptr);
 
-  // If we have a line number cache, and if the query is to a later point in the
-  // same file, start searching from the last query location.  This optimizes
-  // for the case when multiple diagnostics come out of one file in order.
-  if (LineNoCacheTy *Cache = getCache(LineNoCache))
-    if (Cache->LastQueryBufferID == BufferID &&
-        Cache->LastQuery <= Loc.getPointer()) {
-      Ptr = Cache->LastQuery;
-      LineNo = Cache->LineNoOfQuery;
-    }
-
-  // Scan for the location being queried, keeping track of the number of lines
-  // we see.
-  for (; SMLoc::getFromPointer(Ptr) != Loc; ++Ptr)
-    if (*Ptr == '\n') ++LineNo;
-
-  // Allocate the line number cache if it doesn't exist.
-  if (!LineNoCache)
-    LineNoCache = new LineNoCacheTy();
-
-  // Update the line # cache.
-  LineNoCacheTy &Cache = *getCache(LineNoCache);
-  Cache.LastQueryBufferID = BufferID;
-  Cache.LastQuery = Ptr;
-  Cache.LineNoOfQuery = LineNo;
-  
   size_t NewlineOffs = StringRef(BufStart, Ptr-BufStart).find_last_of("\n\r");
   if (NewlineOffs == StringRef::npos) NewlineOffs = ~(size_t)0;
   return std::make_pair(LineNo, Ptr-BufStart-NewlineOffs);
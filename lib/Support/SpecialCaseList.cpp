@@ -15,6 +15,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Support/SpecialCaseList.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringSet.h"
@@ -26,21 +27,115 @@
 
 namespace llvm {
 
+namespace {
+/// A trie of literal strings, which answers whether any of them is a prefix
+/// (or, if built from reversed strings, a suffix) of a query.
+class LiteralTrie {
+  /// Child edges, keyed by the parent node number shifted left by 8 and or'ed
+  /// with the byte on the edge. Node 0 is the root.
+  DenseMap<uint64_t, unsigned> Edges;
+  /// Whether each node ends an inserted string.
+  std::vector<bool> Terminal;
+  bool Reversed;
+
+  static uint64_t getKey(unsigned Node, char C) {
+    return (uint64_t(Node) << 8) | (unsigned char)C;
+  }
+
+public:
+  explicit LiteralTrie(bool Reversed = false)
+      : Terminal(1, false), Reversed(Reversed) {}
+
+  void insert(StringRef S) {
+    unsigned Node = 0;
+    for (size_t I = 0, E = S.size(); I != E; ++I) {
+      char C = Reversed ? S[E - I - 1] : S[I];
+      auto Ins = Edges.insert(std::make_pair(getKey(Node, C), 0u));
+      if (Ins.second) {
+        Ins.first->second = Terminal.size();
+        Terminal.push_back(false);
+      }
+      Node = Ins.first->second;
+    }
+    Terminal[Node] = true;
+  }
+
+  /// Return true if some inserted string is a prefix of \p S, or a suffix if
+  /// the trie is reversed.
+  bool matchesEnd(StringRef S) const {
+    unsigned Node = 0;
+    for (size_t I = 0, E = S.size(); I != E; ++I) {
+      if (Terminal[Node])
+        return true;
+      auto It = Edges.find(getKey(Node, Reversed ? S[E - I - 1] : S[I]));
+      if (It == Edges.end())
+        return false;
+      Node = It->second;
+    }
+    return Terminal[Node];
+  }
+
+  /// Return true if some inserted string occurs anywhere in \p S.
+  bool matchesSubstring(StringRef S) const {
+    assert(!Reversed && "substrings are looked up in a forward trie");
+    for (size_t I = 0, E = S.size(); I <= E; ++I)
+      if (matchesEnd(S.substr(I)))
+        return true;
+    return false;
+  }
+
+  bool empty() const { return Terminal.size() == 1 && !Terminal[0]; }
+};
+} // end anonymous namespace
+
 /// Represents a set of regular expressions.  Regular expressions which are
-/// "literal" (i.e. no regex metacharacters) are stored in Strings, while all
-/// others are represented as a single pipe-separated regex in RegEx.  The
-/// reason for doing so is efficiency; StringSet is much faster at matching
-/// literal strings than Regex.
+/// "literal" (i.e. no regex metacharacters) are stored in Strings.  Globs that
+/// are a literal with a leading and/or trailing '*' are stored in the
+/// Prefixes, Suffixes and Substrings tries.  All others are represented as a
+/// single pipe-separated regex in RegEx.  The reason for doing so is
+/// efficiency; StringSet and the tries are much faster at matching literal
+/// strings than Regex, and blacklists are mostly made of such entries.
 struct SpecialCaseList::Entry {
-  Entry() {}
+  Entry() : Suffixes(/*Reversed=*/true) {}
   Entry(Entry &&Other)
-      : Strings(std::move(Other.Strings)), RegEx(std::move(Other.RegEx)) {}
+      : Strings(std::move(Other.Strings)),
+        Prefixes(std::move(Other.Prefixes)),
+        Suffixes(std::move(Other.Suffixes)),
+        Substrings(std::move(Other.Substrings)), RegEx(std::move(Other.RegEx)) {
+  }
 
   StringSet<> Strings;
+  LiteralTrie Prefixes;
+  LiteralTrie Suffixes;
+  LiteralTrie Substrings;
   std::unique_ptr<Regex> RegEx;
 
   bool match(StringRef Query) const {
-    return Strings.count(Query) || (RegEx && RegEx->match(Query));
+    return Strings.count(Query) ||
+           (!Prefixes.empty() && Prefixes.matchesEnd(Query)) ||
+           (!Suffixes.empty() && Suffixes.matchesEnd(Query)) ||
+           (!Substrings.empty() && Substrings.matchesSubstring(Query)) ||
+           (RegEx && RegEx->match(Query));
+  }
+
+  /// If \p Glob is a literal with a leading and/or trailing '*', add it to
+  /// the matching trie and return true.
+  bool insertLiteralGlob(StringRef Glob) {
+    bool Leading = Glob.startswith("*");
+    if (Leading)
+      Glob = Glob.drop_front();
+    bool Trailing = Glob.endswith("*");
+    if (Trailing)
+      Glob = Glob.drop_back();
+    if ((!Leading && !Trailing) || !Regex::isLiteralERE(Glob))
+      return false;
+    if (Leading && Trailing)
+      Substrings.insert(Glob);
+    else if (Leading)
+      Suffixes.insert(Glob);
+    else
+      Prefixes.insert(Glob);
+    return true;
   }
 };
 
@@ -113,6 +208,9 @@ bool SpecialCaseList::parse(const MemoryBuffer *MB, std::string &Error) {
       continue;
     }
 
+    if (Entries[Prefix][Category].insertLiteralGlob(Regexp))
+      continue;
+
     // Replace * with .*
     for (size_t pos = 0; (pos = Regexp.find("*", pos)) != std::string::npos;
          pos += strlen(".*")) {
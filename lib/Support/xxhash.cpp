@@ -0,0 +1,117 @@
+//===- xxhash.cpp - Stable 64-bit hashing ---------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the xxHash64 algorithm. The reference implementation is
+// at https://github.com/Cyan4973/xxHash and is BSD licensed; this is an
+// independent implementation of the published algorithm.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/xxhash.h"
+#include "llvm/Support/Endian.h"
+
+using namespace llvm;
+using namespace support;
+
+static const uint64_t PRIME64_1 = 11400714785074694791ULL;
+static const uint64_t PRIME64_2 = 14029467366897019727ULL;
+static const uint64_t PRIME64_3 = 1609587929392839161ULL;
+static const uint64_t PRIME64_4 = 9650029242287828579ULL;
+static const uint64_t PRIME64_5 = 2870177450012600261ULL;
+
+static inline uint64_t rotl64(uint64_t X, size_t R) {
+  return (X << R) | (X >> (64 - R));
+}
+
+static inline uint64_t round64(uint64_t Acc, uint64_t Input) {
+  Acc += Input * PRIME64_2;
+  Acc = rotl64(Acc, 31);
+  Acc *= PRIME64_1;
+  return Acc;
+}
+
+static inline uint64_t mergeRound(uint64_t Acc, uint64_t Val) {
+  Val = round64(0, Val);
+  Acc ^= Val;
+  Acc = Acc * PRIME64_1 + PRIME64_4;
+  return Acc;
+}
+
+static inline uint64_t avalanche(uint64_t H64) {
+  H64 ^= H64 >> 33;
+  H64 *= PRIME64_2;
+  H64 ^= H64 >> 29;
+  H64 *= PRIME64_3;
+  H64 ^= H64 >> 32;
+  return H64;
+}
+
+uint64_t llvm::xxHash64(StringRef Data, uint64_t Seed) {
+  size_t Len = Data.size();
+  const unsigned char *P = Data.bytes_begin();
+  const unsigned char *const BEnd = Data.bytes_end();
+  uint64_t H64;
+
+  if (Len >= 32) {
+    // Consume 32-byte stripes with four independent lanes so that the
+    // multiplies of consecutive words can overlap.
+    const unsigned char *const Limit = BEnd - 32;
+    uint64_t V1 = Seed + PRIME64_1 + PRIME64_2;
+    uint64_t V2 = Seed + PRIME64_2;
+    uint64_t V3 = Seed + 0;
+    uint64_t V4 = Seed - PRIME64_1;
+
+    do {
+      V1 = round64(V1, endian::read64le(P));
+      V2 = round64(V2, endian::read64le(P + 8));
+      V3 = round64(V3, endian::read64le(P + 16));
+      V4 = round64(V4, endian::read64le(P + 24));
+      P += 32;
+    } while (P <= Limit);
+
+    H64 = rotl64(V1, 1) + rotl64(V2, 7) + rotl64(V3, 12) + rotl64(V4, 18);
+    H64 = mergeRound(H64, V1);
+    H64 = mergeRound(H64, V2);
+    H64 = mergeRound(H64, V3);
+    H64 = mergeRound(H64, V4);
+  } else {
+    H64 = Seed + PRIME64_5;
+  }
+
+  H64 += (uint64_t)Len;
+
+  while (P + 8 <= BEnd) {
+    uint64_t const K1 = round64(0, endian::read64le(P));
+    H64 ^= K1;
+    H64 = rotl64(H64, 27) * PRIME64_1 + PRIME64_4;
+    P += 8;
+  }
+
+  if (P + 4 <= BEnd) {
+    H64 ^= (uint64_t)(endian::read32le(P)) * PRIME64_1;
+    H64 = rotl64(H64, 23) * PRIME64_2 + PRIME64_3;
+    P += 4;
+  }
+
+  while (P < BEnd) {
+    H64 ^= (*P) * PRIME64_5;
+    H64 = rotl64(H64, 11) * PRIME64_1;
+    P++;
+  }
+
+  return avalanche(H64);
+}
+
+uint64_t llvm::xxHash64(uint64_t Value, uint64_t Seed) {
+  // This is the 8-byte path of the function above with the loops unrolled.
+  uint64_t H64 = Seed + PRIME64_5 + 8;
+  H64 ^= round64(0, Value);
+  H64 = rotl64(H64, 27) * PRIME64_1 + PRIME64_4;
+  return avalanche(H64);
+}
@@ -12,8 +12,10 @@
 //===----------------------------------------------------------------------===//
 
 #include "AArch64InstrInfo.h"
+#include "AArch64MachineFunctionInfo.h"
 #include "AArch64Subtarget.h"
 #include "MCTargetDesc/AArch64AddressingModes.h"
+#include "llvm/CodeGen/LivePhysRegs.h"
 #include "llvm/CodeGen/MachineFrameInfo.h"
 #include "llvm/CodeGen/MachineInstrBuilder.h"
 #include "llvm/CodeGen/MachineMemOperand.h"
@@ -3013,3 +3015,49 @@ AArch64InstrInfo::getSerializableBitmaskMachineOperandTargetFlags() const {
       {MO_CONSTPOOL, "aarch64-constant-pool"}};
   return makeArrayRef(TargetFlags);
 }
+
+bool AArch64InstrInfo::isFunctionSafeToOutlineFrom(
+    const MachineFunction &MF) const {
+  // Linker optimization hints refer to instructions that outlining might
+  // delete.
+  return MF.getInfo<AArch64FunctionInfo>()->getLOHRelated().empty();
+}
+
+AArch64InstrInfo::MachineOutlinerInstrType
+AArch64InstrInfo::getOutliningType(const MachineInstr &MI) const {
+  if (MI.isDebugValue() || MI.isKill())
+    return MachineOutlinerInvisible;
+
+  // Control flow, labels and the prologue and epilogue stay in place.
+  if (MI.isTerminator() || MI.isCall() || MI.isReturn() || MI.isPosition() ||
+      MI.isInlineAsm() || MI.hasUnmodeledSideEffects() ||
+      MI.getFlag(MachineInstr::FrameSetup) ||
+      MI.getFlag(MachineInstr::FrameDestroy))
+    return MachineOutlinerIllegal;
+
+  // The link register holds the return address of the outlined sequence.
+  for (const MachineOperand &MO : MI.operands()) {
+    if (MO.isReg() && MO.getReg() && RI.regsOverlap(MO.getReg(), AArch64::LR))
+      return MachineOutlinerIllegal;
+    if (MO.isMBB() || MO.isBlockAddress() || MO.isFI() || MO.isRegMask() ||
+        MO.isCFIIndex() || MO.isMCSymbol())
+      return MachineOutlinerIllegal;
+  }
+  return MachineOutlinerLegal;
+}
+
+bool AArch64InstrInfo::isOutlinedCallLegal(const LivePhysRegs &LiveRegs) const {
+  // The call clobbers the link register.
+  return !LiveRegs.contains(AArch64::LR);
+}
+
+MachineInstr *
+AArch64InstrInfo::insertOutlinedCall(MachineBasicBlock &MBB,
+                                     MachineBasicBlock::iterator It,
+                                     MachineBasicBlock &Callee) const {
+  return BuildMI(MBB, It, It->getDebugLoc(), get(AArch64::BL)).addMBB(&Callee);
+}
+
+void AArch64InstrInfo::insertOutlinedReturn(MachineBasicBlock &MBB) const {
+  BuildMI(&MBB, DebugLoc(), get(AArch64::RET)).addReg(AArch64::LR);
+}
@@ -189,6 +189,15 @@ public:
   ArrayRef<std::pair<unsigned, const char *>>
   getSerializableBitmaskMachineOperandTargetFlags() const override;
 
+  bool isFunctionSafeToOutlineFrom(const MachineFunction &MF) const override;
+  MachineOutlinerInstrType
+  getOutliningType(const MachineInstr &MI) const override;
+  bool isOutlinedCallLegal(const LivePhysRegs &LiveRegs) const override;
+  MachineInstr *insertOutlinedCall(MachineBasicBlock &MBB,
+                                   MachineBasicBlock::iterator It,
+                                   MachineBasicBlock &Callee) const override;
+  void insertOutlinedReturn(MachineBasicBlock &MBB) const override;
+
 private:
   void instantiateCondBranch(MachineBasicBlock &MBB, DebugLoc DL,
                              MachineBasicBlock *TBB,
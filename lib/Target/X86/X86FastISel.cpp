@@ -2461,6 +2461,69 @@ bool X86FastISel::fastLowerIntrinsicCall(const IntrinsicInst *II) {
     BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DbgLoc, TII.get(X86::TRAP));
     return true;
   }
+  case Intrinsic::bswap:
+  case Intrinsic::ctpop:
+  case Intrinsic::ctlz:
+  case Intrinsic::cttz: {
+    // These select to BSWAP, POPCNT, LZCNT and TZCNT when the subtarget has
+    // them. LZCNT and TZCNT return the operand size for zero, so they also
+    // implement the variants where that isn't undefined.
+    MVT VT;
+    if (!isTypeLegal(II->getType(), VT))
+      return false;
+
+    unsigned Opcode;
+    switch (II->getIntrinsicID()) {
+    default: llvm_unreachable("Unexpected intrinsic!");
+    case Intrinsic::bswap: Opcode = ISD::BSWAP; break;
+    case Intrinsic::ctpop: Opcode = ISD::CTPOP; break;
+    case Intrinsic::ctlz:  Opcode = ISD::CTLZ;  break;
+    case Intrinsic::cttz:  Opcode = ISD::CTTZ;  break;
+    }
+
+    const Value *Op = II->getArgOperand(0);
+    unsigned OpReg = getRegForValue(Op);
+    if (OpReg == 0)
+      return false;
+    unsigned ResultReg =
+        fastEmit_r(VT, VT, Opcode, OpReg, hasTrivialKill(Op));
+    if (ResultReg == 0)
+      return false;
+
+    updateValueMap(II, ResultReg);
+    return true;
+  }
+  case Intrinsic::fmuladd: {
+    // Leave it to SelectionDAG if it would be fused.
+    MVT VT;
+    if (!isTypeLegal(II->getType(), VT))
+      return false;
+    if (TM.Options.AllowFPOpFusion != FPOpFusion::Strict &&
+        TLI.isFMAFasterThanFMulAndFAdd(VT))
+      return false;
+
+    const Value *Op0 = II->getArgOperand(0);
+    const Value *Op1 = II->getArgOperand(1);
+    const Value *Op2 = II->getArgOperand(2);
+    unsigned Op0Reg = getRegForValue(Op0);
+    unsigned Op1Reg = getRegForValue(Op1);
+    unsigned Op2Reg = getRegForValue(Op2);
+    if (Op0Reg == 0 || Op1Reg == 0 || Op2Reg == 0)
+      return false;
+
+    unsigned MulReg = fastEmit_rr(VT, VT, ISD::FMUL, Op0Reg, hasTrivialKill(Op0),
+                                  Op1Reg, hasTrivialKill(Op1));
+    if (MulReg == 0)
+      return false;
+    unsigned ResultReg = fastEmit_rr(VT, VT, ISD::FADD, MulReg,
+                                     /*Op0IsKill=*/true, Op2Reg,
+                                     hasTrivialKill(Op2));
+    if (ResultReg == 0)
+      return false;
+
+    updateValueMap(II, ResultReg);
+    return true;
+  }
   case Intrinsic::sqrt: {
     if (!Subtarget->hasSSE1())
       return false;
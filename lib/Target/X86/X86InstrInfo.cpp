@@ -7145,6 +7145,62 @@ X86InstrInfo::getSerializableDirectMachineOperandTargetFlags() const {
   return makeArrayRef(TargetFlags);
 }
 
+bool X86InstrInfo::isFunctionSafeToOutlineFrom(const MachineFunction &MF) const {
+  // The call to an outlined sequence pushes the return address, which would
+  // overwrite anything the function keeps in the red zone.
+  const MachineFrameInfo *MFI = MF.getFrameInfo();
+  bool MayUseRedZone =
+      Subtarget.is64Bit() && !Subtarget.isTargetWin64() &&
+      !MF.getFunction()->hasFnAttribute(Attribute::NoRedZone) &&
+      !MFI->adjustsStack();
+  return !MayUseRedZone || MFI->getNumObjects() == 0;
+}
+
+X86InstrInfo::MachineOutlinerInstrType
+X86InstrInfo::getOutliningType(const MachineInstr &MI) const {
+  if (MI.isDebugValue() || MI.isKill())
+    return MachineOutlinerInvisible;
+
+  // Control flow, labels and the prologue and epilogue stay in place.
+  if (MI.isTerminator() || MI.isCall() || MI.isReturn() || MI.isPosition() ||
+      MI.isInlineAsm() || MI.hasUnmodeledSideEffects() ||
+      MI.getFlag(MachineInstr::FrameSetup) ||
+      MI.getFlag(MachineInstr::FrameDestroy))
+    return MachineOutlinerIllegal;
+
+  // Inside the outlined sequence the stack pointer is off by the pushed
+  // return address, so nothing may use it.
+  for (const MachineOperand &MO : MI.operands()) {
+    if (MO.isReg() && MO.getReg() &&
+        RI.regsOverlap(MO.getReg(), X86::RSP))
+      return MachineOutlinerIllegal;
+    if (MO.isMBB() || MO.isBlockAddress() || MO.isFI() || MO.isRegMask() ||
+        MO.isCFIIndex() || MO.isMCSymbol())
+      return MachineOutlinerIllegal;
+  }
+  return MachineOutlinerLegal;
+}
+
+MachineInstr *
+X86InstrInfo::insertOutlinedCall(MachineBasicBlock &MBB,
+                                 MachineBasicBlock::iterator It,
+                                 MachineBasicBlock &Callee) const {
+  unsigned Opc = Subtarget.is64Bit() ? X86::CALL64pcrel32 : X86::CALLpcrel32;
+  return BuildMI(MBB, It, It->getDebugLoc(), get(Opc)).addMBB(&Callee);
+}
+
+void X86InstrInfo::insertOutlinedReturn(MachineBasicBlock &MBB) const {
+  unsigned Opc = Subtarget.is64Bit() ? X86::RETQ : X86::RETL;
+  BuildMI(&MBB, DebugLoc(), get(Opc));
+}
+
+bool X86InstrInfo::isFunctionSafeToSplit(const MachineFunction &MF) const {
+  // Branches are relaxed to a 32-bit displacement when their target is in
+  // another section, which only reaches everything below the large code
+  // model.
+  return MF.getTarget().getCodeModel() != CodeModel::Large;
+}
+
 namespace {
   /// Create Global Base Reg pass. This initializes the PIC
   /// global base register for x86-32.
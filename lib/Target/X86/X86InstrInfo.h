@@ -530,6 +530,19 @@ public:
   ArrayRef<std::pair<unsigned, const char *>>
   getSerializableDirectMachineOperandTargetFlags() const override;
 
+  bool isFunctionSafeToOutlineFrom(const MachineFunction &MF) const override;
+
+  MachineOutlinerInstrType
+  getOutliningType(const MachineInstr &MI) const override;
+
+  MachineInstr *insertOutlinedCall(MachineBasicBlock &MBB,
+                                   MachineBasicBlock::iterator It,
+                                   MachineBasicBlock &Callee) const override;
+
+  void insertOutlinedReturn(MachineBasicBlock &MBB) const override;
+
+  bool isFunctionSafeToSplit(const MachineFunction &MF) const override;
+
 protected:
   /// Commutes the operands in the given instruction by changing the operands
   /// order and/or changing the instruction's opcode and/or the immediate value
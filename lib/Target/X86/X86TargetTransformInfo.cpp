@@ -1128,6 +1128,70 @@ int X86TTIImpl::getReductionCost(unsigned Opcode, Type *ValTy,
   return BaseT::getReductionCost(Opcode, ValTy, IsPairwise);
 }
 
+int X86TTIImpl::getMinMaxReductionCost(Type *ValTy, Type *CondTy,
+                                       bool IsPairwise, bool IsUnsigned) {
+  std::pair<int, MVT> LT = TLI->getTypeLegalizationCost(DL, ValTy);
+
+  MVT MTy = LT.second;
+
+  int ISD;
+  if (ValTy->isFPOrFPVectorTy())
+    ISD = ISD::FMINNUM;
+  else
+    ISD = IsUnsigned ? ISD::UMIN : ISD::SMIN;
+
+  // The costs of the splitting form: log2(N) shuffles, each followed by a
+  // min/max. Element types without a native min/max instruction pay for a
+  // compare and a blend (or and/andn/or) at every level instead.
+  static const CostTblEntry SSE2CostTblNoPairWise[] = {
+    { ISD::FMINNUM, MVT::v2f64,   2 },
+    { ISD::FMINNUM, MVT::v4f32,   4 },
+    { ISD::SMIN,    MVT::v8i16,   6 },
+    { ISD::UMIN,    MVT::v16i8,   8 },
+  };
+
+  static const CostTblEntry SSE41CostTblNoPairWise[] = {
+    { ISD::SMIN,    MVT::v4i32,   4 },
+    { ISD::UMIN,    MVT::v4i32,   4 },
+    { ISD::UMIN,    MVT::v8i16,   6 },
+    { ISD::SMIN,    MVT::v16i8,   8 },
+  };
+
+  static const CostTblEntry AVX1CostTblNoPairWise[] = {
+    { ISD::FMINNUM, MVT::v4f64,   4 },
+    { ISD::FMINNUM, MVT::v8f32,   6 },
+  };
+
+  static const CostTblEntry AVX2CostTblNoPairWise[] = {
+    { ISD::SMIN,    MVT::v8i32,   6 },
+    { ISD::UMIN,    MVT::v8i32,   6 },
+    { ISD::SMIN,    MVT::v16i16,  8 },
+    { ISD::UMIN,    MVT::v16i16,  8 },
+    { ISD::SMIN,    MVT::v32i8,  10 },
+    { ISD::UMIN,    MVT::v32i8,  10 },
+  };
+
+  const CostTblEntry *Entry = nullptr;
+  if (ST->hasAVX2())
+    Entry = CostTableLookup(AVX2CostTblNoPairWise, ISD, MTy);
+  if (!Entry && ST->hasAVX())
+    Entry = CostTableLookup(AVX1CostTblNoPairWise, ISD, MTy);
+  if (!Entry && ST->hasSSE41())
+    Entry = CostTableLookup(SSE41CostTblNoPairWise, ISD, MTy);
+  if (!Entry && ST->hasSSE2())
+    Entry = CostTableLookup(SSE2CostTblNoPairWise, ISD, MTy);
+
+  if (Entry) {
+    // The pairwise form needs a second shuffle at every level.
+    int Cost = Entry->Cost;
+    if (IsPairwise)
+      Cost += Log2_32(MTy.getVectorNumElements());
+    return LT.first * Cost;
+  }
+
+  return BaseT::getMinMaxReductionCost(ValTy, CondTy, IsPairwise, IsUnsigned);
+}
+
 /// \brief Calculate the cost of materializing a 64-bit value. This helper
 /// method might only calculate a fraction of a larger immediate. Therefore it
 /// is valid to return a cost of ZERO.
@@ -0,0 +1,399 @@
+//===- LoopFusion.cpp - Loop Fusion Pass ----------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the Loop Fusion Pass. It merges two adjacent inner-most
+// loops that run the same number of iterations into a single loop, so that
+// arrays accessed by both loops are streamed through the memory hierarchy once
+// instead of twice.
+//
+// Two loops are fused when:
+//
+//  * they are in rotated, simplified form, the exit block of the first loop
+//    is the preheader of the second one, and the instructions of that block
+//    can be hoisted above the first loop. This also makes their headers
+//    control-equivalent: one runs if and only if the other does.
+//  * ScalarEvolution proves that their backedge-taken counts are equal.
+//  * the second loop does not use any value computed by the first one.
+//  * every dependence between a memory access of the first loop and one of
+//    the second is preserved in the fused loop. An access of the second loop
+//    in iteration i may only depend on accesses of the first loop in
+//    iterations up to i. Pairs that DependenceAnalysis proves independent are
+//    accepted; the others need affine accesses with equal strides whose
+//    distance ScalarEvolution can order.
+//  * the loops share an array, which is the reason to fuse them, and the fused
+//    body stays small.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/DepthFirstIterator.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/DependenceAnalysis.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Scalar.h"
+#include "llvm/Transforms/Utils/Local.h"
+
+#define LFUSE_NAME "loop-fusion"
+#define DEBUG_TYPE LFUSE_NAME
+
+using namespace llvm;
+
+static cl::opt<unsigned> FusionInstrThreshold(
+    "loop-fusion-instr-threshold", cl::init(200), cl::Hidden,
+    cl::desc("The maximum number of instructions in the body of a fused "
+             "loop"));
+
+static cl::opt<bool> FusionIgnoreProfitability(
+    "loop-fusion-ignore-profitability", cl::init(false), cl::Hidden,
+    cl::desc("Fuse legal loops even if they do not access a common array"));
+
+STATISTIC(NumLoopsFused, "Number of loops fused");
+
+namespace {
+
+typedef SmallVector<Instruction *, 16> AccessList;
+
+class LoopFusion : public FunctionPass {
+public:
+  LoopFusion() : FunctionPass(ID) {
+    initializeLoopFusionPass(*PassRegistry::getPassRegistry());
+  }
+
+  bool runOnFunction(Function &F) override {
+    if (skipOptnoneFunction(F))
+      return false;
+
+    LI = &getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
+    DT = &getAnalysis<DominatorTreeWrapperPass>().getDomTree();
+    SE = &getAnalysis<ScalarEvolutionWrapperPass>().getSE();
+    DA = &getAnalysis<DependenceAnalysis>();
+
+    // Build up a worklist of inner-loops first, as fusion deletes loops.
+    SmallVector<Loop *, 8> Worklist;
+    for (Loop *TopLevelLoop : *LI)
+      for (Loop *L : depth_first(TopLevelLoop))
+        // We only handle inner-most loops.
+        if (L->empty())
+          Worklist.push_back(L);
+
+    // Fuse each loop with the loops that follow it for as long as possible.
+    bool Changed = false;
+    SmallPtrSet<Loop *, 8> Removed;
+    for (Loop *L : Worklist) {
+      if (Removed.count(L))
+        continue;
+      while (Loop *Next = getAdjacentLoop(L)) {
+        if (!canFuse(L, Next))
+          break;
+        fuse(L, Next, F);
+        Removed.insert(Next);
+        Changed = true;
+      }
+    }
+    return Changed;
+  }
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.addRequired<AAResultsWrapperPass>();
+    AU.addRequired<DependenceAnalysis>();
+    AU.addRequired<ScalarEvolutionWrapperPass>();
+    AU.addRequired<LoopInfoWrapperPass>();
+    AU.addPreserved<LoopInfoWrapperPass>();
+    AU.addRequired<DominatorTreeWrapperPass>();
+    AU.addPreserved<DominatorTreeWrapperPass>();
+    AU.addRequiredID(LoopSimplifyID);
+    AU.addPreservedID(LoopSimplifyID);
+    AU.addRequiredID(LCSSAID);
+    AU.addPreservedID(LCSSAID);
+  }
+
+  static char ID;
+
+private:
+  /// \brief Return true if \p L is an inner-most loop in the rotated,
+  /// simplified form that fusion handles: a preheader, and a latch that is
+  /// the only exiting block and ends in a conditional branch to the header
+  /// or the single exit block.
+  bool isFusionCandidate(Loop *L) const {
+    if (!L->empty() || !L->isLoopSimplifyForm())
+      return false;
+    BasicBlock *Latch = L->getLoopLatch();
+    if (L->getExitingBlock() != Latch || !L->getExitBlock())
+      return false;
+    BranchInst *BI = dyn_cast<BranchInst>(Latch->getTerminator());
+    return BI && BI->isConditional();
+  }
+
+  /// \brief Return the loop whose preheader is the exit block of \p L, if both
+  /// are fusion candidates at the same depth.
+  Loop *getAdjacentLoop(Loop *L) const {
+    if (!isFusionCandidate(L))
+      return nullptr;
+    BasicBlock *Exit = L->getExitBlock();
+    BasicBlock *Succ = Exit->getSingleSuccessor();
+    if (!Succ || Exit->getSinglePredecessor() != L->getLoopLatch())
+      return nullptr;
+    Loop *Next = LI->getLoopFor(Succ);
+    if (!Next || Next == L || Next->getHeader() != Succ ||
+        Next->getLoopPreheader() != Exit ||
+        Next->getParentLoop() != L->getParentLoop() ||
+        !isFusionCandidate(Next))
+      return nullptr;
+    return Next;
+  }
+
+  /// \brief Collect the memory accesses of \p L into \p Accesses. Return false
+  /// if \p L accesses memory in ways other than simple loads and stores.
+  static bool collectAccesses(Loop *L, AccessList &Accesses) {
+    for (BasicBlock *BB : L->blocks())
+      for (Instruction &I : *BB) {
+        if (isa<DbgInfoIntrinsic>(I) || !I.mayReadOrWriteMemory())
+          continue;
+        if (LoadInst *Ld = dyn_cast<LoadInst>(&I)) {
+          if (!Ld->isSimple())
+            return false;
+        } else if (StoreInst *St = dyn_cast<StoreInst>(&I)) {
+          if (!St->isSimple())
+            return false;
+        } else {
+          return false;
+        }
+        Accesses.push_back(&I);
+      }
+    return true;
+  }
+
+  /// \brief Return true if fusing preserves the dependence between \p Src in
+  /// loop \p L0 and \p Dst in the following loop \p L1.
+  ///
+  /// Both accesses must be affine recurrences with the same constant stride,
+  /// at least as large as the accesses, so that they touch the same memory
+  /// in iterations \p j of \p L0 and \p i of \p L1 only if
+  /// Start(Src) + Stride * j == Start(Dst) + Stride * i. The fused loop runs
+  /// iteration \p i of \p L1 after iterations up to \p i of \p L0, so the
+  /// distance Start(Src) - Start(Dst) must have the sign of the stride, or be
+  /// zero.
+  bool isPreservedDependence(Instruction *Src, Loop *L0, Instruction *Dst,
+                             Loop *L1) const {
+    const auto *Src0 =
+        dyn_cast<SCEVAddRecExpr>(SE->getSCEV(getPointerOperand(Src)));
+    const auto *Dst1 =
+        dyn_cast<SCEVAddRecExpr>(SE->getSCEV(getPointerOperand(Dst)));
+    if (!Src0 || !Dst1 || Src0->getLoop() != L0 || Dst1->getLoop() != L1 ||
+        !Src0->isAffine() || !Dst1->isAffine())
+      return false;
+
+    const SCEV *Step = Src0->getStepRecurrence(*SE);
+    const auto *StepC = dyn_cast<SCEVConstant>(Step);
+    if (!StepC || Step != Dst1->getStepRecurrence(*SE))
+      return false;
+
+    const DataLayout &DL = Src->getModule()->getDataLayout();
+    uint64_t Size = std::max(DL.getTypeStoreSize(getAccessType(Src)),
+                             DL.getTypeStoreSize(getAccessType(Dst)));
+    int64_t Stride = StepC->getValue()->getSExtValue();
+    if (Stride == 0 || (uint64_t)std::abs(Stride) < Size)
+      return false;
+
+    const SCEV *Dist = SE->getMinusSCEV(Src0->getStart(), Dst1->getStart());
+    return Stride > 0 ? SE->isKnownNonNegative(Dist)
+                      : SE->isKnownNonPositive(Dist);
+  }
+
+  static Value *getPointerOperand(Instruction *I) {
+    if (LoadInst *Ld = dyn_cast<LoadInst>(I))
+      return Ld->getPointerOperand();
+    return cast<StoreInst>(I)->getPointerOperand();
+  }
+
+  static Type *getAccessType(Instruction *I) {
+    if (StoreInst *St = dyn_cast<StoreInst>(I))
+      return St->getValueOperand()->getType();
+    return I->getType();
+  }
+
+  /// \brief Return true if \p L0 and the loop \p L1 adjacent to it can and
+  /// should be fused.
+  bool canFuse(Loop *L0, Loop *L1) const {
+    DEBUG(dbgs() << "LFuse: Trying to fuse " << *L0 << " with " << *L1);
+
+    const SCEV *BTC0 = SE->getBackedgeTakenCount(L0);
+    const SCEV *BTC1 = SE->getBackedgeTakenCount(L1);
+    if (isa<SCEVCouldNotCompute>(BTC0) || BTC0 != BTC1) {
+      DEBUG(dbgs() << "LFuse: Trip counts differ or are unknown.\n");
+      return false;
+    }
+
+    // The block between the loops is hoisted above the first loop, and
+    // contains its LCSSA phis, which the second loop must not use.
+    BasicBlock *Between = L1->getLoopPreheader();
+    for (Instruction &I : *Between) {
+      if (PHINode *PN = dyn_cast<PHINode>(&I)) {
+        for (User *U : PN->users())
+          if (L1->contains(cast<Instruction>(U)) ||
+              cast<Instruction>(U)->getParent() == Between) {
+            DEBUG(dbgs() << "LFuse: Second loop uses the result of the "
+                            "first.\n");
+            return false;
+          }
+        continue;
+      }
+      if (isa<TerminatorInst>(I) || isa<DbgInfoIntrinsic>(I))
+        continue;
+      if (I.mayReadOrWriteMemory() || !isSafeToSpeculativelyExecute(&I)) {
+        DEBUG(dbgs() << "LFuse: Cannot hoist " << I << "\n");
+        return false;
+      }
+    }
+
+    AccessList Accesses0, Accesses1;
+    if (!collectAccesses(L0, Accesses0) || !collectAccesses(L1, Accesses1)) {
+      DEBUG(dbgs() << "LFuse: Unsupported memory access.\n");
+      return false;
+    }
+
+    bool SharesArray = false;
+    for (Instruction *I0 : Accesses0)
+      for (Instruction *I1 : Accesses1) {
+        if (SE->getPointerBase(SE->getSCEV(getPointerOperand(I0))) ==
+            SE->getPointerBase(SE->getSCEV(getPointerOperand(I1))))
+          SharesArray = true;
+        if (isa<LoadInst>(I0) && isa<LoadInst>(I1))
+          continue;
+        if (!DA->depends(I0, I1, true))
+          continue;
+        if (!isPreservedDependence(I0, L0, I1, L1)) {
+          DEBUG(dbgs() << "LFuse: Fusion would reverse the dependence from "
+                       << *I0 << " to " << *I1 << "\n");
+          return false;
+        }
+      }
+
+    if (!SharesArray && !FusionIgnoreProfitability) {
+      DEBUG(dbgs() << "LFuse: The loops access no common array.\n");
+      return false;
+    }
+
+    unsigned NumInstrs = 0;
+    for (Loop *L : {L0, L1})
+      for (BasicBlock *BB : L->blocks())
+        NumInstrs += BB->size();
+    if (NumInstrs > FusionInstrThreshold) {
+      DEBUG(dbgs() << "LFuse: Fused loop would be too large (" << NumInstrs
+                   << " instructions).\n");
+      return false;
+    }
+    return true;
+  }
+
+  /// \brief Fuse \p L1 into the loop \p L0 that precedes it.
+  ///
+  /// The latch of \p L0 branches to the header of \p L1 unconditionally, and
+  /// the latch of \p L1 becomes the latch of the fused loop. The block between
+  /// the loops is dissolved: its instructions are hoisted into the preheader
+  /// of \p L0 and its LCSSA phis move to the exit block of \p L1.
+  void fuse(Loop *L0, Loop *L1, Function &F) {
+    DEBUG(dbgs() << "LFuse: Fusing loops.\n");
+    SE->forgetLoop(L0);
+    SE->forgetLoop(L1);
+
+    BasicBlock *Preheader = L0->getLoopPreheader();
+    BasicBlock *Header0 = L0->getHeader();
+    BasicBlock *Latch0 = L0->getLoopLatch();
+    BasicBlock *Between = L1->getLoopPreheader();
+    BasicBlock *Header1 = L1->getHeader();
+    BasicBlock *Latch1 = L1->getLoopLatch();
+    BasicBlock *Exit = L1->getExitBlock();
+
+    // The fused loop is entered from the preheader of L0 and loops back from
+    // the latch of L1.
+    for (auto I = Header0->begin(); PHINode *PN = dyn_cast<PHINode>(I); ++I)
+      PN->setIncomingBlock(PN->getBasicBlockIndex(Latch0), Latch1);
+    Instruction *Header0Insert = Header0->getFirstNonPHI();
+    while (PHINode *PN = dyn_cast<PHINode>(Header1->begin())) {
+      PN->setIncomingBlock(PN->getBasicBlockIndex(Between), Preheader);
+      PN->moveBefore(Header0Insert);
+    }
+
+    // Dissolve the block between the loops.
+    Instruction *ExitInsert = &*Exit->begin();
+    while (PHINode *PN = dyn_cast<PHINode>(Between->begin())) {
+      PN->setIncomingBlock(PN->getBasicBlockIndex(Latch0), Latch1);
+      PN->moveBefore(ExitInsert);
+    }
+    while (&Between->front() != Between->getTerminator())
+      Between->front().moveBefore(Preheader->getTerminator());
+
+    // Chain the bodies and close the fused loop with the exit test of L1,
+    // which runs as many iterations.
+    BranchInst *Br0 = cast<BranchInst>(Latch0->getTerminator());
+    Value *Cond0 = Br0->getCondition();
+    BranchInst::Create(Header1, Br0);
+    Br0->eraseFromParent();
+    RecursivelyDeleteTriviallyDeadInstructions(Cond0);
+    BranchInst *Br1 = cast<BranchInst>(Latch1->getTerminator());
+    for (unsigned I = 0, E = Br1->getNumSuccessors(); I != E; ++I)
+      if (Br1->getSuccessor(I) == Header1)
+        Br1->setSuccessor(I, Header0);
+
+    LI->removeBlock(Between);
+    Between->eraseFromParent();
+
+    // Move the blocks of L1 into L0 and delete L1.
+    if (Loop *Parent = L1->getParentLoop()) {
+      Parent->removeChildLoop(std::find(Parent->begin(), Parent->end(), L1));
+    } else {
+      LI->removeLoop(std::find(LI->begin(), LI->end(), L1));
+    }
+    for (BasicBlock *BB : L1->blocks()) {
+      L0->addBlockEntry(BB);
+      LI->changeLoopFor(BB, L0);
+    }
+    delete L1;
+
+    DT->recalculate(F);
+    ++NumLoopsFused;
+  }
+
+  LoopInfo *LI;
+  DominatorTree *DT;
+  ScalarEvolution *SE;
+  DependenceAnalysis *DA;
+};
+
+} // anonymous namespace
+
+char LoopFusion::ID;
+static const char lfuse_name[] = "Loop Fusion";
+
+INITIALIZE_PASS_BEGIN(LoopFusion, LFUSE_NAME, lfuse_name, false, false)
+INITIALIZE_PASS_DEPENDENCY(AAResultsWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(DependenceAnalysis)
+INITIALIZE_PASS_DEPENDENCY(DominatorTreeWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(LoopInfoWrapperPass)
+INITIALIZE_PASS_DEPENDENCY(LoopSimplify)
+INITIALIZE_PASS_DEPENDENCY(LCSSA)
+INITIALIZE_PASS_DEPENDENCY(ScalarEvolutionWrapperPass)
+INITIALIZE_PASS_END(LoopFusion, LFUSE_NAME, lfuse_name, false, false)
+
+namespace llvm {
+FunctionPass *createLoopFusionPass() { return new LoopFusion(); }
+}
@@ -113,6 +113,8 @@ using namespace llvm::PatternMatch;
 
 STATISTIC(LoopsVectorized, "Number of loops vectorized");
 STATISTIC(LoopsAnalyzed, "Number of loops analyzed for vectorization");
+STATISTIC(LoopsEpilogueVectorized, "Number of epilogues vectorized");
+STATISTIC(OuterLoopsVectorized, "Number of outer loops vectorized");
 
 static cl::opt<bool>
 EnableIfConversion("enable-if-conversion", cl::init(true), cl::Hidden,
@@ -146,6 +148,25 @@ static cl::opt<bool> EnableMemAccessVersioning(
     "enable-mem-access-versioning", cl::init(true), cl::Hidden,
     cl::desc("Enable symbolic stride memory access versioning"));
 
+static cl::opt<bool> EnableEpilogueVectorization(
+    "enable-epilogue-vectorization", cl::init(false), cl::Hidden,
+    cl::desc("Vectorize the remainder of a vectorized loop with a narrower "
+             "vectorization factor when the cost model finds it profitable"));
+
+/// We only vectorize the epilogue of loops that leave at least this many
+/// iterations minus one to the remainder.
+static cl::opt<unsigned> EpilogueVectorizationMinWidth(
+    "epilogue-vectorization-min-width", cl::init(16), cl::Hidden,
+    cl::desc("Only vectorize the epilogue of loops whose vector body handles "
+             "at least this many iterations at a time"));
+
+/// Outer loops are only vectorized with this option, and only when their
+/// metadata asks for it with an explicit vectorization width.
+static cl::opt<bool> EnableOuterLoopVectorization(
+    "enable-outer-loop-vectorization", cl::init(false), cl::Hidden,
+    cl::desc("Vectorize outer loops that are explicitly marked for "
+             "vectorization"));
+
 static cl::opt<bool> EnableInterleavedMemAccesses(
     "enable-interleaved-mem-accesses", cl::init(false), cl::Hidden,
     cl::desc("Enable vectorization on interleaved memory accesses in a loop"));
@@ -319,7 +340,8 @@ public:
         VF(VecWidth), UF(UnrollFactor), Builder(PSE.getSE()->getContext()),
         Induction(nullptr), OldInduction(nullptr), WidenMap(UnrollFactor),
         TripCount(nullptr), VectorTripCount(nullptr), Legal(nullptr),
-        AddedSafetyChecks(false) {}
+        AddedSafetyChecks(false), HasVectorizedEpilogue(false),
+        SharesSafetyChecks(false) {}
 
   // Perform the actual loop widening (vectorization).
   // MinimumBitWidths maps scalar integer values to the smallest bitwidth they
@@ -341,6 +363,20 @@ public:
     return AddedSafetyChecks;
   }
 
+  /// The remainder of this loop is going to be vectorized too. Emit the SCEV
+  /// and memory checks ahead of the iteration count checks, so that every
+  /// path into the remainder has passed them.
+  void setHasVectorizedEpilogue() { HasVectorizedEpilogue = true; }
+
+  /// Don't emit any SCEV and memory checks. Either this is the vectorized
+  /// epilogue of another loop, whose checks also cover this one, or this is
+  /// an outer loop whose legality was asserted by the user.
+  void setSharesSafetyChecks() { SharesSafetyChecks = true; }
+
+  /// Make the SCEV and memory checks of this loop branch straight to the
+  /// scalar loop when they fail, past the vectorized \p Epilogue.
+  void redirectSafetyChecks(const InnerLoopVectorizer &Epilogue);
+
   virtual ~InnerLoopVectorizer() {}
 
 protected:
@@ -383,6 +419,10 @@ protected:
 
   /// A helper function to vectorize a single BB within the innermost loop.
   void vectorizeBlockInLoop(BasicBlock *BB, PhiVector *PV);
+
+  /// Widen the instruction \p I of the original loop into the vector loop,
+  /// at the current insertion point of the builder.
+  void widenInstruction(Instruction &I, PhiVector *PV);
   
   /// Vectorize a single PHINode in a block. This method handles the induction
   /// variable canonicalization. It supports both VF = 1 for unrolled loops and
@@ -554,6 +594,12 @@ protected:
 
   // Record whether runtime check is added.
   bool AddedSafetyChecks;
+  /// The blocks holding the SCEV and memory checks.
+  SmallVector<BasicBlock *, 2> SafetyCheckBlocks;
+  /// See setHasVectorizedEpilogue().
+  bool HasVectorizedEpilogue;
+  /// See setSharesSafetyChecks().
+  bool SharesSafetyChecks;
 };
 
 class InnerLoopUnroller : public InnerLoopVectorizer {
@@ -573,6 +619,45 @@ private:
   Value *reverseVector(Value *Vec) override;
 };
 
+/// OuterLoopVectorizer vectorizes a loop that contains a single innermost
+/// loop, each vector lane running one iteration of the outer loop. The inner
+/// loop stays a loop in the vector body. Its control flow must be uniform,
+/// that is, the same for all of the lanes, so it is only emitted once. Within
+/// it, the values that are the same for every lane stay scalar and the others
+/// are widened.
+class OuterLoopVectorizer : public InnerLoopVectorizer {
+public:
+  OuterLoopVectorizer(Loop *OrigLoop, PredicatedScalarEvolution &PSE,
+                      LoopInfo *LI, DominatorTree *DT,
+                      const TargetLibraryInfo *TLI,
+                      const TargetTransformInfo *TTI, unsigned VecWidth)
+      : InnerLoopVectorizer(OrigLoop, PSE, LI, DT, TLI, TTI, VecWidth, 1) {
+    // The user asserted that the iterations of the outer loop can run in
+    // lock step, so there is nothing to check at runtime.
+    setSharesSafetyChecks();
+  }
+
+private:
+  void vectorizeLoop() override;
+  void vectorizeMemoryInstruction(Instruction *Instr) override;
+
+  /// Emit the uniform instruction \p I once, as a scalar, for all of the
+  /// lanes.
+  void cloneUniformInstruction(Instruction &I);
+
+  /// Return the scalar that stands for the uniform value \p V in the vector
+  /// loop.
+  Value *getUniformValue(Value *V);
+
+  /// Return the number of bytes by which \p Ptr advances from one iteration
+  /// of the outer loop to the next, or 0 if that is not a known constant.
+  int64_t getOuterLoopStride(Value *Ptr);
+
+  /// Maps the uniform instructions of the original loop to their scalar
+  /// copies.
+  DenseMap<Value *, Value *> UniformMap;
+};
+
 /// \brief Look for a meaningful debug location on the instruction or it's
 /// operands.
 static Instruction *getDebugLocFromInstOrOperands(Instruction *I) {
@@ -1206,6 +1291,11 @@ public:
   /// loop, only that it is legal to do so.
   bool canVectorize();
 
+  /// Returns true if this loop, which must contain a single innermost loop,
+  /// can be vectorized by OuterLoopVectorizer. The independence of its
+  /// iterations is not checked: it is up to the user to assert it.
+  bool canVectorizeOuterLoop();
+
   /// Returns the Induction variable.
   PHINode *getInduction() { return Induction; }
 
@@ -1429,6 +1519,13 @@ public:
   /// possible.
   VectorizationFactor selectVectorizationFactor(bool OptForSize);
 
+  /// \return The vectorization factor to use for a vectorized epilogue of the
+  /// loop, given that the main vector loop uses \p MainVF and \p MainIC, or
+  /// 1 if the remainder should stay scalar. The epilogue is not interleaved
+  /// and only pays off if it is cheaper per iteration than the scalar loop.
+  unsigned selectEpilogueVectorizationFactor(bool OptForSize, unsigned MainVF,
+                                             unsigned MainIC);
+
   /// \return The size (in bits) of the smallest and widest types in the code
   /// that needs to be vectorized. We ignore values that remain scalar such as
   /// 64 bit loop indices.
@@ -1586,6 +1683,13 @@ static void addInnerLoop(Loop &L, SmallVectorImpl<Loop *> &V) {
 
   for (Loop *InnerL : L)
     addInnerLoop(*InnerL, V);
+
+  // A loop around a single innermost loop is a candidate for outer loop
+  // vectorization. It is processed before that innermost loop, which stays
+  // in the scalar remainder either way.
+  if (EnableOuterLoopVectorization && L.getSubLoops().size() == 1 &&
+      (*L.begin())->empty())
+    V.push_back(&L);
 }
 
 /// The LoopVectorize Pass.
@@ -1655,8 +1759,10 @@ struct LoopVectorize : public FunctionPass {
 
     // Now walk the identified inner loops.
     bool Changed = false;
-    while (!Worklist.empty())
-      Changed |= processLoop(Worklist.pop_back_val());
+    while (!Worklist.empty()) {
+      Loop *L = Worklist.pop_back_val();
+      Changed |= L->empty() ? processLoop(L) : processOuterLoop(L);
+    }
 
     // Process each loop nest in the function.
     return Changed;
@@ -1885,10 +1991,21 @@ struct LoopVectorize : public FunctionPass {
                                  Twine(IC) + ")");
     } else {
       // If we decided that it is *legal* to vectorize the loop then do it.
+      unsigned EpilogueVF =
+          CM.selectEpilogueVectorizationFactor(OptForSize, VF.Width, IC);
       InnerLoopVectorizer LB(L, PSE, LI, DT, TLI, TTI, VF.Width, IC);
+      if (EpilogueVF > 1)
+        LB.setHasVectorizedEpilogue();
       LB.vectorize(&LVL, CM.MinBWs);
       ++LoopsVectorized;
 
+      if (EpilogueVF > 1 &&
+          vectorizeEpilogue(L, LB, PSE, CM.MinBWs, EpilogueVF, Hints))
+        emitOptimizationRemark(F->getContext(), LV_NAME, *F, L->getStartLoc(),
+                               Twine("vectorized epilogue loop "
+                                     "(vectorization width: ") +
+                                   Twine(EpilogueVF) + ")");
+
       // Add metadata to disable runtime unrolling scalar loop when there's no
       // runtime check about strides and memory. Because at this situation,
       // scalar loop is rarely used not worthy to be unrolled.
@@ -1909,6 +2026,104 @@ struct LoopVectorize : public FunctionPass {
     return true;
   }
 
+  /// Vectorize the outer loop \p L, if its metadata asks for it with an
+  /// explicit width and its memory accesses are annotated as parallel. The
+  /// cost model only handles innermost loops, so that width is used as it is.
+  bool processOuterLoop(Loop *L) {
+    LoopVectorizeHints Hints(L, /*DisableInterleaving=*/true);
+    if (Hints.getForce() != LoopVectorizeHints::FK_Enabled ||
+        Hints.getWidth() < 2)
+      return false;
+
+    DEBUG(dbgs() << "\nLV: Checking an outer loop in \""
+                 << L->getHeader()->getParent()->getName() << "\" from "
+                 << getDebugLocString(L) << "\n");
+
+    Function *F = L->getHeader()->getParent();
+    if (!Hints.allowVectorization(F, L, AlwaysVectorize)) {
+      DEBUG(dbgs() << "LV: Loop hints prevent vectorization.\n");
+      return false;
+    }
+
+    PredicatedScalarEvolution PSE(*SE);
+    LoopVectorizationRequirements Requirements;
+    LoopVectorizationLegality LVL(L, PSE, DT, TLI, AA, F, TTI, LAA,
+                                  &Requirements, &Hints);
+    if (!LVL.canVectorizeOuterLoop()) {
+      DEBUG(dbgs() << "LV: Not vectorizing: Cannot prove legality.\n");
+      emitMissedWarning(F, L, Hints);
+      return false;
+    }
+
+    if (F->hasFnAttribute(Attribute::NoImplicitFloat)) {
+      emitAnalysisDiag(
+          F, L, Hints,
+          VectorizationReport()
+              << "loop not vectorized due to NoImplicitFloat attribute");
+      emitMissedWarning(F, L, Hints);
+      return false;
+    }
+
+    OuterLoopVectorizer OLV(L, PSE, LI, DT, TLI, TTI, Hints.getWidth());
+    OLV.vectorize(&LVL, MapVector<Instruction *, uint64_t>());
+    ++LoopsVectorized;
+    ++OuterLoopsVectorized;
+
+    emitOptimizationRemark(F->getContext(), LV_NAME, *F, L->getStartLoc(),
+                           Twine("vectorized outer loop (vectorization "
+                                 "width: ") +
+                               Twine(Hints.getWidth()) + ")");
+
+    // Mark the loop as already vectorized to avoid vectorizing again.
+    Hints.setAlreadyVectorized();
+
+    DEBUG(verifyFunction(*L->getHeader()->getParent()));
+    return true;
+  }
+
+  /// Vectorize \p L, the scalar remainder of the loop that \p MainLB has
+  /// just vectorized, with \p VF and no interleaving. The new loop relies on
+  /// the runtime checks of the main vector loop, so when those fail control
+  /// goes straight to what is left of the scalar loop. Returns false, leaving
+  /// the remainder alone, if that loop would need checks of its own.
+  bool vectorizeEpilogue(Loop *L, InnerLoopVectorizer &MainLB,
+                         PredicatedScalarEvolution &MainPSE,
+                         const MapVector<Instruction *, uint64_t> &MinBWs,
+                         unsigned VF, LoopVectorizeHints &Hints) {
+    Function *F = L->getHeader()->getParent();
+    PredicatedScalarEvolution PSE(*SE);
+    LoopVectorizationRequirements Requirements;
+    LoopVectorizationLegality LVL(L, PSE, DT, TLI, AA, F, TTI, LAA,
+                                  &Requirements, &Hints);
+    if (!LVL.canVectorize()) {
+      DEBUG(dbgs() << "LV: Not vectorizing the epilogue: Cannot prove "
+                      "legality.\n");
+      return false;
+    }
+
+    // The memory checks of the main loop cover the remainder, which accesses
+    // a subset of the same ranges. Any SCEV assumption must be one the main
+    // loop has checked too.
+    if (!MainPSE.getUnionPredicate().implies(&PSE.getUnionPredicate())) {
+      DEBUG(dbgs() << "LV: Not vectorizing the epilogue: it needs SCEV "
+                      "checks of its own.\n");
+      return false;
+    }
+
+    // The exit block is shared with the main vector loop. Give the remainder
+    // one of its own, with the single-entry LCSSA phis the vectorizer expects.
+    SplitBlockPredecessors(L->getExitBlock(), L->getExitingBlock(),
+                           ".epil.exit", DT, LI, /*PreserveLCSSA=*/true);
+
+    InnerLoopVectorizer EpilogueLB(L, PSE, LI, DT, TLI, TTI, VF, 1);
+    EpilogueLB.setSharesSafetyChecks();
+    EpilogueLB.vectorize(&LVL, MinBWs);
+    MainLB.redirectSafetyChecks(EpilogueLB);
+    SE->forgetLoop(L);
+    ++LoopsEpilogueVectorized;
+    return true;
+  }
+
   void getAnalysisUsage(AnalysisUsage &AU) const override {
     AU.addRequired<AssumptionCacheTracker>();
     AU.addRequiredID(LoopSimplifyID);
@@ -2770,6 +2985,7 @@ void InnerLoopVectorizer::emitSCEVChecks(Loop *L, BasicBlock *Bypass) {
   ReplaceInstWithInst(BB->getTerminator(),
                       BranchInst::Create(Bypass, NewBB, SCEVCheck));
   LoopBypassBlocks.push_back(BB);
+  SafetyCheckBlocks.push_back(BB);
   AddedSafetyChecks = true;
 }
 
@@ -2795,6 +3011,7 @@ void InnerLoopVectorizer::emitMemRuntimeChecks(Loop *L,
   ReplaceInstWithInst(BB->getTerminator(),
                       BranchInst::Create(Bypass, NewBB, MemRuntimeCheck));
   LoopBypassBlocks.push_back(BB);
+  SafetyCheckBlocks.push_back(BB);
   AddedSafetyChecks = true;
 }
 
@@ -2880,6 +3097,13 @@ void InnerLoopVectorizer::createEmptyLoop() {
 
   Value *StartIdx = ConstantInt::get(IdxTy, 0);
 
+  // A vectorized epilogue runs without checks of its own, so it must only be
+  // reachable through ours. That includes the way in for short trip counts.
+  if (HasVectorizedEpilogue) {
+    emitSCEVChecks(Lp, ScalarPH);
+    emitMemRuntimeChecks(Lp, ScalarPH);
+  }
+
   // We need to test whether the backedge-taken count is uint##_max. Adding one
   // to it will cause overflow and an incorrect loop trip count in the vector
   // body. In case of overflow we want to directly jump to the scalar remainder
@@ -2888,14 +3112,16 @@ void InnerLoopVectorizer::createEmptyLoop() {
   // Now, compare the new count to zero. If it is zero skip the vector loop and
   // jump to the scalar loop.
   emitVectorLoopEnteredCheck(Lp, ScalarPH);
-  // Generate the code to check any assumptions that we've made for SCEV
-  // expressions.
-  emitSCEVChecks(Lp, ScalarPH);
+  if (!HasVectorizedEpilogue && !SharesSafetyChecks) {
+    // Generate the code to check any assumptions that we've made for SCEV
+    // expressions.
+    emitSCEVChecks(Lp, ScalarPH);
 
-  // Generate the code that checks in runtime if arrays overlap. We put the
-  // checks into a separate block to make the more common case of few elements
-  // faster.
-  emitMemRuntimeChecks(Lp, ScalarPH);
+    // Generate the code that checks in runtime if arrays overlap. We put the
+    // checks into a separate block to make the more common case of few
+    // elements faster.
+    emitMemRuntimeChecks(Lp, ScalarPH);
+  }
   
   // Generate the induction variable.
   // The loop step is equal to the vectorization factor (num of SIMD elements)
@@ -2978,6 +3204,68 @@ void InnerLoopVectorizer::createEmptyLoop() {
   Hints.setAlreadyVectorized();
 }
 
+/// \brief Return the nearest common dominator of the predecessors of \p BB.
+static BasicBlock *findIDomFromPreds(DominatorTree *DT, BasicBlock *BB) {
+  BasicBlock *IDom = nullptr;
+  for (BasicBlock *Pred : predecessors(BB))
+    IDom = IDom ? DT->findNearestCommonDominator(IDom, Pred) : Pred;
+  return IDom;
+}
+
+void InnerLoopVectorizer::redirectSafetyChecks(
+    const InnerLoopVectorizer &Epilogue) {
+  /*
+   The epilogue was built from our scalar loop, so its bypass blocks start
+   with our scalar preheader, and the values its own scalar preheader merges
+   in from them are our resume values:
+
+      [ ] <-- SCEV and memory checks.  ---------.
+       |                                         |
+      [ ] <-- iteration count checks. --.        |
+       |                                 |       |
+      [ ] <-- vector loop.               |       |
+       |                                 |       |
+      [ ] <-- middle block.              |       |
+       |                                 v       |
+      [ ] <-- epilogue checks (our scalar preheader).
+       |                                         |
+      [ ] <-- vectorized epilogue.               |
+       |                                         v
+      [ ] <-- scalar preheader of the epilogue. <-
+   */
+  BasicBlock *ScalarPH = Epilogue.LoopScalarPreHeader;
+  assert(Epilogue.LoopBypassBlocks.front() == LoopScalarPreHeader &&
+         "Epilogue does not start at our scalar preheader");
+
+  for (BasicBlock *CheckBB : SafetyCheckBlocks) {
+    // Coming straight from a failed check, the scalar loop starts where we
+    // would have started it.
+    for (Instruction &I : *ScalarPH) {
+      PHINode *PN = dyn_cast<PHINode>(&I);
+      if (!PN)
+        break;
+      Value *V = PN->getIncomingValueForBlock(LoopScalarPreHeader);
+      PHINode *Resume = dyn_cast<PHINode>(V);
+      if (Resume && Resume->getParent() == LoopScalarPreHeader)
+        V = Resume->getIncomingValueForBlock(CheckBB);
+      PN->addIncoming(V, CheckBB);
+    }
+    LoopScalarPreHeader->removePredecessor(CheckBB,
+                                           /*DontDeleteUselessPHIs=*/true);
+    CheckBB->getTerminator()->replaceUsesOfWith(LoopScalarPreHeader, ScalarPH);
+  }
+
+  // Our scalar preheader is now only reached through the iteration count
+  // checks and the middle block, while the scalar loop and its exit are also
+  // reached from the failed checks.
+  DT->changeImmediateDominator(LoopScalarPreHeader,
+                               findIDomFromPreds(DT, LoopScalarPreHeader));
+  DT->changeImmediateDominator(ScalarPH, findIDomFromPreds(DT, ScalarPH));
+  DT->changeImmediateDominator(Epilogue.LoopExitBlock,
+                               findIDomFromPreds(DT, Epilogue.LoopExitBlock));
+  DEBUG(DT->verifyDomTree());
+}
+
 namespace {
 struct CSEDenseMapInfo {
   static bool canHandle(Instruction *I) {
@@ -3720,240 +4008,243 @@ void InnerLoopVectorizer::widenPHIInstruction(
 
 void InnerLoopVectorizer::vectorizeBlockInLoop(BasicBlock *BB, PhiVector *PV) {
   // For each instruction in the old loop.
-  for (BasicBlock::iterator it = BB->begin(), e = BB->end(); it != e; ++it) {
-    VectorParts &Entry = WidenMap.get(&*it);
+  for (Instruction &I : *BB)
+    widenInstruction(I, PV);
+}
 
-    switch (it->getOpcode()) {
-    case Instruction::Br:
-      // Nothing to do for PHIs and BR, since we already took care of the
-      // loop control flow instructions.
-      continue;
-    case Instruction::PHI: {
-      // Vectorize PHINodes.
-      widenPHIInstruction(&*it, Entry, UF, VF, PV);
-      continue;
-    }// End of PHI.
-
-    case Instruction::Add:
-    case Instruction::FAdd:
-    case Instruction::Sub:
-    case Instruction::FSub:
-    case Instruction::Mul:
-    case Instruction::FMul:
-    case Instruction::UDiv:
-    case Instruction::SDiv:
-    case Instruction::FDiv:
-    case Instruction::URem:
-    case Instruction::SRem:
-    case Instruction::FRem:
-    case Instruction::Shl:
-    case Instruction::LShr:
-    case Instruction::AShr:
-    case Instruction::And:
-    case Instruction::Or:
-    case Instruction::Xor: {
-      // Just widen binops.
-      BinaryOperator *BinOp = dyn_cast<BinaryOperator>(it);
-      setDebugLocFromInst(Builder, BinOp);
-      VectorParts &A = getVectorValue(it->getOperand(0));
-      VectorParts &B = getVectorValue(it->getOperand(1));
-
-      // Use this vector value for all users of the original instruction.
-      for (unsigned Part = 0; Part < UF; ++Part) {
-        Value *V = Builder.CreateBinOp(BinOp->getOpcode(), A[Part], B[Part]);
-
-        if (BinaryOperator *VecOp = dyn_cast<BinaryOperator>(V))
-          VecOp->copyIRFlags(BinOp);
-
-        Entry[Part] = V;
-      }
+void InnerLoopVectorizer::widenInstruction(Instruction &I, PhiVector *PV) {
+  VectorParts &Entry = WidenMap.get(&I);
 
-      propagateMetadata(Entry, &*it);
-      break;
-    }
-    case Instruction::Select: {
-      // Widen selects.
-      // If the selector is loop invariant we can create a select
-      // instruction with a scalar condition. Otherwise, use vector-select.
-      auto *SE = PSE.getSE();
-      bool InvariantCond =
-          SE->isLoopInvariant(PSE.getSCEV(it->getOperand(0)), OrigLoop);
-      setDebugLocFromInst(Builder, &*it);
-
-      // The condition can be loop invariant  but still defined inside the
-      // loop. This means that we can't just use the original 'cond' value.
-      // We have to take the 'vectorized' value and pick the first lane.
-      // Instcombine will make this a no-op.
-      VectorParts &Cond = getVectorValue(it->getOperand(0));
-      VectorParts &Op0  = getVectorValue(it->getOperand(1));
-      VectorParts &Op1  = getVectorValue(it->getOperand(2));
-      
-      Value *ScalarCond = (VF == 1) ? Cond[0] :
-        Builder.CreateExtractElement(Cond[0], Builder.getInt32(0));
-
-      for (unsigned Part = 0; Part < UF; ++Part) {
-        Entry[Part] = Builder.CreateSelect(
-          InvariantCond ? ScalarCond : Cond[Part],
-          Op0[Part],
-          Op1[Part]);
-      }
+  switch (I.getOpcode()) {
+  case Instruction::Br:
+    // Nothing to do for PHIs and BR, since we already took care of the
+    // loop control flow instructions.
+    return;
+  case Instruction::PHI: {
+    // Vectorize PHINodes.
+    widenPHIInstruction(&I, Entry, UF, VF, PV);
+    return;
+  }// End of PHI.
 
-      propagateMetadata(Entry, &*it);
-      break;
+  case Instruction::Add:
+  case Instruction::FAdd:
+  case Instruction::Sub:
+  case Instruction::FSub:
+  case Instruction::Mul:
+  case Instruction::FMul:
+  case Instruction::UDiv:
+  case Instruction::SDiv:
+  case Instruction::FDiv:
+  case Instruction::URem:
+  case Instruction::SRem:
+  case Instruction::FRem:
+  case Instruction::Shl:
+  case Instruction::LShr:
+  case Instruction::AShr:
+  case Instruction::And:
+  case Instruction::Or:
+  case Instruction::Xor: {
+    // Just widen binops.
+    BinaryOperator *BinOp = dyn_cast<BinaryOperator>(&I);
+    setDebugLocFromInst(Builder, BinOp);
+    VectorParts &A = getVectorValue(I.getOperand(0));
+    VectorParts &B = getVectorValue(I.getOperand(1));
+
+    // Use this vector value for all users of the original instruction.
+    for (unsigned Part = 0; Part < UF; ++Part) {
+      Value *V = Builder.CreateBinOp(BinOp->getOpcode(), A[Part], B[Part]);
+
+      if (BinaryOperator *VecOp = dyn_cast<BinaryOperator>(V))
+        VecOp->copyIRFlags(BinOp);
+
+      Entry[Part] = V;
     }
 
-    case Instruction::ICmp:
-    case Instruction::FCmp: {
-      // Widen compares. Generate vector compares.
-      bool FCmp = (it->getOpcode() == Instruction::FCmp);
-      CmpInst *Cmp = dyn_cast<CmpInst>(it);
-      setDebugLocFromInst(Builder, &*it);
-      VectorParts &A = getVectorValue(it->getOperand(0));
-      VectorParts &B = getVectorValue(it->getOperand(1));
-      for (unsigned Part = 0; Part < UF; ++Part) {
-        Value *C = nullptr;
-        if (FCmp) {
-          C = Builder.CreateFCmp(Cmp->getPredicate(), A[Part], B[Part]);
-          cast<FCmpInst>(C)->copyFastMathFlags(&*it);
-        } else {
-          C = Builder.CreateICmp(Cmp->getPredicate(), A[Part], B[Part]);
-        }
-        Entry[Part] = C;
-      }
+    propagateMetadata(Entry, &I);
+    break;
+  }
+  case Instruction::Select: {
+    // Widen selects.
+    // If the selector is loop invariant we can create a select
+    // instruction with a scalar condition. Otherwise, use vector-select.
+    auto *SE = PSE.getSE();
+    bool InvariantCond =
+        SE->isLoopInvariant(PSE.getSCEV(I.getOperand(0)), OrigLoop);
+    setDebugLocFromInst(Builder, &I);
+
+    // The condition can be loop invariant  but still defined inside the
+    // loop. This means that we can't just use the original 'cond' value.
+    // We have to take the 'vectorized' value and pick the first lane.
+    // Instcombine will make this a no-op.
+    VectorParts &Cond = getVectorValue(I.getOperand(0));
+    VectorParts &Op0  = getVectorValue(I.getOperand(1));
+    VectorParts &Op1  = getVectorValue(I.getOperand(2));
+    
+    Value *ScalarCond = (VF == 1) ? Cond[0] :
+      Builder.CreateExtractElement(Cond[0], Builder.getInt32(0));
 
-      propagateMetadata(Entry, &*it);
-      break;
+    for (unsigned Part = 0; Part < UF; ++Part) {
+      Entry[Part] = Builder.CreateSelect(
+        InvariantCond ? ScalarCond : Cond[Part],
+        Op0[Part],
+        Op1[Part]);
     }
 
-    case Instruction::Store:
-    case Instruction::Load:
-      vectorizeMemoryInstruction(&*it);
-        break;
-    case Instruction::ZExt:
-    case Instruction::SExt:
-    case Instruction::FPToUI:
-    case Instruction::FPToSI:
-    case Instruction::FPExt:
-    case Instruction::PtrToInt:
-    case Instruction::IntToPtr:
-    case Instruction::SIToFP:
-    case Instruction::UIToFP:
-    case Instruction::Trunc:
-    case Instruction::FPTrunc:
-    case Instruction::BitCast: {
-      CastInst *CI = dyn_cast<CastInst>(it);
-      setDebugLocFromInst(Builder, &*it);
-      /// Optimize the special case where the source is the induction
-      /// variable. Notice that we can only optimize the 'trunc' case
-      /// because: a. FP conversions lose precision, b. sext/zext may wrap,
-      /// c. other casts depend on pointer size.
-      if (CI->getOperand(0) == OldInduction &&
-          it->getOpcode() == Instruction::Trunc) {
-        Value *ScalarCast = Builder.CreateCast(CI->getOpcode(), Induction,
-                                               CI->getType());
-        Value *Broadcasted = getBroadcastInstrs(ScalarCast);
-        InductionDescriptor II =
-            Legal->getInductionVars()->lookup(OldInduction);
-        Constant *Step = ConstantInt::getSigned(
-            CI->getType(), II.getStepValue()->getSExtValue());
-        for (unsigned Part = 0; Part < UF; ++Part)
-          Entry[Part] = getStepVector(Broadcasted, VF * Part, Step);
-        propagateMetadata(Entry, &*it);
-        break;
+    propagateMetadata(Entry, &I);
+    break;
+  }
+
+  case Instruction::ICmp:
+  case Instruction::FCmp: {
+    // Widen compares. Generate vector compares.
+    bool FCmp = (I.getOpcode() == Instruction::FCmp);
+    CmpInst *Cmp = dyn_cast<CmpInst>(&I);
+    setDebugLocFromInst(Builder, &I);
+    VectorParts &A = getVectorValue(I.getOperand(0));
+    VectorParts &B = getVectorValue(I.getOperand(1));
+    for (unsigned Part = 0; Part < UF; ++Part) {
+      Value *C = nullptr;
+      if (FCmp) {
+        C = Builder.CreateFCmp(Cmp->getPredicate(), A[Part], B[Part]);
+        cast<FCmpInst>(C)->copyFastMathFlags(&I);
+      } else {
+        C = Builder.CreateICmp(Cmp->getPredicate(), A[Part], B[Part]);
       }
-      /// Vectorize casts.
-      Type *DestTy = (VF == 1) ? CI->getType() :
-                                 VectorType::get(CI->getType(), VF);
+      Entry[Part] = C;
+    }
 
-      VectorParts &A = getVectorValue(it->getOperand(0));
+    propagateMetadata(Entry, &I);
+    break;
+  }
+
+  case Instruction::Store:
+  case Instruction::Load:
+    vectorizeMemoryInstruction(&I);
+      break;
+  case Instruction::ZExt:
+  case Instruction::SExt:
+  case Instruction::FPToUI:
+  case Instruction::FPToSI:
+  case Instruction::FPExt:
+  case Instruction::PtrToInt:
+  case Instruction::IntToPtr:
+  case Instruction::SIToFP:
+  case Instruction::UIToFP:
+  case Instruction::Trunc:
+  case Instruction::FPTrunc:
+  case Instruction::BitCast: {
+    CastInst *CI = dyn_cast<CastInst>(&I);
+    setDebugLocFromInst(Builder, &I);
+    /// Optimize the special case where the source is the induction
+    /// variable. Notice that we can only optimize the 'trunc' case
+    /// because: a. FP conversions lose precision, b. sext/zext may wrap,
+    /// c. other casts depend on pointer size.
+    if (CI->getOperand(0) == OldInduction &&
+        I.getOpcode() == Instruction::Trunc) {
+      Value *ScalarCast = Builder.CreateCast(CI->getOpcode(), Induction,
+                                             CI->getType());
+      Value *Broadcasted = getBroadcastInstrs(ScalarCast);
+      InductionDescriptor II =
+          Legal->getInductionVars()->lookup(OldInduction);
+      Constant *Step = ConstantInt::getSigned(
+          CI->getType(), II.getStepValue()->getSExtValue());
       for (unsigned Part = 0; Part < UF; ++Part)
-        Entry[Part] = Builder.CreateCast(CI->getOpcode(), A[Part], DestTy);
-      propagateMetadata(Entry, &*it);
+        Entry[Part] = getStepVector(Broadcasted, VF * Part, Step);
+      propagateMetadata(Entry, &I);
       break;
     }
+    /// Vectorize casts.
+    Type *DestTy = (VF == 1) ? CI->getType() :
+                               VectorType::get(CI->getType(), VF);
 
-    case Instruction::Call: {
-      // Ignore dbg intrinsics.
-      if (isa<DbgInfoIntrinsic>(it))
-        break;
-      setDebugLocFromInst(Builder, &*it);
-
-      Module *M = BB->getParent()->getParent();
-      CallInst *CI = cast<CallInst>(it);
-
-      StringRef FnName = CI->getCalledFunction()->getName();
-      Function *F = CI->getCalledFunction();
-      Type *RetTy = ToVectorTy(CI->getType(), VF);
-      SmallVector<Type *, 4> Tys;
-      for (unsigned i = 0, ie = CI->getNumArgOperands(); i != ie; ++i)
-        Tys.push_back(ToVectorTy(CI->getArgOperand(i)->getType(), VF));
-
-      Intrinsic::ID ID = getIntrinsicIDForCall(CI, TLI);
-      if (ID &&
-          (ID == Intrinsic::assume || ID == Intrinsic::lifetime_end ||
-           ID == Intrinsic::lifetime_start)) {
-        scalarizeInstruction(&*it);
-        break;
-      }
-      // The flag shows whether we use Intrinsic or a usual Call for vectorized
-      // version of the instruction.
-      // Is it beneficial to perform intrinsic call compared to lib call?
-      bool NeedToScalarize;
-      unsigned CallCost = getVectorCallCost(CI, VF, *TTI, TLI, NeedToScalarize);
-      bool UseVectorIntrinsic =
-          ID && getVectorIntrinsicCost(CI, VF, *TTI, TLI) <= CallCost;
-      if (!UseVectorIntrinsic && NeedToScalarize) {
-        scalarizeInstruction(&*it);
-        break;
-      }
+    VectorParts &A = getVectorValue(I.getOperand(0));
+    for (unsigned Part = 0; Part < UF; ++Part)
+      Entry[Part] = Builder.CreateCast(CI->getOpcode(), A[Part], DestTy);
+    propagateMetadata(Entry, &I);
+    break;
+  }
 
-      for (unsigned Part = 0; Part < UF; ++Part) {
-        SmallVector<Value *, 4> Args;
-        for (unsigned i = 0, ie = CI->getNumArgOperands(); i != ie; ++i) {
-          Value *Arg = CI->getArgOperand(i);
-          // Some intrinsics have a scalar argument - don't replace it with a
-          // vector.
-          if (!UseVectorIntrinsic || !hasVectorInstrinsicScalarOpd(ID, i)) {
-            VectorParts &VectorArg = getVectorValue(CI->getArgOperand(i));
-            Arg = VectorArg[Part];
-          }
-          Args.push_back(Arg);
-        }
+  case Instruction::Call: {
+    // Ignore dbg intrinsics.
+    if (isa<DbgInfoIntrinsic>(&I))
+      break;
+    setDebugLocFromInst(Builder, &I);
+
+    Module *M = I.getModule();
+    CallInst *CI = cast<CallInst>(&I);
+
+    StringRef FnName = CI->getCalledFunction()->getName();
+    Function *F = CI->getCalledFunction();
+    Type *RetTy = ToVectorTy(CI->getType(), VF);
+    SmallVector<Type *, 4> Tys;
+    for (unsigned i = 0, ie = CI->getNumArgOperands(); i != ie; ++i)
+      Tys.push_back(ToVectorTy(CI->getArgOperand(i)->getType(), VF));
+
+    Intrinsic::ID ID = getIntrinsicIDForCall(CI, TLI);
+    if (ID &&
+        (ID == Intrinsic::assume || ID == Intrinsic::lifetime_end ||
+         ID == Intrinsic::lifetime_start)) {
+      scalarizeInstruction(&I);
+      break;
+    }
+    // The flag shows whether we use Intrinsic or a usual Call for vectorized
+    // version of the instruction.
+    // Is it beneficial to perform intrinsic call compared to lib call?
+    bool NeedToScalarize;
+    unsigned CallCost = getVectorCallCost(CI, VF, *TTI, TLI, NeedToScalarize);
+    bool UseVectorIntrinsic =
+        ID && getVectorIntrinsicCost(CI, VF, *TTI, TLI) <= CallCost;
+    if (!UseVectorIntrinsic && NeedToScalarize) {
+      scalarizeInstruction(&I);
+      break;
+    }
 
-        Function *VectorF;
-        if (UseVectorIntrinsic) {
-          // Use vector version of the intrinsic.
-          Type *TysForDecl[] = {CI->getType()};
-          if (VF > 1)
-            TysForDecl[0] = VectorType::get(CI->getType()->getScalarType(), VF);
-          VectorF = Intrinsic::getDeclaration(M, ID, TysForDecl);
-        } else {
-          // Use vector version of the library call.
-          StringRef VFnName = TLI->getVectorizedFunction(FnName, VF);
-          assert(!VFnName.empty() && "Vector function name is empty.");
-          VectorF = M->getFunction(VFnName);
-          if (!VectorF) {
-            // Generate a declaration
-            FunctionType *FTy = FunctionType::get(RetTy, Tys, false);
-            VectorF =
-                Function::Create(FTy, Function::ExternalLinkage, VFnName, M);
-            VectorF->copyAttributesFrom(F);
-          }
+    for (unsigned Part = 0; Part < UF; ++Part) {
+      SmallVector<Value *, 4> Args;
+      for (unsigned i = 0, ie = CI->getNumArgOperands(); i != ie; ++i) {
+        Value *Arg = CI->getArgOperand(i);
+        // Some intrinsics have a scalar argument - don't replace it with a
+        // vector.
+        if (!UseVectorIntrinsic || !hasVectorInstrinsicScalarOpd(ID, i)) {
+          VectorParts &VectorArg = getVectorValue(CI->getArgOperand(i));
+          Arg = VectorArg[Part];
         }
-        assert(VectorF && "Can't create vector function.");
-        Entry[Part] = Builder.CreateCall(VectorF, Args);
+        Args.push_back(Arg);
       }
 
-      propagateMetadata(Entry, &*it);
-      break;
+      Function *VectorF;
+      if (UseVectorIntrinsic) {
+        // Use vector version of the intrinsic.
+        Type *TysForDecl[] = {CI->getType()};
+        if (VF > 1)
+          TysForDecl[0] = VectorType::get(CI->getType()->getScalarType(), VF);
+        VectorF = Intrinsic::getDeclaration(M, ID, TysForDecl);
+      } else {
+        // Use vector version of the library call.
+        StringRef VFnName = TLI->getVectorizedFunction(FnName, VF);
+        assert(!VFnName.empty() && "Vector function name is empty.");
+        VectorF = M->getFunction(VFnName);
+        if (!VectorF) {
+          // Generate a declaration
+          FunctionType *FTy = FunctionType::get(RetTy, Tys, false);
+          VectorF =
+              Function::Create(FTy, Function::ExternalLinkage, VFnName, M);
+          VectorF->copyAttributesFrom(F);
+        }
+      }
+      assert(VectorF && "Can't create vector function.");
+      Entry[Part] = Builder.CreateCall(VectorF, Args);
     }
 
-    default:
-      // All other instructions are unsupported. Scalarize them.
-      scalarizeInstruction(&*it);
-      break;
-    }// end of switch.
-  }// end of for_each instr.
+    propagateMetadata(Entry, &I);
+    break;
+  }
+
+  default:
+    // All other instructions are unsupported. Scalarize them.
+    scalarizeInstruction(&I);
+    break;
+  }// end of switch.
 }
 
 void InnerLoopVectorizer::updateAnalysis() {
@@ -4393,6 +4684,208 @@ bool LoopVectorizationLegality::canVectorizeInstrs() {
   return true;
 }
 
+bool LoopVectorizationLegality::canVectorizeOuterLoop() {
+  // The outer loop must be in the same canonical, bottom-tested form as the
+  // innermost loops we vectorize.
+  BasicBlock *Header = TheLoop->getHeader();
+  BasicBlock *Latch = TheLoop->getLoopLatch();
+  if (!TheLoop->getLoopPreheader() || !Latch || !TheLoop->getExitBlock() ||
+      TheLoop->getExitingBlock() != Latch) {
+    emitAnalysis(VectorizationReport()
+                 << "loop control flow is not understood by vectorizer");
+    return false;
+  }
+
+  // It must contain a single innermost loop, made of a single block.
+  if (TheLoop->getSubLoops().size() != 1 || !(*TheLoop->begin())->empty()) {
+    emitAnalysis(VectorizationReport()
+                 << "outer loop does not contain a single innermost loop");
+    return false;
+  }
+  Loop *InnerLoop = *TheLoop->begin();
+  BasicBlock *InnerHeader = InnerLoop->getHeader();
+  BranchInst *InnerBr = dyn_cast<BranchInst>(InnerHeader->getTerminator());
+  if (InnerLoop->getNumBlocks() != 1 || !InnerLoop->getLoopPreheader() ||
+      !InnerLoop->getExitBlock() || InnerLoop->contains(Latch) || !InnerBr ||
+      !InnerBr->isConditional()) {
+    emitAnalysis(VectorizationReport()
+                 << "inner loop control flow is not understood by vectorizer");
+    return false;
+  }
+
+  // Apart from the inner loop and the latch, the blocks of the outer loop
+  // must form a straight line.
+  for (BasicBlock *BB : TheLoop->blocks()) {
+    if (BB == Latch || InnerLoop->contains(BB))
+      continue;
+    BranchInst *BI = dyn_cast<BranchInst>(BB->getTerminator());
+    if (!BI || BI->isConditional()) {
+      emitAnalysis(VectorizationReport(BB->getTerminator())
+                   << "control flow in the outer loop cannot be vectorized");
+      return false;
+    }
+  }
+
+  // ScalarEvolution needs to be able to find the exit count.
+  if (PSE.getSE()->getBackedgeTakenCount(TheLoop) ==
+      PSE.getSE()->getCouldNotCompute()) {
+    emitAnalysis(VectorizationReport()
+                 << "could not determine number of loop iterations");
+    DEBUG(dbgs() << "LV: SCEV could not compute the loop exit count.\n");
+    return false;
+  }
+
+  // LoopAccessAnalysis only handles innermost loops, so the memory accesses
+  // of the outer iterations must be annotated as independent with
+  // llvm.mem.parallel_loop_access. The vectorize hints alone only ask for
+  // vectorization if it is legal.
+  if (!TheLoop->isAnnotatedParallel()) {
+    emitAnalysis(VectorizationReport()
+                 << "cannot prove that the outer loop iterations are "
+                    "independent");
+    DEBUG(dbgs() << "LV: Outer loop is not annotated as parallel.\n");
+    return false;
+  }
+
+  const DataLayout &DL = Header->getModule()->getDataLayout();
+  for (BasicBlock *BB : TheLoop->blocks()) {
+    for (Instruction &I : *BB) {
+      if (PHINode *Phi = dyn_cast<PHINode>(&I)) {
+        if (BB == InnerHeader)
+          continue;
+
+        // The PHIs in the rest of the straight line only have one incoming
+        // value, such as the LCSSA PHIs of the inner loop.
+        if (BB != Header) {
+          if (Phi->getNumIncomingValues() != 1) {
+            emitAnalysis(VectorizationReport(Phi)
+                         << "control flow not understood by vectorizer");
+            return false;
+          }
+          continue;
+        }
+
+        // Reductions across the iterations of the outer loop are not
+        // supported yet, so the header PHIs must all be inductions.
+        InductionDescriptor ID;
+        if (!InductionDescriptor::isInductionPHI(Phi, PSE.getSE(), ID)) {
+          emitAnalysis(VectorizationReport(Phi)
+                       << "value could not be identified as "
+                          "an induction variable");
+          return false;
+        }
+        Inductions[Phi] = ID;
+        Type *PhiTy = Phi->getType();
+        if (!WidestIndTy)
+          WidestIndTy = convertPointerToIntegerType(DL, PhiTy);
+        else
+          WidestIndTy = getWiderType(DL, PhiTy, WidestIndTy);
+        if (ID.getKind() == InductionDescriptor::IK_IntInduction &&
+            ID.getStepValue()->isOne() && isa<Constant>(ID.getStartValue()) &&
+            cast<Constant>(ID.getStartValue())->isNullValue() &&
+            (!Induction || PhiTy == WidestIndTy))
+          Induction = Phi;
+        continue;
+      }
+
+      if (isa<DbgInfoIntrinsic>(&I))
+        continue;
+      if (isa<CallInst>(&I)) {
+        emitAnalysis(VectorizationReport(&I)
+                     << "call instruction cannot be vectorized");
+        return false;
+      }
+      if (I.mayHaveSideEffects() && !isa<StoreInst>(&I)) {
+        emitAnalysis(VectorizationReport(&I)
+                     << "instruction cannot be vectorized");
+        return false;
+      }
+      if (LoadInst *LI = dyn_cast<LoadInst>(&I))
+        if (!LI->isSimple()) {
+          emitAnalysis(VectorizationReport(LI)
+                       << "read with atomic ordering or volatile read");
+          return false;
+        }
+      if (StoreInst *SI = dyn_cast<StoreInst>(&I))
+        if (!SI->isSimple() ||
+            !VectorType::isValidElementType(
+                SI->getValueOperand()->getType())) {
+          emitAnalysis(VectorizationReport(SI)
+                       << "store instruction cannot be vectorized");
+          return false;
+        }
+
+      // Check that the instruction return type is vectorizable.
+      if ((!VectorType::isValidElementType(I.getType()) &&
+           !I.getType()->isVoidTy()) || isa<ExtractElementInst>(&I)) {
+        emitAnalysis(VectorizationReport(&I)
+                     << "instruction return type cannot be vectorized");
+        return false;
+      }
+
+      if (hasOutsideLoopUser(TheLoop, &I, AllowedExit)) {
+        emitAnalysis(VectorizationReport(&I)
+                     << "value cannot be used outside the loop");
+        return false;
+      }
+    }
+  }
+
+  if (Inductions.empty()) {
+    emitAnalysis(VectorizationReport()
+                 << "loop induction variable could not be identified");
+    return false;
+  }
+  if (Induction && WidestIndTy != Induction->getType())
+    Induction = nullptr;
+
+  // The values that depend on the induction variables of the outer loop
+  // differ from lane to lane. Everything else is uniform: it is the same for
+  // all of the lanes, and stays scalar.
+  SmallPtrSet<Instruction *, 32> Varying;
+  SmallVector<Instruction *, 32> Worklist;
+  for (auto &Ind : Inductions) {
+    Varying.insert(Ind.first);
+    Worklist.push_back(Ind.first);
+  }
+  while (!Worklist.empty()) {
+    Instruction *I = Worklist.pop_back_val();
+    for (User *U : I->users()) {
+      Instruction *UI = cast<Instruction>(U);
+      if (TheLoop->contains(UI) && Varying.insert(UI).second)
+        Worklist.push_back(UI);
+    }
+  }
+
+  // All of the lanes must agree on when to leave the inner loop.
+  Instruction *InnerCond = dyn_cast<Instruction>(InnerBr->getCondition());
+  if (InnerCond && Varying.count(InnerCond)) {
+    emitAnalysis(VectorizationReport(InnerBr)
+                 << "inner loop control flow is not uniform across the "
+                    "vectorized iterations");
+    return false;
+  }
+
+  for (BasicBlock *BB : TheLoop->blocks())
+    for (Instruction &I : *BB) {
+      // The lanes of a store must not all write to the same address.
+      if (StoreInst *SI = dyn_cast<StoreInst>(&I)) {
+        Instruction *Ptr = dyn_cast<Instruction>(SI->getPointerOperand());
+        if (!Ptr || !Varying.count(Ptr)) {
+          emitAnalysis(VectorizationReport(SI)
+                       << "write to a loop invariant address could not be "
+                          "vectorized");
+          return false;
+        }
+      }
+      if (!Varying.count(&I) && !isa<TerminatorInst>(&I))
+        Uniforms.insert(&I);
+    }
+
+  DEBUG(dbgs() << "LV: We can vectorize this outer loop!\n");
+  return true;
+}
+
 void LoopVectorizationLegality::collectStridedAccess(Value *MemAccess) {
   Value *Ptr = nullptr;
   if (LoadInst *LI = dyn_cast<LoadInst>(MemAccess))
@@ -4857,6 +5350,36 @@ LoopVectorizationCostModel::selectVectorizationFactor(bool OptForSize) {
   return Factor;
 }
 
+unsigned LoopVectorizationCostModel::selectEpilogueVectorizationFactor(
+    bool OptForSize, unsigned MainVF, unsigned MainIC) {
+  if (!EnableEpilogueVectorization || OptForSize ||
+      MainVF * MainIC < EpilogueVectorizationMinWidth)
+    return 1;
+
+  // The epilogue handles fewer than MainVF * MainIC iterations. Without
+  // interleaving, a vector of MainVF elements still fits in there if the main
+  // loop was interleaved.
+  unsigned VF = MainIC > 1 ? MainVF : MainVF / 2;
+
+  // With a known trip count, there is no point in a vector epilogue that the
+  // remainder is too short to enter.
+  unsigned TC = PSE.getSE()->getSmallConstantTripCount(TheLoop);
+  unsigned Remainder = TC ? TC % (MainVF * MainIC) : -1U;
+
+  float ScalarCost = expectedCost(1);
+  for (; VF > 1; VF /= 2) {
+    if (VF > Remainder)
+      continue;
+    float VectorCost = expectedCost(VF) / (float)VF;
+    DEBUG(dbgs() << "LV: Vector epilogue of width " << VF << " costs: "
+                 << (int)VectorCost << ".\n");
+    if (VectorCost < ScalarCost)
+      break;
+  }
+  DEBUG(dbgs() << "LV: Selecting epilogue VF: " << VF << ".\n");
+  return VF;
+}
+
 std::pair<unsigned, unsigned>
 LoopVectorizationCostModel::getSmallestAndWidestTypes() {
   unsigned MinWidth = -1U;
@@ -5821,3 +6344,217 @@ Value *InnerLoopUnroller::getStepVector(Value *Val, int StartIdx, Value *Step) {
   Constant *C = ConstantInt::get(ITy, StartIdx);
   return Builder.CreateAdd(Val, Builder.CreateMul(C, Step), "induction");
 }
+
+void OuterLoopVectorizer::vectorizeLoop() {
+  /*
+   The single block vector body created by createEmptyLoop is split around a
+   copy of the inner loop:
+
+      [ ]     <-- vector.body: the outer loop up to the inner loop.
+       |
+      [ ] \
+      [ ]_|   <-- vector.inner: the inner loop, run once for all lanes.
+       |
+      [ ]     <-- vector.latch: the rest of the outer loop.
+   */
+  // Register the new blocks in the dominator tree while the vector body is
+  // still a single block. SplitBlock keeps it up to date from there.
+  updateAnalysis();
+
+  Loop *InnerLoop = *OrigLoop->begin();
+  BasicBlock *InnerHeader = InnerLoop->getHeader();
+  BasicBlock *VecBody = LoopVectorBody[0];
+  Loop *VectorLoop = LI->getLoopFor(VecBody);
+  Instruction *IndexNext =
+      cast<Instruction>(Induction->getIncomingValueForBlock(VecBody));
+  BasicBlock *VecInner = SplitBlock(VecBody, IndexNext, DT);
+  BasicBlock *VecLatch = SplitBlock(VecInner, IndexNext, DT);
+  VecInner->setName("vector.inner");
+  VecLatch->setName("vector.latch");
+  LoopVectorBody.push_back(VecInner);
+  LoopVectorBody.push_back(VecLatch);
+
+  Loop *VectorInnerLoop = new Loop();
+  VectorLoop->addChildLoop(VectorInnerLoop);
+  VectorInnerLoop->addBasicBlockToLoop(VecInner, *LI);
+  VectorLoop->addBasicBlockToLoop(VecLatch, *LI);
+
+  // The outer loop has no reductions, so this stays empty.
+  PhiVector RdxPHIsToFix;
+  // The PHIs of the inner loop, whose backedge values are filled in once its
+  // body has been emitted.
+  SmallVector<std::pair<PHINode *, PHINode *>, 4> InnerPHIs;
+
+  // Scan the loop in a topological order to ensure that defs are vectorized
+  // before users. The blocks of the outer loop form a straight line, so this
+  // visits the inner loop after everything that comes before it.
+  LoopBlocksDFS DFS(OrigLoop);
+  DFS.perform(LI);
+
+  Builder.SetInsertPoint(VecBody->getTerminator());
+  for (LoopBlocksDFS::RPOIterator bb = DFS.beginRPO(), be = DFS.endRPO();
+       bb != be; ++bb) {
+    BasicBlock *BB = *bb;
+    if (BB == InnerHeader)
+      Builder.SetInsertPoint(VecInner->getTerminator());
+
+    for (Instruction &I : *BB) {
+      if (isa<BranchInst>(&I) || isa<DbgInfoIntrinsic>(&I))
+        continue;
+      bool Uniform = Legal->isUniformAfterVectorization(&I);
+      PHINode *Phi = dyn_cast<PHINode>(&I);
+
+      if (Phi && BB == InnerHeader) {
+        // Uniform PHIs, such as the induction variables of the inner loop,
+        // stay scalar. The others become vector PHIs.
+        Value *Start =
+            Phi->getIncomingValueForBlock(InnerLoop->getLoopPreheader());
+        Instruction *InsertPt = &*VecInner->getFirstInsertionPt();
+        PHINode *NewPhi;
+        if (Uniform) {
+          NewPhi = PHINode::Create(Phi->getType(), 2, Phi->getName(),
+                                   InsertPt);
+          NewPhi->addIncoming(getUniformValue(Start), VecBody);
+          UniformMap[Phi] = NewPhi;
+          WidenMap.splat(Phi, getBroadcastInstrs(NewPhi));
+        } else {
+          NewPhi = PHINode::Create(VectorType::get(Phi->getType(), VF), 2,
+                                   "vec.phi", InsertPt);
+          NewPhi->addIncoming(getVectorValue(Start)[0], VecBody);
+          WidenMap.splat(Phi, NewPhi);
+        }
+        InnerPHIs.push_back(std::make_pair(Phi, NewPhi));
+        continue;
+      }
+
+      if (Phi && BB != OrigLoop->getHeader()) {
+        // Single entry PHIs just forward their incoming value.
+        Value *In = Phi->getIncomingValue(0);
+        if (Uniform)
+          UniformMap[Phi] = getUniformValue(In);
+        WidenMap.splat(Phi, getVectorValue(In)[0]);
+        continue;
+      }
+
+      if (Uniform)
+        cloneUniformInstruction(I);
+      else
+        widenInstruction(I, &RdxPHIsToFix);
+    }
+
+    if (BB != InnerHeader)
+      continue;
+
+    // Close the inner loop.
+    for (auto &P : InnerPHIs) {
+      Value *Next = P.first->getIncomingValueForBlock(InnerHeader);
+      Value *NewNext = Legal->isUniformAfterVectorization(P.first)
+                           ? getUniformValue(Next)
+                           : getVectorValue(Next)[0];
+      P.second->addIncoming(NewNext, VecInner);
+    }
+    BranchInst *Br = cast<BranchInst>(InnerHeader->getTerminator());
+    bool ExitOnTrue = Br->getSuccessor(0) != InnerHeader;
+    BranchInst *NewBr =
+        BranchInst::Create(ExitOnTrue ? VecLatch : VecInner,
+                           ExitOnTrue ? VecInner : VecLatch,
+                           getUniformValue(Br->getCondition()));
+    NewBr->setDebugLoc(Br->getDebugLoc());
+    ReplaceInstWithInst(VecInner->getTerminator(), NewBr);
+    Builder.SetInsertPoint(IndexNext);
+  }
+  assert(RdxPHIsToFix.empty() && "Unexpected reduction in the outer loop");
+
+  fixLCSSAPHIs();
+  DEBUG(DT->verifyDomTree());
+  // Remove redundant induction instructions.
+  cse(LoopVectorBody);
+}
+
+void OuterLoopVectorizer::cloneUniformInstruction(Instruction &I) {
+  setDebugLocFromInst(Builder, &I);
+  Instruction *Cloned = I.clone();
+  for (unsigned Op = 0, E = I.getNumOperands(); Op != E; ++Op)
+    Cloned->setOperand(Op, getUniformValue(I.getOperand(Op)));
+  Builder.Insert(Cloned, I.getName());
+  UniformMap[&I] = Cloned;
+
+  // Widened users see the same value in every lane.
+  if (!I.getType()->isVoidTy())
+    WidenMap.splat(&I, getBroadcastInstrs(Cloned));
+}
+
+Value *OuterLoopVectorizer::getUniformValue(Value *V) {
+  // Values from outside of the loop are used as they are.
+  Instruction *I = dyn_cast<Instruction>(V);
+  if (!I || !OrigLoop->contains(I))
+    return V;
+  assert(UniformMap.count(I) && "Uniform value is unavailable");
+  return UniformMap[I];
+}
+
+int64_t OuterLoopVectorizer::getOuterLoopStride(Value *Ptr) {
+  ScalarEvolution *SE = PSE.getSE();
+  const SCEV *S = SE->getSCEV(Ptr);
+  // Inside the inner loop, the address is a recurrence of the inner loop
+  // starting from the address of its first iteration. If its step is the
+  // same for all lanes, the lanes are as far apart as those starting
+  // addresses are.
+  while (const SCEVAddRecExpr *AR = dyn_cast<SCEVAddRecExpr>(S)) {
+    if (!AR->isAffine())
+      return 0;
+    const SCEV *Step = AR->getStepRecurrence(*SE);
+    if (AR->getLoop() == OrigLoop) {
+      const SCEVConstant *C = dyn_cast<SCEVConstant>(Step);
+      return C ? C->getValue()->getSExtValue() : 0;
+    }
+    if (!OrigLoop->contains(AR->getLoop()) ||
+        !SE->isLoopInvariant(Step, OrigLoop))
+      return 0;
+    S = AR->getStart();
+  }
+  return 0;
+}
+
+void OuterLoopVectorizer::vectorizeMemoryInstruction(Instruction *Instr) {
+  LoadInst *LI = dyn_cast<LoadInst>(Instr);
+  StoreInst *SI = dyn_cast<StoreInst>(Instr);
+  assert((LI || SI) && "Invalid Load/Store instruction");
+
+  Type *ScalarDataTy = LI ? LI->getType() : SI->getValueOperand()->getType();
+  Type *DataTy = VectorType::get(ScalarDataTy, VF);
+  Value *Ptr = LI ? LI->getPointerOperand() : SI->getPointerOperand();
+  unsigned Alignment = LI ? LI->getAlignment() : SI->getAlignment();
+  const DataLayout &DL = Instr->getModule()->getDataLayout();
+  if (!Alignment)
+    Alignment = DL.getABITypeAlignment(ScalarDataTy);
+  unsigned AddressSpace = Ptr->getType()->getPointerAddressSpace();
+  int64_t ScalarAllocatedSize = DL.getTypeAllocSize(ScalarDataTy);
+  int64_t VectorElementSize = DL.getTypeStoreSize(DataTy) / VF;
+
+  // Unless consecutive iterations of the outer loop access consecutive
+  // elements, access the memory one lane at a time.
+  if (ScalarAllocatedSize != VectorElementSize ||
+      getOuterLoopStride(Ptr) != ScalarAllocatedSize)
+    return scalarizeInstruction(Instr);
+
+  // The vector starts at the address of the first lane.
+  setDebugLocFromInst(Builder, Ptr);
+  Value *FirstPtr =
+      Builder.CreateExtractElement(getVectorValue(Ptr)[0], Builder.getInt32(0));
+  Value *VecPtr =
+      Builder.CreateBitCast(FirstPtr, DataTy->getPointerTo(AddressSpace));
+
+  if (SI) {
+    setDebugLocFromInst(Builder, SI);
+    Value *StoredVal = getVectorValue(SI->getValueOperand())[0];
+    propagateMetadata(Builder.CreateAlignedStore(StoredVal, VecPtr, Alignment),
+                      SI);
+    return;
+  }
+
+  setDebugLocFromInst(Builder, LI);
+  Instruction *NewLI = Builder.CreateAlignedLoad(VecPtr, Alignment, "wide.load");
+  propagateMetadata(NewLI, LI);
+  WidenMap.splat(LI, NewLI);
+}
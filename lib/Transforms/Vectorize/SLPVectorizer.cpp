@@ -1687,7 +1687,12 @@ bool BoUpSLP::isFullyVectorizableTinyTree() {
   DEBUG(dbgs() << "SLP: Check whether the tree with height " <<
         VectorizableTree.size() << " is fully vectorizable .\n");
 
-  // We only handle trees of height 2.
+  // A single bundle that feeds a horizontal reduction is consumed whole by
+  // the reduction, so it is worth costing if it needs no gather.
+  if (VectorizableTree.size() == 1)
+    return !UserIgnoreList.empty() && !VectorizableTree[0].NeedToGather;
+
+  // Otherwise we only handle trees of height 2.
   if (VectorizableTree.size() != 2)
     return false;
 
@@ -3617,11 +3622,75 @@ static Value *createRdxShuffleMask(unsigned VecLen, unsigned NumEltsToRdx,
 }
 
 
+/// \brief Return the predicate of the min/max operation computed by \p I, a
+/// select of the operands of a compare that feeds only the select, or
+/// BAD_ICMP_PREDICATE if \p I is not a min/max.
+///
+/// The predicate is canonicalized so that \p I selects its left-hand operand
+/// when the predicate is true, and to one of ICMP_SGT, ICMP_SLT, ICMP_UGT,
+/// ICMP_ULT, FCMP_OGT and FCMP_OLT. Floating-point compares are only accepted
+/// if NaNs and the sign of zero can be ignored, because either makes the order
+/// of the reduction observable.
+static CmpInst::Predicate getMinMaxPredicate(Instruction *I) {
+  SelectInst *Select = dyn_cast<SelectInst>(I);
+  if (!Select)
+    return CmpInst::BAD_ICMP_PREDICATE;
+  CmpInst *Cmp = dyn_cast<CmpInst>(Select->getCondition());
+  if (!Cmp || !Cmp->hasOneUse() || Cmp->getParent() != Select->getParent())
+    return CmpInst::BAD_ICMP_PREDICATE;
+
+  CmpInst::Predicate Pred = Cmp->getPredicate();
+  Value *LHS = Cmp->getOperand(0);
+  Value *RHS = Cmp->getOperand(1);
+  if (Select->getTrueValue() == RHS && Select->getFalseValue() == LHS)
+    Pred = CmpInst::getSwappedPredicate(Pred);
+  else if (Select->getTrueValue() != LHS || Select->getFalseValue() != RHS)
+    return CmpInst::BAD_ICMP_PREDICATE;
+
+  if (isa<FCmpInst>(Cmp)) {
+    const Function *F = Select->getParent()->getParent();
+    if (!Cmp->hasNoNaNs() &&
+        F->getFnAttribute("no-nans-fp-math").getValueAsString() != "true")
+      return CmpInst::BAD_ICMP_PREDICATE;
+    if (!Cmp->hasNoSignedZeros() &&
+        F->getFnAttribute("no-signed-zeros-fp-math").getValueAsString() !=
+            "true")
+      return CmpInst::BAD_ICMP_PREDICATE;
+  }
+
+  switch (Pred) {
+  case CmpInst::ICMP_SGT:
+  case CmpInst::ICMP_SGE:
+    return CmpInst::ICMP_SGT;
+  case CmpInst::ICMP_SLT:
+  case CmpInst::ICMP_SLE:
+    return CmpInst::ICMP_SLT;
+  case CmpInst::ICMP_UGT:
+  case CmpInst::ICMP_UGE:
+    return CmpInst::ICMP_UGT;
+  case CmpInst::ICMP_ULT:
+  case CmpInst::ICMP_ULE:
+    return CmpInst::ICMP_ULT;
+  case CmpInst::FCMP_OGT:
+  case CmpInst::FCMP_OGE:
+  case CmpInst::FCMP_UGT:
+  case CmpInst::FCMP_UGE:
+    return CmpInst::FCMP_OGT;
+  case CmpInst::FCMP_OLT:
+  case CmpInst::FCMP_OLE:
+  case CmpInst::FCMP_ULT:
+  case CmpInst::FCMP_ULE:
+    return CmpInst::FCMP_OLT;
+  default:
+    return CmpInst::BAD_ICMP_PREDICATE;
+  }
+}
+
 /// Model horizontal reductions.
 ///
-/// A horizontal reduction is a tree of reduction operations (currently add and
-/// fadd) that has operations that can be put into a vector as its leaf.
-/// For example, this tree:
+/// A horizontal reduction is a tree of reduction operations (add, fadd, and,
+/// or, xor, or an integer or floating-point min/max) that has operations that
+/// can be put into a vector as its leaf. For example, this tree:
 ///
 /// mul mul mul mul
 ///  \  /    \  /
@@ -3644,31 +3713,37 @@ static Value *createRdxShuffleMask(unsigned VecLen, unsigned NumEltsToRdx,
 ///     |
 ///   *p =
 ///
+/// A min/max reduction operation is a select of the operands of a compare;
+/// both are reduction operations.
+///
 class HorizontalReduction {
   SmallVector<Value *, 16> ReductionOps;
   SmallVector<Value *, 32> ReducedVals;
 
-  BinaryOperator *ReductionRoot;
+  Instruction *ReductionRoot;
   PHINode *ReductionPHI;
 
-  /// The opcode of the reduction.
+  /// The opcode of the reduction, Instruction::Select for a min/max.
   unsigned ReductionOpcode;
-  /// The opcode of the values we perform a reduction on.
-  unsigned ReducedValueOpcode;
+  /// The canonical predicate of a min/max reduction.
+  CmpInst::Predicate MinMaxPred;
   /// Should we model this reduction as a pairwise reduction tree or a tree that
   /// splits the vector in halves and adds those halves.
   bool IsPairwiseReduction;
-
-public:
-  /// The width of one full horizontal reduction operation.
+  /// The width of the horizontal reduction operation being costed or emitted.
   unsigned ReduxWidth;
 
+  /// The smallest number of values reduced as one vector.
+  static const unsigned MinReduxWidth = 4;
+
+public:
   HorizontalReduction()
     : ReductionRoot(nullptr), ReductionPHI(nullptr), ReductionOpcode(0),
-    ReducedValueOpcode(0), IsPairwiseReduction(false), ReduxWidth(0) {}
+    MinMaxPred(CmpInst::BAD_ICMP_PREDICATE), IsPairwiseReduction(false),
+    ReduxWidth(0) {}
 
   /// \brief Try to find a reduction tree.
-  bool matchAssociativeReduction(PHINode *Phi, BinaryOperator *B) {
+  bool matchAssociativeReduction(PHINode *Phi, Instruction *B) {
     assert((!Phi ||
             std::find(Phi->op_begin(), Phi->op_end(), B) != Phi->op_end()) &&
            "Thi phi needs to use the binary operator");
@@ -3677,12 +3752,13 @@ public:
     //  r *= v1 + v2 + v3 + v4
     // In such a case start looking for a tree rooted in the first '+'.
     if (Phi) {
-      if (B->getOperand(0) == Phi) {
+      unsigned FirstOp = getFirstOperandIndex(B);
+      if (B->getOperand(FirstOp) == Phi) {
         Phi = nullptr;
-        B = dyn_cast<BinaryOperator>(B->getOperand(1));
-      } else if (B->getOperand(1) == Phi) {
+        B = dyn_cast<Instruction>(B->getOperand(FirstOp + 1));
+      } else if (B->getOperand(FirstOp + 1) == Phi) {
         Phi = nullptr;
-        B = dyn_cast<BinaryOperator>(B->getOperand(0));
+        B = dyn_cast<Instruction>(B->getOperand(FirstOp));
       }
     }
 
@@ -3694,54 +3770,56 @@ public:
       return false;
 
     const DataLayout &DL = B->getModule()->getDataLayout();
-    ReductionOpcode = B->getOpcode();
-    ReducedValueOpcode = 0;
-    // FIXME: Register size should be a parameter to this function, so we can
-    // try different vectorization factors.
-    ReduxWidth = MinVecRegSize / DL.getTypeSizeInBits(Ty);
     ReductionRoot = B;
     ReductionPHI = Phi;
 
-    if (ReduxWidth < 4)
+    // FIXME: Register size should be a parameter to this function, so we can
+    // try different vectorization factors.
+    if (MinVecRegSize / DL.getTypeSizeInBits(Ty) < MinReduxWidth)
       return false;
 
-    // We currently only support adds.
-    if (ReductionOpcode != Instruction::Add &&
-        ReductionOpcode != Instruction::FAdd)
+    MinMaxPred = getMinMaxPredicate(B);
+    ReductionOpcode = isMinMax() ? (unsigned)Instruction::Select : B->getOpcode();
+    switch (ReductionOpcode) {
+    case Instruction::Add:
+    case Instruction::FAdd:
+    case Instruction::And:
+    case Instruction::Or:
+    case Instruction::Xor:
+    case Instruction::Select:
+      break;
+    default:
       return false;
+    }
 
     // Post order traverse the reduction tree starting at B. We only handle true
-    // trees containing only binary operators or selects.
+    // trees, whose nodes are only used by their parent.
     SmallVector<std::pair<Instruction *, unsigned>, 32> Stack;
-    Stack.push_back(std::make_pair(B, 0));
+    Stack.push_back(std::make_pair(B, getFirstOperandIndex(B)));
     while (!Stack.empty()) {
       Instruction *TreeN = Stack.back().first;
       unsigned EdgeToVist = Stack.back().second++;
-      bool IsReducedValue = TreeN->getOpcode() != ReductionOpcode;
+      bool IsReducedValue = !isReductionOperation(TreeN);
 
       // Only handle trees in the current basic block.
       if (TreeN->getParent() != B->getParent())
         return false;
 
-      // Each tree node needs to have one user except for the ultimate
-      // reduction.
-      if (!TreeN->hasOneUse() && TreeN != B)
+      // Each tree node needs to have one user (the compare and the select of
+      // a min/max) except for the ultimate reduction.
+      if (TreeN != B && !hasRequiredNumberOfUses(TreeN))
         return false;
 
       // Postorder vist.
-      if (EdgeToVist == 2 || IsReducedValue) {
+      if (EdgeToVist == getFirstOperandIndex(TreeN) + 2 || IsReducedValue) {
         if (IsReducedValue) {
-          // Make sure that the opcodes of the operations that we are going to
-          // reduce match.
-          if (!ReducedValueOpcode)
-            ReducedValueOpcode = TreeN->getOpcode();
-          else if (ReducedValueOpcode != TreeN->getOpcode())
-            return false;
           ReducedVals.push_back(TreeN);
         } else {
-          // We need to be able to reassociate the adds.
-          if (!TreeN->isAssociative())
+          // We need to be able to reassociate the operations.
+          if (!isMinMax() && !TreeN->isAssociative())
             return false;
+          if (isMinMax())
+            ReductionOps.push_back(cast<SelectInst>(TreeN)->getCondition());
           ReductionOps.push_back(TreeN);
         }
         // Retract.
@@ -3751,96 +3829,172 @@ public:
 
       // Visit left or right.
       Value *NextV = TreeN->getOperand(EdgeToVist);
-      // We currently only allow BinaryOperator's and SelectInst's as reduction
-      // values in our tree.
-      if (isa<BinaryOperator>(NextV) || isa<SelectInst>(NextV))
-        Stack.push_back(std::make_pair(cast<Instruction>(NextV), 0));
-      else if (NextV != Phi)
+      if (Instruction *NextI = dyn_cast<Instruction>(NextV)) {
+        if (NextI != Phi)
+          Stack.push_back(std::make_pair(NextI, getFirstOperandIndex(NextI)));
+      } else {
         return false;
+      }
     }
     return true;
   }
 
   /// \brief Attempt to vectorize the tree found by
   /// matchAssociativeReduction.
+  ///
+  /// The reduced values are vectorized in groups with the same opcode. Each
+  /// group is covered with the widest power-of-two chunks that are profitable
+  /// to vectorize; the values left over are reduced with scalar operations.
   bool tryToReduce(BoUpSLP &V, TargetTransformInfo *TTI) {
-    if (ReducedVals.empty())
+    if (ReducedVals.size() < MinReduxWidth)
       return false;
 
-    unsigned NumReducedVals = ReducedVals.size();
-    if (NumReducedVals < ReduxWidth)
-      return false;
+    // Keep the values of a group in their original order, which is what
+    // makes their loads consecutive.
+    std::stable_sort(ReducedVals.begin(), ReducedVals.end(),
+                     [](Value *A, Value *B) {
+                       return cast<Instruction>(A)->getOpcode() <
+                              cast<Instruction>(B)->getOpcode();
+                     });
 
     Value *VectorizedTree = nullptr;
+    // The new operations only get the fast-math flags that all the operations
+    // they replace have. An fadd reduction needs unsafe-algebra on every fadd
+    // to be reassociated at all; a min/max reduction keeps the flags of its
+    // compares, whatever the function attributes allowed.
     IRBuilder<> Builder(ReductionRoot);
-    FastMathFlags Unsafe;
-    Unsafe.setUnsafeAlgebra();
-    Builder.SetFastMathFlags(Unsafe);
-    unsigned i = 0;
+    FastMathFlags FMF;
+    FMF.setUnsafeAlgebra();
+    for (Value *Op : ReductionOps)
+      if (isa<FPMathOperator>(Op) && !isa<SelectInst>(Op))
+        FMF &= cast<FPMathOperator>(Op)->getFastMathFlags();
+    Builder.SetFastMathFlags(FMF);
+    SmallVector<Value *, 16> ScalarVals;
 
-    for (; i < NumReducedVals - ReduxWidth + 1; i += ReduxWidth) {
-      V.buildTree(makeArrayRef(&ReducedVals[i], ReduxWidth), ReductionOps);
+    unsigned NumReducedVals = ReducedVals.size();
+    for (unsigned Begin = 0; Begin != NumReducedVals;) {
+      unsigned Opcode = cast<Instruction>(ReducedVals[Begin])->getOpcode();
+      unsigned End = Begin + 1;
+      while (End != NumReducedVals &&
+             cast<Instruction>(ReducedVals[End])->getOpcode() == Opcode)
+        ++End;
+
+      unsigned i = Begin;
+      unsigned Width = PowerOf2Floor(End - Begin);
+      while (Width >= MinReduxWidth) {
+        if (i + Width > End) {
+          Width = PowerOf2Floor(End - i);
+          continue;
+        }
 
-      // Estimate cost.
-      int Cost = V.getTreeCost() + getReductionCost(TTI, ReducedVals[i]);
-      if (Cost >= -SLPCostThreshold)
-        break;
+        ReduxWidth = Width;
+        V.buildTree(makeArrayRef(&ReducedVals[i], ReduxWidth), ReductionOps);
 
-      DEBUG(dbgs() << "SLP: Vectorizing horizontal reduction at cost:" << Cost
-                   << ". (HorRdx)\n");
-
-      // Vectorize a tree.
-      DebugLoc Loc = cast<Instruction>(ReducedVals[i])->getDebugLoc();
-      Value *VectorizedRoot = V.vectorizeTree();
-
-      // Emit a reduction.
-      Value *ReducedSubTree = emitReduction(VectorizedRoot, Builder);
-      if (VectorizedTree) {
-        Builder.SetCurrentDebugLocation(Loc);
-        VectorizedTree = createBinOp(Builder, ReductionOpcode, VectorizedTree,
-                                     ReducedSubTree, "bin.rdx");
-      } else
-        VectorizedTree = ReducedSubTree;
+        // Estimate cost. Try a narrower reduction of the same values if this
+        // one does not pay off.
+        int TreeCost = V.getTreeCost();
+        if (TreeCost == INT_MAX) {
+          Width /= 2;
+          continue;
+        }
+        int Cost = TreeCost + getReductionCost(TTI, ReducedVals[i]);
+        if (Cost >= -SLPCostThreshold) {
+          Width /= 2;
+          continue;
+        }
+
+        DEBUG(dbgs() << "SLP: Vectorizing horizontal reduction at cost:"
+                     << Cost << ". (HorRdx)\n");
+
+        // Vectorize a tree.
+        DebugLoc Loc = cast<Instruction>(ReducedVals[i])->getDebugLoc();
+        Value *VectorizedRoot = V.vectorizeTree();
+
+        // Emit a reduction.
+        Value *ReducedSubTree = emitReduction(VectorizedRoot, Builder);
+        if (VectorizedTree) {
+          Builder.SetCurrentDebugLocation(Loc);
+          VectorizedTree =
+              createOp(Builder, VectorizedTree, ReducedSubTree, "bin.rdx");
+        } else
+          VectorizedTree = ReducedSubTree;
+        i += ReduxWidth;
+      }
+      ScalarVals.append(ReducedVals.begin() + i, ReducedVals.begin() + End);
+      Begin = End;
     }
 
     if (VectorizedTree) {
       // Finish the reduction.
-      for (; i < NumReducedVals; ++i) {
+      for (Value *ScalarV : ScalarVals) {
         Builder.SetCurrentDebugLocation(
-          cast<Instruction>(ReducedVals[i])->getDebugLoc());
-        VectorizedTree = createBinOp(Builder, ReductionOpcode, VectorizedTree,
-                                     ReducedVals[i]);
+          cast<Instruction>(ScalarV)->getDebugLoc());
+        VectorizedTree = createOp(Builder, VectorizedTree, ScalarV);
       }
       // Update users.
-      if (ReductionPHI) {
-        assert(ReductionRoot && "Need a reduction operation");
-        ReductionRoot->setOperand(0, VectorizedTree);
-        ReductionRoot->setOperand(1, ReductionPHI);
-      } else
-        ReductionRoot->replaceAllUsesWith(VectorizedTree);
+      if (ReductionPHI)
+        VectorizedTree =
+            createOp(Builder, VectorizedTree, ReductionPHI, "op.rdx");
+      ReductionRoot->replaceAllUsesWith(VectorizedTree);
     }
     return VectorizedTree != nullptr;
   }
 
-  unsigned numReductionValues() const {
-    return ReducedVals.size();
+private:
+  bool isMinMax() const {
+    return MinMaxPred != CmpInst::BAD_ICMP_PREDICATE;
+  }
+
+  /// \returns the index of the first of the two operands of \p I that a
+  /// reduction operation combines: the values a select chooses from, or the
+  /// operands of a binary operator.
+  static unsigned getFirstOperandIndex(Instruction *I) {
+    return isa<SelectInst>(I) ? 1 : 0;
+  }
+
+  /// \returns true if \p I is an operation of the kind being reduced.
+  bool isReductionOperation(Instruction *I) const {
+    if (isMinMax())
+      return getMinMaxPredicate(I) == MinMaxPred;
+    return I->getOpcode() == ReductionOpcode;
+  }
+
+  /// \returns true if \p I is only used by its parent in the tree.
+  bool hasRequiredNumberOfUses(Instruction *I) const {
+    return isMinMax() ? I->hasNUses(2) : I->hasOneUse();
   }
 
-private:
   /// \brief Calculate the cost of a reduction.
   int getReductionCost(TargetTransformInfo *TTI, Value *FirstReducedVal) {
     Type *ScalarTy = FirstReducedVal->getType();
     Type *VecTy = VectorType::get(ScalarTy, ReduxWidth);
 
-    int PairwiseRdxCost = TTI->getReductionCost(ReductionOpcode, VecTy, true);
-    int SplittingRdxCost = TTI->getReductionCost(ReductionOpcode, VecTy, false);
+    int PairwiseRdxCost, SplittingRdxCost, ScalarReduxCost;
+    if (isMinMax()) {
+      Type *VecCondTy = CmpInst::makeCmpResultType(VecTy);
+      bool IsUnsigned = CmpInst::isUnsigned(MinMaxPred);
+      PairwiseRdxCost =
+          TTI->getMinMaxReductionCost(VecTy, VecCondTy, true, IsUnsigned);
+      SplittingRdxCost =
+          TTI->getMinMaxReductionCost(VecTy, VecCondTy, false, IsUnsigned);
+      Type *CondTy = CmpInst::makeCmpResultType(ScalarTy);
+      unsigned CmpOpcode = CmpInst::isIntPredicate(MinMaxPred)
+                               ? Instruction::ICmp
+                               : Instruction::FCmp;
+      ScalarReduxCost =
+          ReduxWidth *
+          (TTI->getCmpSelInstrCost(CmpOpcode, ScalarTy, CondTy) +
+           TTI->getCmpSelInstrCost(Instruction::Select, ScalarTy, CondTy));
+    } else {
+      PairwiseRdxCost = TTI->getReductionCost(ReductionOpcode, VecTy, true);
+      SplittingRdxCost = TTI->getReductionCost(ReductionOpcode, VecTy, false);
+      ScalarReduxCost =
+          ReduxWidth * TTI->getArithmeticInstrCost(ReductionOpcode, VecTy);
+    }
 
     IsPairwiseReduction = PairwiseRdxCost < SplittingRdxCost;
     int VecReduxCost = IsPairwiseReduction ? PairwiseRdxCost : SplittingRdxCost;
 
-    int ScalarReduxCost =
-        ReduxWidth * TTI->getArithmeticInstrCost(ReductionOpcode, VecTy);
-
     DEBUG(dbgs() << "SLP: Adding cost " << VecReduxCost - ScalarReduxCost
                  << " for reduction that starts with " << *FirstReducedVal
                  << " (It is a "
@@ -3857,6 +4011,18 @@ private:
     return Builder.CreateBinOp((Instruction::BinaryOps)Opcode, L, R, Name);
   }
 
+  /// \brief Emit one reduction operation of \p L and \p R: a binary operator,
+  /// or a compare and a select for a min/max.
+  Value *createOp(IRBuilder<> &Builder, Value *L, Value *R,
+                  const Twine &Name = "") {
+    if (!isMinMax())
+      return createBinOp(Builder, ReductionOpcode, L, R, Name);
+    Value *Cmp = CmpInst::isIntPredicate(MinMaxPred)
+                     ? Builder.CreateICmp(MinMaxPred, L, R, "rdx.minmax.cmp")
+                     : Builder.CreateFCmp(MinMaxPred, L, R, "rdx.minmax.cmp");
+    return Builder.CreateSelect(Cmp, L, R, Name);
+  }
+
   /// \brief Emit a horizontal reduction of the vectorized value.
   Value *emitReduction(Value *VectorizedValue, IRBuilder<> &Builder) {
     assert(VectorizedValue && "Need to have a vectorized tree node");
@@ -3876,14 +4042,13 @@ private:
         Value *RightShuf = Builder.CreateShuffleVector(
           TmpVec, UndefValue::get(TmpVec->getType()), (RightMask),
           "rdx.shuf.r");
-        TmpVec = createBinOp(Builder, ReductionOpcode, LeftShuf, RightShuf,
-                             "bin.rdx");
+        TmpVec = createOp(Builder, LeftShuf, RightShuf, "bin.rdx");
       } else {
         Value *UpperHalf =
           createRdxShuffleMask(ReduxWidth, i, false, false, Builder);
         Value *Shuf = Builder.CreateShuffleVector(
           TmpVec, UndefValue::get(TmpVec->getType()), UpperHalf, "rdx.shuf");
-        TmpVec = createBinOp(Builder, ReductionOpcode, TmpVec, Shuf, "bin.rdx");
+        TmpVec = createOp(Builder, TmpVec, Shuf, "bin.rdx");
       }
     }
 
@@ -3991,21 +4156,15 @@ static Value *getReductionValue(const DominatorTree *DT, PHINode *P,
 /// can be done.
 /// \returns true if a horizontal reduction was matched and reduced.
 /// \returns false if a horizontal reduction was not matched.
-static bool canMatchHorizontalReduction(PHINode *P, BinaryOperator *BI,
+static bool canMatchHorizontalReduction(PHINode *P, Instruction *Root,
                                         BoUpSLP &R, TargetTransformInfo *TTI) {
   if (!ShouldVectorizeHor)
     return false;
 
   HorizontalReduction HorRdx;
-  if (!HorRdx.matchAssociativeReduction(P, BI))
+  if (!HorRdx.matchAssociativeReduction(P, Root))
     return false;
 
-  // If there is a sufficient number of reduction values, reduce
-  // to a nearby power-of-2. Can safely generate oversized
-  // vectors and rely on the backend to split them to legal sizes.
-  HorRdx.ReduxWidth =
-    std::max((uint64_t)4, PowerOf2Floor(HorRdx.numReductionValues()));
-
   return HorRdx.tryToReduce(R, TTI);
 }
 
@@ -4079,19 +4238,23 @@ bool SLPVectorizer::vectorizeChainsInBlock(BasicBlock *BB, BoUpSLP &R) {
 
       Value *Rdx = getReductionValue(DT, P, BB, LI);
 
-      // Check if this is a Binary Operator.
-      BinaryOperator *BI = dyn_cast_or_null<BinaryOperator>(Rdx);
-      if (!BI)
+      // Check if this is a Binary Operator or a select.
+      Instruction *RdxI = dyn_cast_or_null<Instruction>(Rdx);
+      if (!RdxI || !(isa<BinaryOperator>(RdxI) || isa<SelectInst>(RdxI)))
         continue;
 
       // Try to match and vectorize a horizontal reduction.
-      if (canMatchHorizontalReduction(P, BI, R, TTI)) {
+      if (canMatchHorizontalReduction(P, RdxI, R, TTI)) {
         Changed = true;
         it = BB->begin();
         e = BB->end();
         continue;
       }
 
+      BinaryOperator *BI = dyn_cast<BinaryOperator>(RdxI);
+      if (!BI)
+        continue;
+
      Value *Inst = BI->getOperand(0);
       if (Inst == P)
         Inst = BI->getOperand(1);
@@ -4110,10 +4273,11 @@ bool SLPVectorizer::vectorizeChainsInBlock(BasicBlock *BB, BoUpSLP &R) {
 
     if (ShouldStartVectorizeHorAtStore)
       if (StoreInst *SI = dyn_cast<StoreInst>(it))
-        if (BinaryOperator *BinOp =
-                dyn_cast<BinaryOperator>(SI->getValueOperand())) {
-          if (canMatchHorizontalReduction(nullptr, BinOp, R, TTI) ||
-              tryToVectorize(BinOp, R)) {
+        if (Instruction *RdxI =
+                dyn_cast<Instruction>(SI->getValueOperand())) {
+          if ((isa<BinaryOperator>(RdxI) || isa<SelectInst>(RdxI)) &&
+              (canMatchHorizontalReduction(nullptr, RdxI, R, TTI) ||
+               tryToVectorize(dyn_cast<BinaryOperator>(RdxI), R))) {
             Changed = true;
             it = BB->begin();
             e = BB->end();
@@ -0,0 +1,27 @@
+; RUN: llc -enable-machine-outliner -verify-machineinstrs -mtriple=aarch64-unknown-linux < %s | FileCheck %s
+
+declare void @f(i32, i32, i32, i32)
+
+; The argument setup before each call is shared. The link register has been
+; saved by the prologue, so it is free to hold the return address.
+; CHECK-LABEL: calls:
+; CHECK:       bl [[OUTLINED:\.LBB0_[0-9]+]]
+; CHECK-NEXT:  bl f
+; CHECK-NEXT:  bl [[OUTLINED]]
+; CHECK-NEXT:  bl f
+; CHECK-NEXT:  bl [[OUTLINED]]
+; CHECK-NEXT:  bl f
+; CHECK:       ret
+; CHECK:       [[OUTLINED]]:
+; CHECK-DAG:   orr w0, wzr, #0x1
+; CHECK-DAG:   orr w1, wzr, #0x2
+; CHECK-DAG:   orr w2, wzr, #0x3
+; CHECK-DAG:   orr w3, wzr, #0x4
+; CHECK:       ret
+define void @calls() {
+entry:
+  call void @f(i32 1, i32 2, i32 3, i32 4)
+  call void @f(i32 1, i32 2, i32 3, i32 4)
+  call void @f(i32 1, i32 2, i32 3, i32 4)
+  ret void
+}
@@ -0,0 +1,71 @@
+; RUN: llc -mtriple=x86_64-unknown-linux -ext-tsp-block-placement < %s | FileCheck %s
+
+declare void @a()
+declare void @b()
+declare void @c()
+
+; The hot path falls through from the entry to the return, and the cold block
+; is moved out of the way.
+; CHECK-LABEL: diamond:
+; CHECK:       je [[COLD:\.LBB0_[0-9]+]]
+; CHECK:       callq b
+; CHECK:       callq c
+; CHECK:       retq
+; CHECK:       [[COLD]]:
+; CHECK:       callq a
+define void @diamond(i32 %x) !prof !0 {
+entry:
+  %cmp = icmp eq i32 %x, 0
+  br i1 %cmp, label %cold, label %hot, !prof !1
+
+cold:
+  call void @a()
+  br label %exit
+
+hot:
+  call void @b()
+  br label %exit
+
+exit:
+  call void @c()
+  ret void
+}
+
+; The hot loop body falls through to the latch, and the rarely taken block
+; inside the loop is laid out after the loop.
+; CHECK-LABEL: loop:
+; CHECK:       [[HEADER:\.LBB1_[0-9]+]]:
+; CHECK:       callq b
+; CHECK:       jne [[RARE:\.LBB1_[0-9]+]]
+; CHECK:       callq c
+; CHECK:       jne [[HEADER]]
+; CHECK:       retq
+; CHECK:       [[RARE]]:
+; CHECK:       callq a
+define void @loop(i32 %n) !prof !0 {
+entry:
+  br label %header
+
+header:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %latch ]
+  call void @b()
+  %r = and i32 %i, 1023
+  %cmp = icmp ne i32 %r, 0
+  br i1 %cmp, label %rare, label %latch, !prof !1
+
+rare:
+  call void @a()
+  br label %latch
+
+latch:
+  call void @c()
+  %i.next = add i32 %i, 1
+  %done = icmp eq i32 %i.next, %n
+  br i1 %done, label %exit, label %header, !prof !1
+
+exit:
+  ret void
+}
+
+!0 = !{!"function_entry_count", i64 1000}
+!1 = !{!"branch_weights", i32 1, i32 1000}
@@ -0,0 +1,75 @@
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -fast-isel -fast-isel-abort=3 -mattr=+popcnt,+lzcnt,+bmi | FileCheck %s
+
+define i32 @test_bswap_i32(i32 %a) {
+; CHECK-LABEL: test_bswap_i32:
+; CHECK:       bswapl
+  %r = call i32 @llvm.bswap.i32(i32 %a)
+  ret i32 %r
+}
+
+define i64 @test_bswap_i64(i64 %a) {
+; CHECK-LABEL: test_bswap_i64:
+; CHECK:       bswapq
+  %r = call i64 @llvm.bswap.i64(i64 %a)
+  ret i64 %r
+}
+
+define i32 @test_ctpop_i32(i32 %a) {
+; CHECK-LABEL: test_ctpop_i32:
+; CHECK:       popcntl
+  %r = call i32 @llvm.ctpop.i32(i32 %a)
+  ret i32 %r
+}
+
+define i64 @test_ctpop_i64(i64 %a) {
+; CHECK-LABEL: test_ctpop_i64:
+; CHECK:       popcntq
+  %r = call i64 @llvm.ctpop.i64(i64 %a)
+  ret i64 %r
+}
+
+define i32 @test_ctlz_i32(i32 %a) {
+; CHECK-LABEL: test_ctlz_i32:
+; CHECK:       lzcntl
+  %r = call i32 @llvm.ctlz.i32(i32 %a, i1 false)
+  ret i32 %r
+}
+
+define i64 @test_ctlz_i64_zero_undef(i64 %a) {
+; CHECK-LABEL: test_ctlz_i64_zero_undef:
+; CHECK:       lzcntq
+  %r = call i64 @llvm.ctlz.i64(i64 %a, i1 true)
+  ret i64 %r
+}
+
+define i32 @test_cttz_i32(i32 %a) {
+; CHECK-LABEL: test_cttz_i32:
+; CHECK:       tzcntl
+  %r = call i32 @llvm.cttz.i32(i32 %a, i1 false)
+  ret i32 %r
+}
+
+define i64 @test_cttz_i64(i64 %a) {
+; CHECK-LABEL: test_cttz_i64:
+; CHECK:       tzcntq
+  %r = call i64 @llvm.cttz.i64(i64 %a, i1 false)
+  ret i64 %r
+}
+
+define double @test_fmuladd_f64(double %a, double %b, double %c) {
+; CHECK-LABEL: test_fmuladd_f64:
+; CHECK:       mulsd
+; CHECK-NEXT:  addsd
+  %r = call double @llvm.fmuladd.f64(double %a, double %b, double %c)
+  ret double %r
+}
+
+declare i32 @llvm.bswap.i32(i32)
+declare i64 @llvm.bswap.i64(i64)
+declare i32 @llvm.ctpop.i32(i32)
+declare i64 @llvm.ctpop.i64(i64)
+declare i32 @llvm.ctlz.i32(i32, i1)
+declare i64 @llvm.ctlz.i64(i64, i1)
+declare i32 @llvm.cttz.i32(i32, i1)
+declare i64 @llvm.cttz.i64(i64, i1)
+declare double @llvm.fmuladd.f64(double, double, double)
@@ -0,0 +1,20 @@
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -fast-isel -fast-isel-abort=3 | FileCheck %s
+
+; X86 fast isel does not lower vector arguments or return values, so the
+; vectors are passed in memory to keep the whole function in fast isel.
+
+define void @test_fmuladd_v4f32(<4 x float>* %pa, <4 x float>* %pb,
+                                <4 x float>* %pc, <4 x float>* %pr) {
+; CHECK-LABEL: test_fmuladd_v4f32:
+; CHECK:       mulps
+; CHECK-NEXT:  addps
+; CHECK-NEXT:  movaps
+  %a = load <4 x float>, <4 x float>* %pa
+  %b = load <4 x float>, <4 x float>* %pb
+  %c = load <4 x float>, <4 x float>* %pc
+  %r = call <4 x float> @llvm.fmuladd.v4f32(<4 x float> %a, <4 x float> %b, <4 x float> %c)
+  store <4 x float> %r, <4 x float>* %pr
+  ret void
+}
+
+declare <4 x float> @llvm.fmuladd.v4f32(<4 x float>, <4 x float>, <4 x float>)
@@ -0,0 +1,29 @@
+; RUN: rm -f %t
+; RUN: llc < %s -O0 -mtriple=x86_64-unknown-unknown -fast-isel-report=%t -o /dev/null
+; RUN: llc < %s -O0 -mtriple=x86_64-unknown-unknown -fast-isel-report=%t -o /dev/null
+; RUN: FileCheck %s < %t
+
+; Each run appends the fallbacks of the module, most frequent first.
+; CHECK:      2 ret i128
+; CHECK-NEXT: 1 arguments
+; CHECK-NEXT: 1 call llvm.ctpop i32
+; CHECK-NEXT: 2 ret i128
+; CHECK-NEXT: 1 arguments
+; CHECK-NEXT: 1 call llvm.ctpop i32
+
+define i128 @add(i128 %a, i128 %b) {
+  %r = add i128 %a, %b
+  ret i128 %r
+}
+
+define i128 @zext(i64 %a) {
+  %r = zext i64 %a to i128
+  ret i128 %r
+}
+
+define i32 @pop(i32 %a) {
+  %r = call i32 @llvm.ctpop.i32(i32 %a)
+  ret i32 %r
+}
+
+declare i32 @llvm.ctpop.i32(i32)
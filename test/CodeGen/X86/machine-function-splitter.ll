@@ -0,0 +1,85 @@
+; RUN: llc -split-machine-functions -mtriple=x86_64-unknown-linux < %s | FileCheck %s
+; RUN: llc -split-machine-functions -function-sections -mtriple=x86_64-unknown-linux < %s | FileCheck %s --check-prefix=FSECT
+
+declare void @hot()
+declare void @cold()
+
+; The block that never ran is moved to .text.unlikely, reached by a branch
+; from the hot part, and given a frame description of its own.
+; CHECK-LABEL: split:
+; CHECK:       .cfi_startproc
+; CHECK:       pushq %rax
+; CHECK:       .cfi_def_cfa_offset 16
+; CHECK:       jne [[COLD:\.LBB0_[0-9]+]]
+; CHECK:       callq hot
+; CHECK:       retq
+; CHECK:       .size split, .Lhot_end0-split
+; CHECK-NEXT:  .cfi_endproc
+; CHECK:       .section .text.unlikely,"ax",@progbits
+; CHECK:       .type split.cold,@function
+; CHECK:       split.cold:
+; CHECK-NEXT:  .cfi_startproc
+; CHECK:       .cfi_def_cfa_offset 16
+; CHECK-NEXT:  [[COLD]]:
+; CHECK:       callq cold
+; CHECK:       .size split.cold, .Lfunc_end0-split.cold
+; CHECK-NEXT:  .cfi_endproc
+; FSECT:       .section .text.split,"ax",@progbits
+; FSECT:       .section .text.unlikely.split,"ax",@progbits
+define void @split(i1 %c) !prof !0 {
+entry:
+  br i1 %c, label %rare, label %common, !prof !1
+
+common:
+  call void @hot()
+  ret void
+
+rare:
+  call void @cold()
+  ret void
+}
+
+; Without profile data nothing is split.
+; CHECK-LABEL: noprofile:
+; CHECK-NOT:   .text.unlikely
+; CHECK:       .cfi_endproc
+define void @noprofile(i1 %c) {
+entry:
+  br i1 %c, label %rare, label %common, !prof !1
+
+common:
+  call void @hot()
+  ret void
+
+rare:
+  call void @cold()
+  ret void
+}
+
+; Functions that may unwind through a landing pad are not split.
+; CHECK-LABEL: landingpad:
+; CHECK-NOT:   .text.unlikely
+; CHECK:       .cfi_endproc
+define void @landingpad(i1 %c) personality i32 (...)* @__gxx_personality_v0 !prof !0 {
+entry:
+  br i1 %c, label %rare, label %common, !prof !1
+
+common:
+  call void @hot()
+  ret void
+
+rare:
+  invoke void @cold() to label %done unwind label %lpad
+
+lpad:
+  %lp = landingpad { i8*, i32 } cleanup
+  resume { i8*, i32 } %lp
+
+done:
+  ret void
+}
+
+declare i32 @__gxx_personality_v0(...)
+
+!0 = !{!"function_entry_count", i64 1000}
+!1 = !{!"branch_weights", i32 0, i32 1000}
@@ -0,0 +1,50 @@
+; RUN: llc -enable-machine-outliner -verify-machineinstrs -mtriple=x86_64-unknown-linux < %s | FileCheck %s
+; RUN: llc -verify-machineinstrs -mtriple=x86_64-unknown-linux < %s | FileCheck %s --check-prefix=NOOUTLINE
+
+declare void @f(i32, i32, i32, i32)
+
+; The argument setup before each call is shared.
+; CHECK-LABEL: calls:
+; CHECK:       callq [[OUTLINED:\.LBB0_[0-9]+]]
+; CHECK-NEXT:  callq f
+; CHECK-NEXT:  callq [[OUTLINED]]
+; CHECK-NEXT:  callq f
+; CHECK-NEXT:  callq [[OUTLINED]]
+; CHECK-NEXT:  callq f
+; CHECK:       retq
+; CHECK:       [[OUTLINED]]:
+; CHECK-DAG:   movl $1, %edi
+; CHECK-DAG:   movl $2, %esi
+; CHECK-DAG:   movl $3, %edx
+; CHECK-DAG:   movl $4, %ecx
+; CHECK:       retq
+; NOOUTLINE-LABEL: calls:
+; NOOUTLINE-NOT: callq .LBB
+define void @calls() {
+entry:
+  call void @f(i32 1, i32 2, i32 3, i32 4)
+  call void @f(i32 1, i32 2, i32 3, i32 4)
+  call void @f(i32 1, i32 2, i32 3, i32 4)
+  ret void
+}
+
+; Sequences in a loop are hotter than the entry and are left alone.
+; CHECK-LABEL: loop:
+; CHECK-NOT:   callq .LBB
+; CHECK:       .Lfunc_end1:
+define void @loop(i32 %n) {
+entry:
+  br label %body
+
+body:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %body ]
+  call void @f(i32 1, i32 2, i32 3, i32 4)
+  call void @f(i32 1, i32 2, i32 3, i32 4)
+  call void @f(i32 1, i32 2, i32 3, i32 4)
+  %i.next = add i32 %i, 1
+  %done = icmp eq i32 %i.next, %n
+  br i1 %done, label %exit, label %body
+
+exit:
+  ret void
+}
@@ -0,0 +1,97 @@
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -verify-machineinstrs \
+; RUN:   -regalloc-greedy-budget=1 -pass-remarks-analysis=regalloc \
+; RUN:   -o /dev/null 2>&1 | FileCheck %s
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -verify-machineinstrs \
+; RUN:   -pass-remarks-analysis=regalloc -o /dev/null 2>&1 | count 0
+
+; More values are live at once than there are registers, so the allocator has
+; to evict or split. With a tiny budget it gives up on that and just spills,
+; and says so once per function.
+
+; CHECK: remark: {{.*}}register allocation exceeded its budget of 1 work units
+; CHECK-NOT: remark:
+
+define void @pressure(i64* %p, i64* %q) {
+entry:
+  %a0 = getelementptr i64, i64* %p, i64 0
+  %v0 = load volatile i64, i64* %a0
+  %a1 = getelementptr i64, i64* %p, i64 1
+  %v1 = load volatile i64, i64* %a1
+  %a2 = getelementptr i64, i64* %p, i64 2
+  %v2 = load volatile i64, i64* %a2
+  %a3 = getelementptr i64, i64* %p, i64 3
+  %v3 = load volatile i64, i64* %a3
+  %a4 = getelementptr i64, i64* %p, i64 4
+  %v4 = load volatile i64, i64* %a4
+  %a5 = getelementptr i64, i64* %p, i64 5
+  %v5 = load volatile i64, i64* %a5
+  %a6 = getelementptr i64, i64* %p, i64 6
+  %v6 = load volatile i64, i64* %a6
+  %a7 = getelementptr i64, i64* %p, i64 7
+  %v7 = load volatile i64, i64* %a7
+  %a8 = getelementptr i64, i64* %p, i64 8
+  %v8 = load volatile i64, i64* %a8
+  %a9 = getelementptr i64, i64* %p, i64 9
+  %v9 = load volatile i64, i64* %a9
+  %a10 = getelementptr i64, i64* %p, i64 10
+  %v10 = load volatile i64, i64* %a10
+  %a11 = getelementptr i64, i64* %p, i64 11
+  %v11 = load volatile i64, i64* %a11
+  %a12 = getelementptr i64, i64* %p, i64 12
+  %v12 = load volatile i64, i64* %a12
+  %a13 = getelementptr i64, i64* %p, i64 13
+  %v13 = load volatile i64, i64* %a13
+  %a14 = getelementptr i64, i64* %p, i64 14
+  %v14 = load volatile i64, i64* %a14
+  %a15 = getelementptr i64, i64* %p, i64 15
+  %v15 = load volatile i64, i64* %a15
+  %a16 = getelementptr i64, i64* %p, i64 16
+  %v16 = load volatile i64, i64* %a16
+  %a17 = getelementptr i64, i64* %p, i64 17
+  %v17 = load volatile i64, i64* %a17
+  %a18 = getelementptr i64, i64* %p, i64 18
+  %v18 = load volatile i64, i64* %a18
+  %a19 = getelementptr i64, i64* %p, i64 19
+  %v19 = load volatile i64, i64* %a19
+  %b0 = getelementptr i64, i64* %q, i64 0
+  store volatile i64 %v0, i64* %b0
+  %b1 = getelementptr i64, i64* %q, i64 1
+  store volatile i64 %v1, i64* %b1
+  %b2 = getelementptr i64, i64* %q, i64 2
+  store volatile i64 %v2, i64* %b2
+  %b3 = getelementptr i64, i64* %q, i64 3
+  store volatile i64 %v3, i64* %b3
+  %b4 = getelementptr i64, i64* %q, i64 4
+  store volatile i64 %v4, i64* %b4
+  %b5 = getelementptr i64, i64* %q, i64 5
+  store volatile i64 %v5, i64* %b5
+  %b6 = getelementptr i64, i64* %q, i64 6
+  store volatile i64 %v6, i64* %b6
+  %b7 = getelementptr i64, i64* %q, i64 7
+  store volatile i64 %v7, i64* %b7
+  %b8 = getelementptr i64, i64* %q, i64 8
+  store volatile i64 %v8, i64* %b8
+  %b9 = getelementptr i64, i64* %q, i64 9
+  store volatile i64 %v9, i64* %b9
+  %b10 = getelementptr i64, i64* %q, i64 10
+  store volatile i64 %v10, i64* %b10
+  %b11 = getelementptr i64, i64* %q, i64 11
+  store volatile i64 %v11, i64* %b11
+  %b12 = getelementptr i64, i64* %q, i64 12
+  store volatile i64 %v12, i64* %b12
+  %b13 = getelementptr i64, i64* %q, i64 13
+  store volatile i64 %v13, i64* %b13
+  %b14 = getelementptr i64, i64* %q, i64 14
+  store volatile i64 %v14, i64* %b14
+  %b15 = getelementptr i64, i64* %q, i64 15
+  store volatile i64 %v15, i64* %b15
+  %b16 = getelementptr i64, i64* %q, i64 16
+  store volatile i64 %v16, i64* %b16
+  %b17 = getelementptr i64, i64* %q, i64 17
+  store volatile i64 %v17, i64* %b17
+  %b18 = getelementptr i64, i64* %q, i64 18
+  store volatile i64 %v18, i64* %b18
+  %b19 = getelementptr i64, i64* %q, i64 19
+  store volatile i64 %v19, i64* %b19
+  ret void
+}
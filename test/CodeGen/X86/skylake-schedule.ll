@@ -0,0 +1,136 @@
+; REQUIRES: asserts
+;
+; Check the latencies the Skylake machine model assigns against measured
+; instruction tables for Skylake-SP. Each function isolates one instruction so
+; that its SUnit is easy to find in the scheduler dump. The first run disables
+; AVX-512 so that isel picks the VEX forms; the second checks the EVEX forms
+; of 512-bit operations.
+;
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -mcpu=skylake -mattr=-avx512f -enable-misched -debug-only=misched -o - 2>&1 > /dev/null | FileCheck %s
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -mcpu=skylake -enable-misched -debug-only=misched -o - 2>&1 > /dev/null | FileCheck %s --check-prefix=EVEX
+
+; CHECK-LABEL: imul32:BB#0
+; CHECK: IMUL32rr
+; CHECK: Latency : 3
+define i32 @imul32(i32 %a, i32 %b) {
+  %r = mul i32 %a, %b
+  ret i32 %r
+}
+
+; CHECK-LABEL: popcnt32:BB#0
+; CHECK: POPCNT32rr
+; CHECK: Latency : 3
+define i32 @popcnt32(i32 %a) {
+  %r = call i32 @llvm.ctpop.i32(i32 %a)
+  ret i32 %r
+}
+
+; CHECK-LABEL: pdep32:BB#0
+; CHECK: PDEP32rr
+; CHECK: Latency : 3
+define i32 @pdep32(i32 %a, i32 %b) {
+  %r = call i32 @llvm.x86.bmi.pdep.32(i32 %a, i32 %b)
+  ret i32 %r
+}
+
+; CHECK-LABEL: addps:BB#0
+; CHECK: VADDPSYrr
+; CHECK: Latency : 4
+define <8 x float> @addps(<8 x float> %a, <8 x float> %b) {
+  %r = fadd <8 x float> %a, %b
+  ret <8 x float> %r
+}
+
+; CHECK-LABEL: mulpd:BB#0
+; CHECK: VMULPDYrr
+; CHECK: Latency : 4
+define <4 x double> @mulpd(<4 x double> %a, <4 x double> %b) {
+  %r = fmul <4 x double> %a, %b
+  ret <4 x double> %r
+}
+
+; CHECK-LABEL: fmaps:BB#0
+; CHECK: VFMADDPSr213rY
+; CHECK: Latency : 4
+define <8 x float> @fmaps(<8 x float> %a, <8 x float> %b, <8 x float> %c) {
+  %r = call <8 x float> @llvm.fma.v8f32(<8 x float> %a, <8 x float> %b, <8 x float> %c)
+  ret <8 x float> %r
+}
+
+; CHECK-LABEL: divps:BB#0
+; CHECK: VDIVPSYrr
+; CHECK: Latency : 11
+define <8 x float> @divps(<8 x float> %a, <8 x float> %b) {
+  %r = fdiv <8 x float> %a, %b
+  ret <8 x float> %r
+}
+
+; CHECK-LABEL: divpd:BB#0
+; CHECK: VDIVPDYrr
+; CHECK: Latency : 14
+define <4 x double> @divpd(<4 x double> %a, <4 x double> %b) {
+  %r = fdiv <4 x double> %a, %b
+  ret <4 x double> %r
+}
+
+; CHECK-LABEL: sqrtpd:BB#0
+; CHECK: VSQRTPDYr
+; CHECK: Latency : 18
+define <4 x double> @sqrtpd(<4 x double> %a) {
+  %r = call <4 x double> @llvm.sqrt.v4f64(<4 x double> %a)
+  ret <4 x double> %r
+}
+
+; CHECK-LABEL: pmulld:BB#0
+; CHECK: VPMULLDYrr
+; CHECK: Latency : 10
+define <8 x i32> @pmulld(<8 x i32> %a, <8 x i32> %b) {
+  %r = mul <8 x i32> %a, %b
+  ret <8 x i32> %r
+}
+
+; CHECK-LABEL: permps:BB#0
+; CHECK: VPERMPSYrr
+; CHECK: Latency : 3
+define <8 x float> @permps(<8 x float> %a, <8 x i32> %b) {
+  %r = call <8 x float> @llvm.x86.avx2.permps(<8 x float> %a, <8 x i32> %b)
+  ret <8 x float> %r
+}
+
+; EVEX-LABEL: addps_zmm:BB#0
+; EVEX: VADDPSZrr
+; EVEX: Latency : 4
+define <16 x float> @addps_zmm(<16 x float> %a, <16 x float> %b) {
+  %r = fadd <16 x float> %a, %b
+  ret <16 x float> %r
+}
+
+; EVEX-LABEL: divps_zmm:BB#0
+; EVEX: VDIVPSZrr
+; EVEX: Latency : 18
+define <16 x float> @divps_zmm(<16 x float> %a, <16 x float> %b) {
+  %r = fdiv <16 x float> %a, %b
+  ret <16 x float> %r
+}
+
+; EVEX-LABEL: pmulld_zmm:BB#0
+; EVEX: VPMULLDZrr
+; EVEX: Latency : 10
+define <16 x i32> @pmulld_zmm(<16 x i32> %a, <16 x i32> %b) {
+  %r = mul <16 x i32> %a, %b
+  ret <16 x i32> %r
+}
+
+; EVEX-LABEL: pand_zmm:BB#0
+; EVEX: VPANDDZrr
+; EVEX: Latency : 1
+define <16 x i32> @pand_zmm(<16 x i32> %a, <16 x i32> %b) {
+  %r = and <16 x i32> %a, %b
+  ret <16 x i32> %r
+}
+
+declare i32 @llvm.ctpop.i32(i32)
+declare i32 @llvm.x86.bmi.pdep.32(i32, i32)
+declare <8 x float> @llvm.fma.v8f32(<8 x float>, <8 x float>, <8 x float>)
+declare <4 x double> @llvm.sqrt.v4f64(<4 x double>)
+declare <8 x float> @llvm.x86.avx2.permps(<8 x float>, <8 x i32>)
@@ -0,0 +1,80 @@
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -verify-liveinterval-updates \
+; RUN:   | FileCheck %s
+; RUN: llc < %s -mtriple=x86_64-unknown-unknown -verify-liveinterval-updates \
+; RUN:   -early-live-intervals | FileCheck %s
+
+; The two-address pass, the coalescer and the machine scheduler all update
+; live intervals in place. Check those updates against a full recompute on a
+; loop with tied operands and sub-register uses.
+
+; CHECK-LABEL: loop:
+; CHECK: retq
+define i32 @loop(i32* %p, i32 %n) {
+entry:
+  br label %body
+
+body:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %body ]
+  %acc = phi i32 [ 1, %entry ], [ %acc.next, %body ]
+  %idx = sext i32 %i to i64
+  %addr = getelementptr i32, i32* %p, i64 %idx
+  %v = load i32, i32* %addr
+  %mul = mul i32 %acc, %v
+  %lo = trunc i32 %mul to i16
+  %ext = zext i16 %lo to i32
+  %acc.next = add i32 %ext, %i
+  %i.next = add i32 %i, 1
+  %done = icmp eq i32 %i.next, %n
+  br i1 %done, label %exit, label %body
+
+exit:
+  ret i32 %acc.next
+}
+
+; The same loop with debug values around the converted increment. They must
+; not be indexed along with the instructions that three-address conversion
+; emits.
+
+; CHECK-LABEL: loop_dbg:
+; CHECK: retq
+define i32 @loop_dbg(i32* %p, i32 %n) !dbg !4 {
+entry:
+  br label %body
+
+body:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %body ]
+  %acc = phi i32 [ 1, %entry ], [ %acc.next, %body ]
+  %idx = sext i32 %i to i64
+  %addr = getelementptr i32, i32* %p, i64 %idx
+  %v = load i32, i32* %addr
+  %mul = mul i32 %acc, %v
+  %lo = trunc i32 %mul to i16
+  %ext = zext i16 %lo to i32
+  %acc.next = add i32 %ext, %i
+  call void @llvm.dbg.value(metadata i32 %i, i64 0, metadata !9, metadata !10), !dbg !11
+  %i.next = add i32 %i, 1
+  call void @llvm.dbg.value(metadata i32 %i.next, i64 0, metadata !9, metadata !10), !dbg !11
+  %done = icmp eq i32 %i.next, %n
+  br i1 %done, label %exit, label %body
+
+exit:
+  ret i32 %acc.next
+}
+
+declare void @llvm.dbg.value(metadata, i64, metadata, metadata)
+
+!llvm.dbg.cu = !{!0}
+!llvm.module.flags = !{!12}
+
+!0 = distinct !DICompileUnit(language: DW_LANG_C99, producer: "clang", isOptimized: true, emissionKind: 1, file: !1, enums: !2, retainedTypes: !2, subprograms: !3, globals: !2, imports: !2)
+!1 = !DIFile(filename: "loop.c", directory: "/tmp")
+!2 = !{}
+!3 = !{!4}
+!4 = distinct !DISubprogram(name: "loop_dbg", line: 1, isLocal: false, isDefinition: true, isOptimized: true, scopeLine: 1, file: !1, scope: !1, type: !5, variables: !2)
+!5 = !DISubroutineType(types: !6)
+!6 = !{!7}
+!7 = !DIBasicType(name: "int", size: 32, align: 32, encoding: DW_ATE_signed)
+!9 = !DILocalVariable(name: "i", line: 2, scope: !4, file: !1, type: !7)
+!10 = !DIExpression()
+!11 = !DILocation(line: 2, scope: !4)
+!12 = !{i32 2, !"Debug Info Version", i32 3}
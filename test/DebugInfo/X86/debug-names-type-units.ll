@@ -0,0 +1,64 @@
+; RUN: llc -mtriple=x86_64-pc-linux-gnu -dwarf-debug-names=Enable \
+; RUN:   -generate-type-units -filetype=obj < %s -o %t
+; RUN: llvm-dwarfdump -debug-dump=debug_names %t | FileCheck %s
+; RUN: llvm-dwarfdump -debug-dump=debug_names %t \
+; RUN:   | FileCheck --check-prefix=NOTU %s
+
+; The index covers both compile units. The structure and its member types
+; live in a type unit in .debug_types, which a DWARF v5 name index cannot refer
+; to. Only the DIEs of the compile units, including their declarations of the
+; structure, are indexed.
+
+; Derived from:
+; a.cpp:
+;   namespace ns { struct S { int x; }; }
+;   ns::S A;
+; b.cpp:
+;   namespace ns { struct S { int x; }; }
+;   ns::S B;
+
+; CHECK: .debug_names contents:
+; CHECK: Name index @ 0x00000000
+; CHECK-NEXT: Version = 5
+; CHECK-NEXT: CU count = 2
+; CHECK-NEXT: Local TU count = 0
+; CHECK-NEXT: Foreign TU count = 0
+; CHECK: CU[0] = 0x00000000
+; CHECK-NEXT: CU[1] = [[CU1:0x[0-9a-f]+]]
+; CHECK-DAG: String: 0x{{[0-9a-f]*}} "A"}
+; CHECK-DAG: Entry: DW_TAG_variable CU: 0x00000000 DIE: 0x{{[0-9a-f]*}}
+; CHECK-DAG: String: 0x{{[0-9a-f]*}} "B"}
+; CHECK-DAG: Entry: DW_TAG_variable CU: [[CU1]] DIE: 0x{{[0-9a-f]*}}
+; CHECK-DAG: String: 0x{{[0-9a-f]*}} "S"}
+; CHECK-DAG: Entry: DW_TAG_structure_type CU: 0x00000000 DIE: 0x{{[0-9a-f]*}}
+; CHECK-DAG: Entry: DW_TAG_structure_type CU: [[CU1]] DIE: 0x{{[0-9a-f]*}}
+
+; NOTU: Name count = 4
+; NOTU-NOT: "int"
+; NOTU-NOT: DW_TAG_base_type
+
+%"struct.ns::S" = type { i32 }
+
+@A = global %"struct.ns::S" zeroinitializer, align 4
+@B = global %"struct.ns::S" zeroinitializer, align 4
+
+!llvm.dbg.cu = !{!0, !10}
+!llvm.module.flags = !{!14, !15}
+
+!0 = distinct !DICompileUnit(language: DW_LANG_C_plus_plus, producer: "clang", isOptimized: false, emissionKind: 1, file: !1, enums: !2, retainedTypes: !3, globals: !8)
+!1 = !DIFile(filename: "a.cpp", directory: "/tmp")
+!2 = !{}
+!3 = !{!4}
+!4 = !DICompositeType(tag: DW_TAG_structure_type, name: "S", scope: !5, file: !1, line: 1, size: 32, align: 32, elements: !6, identifier: "_ZTSN2ns1SE")
+!5 = !DINamespace(name: "ns", scope: null, file: !1, line: 1)
+!6 = !{!7}
+!7 = !DIDerivedType(tag: DW_TAG_member, name: "x", scope: !"_ZTSN2ns1SE", file: !1, line: 1, baseType: !13, size: 32, align: 32)
+!8 = !{!9}
+!9 = !DIGlobalVariable(name: "A", scope: !0, file: !1, line: 2, type: !"_ZTSN2ns1SE", isLocal: false, isDefinition: true, variable: %"struct.ns::S"* @A)
+!10 = distinct !DICompileUnit(language: DW_LANG_C_plus_plus, producer: "clang", isOptimized: false, emissionKind: 1, file: !11, enums: !2, retainedTypes: !3, globals: !12)
+!11 = !DIFile(filename: "b.cpp", directory: "/tmp")
+!12 = !{!16}
+!13 = !DIBasicType(name: "int", size: 32, align: 32, encoding: DW_ATE_signed)
+!14 = !{i32 2, !"Dwarf Version", i32 4}
+!15 = !{i32 2, !"Debug Info Version", i32 3}
+!16 = !DIGlobalVariable(name: "B", scope: !10, file: !11, line: 2, type: !"_ZTSN2ns1SE", isLocal: false, isDefinition: true, variable: %"struct.ns::S"* @B)
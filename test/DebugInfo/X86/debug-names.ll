@@ -0,0 +1,74 @@
+; RUN: llc -mtriple=x86_64-pc-linux-gnu -dwarf-debug-names=Enable -filetype=obj < %s -o %t
+; RUN: llvm-dwarfdump -debug-dump=debug_names %t | FileCheck %s
+; RUN: llvm-dwarfdump -find=main -find=Counter -find=missing %t \
+; RUN:   | FileCheck --check-prefix=FIND %s
+; RUN: llc -mtriple=x86_64-pc-linux-gnu -dwarf-debug-names=Enable < %s \
+; RUN:   | FileCheck --check-prefix=ASM %s
+; RUN: llc -mtriple=x86_64-pc-linux-gnu -filetype=obj < %s \
+; RUN:   | llvm-readobj -sections - | FileCheck --check-prefix=NONE %s
+
+; Derived from:
+; int Counter;
+; int main(void) {
+;   return Counter;
+; }
+
+; CHECK: .debug_names contents:
+; CHECK: Name index @ 0x00000000
+; CHECK-NEXT: Version = 5
+; CHECK-NEXT: CU count = 1
+; CHECK-NEXT: Local TU count = 0
+; CHECK-NEXT: Foreign TU count = 0
+; CHECK-NEXT: Bucket count = 3
+; CHECK-NEXT: Name count = 3
+; CHECK: CU[0] = 0x00000000
+; CHECK-DAG: Abbrev[0x24] DW_TAG_base_type DW_IDX_die_offset:DW_FORM_ref4
+; CHECK-DAG: Abbrev[0x2e] DW_TAG_subprogram DW_IDX_die_offset:DW_FORM_ref4
+; CHECK-DAG: Abbrev[0x34] DW_TAG_variable DW_IDX_die_offset:DW_FORM_ref4
+; CHECK-DAG: String: 0x{{[0-9a-f]*}} "main"}
+; CHECK-DAG: Entry: DW_TAG_subprogram CU: 0x00000000 DIE: 0x{{[0-9a-f]*}}
+; CHECK-DAG: String: 0x{{[0-9a-f]*}} "Counter"}
+; CHECK-DAG: Entry: DW_TAG_variable CU: 0x00000000 DIE: 0x{{[0-9a-f]*}}
+; CHECK-DAG: String: 0x{{[0-9a-f]*}} "int"}
+; CHECK-DAG: Entry: DW_TAG_base_type CU: 0x00000000 DIE: 0x{{[0-9a-f]*}}
+
+; FIND: DW_TAG_subprogram
+; FIND: DW_AT_name {{.*}} "main"
+; FIND: DW_TAG_variable
+; FIND: DW_AT_name {{.*}} "Counter"
+; FIND-NOT: DW_TAG
+
+; ASM: .section .debug_names,"",@progbits
+; ASM-NEXT: .long .Lnames_end0-.Lnames_start0 # Header: unit length
+; ASM-NEXT: .Lnames_start0:
+; ASM-NEXT: .short 5 # Header: version
+; ASM: .long .Lcu_begin0 # Compilation unit 0
+; ASM: .Lnames_end0:
+
+; The index is only emitted by default for DWARF v5.
+; NONE-NOT: .debug_names
+
+@Counter = global i32 0, align 4
+
+define i32 @main() !dbg !4 {
+entry:
+  %0 = load i32, i32* @Counter, align 4, !dbg !10
+  ret i32 %0, !dbg !10
+}
+
+!llvm.dbg.cu = !{!0}
+!llvm.module.flags = !{!9, !11}
+
+!0 = distinct !DICompileUnit(language: DW_LANG_C99, producer: "clang", isOptimized: false, emissionKind: 0, file: !1, enums: !2, retainedTypes: !2, subprograms: !3, globals: !12, imports: !2)
+!1 = !DIFile(filename: "names.c", directory: "/tmp")
+!2 = !{}
+!3 = !{!4}
+!4 = distinct !DISubprogram(name: "main", line: 2, isLocal: false, isDefinition: true, flags: DIFlagPrototyped, isOptimized: false, scopeLine: 2, file: !1, scope: !1, type: !6, variables: !2)
+!6 = !DISubroutineType(types: !7)
+!7 = !{!8}
+!8 = !DIBasicType(tag: DW_TAG_base_type, name: "int", size: 32, align: 32, encoding: DW_ATE_signed)
+!9 = !{i32 2, !"Dwarf Version", i32 4}
+!10 = !DILocation(line: 3, scope: !4)
+!11 = !{i32 1, !"Debug Info Version", i32 3}
+!12 = !{!13}
+!13 = !DIGlobalVariable(name: "Counter", scope: !0, file: !1, line: 1, type: !8, isLocal: false, isDefinition: true, variable: i32* @Counter)
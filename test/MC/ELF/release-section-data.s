@@ -0,0 +1,28 @@
+// REQUIRES: asserts
+// RUN: llvm-mc -filetype=obj -triple x86_64-pc-linux -stats %s -o %t 2>&1 \
+// RUN:   | FileCheck %s
+// RUN: llvm-readobj -sections -section-data %t \
+// RUN:   | FileCheck --check-prefix=OBJ %s
+
+// The ELF writer frees the contents of the fragments of each section as soon
+// as it has written the section out: 21 bytes of .text and 12 of .data. The
+// object still holds all of them.
+
+// CHECK: 33 assembler - Number of fragment bytes freed once written out
+
+// OBJ:      Name: .text
+// OBJ:      SectionData (
+// OBJ-NEXT:   0000: 01000000 00000000 02000000 00000000
+// OBJ-NEXT:   0010: B8010000 00
+// OBJ-NEXT: )
+// OBJ:      Name: .data
+// OBJ:      SectionData (
+// OBJ-NEXT:   0000: 01000000 02000000 03000000
+// OBJ-NEXT: )
+
+	.text
+	.quad 1, 2
+	movl $1, %eax
+
+	.data
+	.long 1, 2, 3
@@ -0,0 +1,21 @@
+// RUN: llvm-mc -triple x86_64-pc-linux -filetype=obj %s -o - | llvm-readobj -s | FileCheck %s
+
+// Each backward jump below only fits in a short jump if the one it jumps over
+// does too. Relaxing the first one must relax all of them, which layout used to
+// take one iteration per jump to find out, making it quadratic.
+
+.text
+2:
+  .fill 200, 1, 0x90
+.rept 2000
+1:
+  jmp 2b
+  .fill 124, 1, 0x90
+2:
+  jmp 1b
+  .fill 124, 1, 0x90
+.endr
+
+// All the jumps are relaxed: 200 + 2000 * 2 * (5 + 124).
+// CHECK:      Name: .text
+// CHECK:      Size: 516200
@@ -0,0 +1,11 @@
+; RUN: opt -instcombine -print-memory-usage -disable-output < %s 2>&1 | FileCheck %s
+
+; CHECK: Memory usage after 'Combine redundant instructions' on 'foo'
+; CHECK: Total: {{[0-9]+}} bytes
+; CHECK-DAG: module.instructions
+; CHECK-DAG: types.allocator
+
+define i32 @foo(i32 %x) {
+  %a = add i32 %x, 0
+  ret i32 %a
+}
@@ -0,0 +1,146 @@
+; RUN: opt -basicaa -loop-fusion -S < %s | FileCheck %s
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+
+; The second loop reads B[i + 1], which the first loop writes in the next
+; iteration.
+
+; CHECK-LABEL: @backward_dep(
+; CHECK: br i1 %cond0, label %loop1.ph, label %loop0
+; CHECK: br i1 %cond1, label %exit, label %loop1
+
+define void @backward_dep(i32* noalias %A, i32* noalias %B, i32* noalias %C) {
+entry:
+  br label %loop0
+
+loop0:
+  %i0 = phi i64 [ 0, %entry ], [ %i0.next, %loop0 ]
+  %a.addr = getelementptr inbounds i32, i32* %A, i64 %i0
+  %a = load i32, i32* %a.addr, align 4
+  %b.addr = getelementptr inbounds i32, i32* %B, i64 %i0
+  store i32 %a, i32* %b.addr, align 4
+  %i0.next = add nuw nsw i64 %i0, 1
+  %cond0 = icmp eq i64 %i0.next, 100
+  br i1 %cond0, label %loop1.ph, label %loop0
+
+loop1.ph:
+  br label %loop1
+
+loop1:
+  %i1 = phi i64 [ 0, %loop1.ph ], [ %i1.next, %loop1 ]
+  %i1.next = add nuw nsw i64 %i1, 1
+  %b1.addr = getelementptr inbounds i32, i32* %B, i64 %i1.next
+  %b1 = load i32, i32* %b1.addr, align 4
+  %c.addr = getelementptr inbounds i32, i32* %C, i64 %i1
+  store i32 %b1, i32* %c.addr, align 4
+  %cond1 = icmp eq i64 %i1.next, 100
+  br i1 %cond1, label %exit, label %loop1
+
+exit:
+  ret void
+}
+
+; The loops run a different number of iterations.
+
+; CHECK-LABEL: @trip_counts(
+; CHECK: br i1 %cond0, label %loop1.ph, label %loop0
+; CHECK: br i1 %cond1, label %exit, label %loop1
+
+define void @trip_counts(i32* noalias %A, i32* noalias %B) {
+entry:
+  br label %loop0
+
+loop0:
+  %i0 = phi i64 [ 0, %entry ], [ %i0.next, %loop0 ]
+  %a.addr = getelementptr inbounds i32, i32* %A, i64 %i0
+  store i32 0, i32* %a.addr, align 4
+  %i0.next = add nuw nsw i64 %i0, 1
+  %cond0 = icmp eq i64 %i0.next, 100
+  br i1 %cond0, label %loop1.ph, label %loop0
+
+loop1.ph:
+  br label %loop1
+
+loop1:
+  %i1 = phi i64 [ 0, %loop1.ph ], [ %i1.next, %loop1 ]
+  %a1.addr = getelementptr inbounds i32, i32* %A, i64 %i1
+  store i32 1, i32* %a1.addr, align 4
+  %i1.next = add nuw nsw i64 %i1, 1
+  %cond1 = icmp eq i64 %i1.next, 50
+  br i1 %cond1, label %exit, label %loop1
+
+exit:
+  ret void
+}
+
+; The second loop uses the result of the first one.
+
+; CHECK-LABEL: @uses_result(
+; CHECK: br i1 %cond0, label %loop1.ph, label %loop0
+; CHECK: br i1 %cond1, label %exit, label %loop1
+
+define void @uses_result(i32* noalias %A, i32* noalias %B) {
+entry:
+  br label %loop0
+
+loop0:
+  %i0 = phi i64 [ 0, %entry ], [ %i0.next, %loop0 ]
+  %sum = phi i32 [ 0, %entry ], [ %sum.next, %loop0 ]
+  %a.addr = getelementptr inbounds i32, i32* %A, i64 %i0
+  %a = load i32, i32* %a.addr, align 4
+  %sum.next = add i32 %sum, %a
+  %i0.next = add nuw nsw i64 %i0, 1
+  %cond0 = icmp eq i64 %i0.next, 100
+  br i1 %cond0, label %loop1.ph, label %loop0
+
+loop1.ph:
+  %sum.lcssa = phi i32 [ %sum.next, %loop0 ]
+  br label %loop1
+
+loop1:
+  %i1 = phi i64 [ 0, %loop1.ph ], [ %i1.next, %loop1 ]
+  %a1.addr = getelementptr inbounds i32, i32* %A, i64 %i1
+  %a1 = load i32, i32* %a1.addr, align 4
+  %div = sdiv i32 %a1, %sum.lcssa
+  %b.addr = getelementptr inbounds i32, i32* %B, i64 %i1
+  store i32 %div, i32* %b.addr, align 4
+  %i1.next = add nuw nsw i64 %i1, 1
+  %cond1 = icmp eq i64 %i1.next, 100
+  br i1 %cond1, label %exit, label %loop1
+
+exit:
+  ret void
+}
+
+; The loops access unrelated arrays, so fusing them saves no memory traffic.
+
+; CHECK-LABEL: @no_common_array(
+; CHECK: br i1 %cond0, label %loop1.ph, label %loop0
+; CHECK: br i1 %cond1, label %exit, label %loop1
+
+define void @no_common_array(i32* noalias %A, i32* noalias %B) {
+entry:
+  br label %loop0
+
+loop0:
+  %i0 = phi i64 [ 0, %entry ], [ %i0.next, %loop0 ]
+  %a.addr = getelementptr inbounds i32, i32* %A, i64 %i0
+  store i32 0, i32* %a.addr, align 4
+  %i0.next = add nuw nsw i64 %i0, 1
+  %cond0 = icmp eq i64 %i0.next, 100
+  br i1 %cond0, label %loop1.ph, label %loop0
+
+loop1.ph:
+  br label %loop1
+
+loop1:
+  %i1 = phi i64 [ 0, %loop1.ph ], [ %i1.next, %loop1 ]
+  %b.addr = getelementptr inbounds i32, i32* %B, i64 %i1
+  store i32 1, i32* %b.addr, align 4
+  %i1.next = add nuw nsw i64 %i1, 1
+  %cond1 = icmp eq i64 %i1.next, 100
+  br i1 %cond1, label %exit, label %loop1
+
+exit:
+  ret void
+}
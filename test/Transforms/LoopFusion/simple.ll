@@ -0,0 +1,144 @@
+; RUN: opt -basicaa -loop-fusion -S < %s | FileCheck %s
+; RUN: opt -basicaa -loop-fusion -verify-loop-info -verify-dom-info -S < %s \
+; RUN:   | opt -analyze -loops | FileCheck %s --check-prefix=LOOPS
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+
+; Three loops over the same 100 elements:
+;
+;   for (i = 0; i < 100; i++) B[i] = A[i] * 3;
+;   for (i = 0; i < 100; i++) C[i] = B[i] + A[i];
+;   for (i = 0; i < 100; i++) D[i] = C[i] * B[i];
+;
+; Each loop reads what the previous one wrote in the same iteration, so they
+; are fused into a single loop.
+
+; LOOPS-LABEL: 'fuse_three':
+; LOOPS-NEXT: Loop at depth 1 containing: %loop0<header>,%loop1,%loop2<latch><exiting>
+; LOOPS-NOT: Loop at depth
+; LOOPS-LABEL: 'fuse_live_out':
+; LOOPS-NEXT: Loop at depth 1 containing: %loop0<header>,%loop1<latch><exiting>
+; LOOPS-NOT: Loop at depth
+
+; CHECK-LABEL: @fuse_three(
+; CHECK: entry:
+; CHECK-NEXT: br label %[[L0:.*]]
+; CHECK: [[L0]]:
+; CHECK-NEXT: %i0 = phi i64 [ 0, %entry ], [ %i0.next, %[[L2:.*]] ]
+; CHECK-NEXT: %i1 = phi i64 [ 0, %entry ], [ %i1.next, %[[L2]] ]
+; CHECK-NEXT: %i2 = phi i64 [ 0, %entry ], [ %i2.next, %[[L2]] ]
+; CHECK: store i32 %mul, i32* %b.addr
+; CHECK-NEXT: %i0.next = add nuw nsw i64 %i0, 1
+; CHECK-NEXT: br label %[[L1:.*]]
+; CHECK: [[L1]]:
+; CHECK: store i32 %add, i32* %c.addr
+; CHECK-NEXT: %i1.next = add nuw nsw i64 %i1, 1
+; CHECK-NEXT: br label %[[L2]]
+; CHECK: [[L2]]:
+; CHECK: store i32 %mul2, i32* %d.addr
+; CHECK: %i2.next = add nuw nsw i64 %i2, 1
+; CHECK-NEXT: %cond2 = icmp eq i64 %i2.next, 100
+; CHECK-NEXT: br i1 %cond2, label %exit, label %[[L0]]
+; CHECK: exit:
+; CHECK-NEXT: ret void
+
+define void @fuse_three(i32* noalias %A, i32* noalias %B, i32* noalias %C,
+                        i32* noalias %D) {
+entry:
+  br label %loop0
+
+loop0:
+  %i0 = phi i64 [ 0, %entry ], [ %i0.next, %loop0 ]
+  %a.addr = getelementptr inbounds i32, i32* %A, i64 %i0
+  %a = load i32, i32* %a.addr, align 4
+  %mul = mul nsw i32 %a, 3
+  %b.addr = getelementptr inbounds i32, i32* %B, i64 %i0
+  store i32 %mul, i32* %b.addr, align 4
+  %i0.next = add nuw nsw i64 %i0, 1
+  %cond0 = icmp eq i64 %i0.next, 100
+  br i1 %cond0, label %loop1.ph, label %loop0
+
+loop1.ph:
+  br label %loop1
+
+loop1:
+  %i1 = phi i64 [ 0, %loop1.ph ], [ %i1.next, %loop1 ]
+  %b1.addr = getelementptr inbounds i32, i32* %B, i64 %i1
+  %b1 = load i32, i32* %b1.addr, align 4
+  %a1.addr = getelementptr inbounds i32, i32* %A, i64 %i1
+  %a1 = load i32, i32* %a1.addr, align 4
+  %add = add nsw i32 %b1, %a1
+  %c.addr = getelementptr inbounds i32, i32* %C, i64 %i1
+  store i32 %add, i32* %c.addr, align 4
+  %i1.next = add nuw nsw i64 %i1, 1
+  %cond1 = icmp eq i64 %i1.next, 100
+  br i1 %cond1, label %loop2.ph, label %loop1
+
+loop2.ph:
+  br label %loop2
+
+loop2:
+  %i2 = phi i64 [ 0, %loop2.ph ], [ %i2.next, %loop2 ]
+  %c2.addr = getelementptr inbounds i32, i32* %C, i64 %i2
+  %c2 = load i32, i32* %c2.addr, align 4
+  %b2.addr = getelementptr inbounds i32, i32* %B, i64 %i2
+  %b2 = load i32, i32* %b2.addr, align 4
+  %mul2 = mul nsw i32 %c2, %b2
+  %d.addr = getelementptr inbounds i32, i32* %D, i64 %i2
+  store i32 %mul2, i32* %d.addr, align 4
+  %i2.next = add nuw nsw i64 %i2, 1
+  %cond2 = icmp eq i64 %i2.next, 100
+  br i1 %cond2, label %exit, label %loop2
+
+exit:
+  ret void
+}
+
+; The second loop overwrites the array the first one sums up, and the sum is
+; used after the second loop. Its LCSSA phi
+; moves to the exit of the fused loop, and the code between the loops is
+; hoisted above it.
+
+; CHECK-LABEL: @fuse_live_out(
+; CHECK: entry:
+; CHECK-NEXT: %n2 = shl i32 %n, 1
+; CHECK-NEXT: br label %loop0
+; CHECK: loop0:
+; CHECK: br label %loop1
+; CHECK: loop1:
+; CHECK: store i32 %n2
+; CHECK: br i1 %cond1, label %exit, label %loop0
+; CHECK: exit:
+; CHECK-NEXT: %sum.lcssa = phi i32 [ %sum.next, %loop1 ]
+; CHECK-NEXT: ret i32 %sum.lcssa
+
+define i32 @fuse_live_out(i32* %A, i32 %n) {
+entry:
+  br label %loop0
+
+loop0:
+  %i0 = phi i64 [ 0, %entry ], [ %i0.next, %loop0 ]
+  %sum = phi i32 [ 0, %entry ], [ %sum.next, %loop0 ]
+  %a.addr = getelementptr inbounds i32, i32* %A, i64 %i0
+  %a = load i32, i32* %a.addr, align 4
+  %sum.next = add i32 %sum, %a
+  %i0.next = add nuw nsw i64 %i0, 1
+  %cond0 = icmp eq i64 %i0.next, 64
+  br i1 %cond0, label %loop1.ph, label %loop0
+
+loop1.ph:
+  %sum.lcssa = phi i32 [ %sum.next, %loop0 ]
+  %n2 = shl i32 %n, 1
+  br label %loop1
+
+loop1:
+  %i1 = phi i64 [ 0, %loop1.ph ], [ %i1.next, %loop1 ]
+  %a1.addr = getelementptr inbounds i32, i32* %A, i64 %i1
+  store i32 %n2, i32* %a1.addr, align 4
+  %i1.next = add nuw nsw i64 %i1, 1
+  %cond1 = icmp eq i64 %i1.next, 64
+  br i1 %cond1, label %exit, label %loop1
+
+exit:
+  ret i32 %sum.lcssa
+}
@@ -0,0 +1,176 @@
+; RUN: opt < %s -loop-vectorize -enable-outer-loop-vectorization -S | FileCheck %s
+; RUN: opt < %s -loop-vectorize -enable-outer-loop-vectorization \
+; RUN:   -pass-remarks=loop-vectorize -disable-output 2>&1 | \
+; RUN:   FileCheck %s --check-prefix=REMARK
+; RUN: opt < %s -loop-vectorize -S | FileCheck %s --check-prefix=DISABLED
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; REMARK: remark: {{.*}}vectorized outer loop (vectorization width: 4)
+; REMARK: remark: {{.*}}loop not vectorized: inner loop control flow is not uniform across the vectorized iterations
+; REMARK: warning: {{.*}}loop not vectorized: failed explicitly specified loop vectorization
+; REMARK: remark: {{.*}}loop not vectorized: cannot prove that the outer loop iterations are independent
+; REMARK: warning: {{.*}}loop not vectorized: failed explicitly specified loop vectorization
+
+; DISABLED-NOT: <4 x float>
+
+; The sums of the columns of an 8 x N matrix:
+;
+;   #pragma clang loop vectorize(enable) vectorize_width(4)
+;   for (long i = 0; i < N; i++) {
+;     float S = 0;
+;     for (long j = 0; j < 8; j++)
+;       S += A[j * N + i] * B[j];
+;     C[i] = S;
+;   }
+;
+; The accesses are annotated with llvm.mem.parallel_loop_access, which states
+; that the outer iterations are independent. Every lane runs the inner loop 8
+; times, so it stays a loop with a scalar counter. B[j] is the same for all
+; lanes and is loaded once, while A and C are accessed with wide loads and
+; stores.
+
+; CHECK-LABEL: @colsum(
+; CHECK: vector.body:
+; CHECK: vector.inner:
+; CHECK:   %[[J:.*]] = phi i64 [ 0, %vector.body ], [ %[[JNEXT:.*]], %vector.inner ]
+; CHECK:   %[[S:.*]] = phi <4 x float> [ zeroinitializer, %vector.body ], [ %[[SNEXT:.*]], %vector.inner ]
+; CHECK:   load <4 x float>
+; CHECK:   load float, float*
+; CHECK:   fmul <4 x float>
+; CHECK:   %[[SNEXT]] = fadd <4 x float> %[[S]]
+; CHECK:   %[[JNEXT]] = add nuw nsw i64 %[[J]], 1
+; CHECK:   br i1 %{{.*}}, label %vector.latch, label %vector.inner
+; CHECK: vector.latch:
+; CHECK:   store <4 x float> %[[SNEXT]]
+; CHECK:   br i1 %{{.*}}, label %middle.block, label %vector.body
+
+define void @colsum(float* noalias %C, float* noalias %A, float* noalias %B, i64 %N) {
+entry:
+  br label %outer
+
+outer:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %outer.latch ]
+  br label %inner
+
+inner:
+  %j = phi i64 [ 0, %outer ], [ %j.next, %inner ]
+  %s = phi float [ 0.000000e+00, %outer ], [ %s.next, %inner ]
+  %jn = mul nsw i64 %j, %N
+  %idx = add nsw i64 %jn, %i
+  %a.addr = getelementptr inbounds float, float* %A, i64 %idx
+  %a = load float, float* %a.addr, align 4, !llvm.mem.parallel_loop_access !0
+  %b.addr = getelementptr inbounds float, float* %B, i64 %j
+  %b = load float, float* %b.addr, align 4, !llvm.mem.parallel_loop_access !0
+  %mul = fmul float %a, %b
+  %s.next = fadd float %s, %mul
+  %j.next = add nuw nsw i64 %j, 1
+  %inner.cond = icmp eq i64 %j.next, 8
+  br i1 %inner.cond, label %outer.latch, label %inner
+
+outer.latch:
+  %s.lcssa = phi float [ %s.next, %inner ]
+  %c.addr = getelementptr inbounds float, float* %C, i64 %i
+  store float %s.lcssa, float* %c.addr, align 4, !llvm.mem.parallel_loop_access !0
+  %i.next = add nuw nsw i64 %i, 1
+  %outer.cond = icmp eq i64 %i.next, %N
+  br i1 %outer.cond, label %exit, label %outer, !llvm.loop !0
+
+exit:
+  ret void
+}
+
+; The inner loop runs i + 1 times, which differs from lane to lane.
+
+; CHECK-LABEL: @triangle(
+; CHECK-NOT: <4 x float>
+; CHECK: ret void
+
+define void @triangle(float* noalias %C, float* noalias %A, i64 %N) {
+entry:
+  br label %outer
+
+outer:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %outer.latch ]
+  %i.next = add nuw nsw i64 %i, 1
+  br label %inner
+
+inner:
+  %j = phi i64 [ 0, %outer ], [ %j.next, %inner ]
+  %s = phi float [ 0.000000e+00, %outer ], [ %s.next, %inner ]
+  %jn = mul nsw i64 %j, %N
+  %idx = add nsw i64 %jn, %i
+  %a.addr = getelementptr inbounds float, float* %A, i64 %idx
+  %a = load float, float* %a.addr, align 4, !llvm.mem.parallel_loop_access !3
+  %s.next = fadd float %s, %a
+  %j.next = add nuw nsw i64 %j, 1
+  %inner.cond = icmp eq i64 %j.next, %i.next
+  br i1 %inner.cond, label %outer.latch, label %inner
+
+outer.latch:
+  %s.lcssa = phi float [ %s.next, %inner ]
+  %c.addr = getelementptr inbounds float, float* %C, i64 %i
+  store float %s.lcssa, float* %c.addr, align 4, !llvm.mem.parallel_loop_access !3
+  %outer.cond = icmp eq i64 %i.next, %N
+  br i1 %outer.cond, label %exit, label %outer, !llvm.loop !3
+
+exit:
+  ret void
+}
+
+; Each iteration reads the element of C written by the previous one:
+;
+;   #pragma clang loop vectorize(enable) vectorize_width(4)
+;   for (long i = 1; i < N; i++) {
+;     float S = C[i - 1];
+;     for (long j = 0; j < 8; j++)
+;       S += B[j];
+;     C[i] = S;
+;   }
+;
+; The accesses are not annotated as parallel, so the loop-carried dependence
+; cannot be ruled out and the loop is left alone.
+
+; CHECK-LABEL: @carried(
+; CHECK-NOT: <4 x float>
+; CHECK: ret void
+
+define void @carried(float* noalias %C, float* noalias %B, i64 %N) {
+entry:
+  br label %outer
+
+outer:
+  %i = phi i64 [ 1, %entry ], [ %i.next, %outer.latch ]
+  %prev = add nsw i64 %i, -1
+  %p.addr = getelementptr inbounds float, float* %C, i64 %prev
+  %p = load float, float* %p.addr, align 4
+  br label %inner
+
+inner:
+  %j = phi i64 [ 0, %outer ], [ %j.next, %inner ]
+  %s = phi float [ %p, %outer ], [ %s.next, %inner ]
+  %b.addr = getelementptr inbounds float, float* %B, i64 %j
+  %b = load float, float* %b.addr, align 4
+  %s.next = fadd float %s, %b
+  %j.next = add nuw nsw i64 %j, 1
+  %inner.cond = icmp eq i64 %j.next, 8
+  br i1 %inner.cond, label %outer.latch, label %inner
+
+outer.latch:
+  %s.lcssa = phi float [ %s.next, %inner ]
+  %c.addr = getelementptr inbounds float, float* %C, i64 %i
+  store float %s.lcssa, float* %c.addr, align 4
+  %i.next = add nuw nsw i64 %i, 1
+  %outer.cond = icmp eq i64 %i.next, %N
+  br i1 %outer.cond, label %exit, label %outer, !llvm.loop !4
+
+exit:
+  ret void
+}
+
+!0 = distinct !{!0, !1, !2}
+!1 = !{!"llvm.loop.vectorize.enable", i1 true}
+!2 = !{!"llvm.loop.vectorize.width", i32 4}
+!3 = distinct !{!3, !1, !2}
+!4 = distinct !{!4, !1, !2}
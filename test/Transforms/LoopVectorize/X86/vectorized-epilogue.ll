@@ -0,0 +1,86 @@
+; RUN: opt < %s -loop-vectorize -enable-epilogue-vectorization -mcpu=core-avx2 -S | FileCheck %s
+; RUN: opt < %s -loop-vectorize -mcpu=core-avx2 -S | FileCheck %s --check-prefix=DISABLED
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; The main loop handles 32 iterations at a time. The remainder gets a vector
+; loop of its own, entered after the main vector loop or when the trip count
+; is too short for it. The memory checks run first and, when they fail, go
+; straight to the scalar loop; the epilogue has no checks of its own.
+
+; CHECK-LABEL: @add(
+; CHECK: vector.memcheck:
+; CHECK: br i1 %memcheck.conflict, label %[[SCALARPH:scalar.ph[0-9]+]], label %vector.ph
+; CHECK: %min.iters.check = icmp ult i64 %{{.*}}, 32
+; CHECK: vector.body:
+; CHECK: load <8 x i32>
+; CHECK: middle.block:
+; CHECK: scalar.ph:
+; CHECK-NOT: memcheck
+; CHECK: %min.iters.check{{[0-9]+}} = icmp ult i64 %{{.*}}, 8
+; CHECK: vector.body{{[0-9]+}}:
+; CHECK: load <8 x i32>
+; CHECK: [[SCALARPH]]:
+; CHECK: for.body:
+
+; DISABLED-LABEL: @add(
+; DISABLED: vector.body:
+; DISABLED-NOT: vector.body{{[0-9]+}}:
+; DISABLED: for.body:
+
+define void @add(i32* %a, i32* %b, i32* %c, i64 %n) {
+entry:
+  %cmp = icmp sgt i64 %n, 0
+  br i1 %cmp, label %for.body, label %for.end
+
+for.body:
+  %i = phi i64 [ %i.next, %for.body ], [ 0, %entry ]
+  %pb = getelementptr inbounds i32, i32* %b, i64 %i
+  %vb = load i32, i32* %pb, align 4
+  %pc = getelementptr inbounds i32, i32* %c, i64 %i
+  %vc = load i32, i32* %pc, align 4
+  %sum = add nsw i32 %vc, %vb
+  %pa = getelementptr inbounds i32, i32* %a, i64 %i
+  store i32 %sum, i32* %pa, align 4
+  %i.next = add nuw nsw i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %for.end, label %for.body
+
+for.end:
+  ret void
+}
+
+; A reduction continues from the result of the main loop in the epilogue, and
+; from the result of the epilogue in the scalar loop.
+
+; CHECK-LABEL: @sum(
+; CHECK: vector.body:
+; CHECK: middle.block:
+; CHECK: scalar.ph:
+; CHECK: %bc.merge.rdx = phi i32
+; CHECK: insertelement <8 x i32> zeroinitializer, i32 %bc.merge.rdx, i32 0
+; CHECK: vector.body{{[0-9]+}}:
+; CHECK: scalar.ph{{[0-9]+}}:
+; CHECK: %bc.merge.rdx{{[0-9]+}} = phi i32
+; CHECK: for.body:
+
+define i32 @sum(i32* noalias %a, i64 %n) {
+entry:
+  %cmp = icmp sgt i64 %n, 0
+  br i1 %cmp, label %for.body, label %for.end
+
+for.body:
+  %i = phi i64 [ %i.next, %for.body ], [ 0, %entry ]
+  %acc = phi i32 [ %acc.next, %for.body ], [ 0, %entry ]
+  %p = getelementptr inbounds i32, i32* %a, i64 %i
+  %v = load i32, i32* %p, align 4
+  %acc.next = add nsw i32 %v, %acc
+  %i.next = add nuw nsw i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %for.end, label %for.body
+
+for.end:
+  %r = phi i32 [ 0, %entry ], [ %acc.next, %for.body ]
+  ret i32 %r
+}
@@ -0,0 +1,461 @@
+; RUN: opt -slp-vectorizer -slp-vectorize-hor -slp-vectorize-hor-store -S < %s -mtriple=x86_64-unknown-linux-gnu -mcpu=corei7 | FileCheck %s
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+
+; The min/max reductions below start from the value at %res. If the first
+; compare were between two of the reduced values, the pair would be
+; vectorized on its own before the whole reduction is matched.
+
+; A signed max of the sums of eight pairs of values is reduced with log2(8)
+; shuffles and compares.
+
+; CHECK-LABEL: @smax_v8i32(
+; CHECK: add <8 x i32>
+; CHECK: shufflevector <8 x i32>
+; CHECK: icmp sgt <8 x i32>
+; CHECK: select <8 x i1>
+; CHECK: extractelement <8 x i32>
+; CHECK: store i32
+
+define void @smax_v8i32(i32* %p, i32* %q, i32* %res) {
+entry:
+  %p0v = load i32, i32* %p, align 4
+  %q0v = load i32, i32* %q, align 4
+  %p1 = getelementptr inbounds i32, i32* %p, i64 1
+  %p1v = load i32, i32* %p1, align 4
+  %q1 = getelementptr inbounds i32, i32* %q, i64 1
+  %q1v = load i32, i32* %q1, align 4
+  %p2 = getelementptr inbounds i32, i32* %p, i64 2
+  %p2v = load i32, i32* %p2, align 4
+  %q2 = getelementptr inbounds i32, i32* %q, i64 2
+  %q2v = load i32, i32* %q2, align 4
+  %p3 = getelementptr inbounds i32, i32* %p, i64 3
+  %p3v = load i32, i32* %p3, align 4
+  %q3 = getelementptr inbounds i32, i32* %q, i64 3
+  %q3v = load i32, i32* %q3, align 4
+  %p4 = getelementptr inbounds i32, i32* %p, i64 4
+  %p4v = load i32, i32* %p4, align 4
+  %q4 = getelementptr inbounds i32, i32* %q, i64 4
+  %q4v = load i32, i32* %q4, align 4
+  %p5 = getelementptr inbounds i32, i32* %p, i64 5
+  %p5v = load i32, i32* %p5, align 4
+  %q5 = getelementptr inbounds i32, i32* %q, i64 5
+  %q5v = load i32, i32* %q5, align 4
+  %p6 = getelementptr inbounds i32, i32* %p, i64 6
+  %p6v = load i32, i32* %p6, align 4
+  %q6 = getelementptr inbounds i32, i32* %q, i64 6
+  %q6v = load i32, i32* %q6, align 4
+  %p7 = getelementptr inbounds i32, i32* %p, i64 7
+  %p7v = load i32, i32* %p7, align 4
+  %q7 = getelementptr inbounds i32, i32* %q, i64 7
+  %q7v = load i32, i32* %q7, align 4
+  %v0 = add i32 %p0v, %q0v
+  %v1 = add i32 %p1v, %q1v
+  %v2 = add i32 %p2v, %q2v
+  %v3 = add i32 %p3v, %q3v
+  %v4 = add i32 %p4v, %q4v
+  %v5 = add i32 %p5v, %q5v
+  %v6 = add i32 %p6v, %q6v
+  %v7 = add i32 %p7v, %q7v
+  %m = load i32, i32* %res, align 4
+  %c0 = icmp sgt i32 %m, %v0
+  %r0 = select i1 %c0, i32 %m, i32 %v0
+  %c1 = icmp sgt i32 %r0, %v1
+  %r1 = select i1 %c1, i32 %r0, i32 %v1
+  %c2 = icmp sgt i32 %r1, %v2
+  %r2 = select i1 %c2, i32 %r1, i32 %v2
+  %c3 = icmp sgt i32 %r2, %v3
+  %r3 = select i1 %c3, i32 %r2, i32 %v3
+  %c4 = icmp sgt i32 %r3, %v4
+  %r4 = select i1 %c4, i32 %r3, i32 %v4
+  %c5 = icmp sgt i32 %r4, %v5
+  %r5 = select i1 %c5, i32 %r4, i32 %v5
+  %c6 = icmp sgt i32 %r5, %v6
+  %r6 = select i1 %c6, i32 %r5, i32 %v6
+  %c7 = icmp sgt i32 %r6, %v7
+  %r7 = select i1 %c7, i32 %r6, i32 %v7
+  store i32 %r7, i32* %res, align 4
+  ret void
+}
+
+; Seven values: four are reduced in a vector, and the other three are folded
+; into the result with scalar compares and selects.
+
+; CHECK-LABEL: @umin_partial(
+; CHECK: add <4 x i32>
+; CHECK: icmp ult <4 x i32>
+; CHECK: %[[EXT:.*]] = extractelement <4 x i32>
+; CHECK: icmp ult i32 %[[EXT]]
+; CHECK: %[[SEL:.*]] = select i1 %{{.*}}, i32 %[[EXT]]
+; CHECK: icmp ult i32 %[[SEL]]
+; CHECK: store i32
+
+define void @umin_partial(i32* %p, i32* %q, i32* %res) {
+entry:
+  %p0v = load i32, i32* %p, align 4
+  %q0v = load i32, i32* %q, align 4
+  %p1 = getelementptr inbounds i32, i32* %p, i64 1
+  %p1v = load i32, i32* %p1, align 4
+  %q1 = getelementptr inbounds i32, i32* %q, i64 1
+  %q1v = load i32, i32* %q1, align 4
+  %p2 = getelementptr inbounds i32, i32* %p, i64 2
+  %p2v = load i32, i32* %p2, align 4
+  %q2 = getelementptr inbounds i32, i32* %q, i64 2
+  %q2v = load i32, i32* %q2, align 4
+  %p3 = getelementptr inbounds i32, i32* %p, i64 3
+  %p3v = load i32, i32* %p3, align 4
+  %q3 = getelementptr inbounds i32, i32* %q, i64 3
+  %q3v = load i32, i32* %q3, align 4
+  %p4 = getelementptr inbounds i32, i32* %p, i64 4
+  %p4v = load i32, i32* %p4, align 4
+  %q4 = getelementptr inbounds i32, i32* %q, i64 4
+  %q4v = load i32, i32* %q4, align 4
+  %p5 = getelementptr inbounds i32, i32* %p, i64 5
+  %p5v = load i32, i32* %p5, align 4
+  %q5 = getelementptr inbounds i32, i32* %q, i64 5
+  %q5v = load i32, i32* %q5, align 4
+  %v0 = add i32 %p0v, %q0v
+  %v1 = add i32 %p1v, %q1v
+  %v2 = add i32 %p2v, %q2v
+  %v3 = add i32 %p3v, %q3v
+  %v4 = add i32 %p4v, %q4v
+  %v5 = add i32 %p5v, %q5v
+  %m = load i32, i32* %res, align 4
+  %c0 = icmp ult i32 %m, %v0
+  %r0 = select i1 %c0, i32 %m, i32 %v0
+  %c1 = icmp ult i32 %r0, %v1
+  %r1 = select i1 %c1, i32 %r0, i32 %v1
+  %c2 = icmp ult i32 %r1, %v2
+  %r2 = select i1 %c2, i32 %r1, i32 %v2
+  %c3 = icmp ult i32 %r2, %v3
+  %r3 = select i1 %c3, i32 %r2, i32 %v3
+  %c4 = icmp ult i32 %r3, %v4
+  %r4 = select i1 %c4, i32 %r3, i32 %v4
+  %c5 = icmp ult i32 %r4, %v5
+  %r5 = select i1 %c5, i32 %r4, i32 %v5
+  store i32 %r5, i32* %res, align 4
+  ret void
+}
+
+; CHECK-LABEL: @xor_v8i32(
+; CHECK: add <8 x i32>
+; CHECK: xor <8 x i32>
+; CHECK: extractelement <8 x i32>
+
+define void @xor_v8i32(i32* %p, i32* %q, i32* %res) {
+entry:
+  %p0v = load i32, i32* %p, align 4
+  %q0v = load i32, i32* %q, align 4
+  %p1 = getelementptr inbounds i32, i32* %p, i64 1
+  %p1v = load i32, i32* %p1, align 4
+  %q1 = getelementptr inbounds i32, i32* %q, i64 1
+  %q1v = load i32, i32* %q1, align 4
+  %p2 = getelementptr inbounds i32, i32* %p, i64 2
+  %p2v = load i32, i32* %p2, align 4
+  %q2 = getelementptr inbounds i32, i32* %q, i64 2
+  %q2v = load i32, i32* %q2, align 4
+  %p3 = getelementptr inbounds i32, i32* %p, i64 3
+  %p3v = load i32, i32* %p3, align 4
+  %q3 = getelementptr inbounds i32, i32* %q, i64 3
+  %q3v = load i32, i32* %q3, align 4
+  %p4 = getelementptr inbounds i32, i32* %p, i64 4
+  %p4v = load i32, i32* %p4, align 4
+  %q4 = getelementptr inbounds i32, i32* %q, i64 4
+  %q4v = load i32, i32* %q4, align 4
+  %p5 = getelementptr inbounds i32, i32* %p, i64 5
+  %p5v = load i32, i32* %p5, align 4
+  %q5 = getelementptr inbounds i32, i32* %q, i64 5
+  %q5v = load i32, i32* %q5, align 4
+  %p6 = getelementptr inbounds i32, i32* %p, i64 6
+  %p6v = load i32, i32* %p6, align 4
+  %q6 = getelementptr inbounds i32, i32* %q, i64 6
+  %q6v = load i32, i32* %q6, align 4
+  %p7 = getelementptr inbounds i32, i32* %p, i64 7
+  %p7v = load i32, i32* %p7, align 4
+  %q7 = getelementptr inbounds i32, i32* %q, i64 7
+  %q7v = load i32, i32* %q7, align 4
+  %v0 = add i32 %p0v, %q0v
+  %v1 = add i32 %p1v, %q1v
+  %v2 = add i32 %p2v, %q2v
+  %v3 = add i32 %p3v, %q3v
+  %v4 = add i32 %p4v, %q4v
+  %v5 = add i32 %p5v, %q5v
+  %v6 = add i32 %p6v, %q6v
+  %v7 = add i32 %p7v, %q7v
+  %r1 = xor i32 %v0, %v1
+  %r2 = xor i32 %r1, %v2
+  %r3 = xor i32 %r2, %v3
+  %r4 = xor i32 %r3, %v4
+  %r5 = xor i32 %r4, %v5
+  %r6 = xor i32 %r5, %v6
+  %r7 = xor i32 %r6, %v7
+  store i32 %r7, i32* %res, align 4
+  ret void
+}
+
+; CHECK-LABEL: @and_v4i32(
+; CHECK: add <4 x i32>
+; CHECK: and <4 x i32>
+; CHECK: extractelement <4 x i32>
+
+define void @and_v4i32(i32* %p, i32* %q, i32* %res) {
+entry:
+  %p0v = load i32, i32* %p, align 4
+  %q0v = load i32, i32* %q, align 4
+  %p1 = getelementptr inbounds i32, i32* %p, i64 1
+  %p1v = load i32, i32* %p1, align 4
+  %q1 = getelementptr inbounds i32, i32* %q, i64 1
+  %q1v = load i32, i32* %q1, align 4
+  %p2 = getelementptr inbounds i32, i32* %p, i64 2
+  %p2v = load i32, i32* %p2, align 4
+  %q2 = getelementptr inbounds i32, i32* %q, i64 2
+  %q2v = load i32, i32* %q2, align 4
+  %p3 = getelementptr inbounds i32, i32* %p, i64 3
+  %p3v = load i32, i32* %p3, align 4
+  %q3 = getelementptr inbounds i32, i32* %q, i64 3
+  %q3v = load i32, i32* %q3, align 4
+  %v0 = add i32 %p0v, %q0v
+  %v1 = add i32 %p1v, %q1v
+  %v2 = add i32 %p2v, %q2v
+  %v3 = add i32 %p3v, %q3v
+  %r1 = and i32 %v0, %v1
+  %r2 = and i32 %r1, %v2
+  %r3 = and i32 %r2, %v3
+  store i32 %r3, i32* %res, align 4
+  ret void
+}
+
+; When the reduced values are consecutive loads, the tree has a single
+; bundle, which the reduction consumes as a whole.
+
+; CHECK-LABEL: @smax_loads(
+; CHECK: load <8 x i32>
+; CHECK: icmp sgt <8 x i32>
+; CHECK: extractelement <8 x i32>
+
+define void @smax_loads(i32* %p, i32* %res) {
+entry:
+  %a0 = load i32, i32* %p, align 4
+  %p1 = getelementptr inbounds i32, i32* %p, i64 1
+  %a1 = load i32, i32* %p1, align 4
+  %p2 = getelementptr inbounds i32, i32* %p, i64 2
+  %a2 = load i32, i32* %p2, align 4
+  %p3 = getelementptr inbounds i32, i32* %p, i64 3
+  %a3 = load i32, i32* %p3, align 4
+  %p4 = getelementptr inbounds i32, i32* %p, i64 4
+  %a4 = load i32, i32* %p4, align 4
+  %p5 = getelementptr inbounds i32, i32* %p, i64 5
+  %a5 = load i32, i32* %p5, align 4
+  %p6 = getelementptr inbounds i32, i32* %p, i64 6
+  %a6 = load i32, i32* %p6, align 4
+  %p7 = getelementptr inbounds i32, i32* %p, i64 7
+  %a7 = load i32, i32* %p7, align 4
+  %c1 = icmp sgt i32 %a0, %a1
+  %r1 = select i1 %c1, i32 %a0, i32 %a1
+  %c2 = icmp sgt i32 %r1, %a2
+  %r2 = select i1 %c2, i32 %r1, i32 %a2
+  %c3 = icmp sgt i32 %r2, %a3
+  %r3 = select i1 %c3, i32 %r2, i32 %a3
+  %c4 = icmp sgt i32 %r3, %a4
+  %r4 = select i1 %c4, i32 %r3, i32 %a4
+  %c5 = icmp sgt i32 %r4, %a5
+  %r5 = select i1 %c5, i32 %r4, i32 %a5
+  %c6 = icmp sgt i32 %r5, %a6
+  %r6 = select i1 %c6, i32 %r5, i32 %a6
+  %c7 = icmp sgt i32 %r6, %a7
+  %r7 = select i1 %c7, i32 %r6, i32 %a7
+  store i32 %r7, i32* %res, align 4
+  ret void
+}
+
+; Floating-point min/max reductions can only be reordered if NaNs and the
+; sign of zero can be ignored. The new compares keep the flags of the
+; original ones, and do not pick up flags from the function attributes.
+
+; CHECK-LABEL: @fmax_attrs(
+; CHECK: fmul <4 x float>
+; CHECK: fcmp ogt <4 x float>
+; CHECK: extractelement <4 x float>
+
+define void @fmax_attrs(float* %p, float* %q, float* %res) #0 {
+entry:
+  %p0v = load float, float* %p, align 4
+  %q0v = load float, float* %q, align 4
+  %p1 = getelementptr inbounds float, float* %p, i64 1
+  %p1v = load float, float* %p1, align 4
+  %q1 = getelementptr inbounds float, float* %q, i64 1
+  %q1v = load float, float* %q1, align 4
+  %p2 = getelementptr inbounds float, float* %p, i64 2
+  %p2v = load float, float* %p2, align 4
+  %q2 = getelementptr inbounds float, float* %q, i64 2
+  %q2v = load float, float* %q2, align 4
+  %p3 = getelementptr inbounds float, float* %p, i64 3
+  %p3v = load float, float* %p3, align 4
+  %q3 = getelementptr inbounds float, float* %q, i64 3
+  %q3v = load float, float* %q3, align 4
+  %v0 = fmul float %p0v, %q0v
+  %v1 = fmul float %p1v, %q1v
+  %v2 = fmul float %p2v, %q2v
+  %v3 = fmul float %p3v, %q3v
+  %m = load float, float* %res, align 4
+  %c0 = fcmp ogt float %m, %v0
+  %r0 = select i1 %c0, float %m, float %v0
+  %c1 = fcmp ogt float %r0, %v1
+  %r1 = select i1 %c1, float %r0, float %v1
+  %c2 = fcmp ogt float %r1, %v2
+  %r2 = select i1 %c2, float %r1, float %v2
+  %c3 = fcmp ogt float %r2, %v3
+  %r3 = select i1 %c3, float %r2, float %v3
+  store float %r3, float* %res, align 4
+  ret void
+}
+
+; CHECK-LABEL: @fmax_flags(
+; CHECK: fmul <4 x float>
+; CHECK: fcmp nnan nsz ogt <4 x float>
+; CHECK: extractelement <4 x float>
+
+define void @fmax_flags(float* %p, float* %q, float* %res) {
+entry:
+  %p0v = load float, float* %p, align 4
+  %q0v = load float, float* %q, align 4
+  %p1 = getelementptr inbounds float, float* %p, i64 1
+  %p1v = load float, float* %p1, align 4
+  %q1 = getelementptr inbounds float, float* %q, i64 1
+  %q1v = load float, float* %q1, align 4
+  %p2 = getelementptr inbounds float, float* %p, i64 2
+  %p2v = load float, float* %p2, align 4
+  %q2 = getelementptr inbounds float, float* %q, i64 2
+  %q2v = load float, float* %q2, align 4
+  %p3 = getelementptr inbounds float, float* %p, i64 3
+  %p3v = load float, float* %p3, align 4
+  %q3 = getelementptr inbounds float, float* %q, i64 3
+  %q3v = load float, float* %q3, align 4
+  %v0 = fmul float %p0v, %q0v
+  %v1 = fmul float %p1v, %q1v
+  %v2 = fmul float %p2v, %q2v
+  %v3 = fmul float %p3v, %q3v
+  %m = load float, float* %res, align 4
+  %c0 = fcmp nnan nsz ogt float %m, %v0
+  %r0 = select i1 %c0, float %m, float %v0
+  %c1 = fcmp nnan nsz ogt float %r0, %v1
+  %r1 = select i1 %c1, float %r0, float %v1
+  %c2 = fcmp nnan nsz ogt float %r1, %v2
+  %r2 = select i1 %c2, float %r1, float %v2
+  %c3 = fcmp nnan nsz ogt float %r2, %v3
+  %r3 = select i1 %c3, float %r2, float %v3
+  store float %r3, float* %res, align 4
+  ret void
+}
+
+; CHECK-LABEL: @fmin_fast(
+; CHECK: fcmp fast olt <4 x float>
+
+define void @fmin_fast(float* %p, float* %q, float* %res) {
+entry:
+  %p0v = load float, float* %p, align 4
+  %q0v = load float, float* %q, align 4
+  %p1 = getelementptr inbounds float, float* %p, i64 1
+  %p1v = load float, float* %p1, align 4
+  %q1 = getelementptr inbounds float, float* %q, i64 1
+  %q1v = load float, float* %q1, align 4
+  %p2 = getelementptr inbounds float, float* %p, i64 2
+  %p2v = load float, float* %p2, align 4
+  %q2 = getelementptr inbounds float, float* %q, i64 2
+  %q2v = load float, float* %q2, align 4
+  %p3 = getelementptr inbounds float, float* %p, i64 3
+  %p3v = load float, float* %p3, align 4
+  %q3 = getelementptr inbounds float, float* %q, i64 3
+  %q3v = load float, float* %q3, align 4
+  %v0 = fmul float %p0v, %q0v
+  %v1 = fmul float %p1v, %q1v
+  %v2 = fmul float %p2v, %q2v
+  %v3 = fmul float %p3v, %q3v
+  %m = load float, float* %res, align 4
+  %c0 = fcmp fast olt float %m, %v0
+  %r0 = select i1 %c0, float %m, float %v0
+  %c1 = fcmp fast olt float %r0, %v1
+  %r1 = select i1 %c1, float %r0, float %v1
+  %c2 = fcmp fast olt float %r1, %v2
+  %r2 = select i1 %c2, float %r1, float %v2
+  %c3 = fcmp fast olt float %r2, %v3
+  %r3 = select i1 %c3, float %r2, float %v3
+  store float %r3, float* %res, align 4
+  ret void
+}
+
+; CHECK-LABEL: @fmax_nnan_only(
+; CHECK-NOT: <4 x float>
+; CHECK: ret void
+
+define void @fmax_nnan_only(float* %p, float* %q, float* %res) {
+entry:
+  %p0v = load float, float* %p, align 4
+  %q0v = load float, float* %q, align 4
+  %p1 = getelementptr inbounds float, float* %p, i64 1
+  %p1v = load float, float* %p1, align 4
+  %q1 = getelementptr inbounds float, float* %q, i64 1
+  %q1v = load float, float* %q1, align 4
+  %p2 = getelementptr inbounds float, float* %p, i64 2
+  %p2v = load float, float* %p2, align 4
+  %q2 = getelementptr inbounds float, float* %q, i64 2
+  %q2v = load float, float* %q2, align 4
+  %p3 = getelementptr inbounds float, float* %p, i64 3
+  %p3v = load float, float* %p3, align 4
+  %q3 = getelementptr inbounds float, float* %q, i64 3
+  %q3v = load float, float* %q3, align 4
+  %v0 = fmul float %p0v, %q0v
+  %v1 = fmul float %p1v, %q1v
+  %v2 = fmul float %p2v, %q2v
+  %v3 = fmul float %p3v, %q3v
+  %m = load float, float* %res, align 4
+  %c0 = fcmp nnan ogt float %m, %v0
+  %r0 = select i1 %c0, float %m, float %v0
+  %c1 = fcmp nnan ogt float %r0, %v1
+  %r1 = select i1 %c1, float %r0, float %v1
+  %c2 = fcmp nnan ogt float %r1, %v2
+  %r2 = select i1 %c2, float %r1, float %v2
+  %c3 = fcmp nnan ogt float %r2, %v3
+  %r3 = select i1 %c3, float %r2, float %v3
+  store float %r3, float* %res, align 4
+  ret void
+}
+
+; CHECK-LABEL: @fmax_nans(
+; CHECK-NOT: <4 x float>
+; CHECK: ret void
+
+define void @fmax_nans(float* %p, float* %q, float* %res) {
+entry:
+  %p0v = load float, float* %p, align 4
+  %q0v = load float, float* %q, align 4
+  %p1 = getelementptr inbounds float, float* %p, i64 1
+  %p1v = load float, float* %p1, align 4
+  %q1 = getelementptr inbounds float, float* %q, i64 1
+  %q1v = load float, float* %q1, align 4
+  %p2 = getelementptr inbounds float, float* %p, i64 2
+  %p2v = load float, float* %p2, align 4
+  %q2 = getelementptr inbounds float, float* %q, i64 2
+  %q2v = load float, float* %q2, align 4
+  %p3 = getelementptr inbounds float, float* %p, i64 3
+  %p3v = load float, float* %p3, align 4
+  %q3 = getelementptr inbounds float, float* %q, i64 3
+  %q3v = load float, float* %q3, align 4
+  %v0 = fmul float %p0v, %q0v
+  %v1 = fmul float %p1v, %q1v
+  %v2 = fmul float %p2v, %q2v
+  %v3 = fmul float %p3v, %q3v
+  %m = load float, float* %res, align 4
+  %c0 = fcmp ogt float %m, %v0
+  %r0 = select i1 %c0, float %m, float %v0
+  %c1 = fcmp ogt float %r0, %v1
+  %r1 = select i1 %c1, float %r0, float %v1
+  %c2 = fcmp ogt float %r1, %v2
+  %r2 = select i1 %c2, float %r1, float %v2
+  %c3 = fcmp ogt float %r2, %v3
+  %r3 = select i1 %c3, float %r2, float %v3
+  store float %r3, float* %res, align 4
+  ret void
+}
+
+attributes #0 = { "no-nans-fp-math"="true" "no-signed-zeros-fp-math"="true" }
@@ -7,12 +7,14 @@ target triple = "x86_64-apple-macosx10.9.0"
 ;CHECK: load <4 x i32>
 ;CHECK: load <4 x i32>
 ;CHECK: %[[S1:.+]] = add nsw <4 x i32>
-;CHECK-DAG: store <4 x i32> %[[S1]]
-;CHECK-DAG: %[[A1:.+]] = add nsw i32
-;CHECK-DAG: %[[A2:.+]] = add nsw i32 %[[A1]]
-;CHECK-DAG: %[[A3:.+]] = add nsw i32 %[[A2]]
-;CHECK-DAG: %[[A4:.+]] = add nsw i32 %[[A3]]
-;CHECK: ret i32 %[[A4]] 
+;CHECK: store <4 x i32> %[[S1]]
+;CHECK: %[[SHUF1:.+]] = shufflevector <4 x i32> %[[S1]]
+;CHECK: %[[RDX1:.+]] = add <4 x i32> %[[S1]], %[[SHUF1]]
+;CHECK: %[[SHUF2:.+]] = shufflevector <4 x i32> %[[RDX1]]
+;CHECK: %[[RDX2:.+]] = add <4 x i32> %[[RDX1]], %[[SHUF2]]
+;CHECK: %[[EXT:.+]] = extractelement <4 x i32> %[[RDX2]], i32 0
+;CHECK: %[[A:.+]] = add i32 %[[EXT]], %a.088
+;CHECK: ret i32 %[[A]]
 
 define i32 @foo(i32* nocapture readonly %diff) #0 {
 entry:
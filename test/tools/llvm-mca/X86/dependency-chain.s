@@ -0,0 +1,22 @@
+# RUN: llvm-mca -triple=x86_64-unknown-unknown -mcpu=skylake %s | FileCheck %s --check-prefix=SKL
+# RUN: llvm-mca -triple=x86_64-unknown-unknown -mcpu=znver1 %s | FileCheck %s --check-prefix=ZEN
+
+# The multiply does not depend on the previous iteration, but the add
+# accumulates into %xmm3, so the loop runs at the latency of the add.
+
+vmulps %xmm0, %xmm1, %xmm2
+vaddps %xmm2, %xmm3, %xmm3
+
+# SKL:      Iterations:        100
+# SKL-NEXT: Instructions:      200
+# SKL:      Cycles Per Iteration: 4.{{[0-9]+}}
+# SKL:      Dependency chain:  4.00
+# SKL-NEXT: Bottleneck: dependency chain
+# SKL:      Critical dependency chain (4 cycles per iteration):
+# SKL-NEXT:   [1] vaddps %xmm2, %xmm3, %xmm3 (latency: 4)
+
+# ZEN:      Cycles Per Iteration: 3.{{[0-9]+}}
+# ZEN:      Dependency chain:  3.00
+# ZEN-NEXT: Bottleneck: dependency chain
+# ZEN:      Critical dependency chain (3 cycles per iteration):
+# ZEN-NEXT:   [1] vaddps %xmm2, %xmm3, %xmm3 (latency: 3)
@@ -0,0 +1,20 @@
+# RUN: llvm-mca -triple=x86_64-unknown-unknown -mcpu=skylake -dispatch=2 %s | FileCheck %s
+
+# Eight independent single micro-op instructions that can issue on four ports.
+# With two micro-ops dispatched per cycle, dispatch is the bottleneck.
+
+addl $1, %eax
+addl $1, %ebx
+addl $1, %ecx
+addl $1, %edx
+addl $1, %esi
+addl $1, %edi
+addl $1, %r8d
+addl $1, %r9d
+
+# CHECK:      Dispatch Width:    2
+# CHECK:      Cycles Per Iteration: 4.{{[0-9]+}}
+# CHECK:      Dispatch:          4.00
+# CHECK-NEXT: Resources:         2.00
+# CHECK-NEXT: Dependency chain:  1.00
+# CHECK-NEXT: Bottleneck: dispatch width
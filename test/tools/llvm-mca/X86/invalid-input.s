@@ -0,0 +1,8 @@
+# RUN: not llvm-mca -triple=x86_64-unknown-unknown -mcpu=skylake %s 2>&1 | FileCheck %s --check-prefix=EMPTY
+# RUN: echo "addl %eax, %ebx" | not llvm-mca -triple=x86_64-unknown-unknown -mcpu=generic 2>&1 | FileCheck %s --check-prefix=NOMODEL
+
+# EMPTY: error: no assembly instructions found.
+# NOMODEL: error: unable to find instruction-level scheduling information for target triple 'x86_64-unknown-unknown' and cpu 'generic'.
+
+foo:
+  .quad 0
@@ -0,0 +1,23 @@
+# RUN: llvm-mca -triple=x86_64-unknown-unknown -mcpu=skylake -iterations=200 %s | FileCheck %s
+
+# Independent shuffles that can only issue on port 5.
+
+vpshufd $0, %xmm0, %xmm1
+vpshufd $1, %xmm0, %xmm2
+vpshufd $2, %xmm0, %xmm3
+vpshufd $3, %xmm0, %xmm4
+
+# CHECK:      Iterations:        200
+# CHECK:      Cycles Per Iteration: 4.{{[0-9]+}}
+# CHECK:      Dispatch:          0.67
+# CHECK-NEXT: Resources:         4.00 (SKLPort5)
+# CHECK-NEXT: Dependency chain:  0.00
+# CHECK-NEXT: Bottleneck: resource pressure on SKLPort5
+
+# CHECK:      Resource pressure by instruction:
+# CHECK:      1.00 {{.*}} vpshufd $0, %xmm0, %xmm1
+# CHECK-NEXT: 1.00 {{.*}} vpshufd $1, %xmm0, %xmm2
+# CHECK-NEXT: 1.00 {{.*}} vpshufd $2, %xmm0, %xmm3
+# CHECK-NEXT: 1.00 {{.*}} vpshufd $3, %xmm0, %xmm4
+
+# CHECK: No loop-carried dependency chain.
@@ -0,0 +1,48 @@
+// Check that disassembling a section in parallel gives the same output as
+// disassembling it on one thread.
+// RUN: llvm-mc -filetype=obj -triple x86_64-pc-linux %s -o %t
+// RUN: llvm-objdump -d -r -threads=1 %t > %t.1
+// RUN: llvm-objdump -d -r -threads=3 %t > %t.3
+// RUN: diff %t.1 %t.3
+// RUN: FileCheck %s < %t.3
+
+// Each function is larger than the ranges of symbols disassembled at once.
+.macro func name, callee, ext
+  .globl \name
+\name:
+  callq \callee
+  callq \ext
+  .rept 7000
+  movabsq $0x1122334455667788, %rax
+  .endr
+  retq
+.endm
+
+.text
+func f0, f1, ext0
+func f1, f2, ext1
+func f2, f3, ext2
+func f3, f0, ext3
+
+// Calls within the section are resolved by the assembler, so each one is
+// printed with the target symbol. Calls to the undefined externals keep a
+// relocation, and each range of symbols must print the relocations that fall
+// within it.
+// CHECK:      Disassembly of section .text:
+// CHECK-NEXT: f0:
+// CHECK-NEXT:   0: e8 76 11 01 00 callq 70006 <f1>
+// CHECK-NEXT:   5: e8 00 00 00 00 callq 0
+// CHECK-NEXT: 0000000000000006: R_X86_64_PC32 ext0-4-P
+// CHECK:      {{^}}f1:
+// CHECK-NEXT: 1117b: e8 76 11 01 00 callq 70006 <f2>
+// CHECK-NEXT: 11180: e8 00 00 00 00 callq 0
+// CHECK-NEXT: 0000000000011181: R_X86_64_PC32 ext1-4-P
+// CHECK:      {{^}}f2:
+// CHECK-NEXT: 222f6: e8 76 11 01 00 callq 70006 <f3>
+// CHECK-NEXT: 222fb: e8 00 00 00 00 callq 0
+// CHECK-NEXT: 00000000000222fc: R_X86_64_PC32 ext2-4-P
+// CHECK:      {{^}}f3:
+// CHECK-NEXT: 33471: e8 8a cb fc ff callq -210038 <f0>
+// CHECK-NEXT: 33476: e8 00 00 00 00 callq 0
+// CHECK-NEXT: 0000000000033477: R_X86_64_PC32 ext3-4-P
+// CHECK:      445eb: c3 retq
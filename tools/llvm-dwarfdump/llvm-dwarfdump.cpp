@@ -51,6 +51,7 @@ static cl::opt<DIDumpType> DumpType(
         clEnumValN(DIDT_AppleNamespaces, "apple_namespaces",
                    ".apple_namespaces"),
         clEnumValN(DIDT_AppleObjC, "apple_objc", ".apple_objc"),
+        clEnumValN(DIDT_DebugNames, "debug_names", ".debug_names"),
         clEnumValN(DIDT_Aranges, "aranges", ".debug_aranges"),
         clEnumValN(DIDT_Info, "info", ".debug_info"),
         clEnumValN(DIDT_InfoDwo, "info.dwo", ".debug_info.dwo"),
@@ -74,6 +75,11 @@ static cl::opt<DIDumpType> DumpType(
         clEnumValN(DIDT_CUIndex, "cu_index", ".debug_cu_index"),
         clEnumValN(DIDT_TUIndex, "tu_index", ".debug_tu_index"), clEnumValEnd));
 
+static cl::list<std::string>
+FindNames("find", cl::desc("Look up a name in the .debug_names index and dump "
+                           "the matching DIEs instead of the sections"),
+          cl::value_desc("name"));
+
 static void error(StringRef Filename, std::error_code EC) {
   if (!EC)
     return;
@@ -81,13 +87,40 @@ static void error(StringRef Filename, std::error_code EC) {
   exit(1);
 }
 
+static void FindNamesInIndex(DWARFContext &DICtx, Twine Filename) {
+  const DWARFDebugNames &Index = DICtx.getDebugNames();
+  if (Index.empty()) {
+    errs() << Filename << ": no .debug_names index\n";
+    return;
+  }
+
+  for (const std::string &Name : FindNames) {
+    for (const DWARFDebugNames::Entry &E : Index.lookup(Name)) {
+      DWARFCompileUnit *CU = DICtx.getCompileUnitForOffset(E.CUOffset);
+      if (!CU || !CU->getNumDIEs())
+        continue;
+      uint32_t Offset = CU->getOffset() + E.DIEOffset;
+      const DWARFDebugInfoEntryMinimal *Die = CU->getDIEForOffset(Offset);
+      if (!Die || Die->getOffset() != Offset) {
+        errs() << Filename << ": invalid DIE offset "
+               << format("0x%08x", Offset) << " for '" << Name << "'\n";
+        continue;
+      }
+      Die->dump(outs(), CU, 0);
+    }
+  }
+}
+
 static void DumpObjectFile(ObjectFile &Obj, Twine Filename) {
-  std::unique_ptr<DIContext> DICtx(new DWARFContextInMemory(Obj));
+  std::unique_ptr<DWARFContext> DICtx(new DWARFContextInMemory(Obj));
 
   outs() << Filename.str() << ":\tfile format " << Obj.getFileFormatName()
          << "\n\n";
-  // Dump the complete DWARF structure.
-  DICtx->dump(outs(), DumpType);
+  // Look up the requested names, or dump the complete DWARF structure.
+  if (!FindNames.empty())
+    FindNamesInIndex(*DICtx, Filename);
+  else
+    DICtx->dump(outs(), DumpType);
 }
 
 static void DumpInput(StringRef Filename) {
@@ -0,0 +1,490 @@
+//===-- Simulator.cpp - Out-of-order pipeline simulator -------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Simulator.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/MC/MCInstPrinter.h"
+#include "llvm/MC/MCInstrInfo.h"
+#include "llvm/MC/MCRegisterInfo.h"
+#include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <deque>
+
+using namespace llvm;
+using namespace mca;
+
+static const uint64_t NotIssued = ~0ULL;
+
+Simulator::Simulator(const MCSubtargetInfo &STI, const MCInstrInfo &MCII,
+                     const MCRegisterInfo &MRI, ArrayRef<MCInst> Source,
+                     unsigned DispatchWidth, unsigned Iterations)
+    : STI(STI), MCII(MCII), MRI(MRI), Source(Source),
+      DispatchWidth(DispatchWidth), Iterations(Iterations) {
+  buildUnits();
+  buildDescs();
+  computeCriticalChain();
+}
+
+/// Create one unit for every instance of a processor resource that is not a
+/// group. Groups are resolved to these units when an instruction issues.
+void Simulator::buildUnits() {
+  const MCSchedModel &SM = STI.getSchedModel();
+  FirstUnit.assign(SM.getNumProcResourceKinds(), ~0U);
+  for (unsigned K = 1, E = SM.getNumProcResourceKinds(); K != E; ++K) {
+    const MCProcResourceDesc *PR = SM.getProcResource(K);
+    if (PR->SubUnitsIdxBegin)
+      continue;
+    FirstUnit[K] = UnitNames.size();
+    if (PR->NumUnits == 1) {
+      UnitNames.push_back(PR->Name);
+      continue;
+    }
+    for (unsigned U = 0; U != PR->NumUnits; ++U)
+      UnitNames.push_back((Twine(PR->Name) + "." + Twine(U)).str());
+  }
+}
+
+namespace {
+/// A register written by an instruction of the input.
+struct RegWrite {
+  unsigned Reg;
+  unsigned Latency;
+  unsigned WriteResID;
+};
+
+/// A register read by an instruction of the input. UseIdx counts the register
+/// uses before this one, which is how the machine model identifies operands.
+struct RegRead {
+  unsigned Reg;
+  unsigned UseIdx;
+};
+} // end anonymous namespace
+
+void Simulator::buildDescs() {
+  const MCSchedModel &SM = STI.getSchedModel();
+  unsigned NumKinds = SM.getNumProcResourceKinds();
+  unsigned N = Source.size();
+
+  // The resource kinds each kind is made of, to tell which groups contain
+  // which other resources.
+  std::vector<BitVector> KindUnits(NumKinds, BitVector(NumKinds));
+  for (unsigned K = 1; K != NumKinds; ++K) {
+    const MCProcResourceDesc *PR = SM.getProcResource(K);
+    if (!PR->SubUnitsIdxBegin) {
+      KindUnits[K].set(K);
+      continue;
+    }
+    for (unsigned U = 0; U != PR->NumUnits; ++U)
+      KindUnits[K].set(PR->SubUnitsIdxBegin[U]);
+  }
+
+  Descs.resize(N);
+  std::vector<SmallVector<RegWrite, 4>> Writes(N);
+  std::vector<SmallVector<RegRead, 4>> Reads(N);
+  std::vector<const MCSchedClassDesc *> Classes(N);
+  for (unsigned Idx = 0; Idx != N; ++Idx) {
+    const MCInst &MI = Source[Idx];
+    const MCInstrDesc &MCID = MCII.get(MI.getOpcode());
+    InstrDesc &D = Descs[Idx];
+
+    // Variant scheduling classes are resolved by predicates on
+    // MachineInstrs, which are not available here.
+    const MCSchedClassDesc *SC = SM.getSchedClassDesc(MCID.getSchedClass());
+    if (!SC->isValid() || SC->isVariant()) {
+      D.HasSchedInfo = false;
+      SC = nullptr;
+    }
+    Classes[Idx] = SC;
+
+    auto getDefLatency = [&](unsigned DefIdx, unsigned &WriteResID) {
+      WriteResID = 0;
+      // Defs the model does not describe, such as most implicit defs, take a
+      // single cycle.
+      if (!SC || DefIdx >= SC->NumWriteLatencyEntries)
+        return 1u;
+      const MCWriteLatencyEntry *WLEntry = STI.getWriteLatencyEntry(SC, DefIdx);
+      WriteResID = WLEntry->WriteResourceID;
+      return WLEntry->Cycles < 0 ? 1u : unsigned(WLEntry->Cycles);
+    };
+
+    // Explicit defs come first, followed by explicit uses, implicit defs and
+    // implicit uses, in the order the machine model numbers them.
+    unsigned DefIdx = 0, UseIdx = 0;
+    for (unsigned I = 0, E = MI.getNumOperands(); I != E; ++I) {
+      const MCOperand &MO = MI.getOperand(I);
+      if (!MO.isReg())
+        continue;
+      if (I < MCID.getNumDefs()) {
+        unsigned WriteResID;
+        unsigned Latency = getDefLatency(DefIdx++, WriteResID);
+        if (MO.getReg())
+          Writes[Idx].push_back({MO.getReg(), Latency, WriteResID});
+        continue;
+      }
+      if (MO.getReg())
+        Reads[Idx].push_back({MO.getReg(), UseIdx});
+      ++UseIdx;
+    }
+    for (unsigned I = 0, E = MCID.getNumImplicitDefs(); I != E; ++I) {
+      unsigned WriteResID;
+      unsigned Latency = getDefLatency(DefIdx++, WriteResID);
+      Writes[Idx].push_back({MCID.getImplicitDefs()[I], Latency, WriteResID});
+    }
+    for (unsigned I = 0, E = MCID.getNumImplicitUses(); I != E; ++I)
+      Reads[Idx].push_back({MCID.getImplicitUses()[I], UseIdx++});
+
+    if (!SC)
+      continue;
+
+    D.NumMicroOps = SC->NumMicroOps;
+    D.Latency = 0;
+    for (unsigned I = 0; I != SC->NumWriteLatencyEntries; ++I) {
+      int Cycles = STI.getWriteLatencyEntry(SC, I)->Cycles;
+      D.Latency = std::max(D.Latency, unsigned(std::max(Cycles, 0)));
+    }
+
+    // TableGen adds every group that contains a resource to the resources of
+    // a write, with the same cycles. Walk the resources from the smallest to
+    // the largest and keep, for each, only the cycles that are not already
+    // accounted for by the resources it contains.
+    SmallVector<MCWriteProcResEntry, 8> Entries(STI.getWriteProcResBegin(SC),
+                                                STI.getWriteProcResEnd(SC));
+    std::stable_sort(Entries.begin(), Entries.end(),
+                     [&](const MCWriteProcResEntry &A,
+                         const MCWriteProcResEntry &B) {
+                       return KindUnits[A.ProcResourceIdx].count() <
+                              KindUnits[B.ProcResourceIdx].count();
+                     });
+    SmallVector<unsigned, 8> OwnCycles;
+    for (unsigned I = 0, E = Entries.size(); I != E; ++I) {
+      const BitVector &Units = KindUnits[Entries[I].ProcResourceIdx];
+      int Own = Entries[I].Cycles;
+      for (unsigned J = 0; J != I; ++J) {
+        BitVector Inner = KindUnits[Entries[J].ProcResourceIdx];
+        Inner.reset(Units);
+        if (Inner.none())
+          Own -= OwnCycles[J];
+      }
+      OwnCycles.push_back(std::max(Own, 0));
+      if (Own <= 0)
+        continue;
+      ResourceUse RU;
+      RU.Cycles = Own;
+      for (int K = Units.find_first(); K != -1; K = Units.find_next(K)) {
+        if (FirstUnit[K] == ~0U)
+          continue;
+        for (unsigned U = 0; U != SM.getProcResource(K)->NumUnits; ++U)
+          RU.Units.push_back(FirstUnit[K] + U);
+      }
+      if (!RU.Units.empty())
+        D.Resources.push_back(RU);
+    }
+  }
+
+  // Find the producers of each register read, first earlier in the same
+  // iteration, then in the previous iteration.
+  for (unsigned J = 0; J != N; ++J) {
+    for (const RegRead &R : Reads[J]) {
+      for (MCRegUnitIterator Unit(R.Reg, &MRI); Unit.isValid(); ++Unit) {
+        bool Found = false;
+        for (unsigned Step = 1; Step <= N && !Found; ++Step) {
+          unsigned P = (J + N - Step) % N;
+          unsigned Distance = Step > J ? 1 : 0;
+          for (const RegWrite &W : Writes[P]) {
+            bool Overlaps = false;
+            for (MCRegUnitIterator WU(W.Reg, &MRI); WU.isValid(); ++WU)
+              Overlaps |= *WU == *Unit;
+            if (!Overlaps)
+              continue;
+            int Latency = W.Latency;
+            if (Classes[J])
+              Latency -= STI.getReadAdvanceCycles(Classes[J], R.UseIdx,
+                                                  W.WriteResID);
+            Latency = std::max(Latency, 0);
+
+            auto Existing =
+                std::find_if(Descs[J].Deps.begin(), Descs[J].Deps.end(),
+                             [&](const Dependency &Dep) {
+                               return Dep.Producer == P &&
+                                      Dep.Distance == Distance;
+                             });
+            if (Existing == Descs[J].Deps.end())
+              Descs[J].Deps.push_back({P, Distance, unsigned(Latency)});
+            else
+              Existing->Latency =
+                  std::max(Existing->Latency, unsigned(Latency));
+            Found = true;
+          }
+        }
+      }
+    }
+  }
+}
+
+/// Find the loop-carried dependency chain with the highest latency. For each
+/// instruction, this is the longest path from it to its copy in the next
+/// iteration through two unrolled iterations of the input.
+void Simulator::computeCriticalChain() {
+  unsigned N = Source.size();
+  const int64_t Unreachable = -1;
+  for (unsigned Start = 0; Start != N; ++Start) {
+    std::vector<int64_t> Dist(2 * N, Unreachable);
+    std::vector<unsigned> Pred(2 * N, ~0U);
+    Dist[Start] = 0;
+    for (unsigned Node = Start + 1; Node <= Start + N; ++Node) {
+      unsigned Iter = Node / N, Idx = Node % N;
+      for (const Dependency &Dep : Descs[Idx].Deps) {
+        if (Dep.Distance > Iter)
+          continue;
+        unsigned From = (Iter - Dep.Distance) * N + Dep.Producer;
+        if (Dist[From] == Unreachable ||
+            Dist[From] + Dep.Latency <= Dist[Node])
+          continue;
+        Dist[Node] = Dist[From] + Dep.Latency;
+        Pred[Node] = From;
+      }
+    }
+    if (Dist[Start + N] == Unreachable ||
+        Dist[Start + N] <= int64_t(CriticalChainLatency))
+      continue;
+
+    CriticalChainLatency = Dist[Start + N];
+    CriticalChain.clear();
+    for (unsigned Node = Pred[Start + N]; Node != ~0U; Node = Pred[Node])
+      CriticalChain.push_back(Node % N);
+    std::reverse(CriticalChain.begin(), CriticalChain.end());
+  }
+}
+
+void Simulator::run() {
+  const MCSchedModel &SM = STI.getSchedModel();
+  unsigned N = Source.size();
+  uint64_t NumInstances = uint64_t(N) * Iterations;
+  // A model without a reorder buffer describes an in-order machine.
+  bool InOrder = SM.MicroOpBufferSize == 0;
+
+  std::vector<uint64_t> IssueCycle(NumInstances, NotIssued);
+  std::vector<uint64_t> BusyUntil(UnitNames.size(), 0);
+  std::vector<uint64_t> UnitUsage(UnitNames.size(), 0);
+  Pressure.assign(N, std::vector<uint64_t>(UnitNames.size(), 0));
+
+  auto tryIssue = [&](uint64_t Id, uint64_t Cycle) {
+    const InstrDesc &D = Descs[Id % N];
+    uint64_t Iter = Id / N;
+    for (const Dependency &Dep : D.Deps) {
+      if (Dep.Distance > Iter)
+        continue;
+      uint64_t P = (Iter - Dep.Distance) * N + Dep.Producer;
+      if (IssueCycle[P] == NotIssued || IssueCycle[P] + Dep.Latency > Cycle)
+        return false;
+    }
+
+    // Pick the least used free unit for each resource. A unit picked for
+    // one resource is not picked again for another unless there is no other
+    // choice, in which case the instruction holds it for longer.
+    SmallVector<std::pair<unsigned, unsigned>, 4> Chosen;
+    for (const ResourceUse &RU : D.Resources) {
+      unsigned Best = ~0U;
+      bool BestTaken = false;
+      for (unsigned U : RU.Units) {
+        if (BusyUntil[U] > Cycle)
+          continue;
+        bool Taken = std::any_of(Chosen.begin(), Chosen.end(),
+                                 [&](const std::pair<unsigned, unsigned> &C) {
+                                   return C.first == U;
+                                 });
+        if (Best == ~0U || (BestTaken && !Taken) ||
+            (Taken == BestTaken && UnitUsage[U] < UnitUsage[Best])) {
+          Best = U;
+          BestTaken = Taken;
+        }
+      }
+      if (Best == ~0U)
+        return false;
+      auto Existing = std::find_if(Chosen.begin(), Chosen.end(),
+                                   [&](const std::pair<unsigned, unsigned> &C) {
+                                     return C.first == Best;
+                                   });
+      if (Existing != Chosen.end())
+        Existing->second += RU.Cycles;
+      else
+        Chosen.push_back({Best, RU.Cycles});
+    }
+
+    for (const auto &C : Chosen) {
+      BusyUntil[C.first] = Cycle + C.second;
+      UnitUsage[C.first] += C.second;
+      Pressure[Id % N][C.first] += C.second;
+    }
+    IssueCycle[Id] = Cycle;
+    return true;
+  };
+
+  std::deque<uint64_t> ROB;
+  std::vector<uint64_t> Waiting;
+  unsigned ROBMicroOps = 0;
+  uint64_t Next = 0, Retired = 0, Cycle = 0;
+  while (Retired != NumInstances) {
+    // Retire completed instructions in order.
+    for (unsigned NumRetired = 0; !ROB.empty() && NumRetired != DispatchWidth;
+         ++NumRetired) {
+      uint64_t Id = ROB.front();
+      if (IssueCycle[Id] == NotIssued ||
+          IssueCycle[Id] + Descs[Id % N].Latency > Cycle)
+        break;
+      ROB.pop_front();
+      ROBMicroOps -= Descs[Id % N].NumMicroOps;
+      ++Retired;
+    }
+
+    // Issue the instructions whose operands and resources are ready, oldest
+    // first.
+    for (auto I = Waiting.begin(); I != Waiting.end();) {
+      if (tryIssue(*I, Cycle)) {
+        I = Waiting.erase(I);
+        continue;
+      }
+      if (InOrder)
+        break;
+      ++I;
+    }
+
+    // Dispatch in order, up to DispatchWidth micro-ops per cycle. An
+    // instruction with more micro-ops than that takes a whole cycle.
+    unsigned Slots = DispatchWidth;
+    while (Next != NumInstances && Slots) {
+      unsigned MicroOps = Descs[Next % N].NumMicroOps;
+      if (MicroOps > Slots && Slots != DispatchWidth)
+        break;
+      if (InOrder ? Waiting.size() >= DispatchWidth
+                  : !ROB.empty() &&
+                        ROBMicroOps + MicroOps > SM.MicroOpBufferSize)
+        break;
+      ROB.push_back(Next);
+      Waiting.push_back(Next);
+      ROBMicroOps += MicroOps;
+      TotalMicroOps += MicroOps;
+      Slots -= std::min(MicroOps, Slots);
+      ++Next;
+    }
+
+    ++Cycle;
+  }
+  TotalCycles = Cycle;
+}
+
+static std::string printInst(MCInstPrinter &IP, const MCInst &MI,
+                             const MCSubtargetInfo &STI) {
+  std::string Str;
+  raw_string_ostream OS(Str);
+  IP.printInst(&MI, OS, "", STI);
+  return StringRef(OS.str()).trim().str();
+}
+
+void Simulator::printSummary(raw_ostream &OS) const {
+  uint64_t NumInstrs = uint64_t(Source.size()) * Iterations;
+  OS << "Iterations:        " << Iterations << '\n'
+     << "Instructions:      " << NumInstrs << '\n'
+     << "Total Cycles:      " << TotalCycles << '\n'
+     << "Total uOps:        " << TotalMicroOps << "\n\n"
+     << "Dispatch Width:    " << DispatchWidth << '\n'
+     << "uOps Per Cycle:    "
+     << format("%.2f", double(TotalMicroOps) / TotalCycles) << '\n'
+     << "IPC:               " << format("%.2f", double(NumInstrs) / TotalCycles)
+     << '\n'
+     << "Cycles Per Iteration: "
+     << format("%.2f", double(TotalCycles) / Iterations) << "\n\n";
+
+  // Each of these bounds the cycles per iteration from below; the largest one
+  // is the bottleneck.
+  double DispatchBound = double(TotalMicroOps) / Iterations / DispatchWidth;
+  double ResourceBound = 0;
+  unsigned BusiestUnit = 0;
+  for (unsigned U = 0, E = UnitNames.size(); U != E; ++U) {
+    uint64_t Busy = 0;
+    for (const auto &Row : Pressure)
+      Busy += Row[U];
+    if (double(Busy) / Iterations > ResourceBound) {
+      ResourceBound = double(Busy) / Iterations;
+      BusiestUnit = U;
+    }
+  }
+  double ChainBound = CriticalChainLatency;
+
+  OS << "Throughput bounds (cycles per iteration):\n"
+     << "  Dispatch:          " << format("%.2f", DispatchBound) << '\n'
+     << "  Resources:         " << format("%.2f", ResourceBound);
+  if (ResourceBound > 0)
+    OS << " (" << UnitNames[BusiestUnit] << ")";
+  OS << '\n'
+     << "  Dependency chain:  " << format("%.2f", ChainBound) << '\n';
+
+  OS << "Bottleneck: ";
+  if (ChainBound >= ResourceBound && ChainBound >= DispatchBound)
+    OS << "dependency chain";
+  else if (ResourceBound >= DispatchBound)
+    OS << "resource pressure on " << UnitNames[BusiestUnit];
+  else
+    OS << "dispatch width";
+  OS << "\n\n";
+}
+
+static void printPressure(raw_ostream &OS, uint64_t Busy,
+                          unsigned Iterations) {
+  if (!Busy) {
+    OS << left_justify(" -", 7);
+    return;
+  }
+  OS << format("%6.2f", double(Busy) / Iterations) << ' ';
+}
+
+void Simulator::printResourcePressure(raw_ostream &OS,
+                                      MCInstPrinter &IP) const {
+  OS << "Resources:\n";
+  for (unsigned U = 0, E = UnitNames.size(); U != E; ++U)
+    OS << left_justify(("[" + Twine(U) + "]").str(), 6) << "- "
+       << UnitNames[U] << '\n';
+
+  OS << "\nResource pressure per iteration:\n";
+  for (unsigned U = 0, E = UnitNames.size(); U != E; ++U)
+    OS << left_justify(("[" + Twine(U) + "]").str(), 7);
+  OS << '\n';
+  for (unsigned U = 0, E = UnitNames.size(); U != E; ++U) {
+    uint64_t Busy = 0;
+    for (const auto &Row : Pressure)
+      Busy += Row[U];
+    printPressure(OS, Busy, Iterations);
+  }
+  OS << "\n\nResource pressure by instruction:\n";
+  for (unsigned U = 0, E = UnitNames.size(); U != E; ++U)
+    OS << left_justify(("[" + Twine(U) + "]").str(), 7);
+  OS << "Instructions:\n";
+  for (unsigned Idx = 0, E = Source.size(); Idx != E; ++Idx) {
+    for (uint64_t Busy : Pressure[Idx])
+      printPressure(OS, Busy, Iterations);
+    OS << printInst(IP, Source[Idx], STI) << '\n';
+  }
+  OS << '\n';
+}
+
+void Simulator::printCriticalChain(raw_ostream &OS, MCInstPrinter &IP) const {
+  if (CriticalChain.empty()) {
+    OS << "No loop-carried dependency chain.\n";
+    return;
+  }
+  OS << "Critical dependency chain (" << CriticalChainLatency
+     << " cycles per iteration):\n";
+  for (unsigned Idx : CriticalChain)
+    OS << "  [" << Idx << "] " << printInst(IP, Source[Idx], STI)
+       << "  (latency: " << Descs[Idx].Latency << ")\n";
+}
@@ -0,0 +1,113 @@
+//===-- Simulator.h - Out-of-order pipeline simulator -----------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares a simple simulator of an out-of-order pipeline driven by
+// the machine model of a subtarget. It repeats a sequence of instructions for
+// a number of iterations, dispatching them in order into a reorder buffer,
+// issuing them out of order to the processor resource units once their
+// operands are ready, and retiring them in order.
+//
+// Only register dependencies are modeled. Memory dependencies, dependency
+// breaking idioms, and the front end are not.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_TOOLS_LLVM_MCA_SIMULATOR_H
+#define LLVM_TOOLS_LLVM_MCA_SIMULATOR_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/MC/MCInst.h"
+#include <string>
+#include <vector>
+
+namespace llvm {
+
+class MCInstPrinter;
+class MCInstrInfo;
+class MCRegisterInfo;
+class MCSubtargetInfo;
+class raw_ostream;
+
+namespace mca {
+
+/// A register dependency of an instruction on an earlier one. The producer is
+/// Distance iterations back, so a non-zero distance is a loop-carried
+/// dependency.
+struct Dependency {
+  unsigned Producer;
+  unsigned Distance;
+  unsigned Latency;
+};
+
+/// A processor resource consumed by an instruction. Any of the units in
+/// Units can be used, and the chosen one is busy for Cycles cycles.
+struct ResourceUse {
+  SmallVector<unsigned, 4> Units;
+  unsigned Cycles;
+};
+
+/// What the machine model says about one instruction of the input.
+struct InstrDesc {
+  unsigned NumMicroOps = 1;
+  unsigned Latency = 1;
+  bool HasSchedInfo = true;
+  SmallVector<ResourceUse, 4> Resources;
+  SmallVector<Dependency, 4> Deps;
+};
+
+class Simulator {
+  const MCSubtargetInfo &STI;
+  const MCInstrInfo &MCII;
+  const MCRegisterInfo &MRI;
+  ArrayRef<MCInst> Source;
+  unsigned DispatchWidth;
+  unsigned Iterations;
+
+  /// Names of the resource units; a resource with several units gets one
+  /// entry per unit.
+  std::vector<std::string> UnitNames;
+  /// The first unit of each processor resource kind that is not a group.
+  std::vector<unsigned> FirstUnit;
+
+  std::vector<InstrDesc> Descs;
+
+  // Results.
+  uint64_t TotalCycles = 0;
+  uint64_t TotalMicroOps = 0;
+  /// Busy cycles of each unit, per instruction of the input.
+  std::vector<std::vector<uint64_t>> Pressure;
+  /// The loop-carried dependency chain with the highest latency.
+  std::vector<unsigned> CriticalChain;
+  unsigned CriticalChainLatency = 0;
+
+  void buildUnits();
+  void buildDescs();
+  void computeCriticalChain();
+
+public:
+  Simulator(const MCSubtargetInfo &STI, const MCInstrInfo &MCII,
+            const MCRegisterInfo &MRI, ArrayRef<MCInst> Source,
+            unsigned DispatchWidth, unsigned Iterations);
+
+  /// Simulate the execution of Iterations repetitions of the input.
+  void run();
+
+  const InstrDesc &getDesc(unsigned Idx) const { return Descs[Idx]; }
+  unsigned getDispatchWidth() const { return DispatchWidth; }
+
+  void printSummary(raw_ostream &OS) const;
+  void printResourcePressure(raw_ostream &OS, MCInstPrinter &IP) const;
+  void printCriticalChain(raw_ostream &OS, MCInstPrinter &IP) const;
+};
+
+} // end namespace mca
+} // end namespace llvm
+
+#endif
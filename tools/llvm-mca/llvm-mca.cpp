@@ -0,0 +1,249 @@
+//===-- llvm-mca.cpp - Machine Code Analyzer ---------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This utility is a static performance analyzer for machine code. It parses a
+// sequence of assembly instructions, simulates their execution in a loop on
+// the machine model of the selected CPU, and reports the cycles per iteration,
+// the pressure on each processor resource, and the critical dependency chain.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Simulator.h"
+#include "llvm/MC/MCAsmInfo.h"
+#include "llvm/MC/MCContext.h"
+#include "llvm/MC/MCInstPrinter.h"
+#include "llvm/MC/MCInstrInfo.h"
+#include "llvm/MC/MCObjectFileInfo.h"
+#include "llvm/MC/MCParser/MCAsmParser.h"
+#include "llvm/MC/MCRegisterInfo.h"
+#include "llvm/MC/MCStreamer.h"
+#include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/MC/MCTargetAsmParser.h"
+#include "llvm/MC/MCTargetOptionsCommandFlags.h"
+#include "llvm/MC/SubtargetFeature.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/PrettyStackTrace.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ToolOutputFile.h"
+#include <algorithm>
+
+using namespace llvm;
+
+static cl::opt<std::string>
+InputFilename(cl::Positional, cl::desc("<input file>"), cl::init("-"));
+
+static cl::opt<std::string>
+OutputFilename("o", cl::desc("Output filename"), cl::init("-"),
+               cl::value_desc("filename"));
+
+static cl::opt<std::string>
+ArchName("arch", cl::desc("Target arch to assemble for, "
+                          "see -version for available targets"));
+
+static cl::opt<std::string>
+TripleName("triple", cl::desc("Target triple to assemble for, "
+                              "see -version for available targets"));
+
+static cl::opt<std::string>
+MCPU("mcpu",
+     cl::desc("Target a specific cpu type (-mcpu=help for details)"),
+     cl::value_desc("cpu-name"), cl::init(""));
+
+static cl::list<std::string>
+MAttrs("mattr", cl::CommaSeparated,
+       cl::desc("Target specific attributes (-mattr=help for details)"),
+       cl::value_desc("a1,+a2,-a3,..."));
+
+static cl::opt<unsigned>
+Iterations("iterations", cl::desc("Number of iterations to simulate"),
+           cl::init(100));
+
+static cl::opt<unsigned>
+DispatchWidth("dispatch",
+              cl::desc("Micro-ops dispatched per cycle (default: the issue "
+                       "width of the machine model)"),
+              cl::init(0));
+
+static cl::opt<unsigned>
+OutputAsmVariant("output-asm-variant",
+                 cl::desc("Syntax variant to use for output printing"));
+
+namespace {
+
+/// A streamer that collects the instructions of the input and ignores
+/// everything else.
+class InstructionCollector : public MCStreamer {
+  std::vector<MCInst> &Insts;
+
+public:
+  InstructionCollector(MCContext &Context, std::vector<MCInst> &Insts)
+      : MCStreamer(Context), Insts(Insts) {}
+
+  void EmitInstruction(const MCInst &Inst,
+                       const MCSubtargetInfo &STI) override {
+    Insts.push_back(Inst);
+  }
+
+  bool EmitSymbolAttribute(MCSymbol *Symbol,
+                           MCSymbolAttr Attribute) override {
+    return true;
+  }
+  void EmitCommonSymbol(MCSymbol *Symbol, uint64_t Size,
+                        unsigned ByteAlignment) override {}
+  void EmitZerofill(MCSection *Section, MCSymbol *Symbol = nullptr,
+                    uint64_t Size = 0, unsigned ByteAlignment = 0) override {}
+  void EmitGPRel32Value(const MCExpr *Value) override {}
+};
+
+} // end anonymous namespace
+
+static const Target *GetTarget(const char *ProgName) {
+  // Figure out the target triple.
+  if (TripleName.empty())
+    TripleName = sys::getDefaultTargetTriple();
+  Triple TheTriple(Triple::normalize(TripleName));
+
+  // Get the target specific parser.
+  std::string Error;
+  const Target *TheTarget = TargetRegistry::lookupTarget(ArchName, TheTriple,
+                                                         Error);
+  if (!TheTarget) {
+    errs() << ProgName << ": " << Error;
+    return nullptr;
+  }
+
+  // Update the triple name and return the found target.
+  TripleName = TheTriple.getTriple();
+  return TheTarget;
+}
+
+int main(int argc, char **argv) {
+  // Print a stack trace if we signal out.
+  sys::PrintStackTraceOnErrorSignal();
+  PrettyStackTraceProgram X(argc, argv);
+  llvm_shutdown_obj Y;  // Call llvm_shutdown() on exit.
+
+  // Initialize targets and assembly parsers.
+  llvm::InitializeAllTargetInfos();
+  llvm::InitializeAllTargetMCs();
+  llvm::InitializeAllAsmParsers();
+
+  cl::ParseCommandLineOptions(argc, argv, "llvm machine code analyzer\n");
+  MCTargetOptions MCOptions = InitMCTargetOptionsFromFlags();
+
+  const char *ProgName = argv[0];
+  const Target *TheTarget = GetTarget(ProgName);
+  if (!TheTarget)
+    return 1;
+  Triple TheTriple(TripleName);
+
+  ErrorOr<std::unique_ptr<MemoryBuffer>> BufferPtr =
+      MemoryBuffer::getFileOrSTDIN(InputFilename);
+  if (std::error_code EC = BufferPtr.getError()) {
+    errs() << InputFilename << ": " << EC.message() << '\n';
+    return 1;
+  }
+
+  SourceMgr SrcMgr;
+  SrcMgr.AddNewSourceBuffer(std::move(*BufferPtr), SMLoc());
+
+  std::unique_ptr<MCRegisterInfo> MRI(TheTarget->createMCRegInfo(TripleName));
+  assert(MRI && "Unable to create target register info!");
+
+  std::unique_ptr<MCAsmInfo> MAI(TheTarget->createMCAsmInfo(*MRI, TripleName));
+  assert(MAI && "Unable to create target asm info!");
+
+  MCObjectFileInfo MOFI;
+  MCContext Ctx(MAI.get(), MRI.get(), &MOFI, &SrcMgr);
+  MOFI.InitMCObjectFileInfo(TheTriple, Reloc::Default, CodeModel::Default, Ctx);
+
+  std::string FeaturesStr;
+  if (MAttrs.size()) {
+    SubtargetFeatures Features;
+    for (unsigned i = 0; i != MAttrs.size(); ++i)
+      Features.AddFeature(MAttrs[i]);
+    FeaturesStr = Features.getString();
+  }
+
+  if (MCPU == "native")
+    MCPU = sys::getHostCPUName();
+
+  std::unique_ptr<MCInstrInfo> MCII(TheTarget->createMCInstrInfo());
+  std::unique_ptr<MCSubtargetInfo> STI(
+      TheTarget->createMCSubtargetInfo(TripleName, MCPU, FeaturesStr));
+  if (!STI->getSchedModel().hasInstrSchedModel()) {
+    errs() << ProgName << ": error: unable to find instruction-level "
+           << "scheduling information for target triple '" << TripleName
+           << "' and cpu '" << MCPU << "'.\n";
+    return 1;
+  }
+
+  // Parse the input.
+  std::vector<MCInst> Insts;
+  InstructionCollector Str(Ctx, Insts);
+  std::unique_ptr<MCAsmParser> Parser(
+      createMCAsmParser(SrcMgr, Ctx, Str, *MAI));
+  std::unique_ptr<MCTargetAsmParser> TAP(
+      TheTarget->createMCAsmParser(*STI, *Parser, *MCII, MCOptions));
+  if (!TAP) {
+    errs() << ProgName
+           << ": error: this target does not support assembly parsing.\n";
+    return 1;
+  }
+  Parser->setTargetParser(*TAP);
+  if (Parser->Run(false))
+    return 1;
+
+  if (Insts.empty()) {
+    errs() << ProgName << ": error: no assembly instructions found.\n";
+    return 1;
+  }
+
+  std::unique_ptr<MCInstPrinter> IP(TheTarget->createMCInstPrinter(
+      TheTriple, OutputAsmVariant, *MAI, *MCII, *MRI));
+  if (!IP) {
+    errs() << ProgName << ": error: unable to create instruction printer for "
+           << "target triple '" << TripleName << "' with assembly variant "
+           << OutputAsmVariant << ".\n";
+    return 1;
+  }
+
+  std::error_code EC;
+  tool_output_file Out(OutputFilename, EC, sys::fs::F_None);
+  if (EC) {
+    errs() << EC.message() << '\n';
+    return 1;
+  }
+
+  unsigned Width = DispatchWidth ? DispatchWidth
+                                 : STI->getSchedModel().IssueWidth;
+  mca::Simulator Sim(*STI, *MCII, *MRI, Insts, Width,
+                     std::max(1u, unsigned(Iterations)));
+
+  for (unsigned Idx = 0, E = Insts.size(); Idx != E; ++Idx)
+    if (!Sim.getDesc(Idx).HasSchedInfo)
+      errs() << ProgName << ": warning: no scheduling information for '"
+             << MCII->getName(Insts[Idx].getOpcode())
+             << "', assuming a single micro-op with unit latency.\n";
+
+  Sim.run();
+  Sim.printSummary(Out.os());
+  Sim.printResourcePressure(Out.os(), *IP);
+  Sim.printCriticalChain(Out.os(), *IP);
+
+  Out.keep();
+  return 0;
+}
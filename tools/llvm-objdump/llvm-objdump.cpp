@@ -53,11 +53,13 @@
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cctype>
 #include <cstring>
 #include <system_error>
+#include <thread>
 
 using namespace llvm;
 using namespace object;
@@ -176,6 +178,12 @@ cl::opt<bool>
 cl::opt<bool> PrintFaultMaps("fault-map-section",
                              cl::desc("Display contents of faultmap section"));
 
+static cl::opt<unsigned>
+DisassembleThreads("threads",
+                   cl::desc("Number of threads to disassemble with "
+                            "(0 = number of cores)"),
+                   cl::init(0));
+
 static StringRef ToolName;
 
 namespace {
@@ -303,12 +311,12 @@ public:
                          ArrayRef<uint8_t> Bytes, uint64_t Address,
                          raw_ostream &OS, StringRef Annot,
                          MCSubtargetInfo const &STI) {
-    outs() << format("%8" PRIx64 ":", Address);
+    OS << format("%8" PRIx64 ":", Address);
     if (!NoShowRawInsn) {
-      outs() << "\t";
-      dumpBytes(Bytes, outs());
+      OS << "\t";
+      dumpBytes(Bytes, OS);
     }
-    IP.printInst(MI, outs(), "", STI);
+    IP.printInst(MI, OS, "", STI);
   }
 };
 PrettyPrinter PrettyPrinterInst;
@@ -515,9 +523,10 @@ static std::error_code getRelocationValueString(const COFFObjectFile *Obj,
   return std::error_code();
 }
 
-static void printRelocationTargetName(const MachOObjectFile *O,
-                                      const MachO::any_relocation_info &RE,
-                                      raw_string_ostream &fmt) {
+static std::error_code
+printRelocationTargetName(const MachOObjectFile *O,
+                          const MachO::any_relocation_info &RE,
+                          raw_string_ostream &fmt) {
   bool IsScattered = O->isRelocationScattered(RE);
 
   // Target of a scattered relocation is an address.  In the interest of
@@ -528,36 +537,33 @@ static void printRelocationTargetName(const MachOObjectFile *O,
     uint32_t Val = O->getPlainRelocationSymbolNum(RE);
 
     for (const SymbolRef &Symbol : O->symbols()) {
-      std::error_code ec;
       ErrorOr<uint64_t> Addr = Symbol.getAddress();
-      if ((ec = Addr.getError()))
-        report_fatal_error(ec.message());
+      if (std::error_code EC = Addr.getError())
+        return EC;
       if (*Addr != Val)
         continue;
       ErrorOr<StringRef> Name = Symbol.getName();
       if (std::error_code EC = Name.getError())
-        report_fatal_error(EC.message());
+        return EC;
       fmt << *Name;
-      return;
+      return std::error_code();
     }
 
     // If we couldn't find a symbol that this relocation refers to, try
     // to find a section beginning instead.
     for (const SectionRef &Section : ToolSectionFilter(*O)) {
-      std::error_code ec;
-
       StringRef Name;
       uint64_t Addr = Section.getAddress();
       if (Addr != Val)
         continue;
-      if ((ec = Section.getName(Name)))
-        report_fatal_error(ec.message());
+      if (std::error_code EC = Section.getName(Name))
+        return EC;
       fmt << Name;
-      return;
+      return std::error_code();
     }
 
     fmt << format("0x%x", Val);
-    return;
+    return std::error_code();
   }
 
   StringRef S;
@@ -568,7 +574,8 @@ static void printRelocationTargetName(const MachOObjectFile *O,
     symbol_iterator SI = O->symbol_begin();
     advance(SI, Val);
     ErrorOr<StringRef> SOrErr = SI->getName();
-    error(SOrErr.getError());
+    if (std::error_code EC = SOrErr.getError())
+      return EC;
     S = *SOrErr;
   } else {
     section_iterator SI = O->section_begin();
@@ -578,6 +585,7 @@ static void printRelocationTargetName(const MachOObjectFile *O,
   }
 
   fmt << S;
+  return std::error_code();
 }
 
 static std::error_code getRelocationValueString(const MachOObjectFile *Obj,
@@ -603,7 +611,8 @@ static std::error_code getRelocationValueString(const MachOObjectFile *Obj,
     switch (Type) {
     case MachO::X86_64_RELOC_GOT_LOAD:
     case MachO::X86_64_RELOC_GOT: {
-      printRelocationTargetName(Obj, RE, fmt);
+      if (std::error_code EC = printRelocationTargetName(Obj, RE, fmt))
+        return EC;
       fmt << "@GOT";
       if (isPCRel)
         fmt << "PCREL";
@@ -619,36 +628,42 @@ static std::error_code getRelocationValueString(const MachOObjectFile *Obj,
       // NOTE: Scattered relocations don't exist on x86_64.
       unsigned RType = Obj->getAnyRelocationType(RENext);
       if (RType != MachO::X86_64_RELOC_UNSIGNED)
-        report_fatal_error("Expected X86_64_RELOC_UNSIGNED after "
-                           "X86_64_RELOC_SUBTRACTOR.");
+        return object_error::parse_failed;
 
       // The X86_64_RELOC_UNSIGNED contains the minuend symbol;
       // X86_64_RELOC_SUBTRACTOR contains the subtrahend.
-      printRelocationTargetName(Obj, RENext, fmt);
+      if (std::error_code EC = printRelocationTargetName(Obj, RENext, fmt))
+        return EC;
       fmt << "-";
-      printRelocationTargetName(Obj, RE, fmt);
+      if (std::error_code EC = printRelocationTargetName(Obj, RE, fmt))
+        return EC;
       break;
     }
     case MachO::X86_64_RELOC_TLV:
-      printRelocationTargetName(Obj, RE, fmt);
+      if (std::error_code EC = printRelocationTargetName(Obj, RE, fmt))
+        return EC;
       fmt << "@TLV";
       if (isPCRel)
         fmt << "P";
       break;
     case MachO::X86_64_RELOC_SIGNED_1:
-      printRelocationTargetName(Obj, RE, fmt);
+      if (std::error_code EC = printRelocationTargetName(Obj, RE, fmt))
+        return EC;
       fmt << "-1";
       break;
     case MachO::X86_64_RELOC_SIGNED_2:
-      printRelocationTargetName(Obj, RE, fmt);
+      if (std::error_code EC = printRelocationTargetName(Obj, RE, fmt))
+        return EC;
       fmt << "-2";
       break;
     case MachO::X86_64_RELOC_SIGNED_4:
-      printRelocationTargetName(Obj, RE, fmt);
+      if (std::error_code EC = printRelocationTargetName(Obj, RE, fmt))
+        return EC;
       fmt << "-4";
       break;
     default:
-      printRelocationTargetName(Obj, RE, fmt);
+      if (std::error_code EC = printRelocationTargetName(Obj, RE, fmt))
+        return EC;
       break;
     }
     // X86 and ARM share some relocation types in common.
@@ -668,12 +683,13 @@ static std::error_code getRelocationValueString(const MachOObjectFile *Obj,
       unsigned RType = Obj->getAnyRelocationType(RENext);
 
       if (RType != MachO::GENERIC_RELOC_PAIR)
-        report_fatal_error("Expected GENERIC_RELOC_PAIR after "
-                           "GENERIC_RELOC_SECTDIFF.");
+        return object_error::parse_failed;
 
-      printRelocationTargetName(Obj, RE, fmt);
+      if (std::error_code EC = printRelocationTargetName(Obj, RE, fmt))
+        return EC;
       fmt << "-";
-      printRelocationTargetName(Obj, RENext, fmt);
+      if (std::error_code EC = printRelocationTargetName(Obj, RENext, fmt))
+        return EC;
       break;
     }
     }
@@ -689,23 +705,26 @@ static std::error_code getRelocationValueString(const MachOObjectFile *Obj,
         // GENERIC_RELOC_PAIR.
         unsigned RType = Obj->getAnyRelocationType(RENext);
         if (RType != MachO::GENERIC_RELOC_PAIR)
-          report_fatal_error("Expected GENERIC_RELOC_PAIR after "
-                             "GENERIC_RELOC_LOCAL_SECTDIFF.");
+          return object_error::parse_failed;
 
-        printRelocationTargetName(Obj, RE, fmt);
+        if (std::error_code EC = printRelocationTargetName(Obj, RE, fmt))
+          return EC;
         fmt << "-";
-        printRelocationTargetName(Obj, RENext, fmt);
+        if (std::error_code EC = printRelocationTargetName(Obj, RENext, fmt))
+          return EC;
         break;
       }
       case MachO::GENERIC_RELOC_TLV: {
-        printRelocationTargetName(Obj, RE, fmt);
+        if (std::error_code EC = printRelocationTargetName(Obj, RE, fmt))
+          return EC;
         fmt << "@TLV";
         if (IsPCRel)
           fmt << "P";
         break;
       }
       default:
-        printRelocationTargetName(Obj, RE, fmt);
+        if (std::error_code EC = printRelocationTargetName(Obj, RE, fmt))
+          return EC;
       }
     } else { // ARM-specific relocations
       switch (Type) {
@@ -719,7 +738,8 @@ static std::error_code getRelocationValueString(const MachOObjectFile *Obj,
           fmt << ":upper16:(";
         else
           fmt << ":lower16:(";
-        printRelocationTargetName(Obj, RE, fmt);
+        if (std::error_code EC = printRelocationTargetName(Obj, RE, fmt))
+          return EC;
 
         DataRefImpl RelNext = Rel;
         Obj->moveRelocationNext(RelNext);
@@ -729,8 +749,7 @@ static std::error_code getRelocationValueString(const MachOObjectFile *Obj,
         // ARM_RELOC_PAIR.
         unsigned RType = Obj->getAnyRelocationType(RENext);
         if (RType != MachO::ARM_RELOC_PAIR)
-          report_fatal_error("Expected ARM_RELOC_PAIR after "
-                             "ARM_RELOC_HALF");
+          return object_error::parse_failed;
 
         // NOTE: The half of the target virtual address is stashed in the
         // address field of the secondary relocation, but we can't reverse
@@ -741,17 +760,20 @@ static std::error_code getRelocationValueString(const MachOObjectFile *Obj,
         // symbol/section pointer of the follow-on relocation.
         if (Type == MachO::ARM_RELOC_HALF_SECTDIFF) {
           fmt << "-";
-          printRelocationTargetName(Obj, RENext, fmt);
+          if (std::error_code EC = printRelocationTargetName(Obj, RENext, fmt))
+            return EC;
         }
 
         fmt << ")";
         break;
       }
-      default: { printRelocationTargetName(Obj, RE, fmt); }
+      default:
+        if (std::error_code EC = printRelocationTargetName(Obj, RE, fmt))
+          return EC;
       }
     }
-  } else
-    printRelocationTargetName(Obj, RE, fmt);
+  } else if (std::error_code EC = printRelocationTargetName(Obj, RE, fmt))
+    return EC;
 
   fmt.flush();
   Result.append(fmtbuf.begin(), fmtbuf.end());
@@ -802,6 +824,249 @@ static bool getHidden(RelocationRef RelRef) {
   return false;
 }
 
+namespace {
+typedef std::vector<std::pair<uint64_t, StringRef>> SectionSymbolsTy;
+
+/// Everything needed to disassemble a range of symbols of a section. It is
+/// shared by the threads disassembling the section, and not modified while
+/// they run.
+struct SectionDisassembly {
+  const ObjectFile *Obj;
+  const Target *TheTarget;
+  const MCAsmInfo *AsmInfo;
+  const MCRegisterInfo *MRI;
+  const MCObjectFileInfo *MOFI;
+  const MCSubtargetInfo *STI;
+  const MCInstrInfo *MII;
+  const MCInstrAnalysis *MIA;
+  PrettyPrinter *PIP;
+  StringRef Fmt;
+
+  uint64_t SectionAddr;
+  uint64_t SectSize;
+  ArrayRef<uint8_t> Bytes;
+  const SectionSymbolsTy *Symbols;
+  ArrayRef<uint64_t> DataMappingSymsAddr;
+  ArrayRef<uint64_t> TextMappingSymsAddr;
+  /// The relocations of the section, sorted by offset.
+  ArrayRef<RelocationRef> Rels;
+
+  /// The start addresses of all the sections, sorted, and the symbols of the
+  /// section at the same index, used to symbolize branch targets.
+  ArrayRef<std::pair<uint64_t, SectionRef>> SectionAddresses;
+  ArrayRef<const SectionSymbolsTy *> SectionSymbols;
+};
+}
+
+/// Disassemble the symbols [SymBegin, SymEnd) of a section, printing the
+/// instructions and the relocations in that range to \p OS and warnings to
+/// \p ErrOS. Errors are returned rather than reported, since this may run on
+/// a worker thread and error() exits the process.
+static std::error_code DisassembleSymbols(const SectionDisassembly &SD,
+                                          unsigned SymBegin, unsigned SymEnd,
+                                          raw_ostream &OS,
+                                          raw_ostream &ErrOS) {
+  // Disassemblers and printers are not thread-safe, so each range gets its
+  // own.
+  MCContext Ctx(SD.AsmInfo, SD.MRI, SD.MOFI);
+  std::unique_ptr<MCDisassembler> DisAsm(
+      SD.TheTarget->createMCDisassembler(*SD.STI, Ctx));
+  std::unique_ptr<MCInstPrinter> IP(SD.TheTarget->createMCInstPrinter(
+      Triple(TripleName), SD.AsmInfo->getAssemblerDialect(), *SD.AsmInfo,
+      *SD.MII, *SD.MRI));
+  IP->setPrintImmHex(PrintImmHex);
+
+  const ObjectFile *Obj = SD.Obj;
+  const SectionSymbolsTy &Symbols = *SD.Symbols;
+  uint64_t SectionAddr = SD.SectionAddr;
+  uint64_t SectSize = SD.SectSize;
+  ArrayRef<uint8_t> Bytes = SD.Bytes;
+
+  // Print the relocations between the start of the first symbol and the start
+  // of the symbol after the last one. The first range also prints the
+  // relocations before its first symbol.
+  auto RelocBefore = [&](uint64_t Offset) {
+    return std::lower_bound(SD.Rels.begin(), SD.Rels.end(), Offset,
+                            [](const RelocationRef &R, uint64_t Offset) {
+                              return R.getOffset() < Offset;
+                            });
+  };
+  ArrayRef<RelocationRef>::iterator rel_cur =
+      SymBegin == 0 ? SD.Rels.begin()
+                    : RelocBefore(Symbols[SymBegin].first - SectionAddr);
+  ArrayRef<RelocationRef>::iterator rel_end =
+      SymEnd == Symbols.size() ? SD.Rels.end()
+                               : RelocBefore(Symbols[SymEnd].first -
+                                             SectionAddr);
+
+  SmallString<40> Comments;
+  raw_svector_ostream CommentStream(Comments);
+
+  uint64_t Size;
+  uint64_t Index;
+
+  // Disassemble symbol by symbol.
+  for (unsigned si = SymBegin, se = Symbols.size(); si != SymEnd; ++si) {
+
+    uint64_t Start = Symbols[si].first - SectionAddr;
+    // The end is either the section end or the beginning of the next
+    // symbol.
+    uint64_t End =
+        (si == se - 1) ? SectSize : Symbols[si + 1].first - SectionAddr;
+    // Don't try to disassemble beyond the end of section contents.
+    if (End > SectSize)
+      End = SectSize;
+    // If this symbol has the same address as the next symbol, then skip it.
+    if (Start >= End)
+      continue;
+
+    OS << '\n' << Symbols[si].second << ":\n";
+
+#ifndef NDEBUG
+    raw_ostream &DebugOut = DebugFlag ? dbgs() : nulls();
+#else
+    raw_ostream &DebugOut = nulls();
+#endif
+
+    for (Index = Start; Index < End; Index += Size) {
+      MCInst Inst;
+
+      // AArch64 ELF binaries can interleave data and text in the
+      // same section. We rely on the markers introduced to
+      // understand what we need to dump.
+      if (Obj->isELF() && Obj->getArch() == Triple::aarch64) {
+        uint64_t Stride = 0;
+
+        auto DAI = std::lower_bound(SD.DataMappingSymsAddr.begin(),
+                                    SD.DataMappingSymsAddr.end(), Index);
+        if (DAI != SD.DataMappingSymsAddr.end() && *DAI == Index) {
+          // Switch to data.
+          while (Index < End) {
+            OS << format("%8" PRIx64 ":", SectionAddr + Index);
+            OS << "\t";
+            if (Index + 4 <= End) {
+              Stride = 4;
+              dumpBytes(Bytes.slice(Index, 4), OS);
+              OS << "\t.word";
+            } else if (Index + 2 <= End) {
+              Stride = 2;
+              dumpBytes(Bytes.slice(Index, 2), OS);
+              OS << "\t.short";
+            } else {
+              Stride = 1;
+              dumpBytes(Bytes.slice(Index, 1), OS);
+              OS << "\t.byte";
+            }
+            Index += Stride;
+            OS << "\n";
+            auto TAI = std::lower_bound(SD.TextMappingSymsAddr.begin(),
+                                        SD.TextMappingSymsAddr.end(), Index);
+            if (TAI != SD.TextMappingSymsAddr.end() && *TAI == Index)
+              break;
+          }
+        }
+      }
+
+      if (Index >= End)
+        break;
+
+      if (DisAsm->getInstruction(Inst, Size, Bytes.slice(Index),
+                                 SectionAddr + Index, DebugOut,
+                                 CommentStream)) {
+        SD.PIP->printInst(*IP, &Inst,
+                          Bytes.slice(Index, Size),
+                          SectionAddr + Index, OS, "", *SD.STI);
+        OS << CommentStream.str();
+        Comments.clear();
+
+        // Try to resolve the target of a call, tail call, etc. to a specific
+        // symbol.
+        const MCInstrAnalysis *MIA = SD.MIA;
+        if (MIA && (MIA->isCall(Inst) || MIA->isUnconditionalBranch(Inst) ||
+                    MIA->isConditionalBranch(Inst))) {
+          uint64_t Target;
+          if (MIA->evaluateBranch(Inst, SectionAddr + Index, Size, Target)) {
+            // In a relocatable object, the target's section must reside in
+            // the same section as the call instruction or it is accessed
+            // through a relocation.
+            //
+            // In a non-relocatable object, the target may be in any section.
+            //
+            // N.B. We don't walk the relocations in the relocatable case yet.
+            const SectionSymbolsTy *TargetSectionSymbols = &Symbols;
+            if (!Obj->isRelocatableObject()) {
+              auto SectionAddress = std::upper_bound(
+                  SD.SectionAddresses.begin(), SD.SectionAddresses.end(),
+                  Target,
+                  [](uint64_t LHS,
+                     const std::pair<uint64_t, SectionRef> &RHS) {
+                    return LHS < RHS.first;
+                  });
+              if (SectionAddress != SD.SectionAddresses.begin()) {
+                --SectionAddress;
+                TargetSectionSymbols =
+                    SD.SectionSymbols[SectionAddress -
+                                      SD.SectionAddresses.begin()];
+              } else {
+                TargetSectionSymbols = nullptr;
+              }
+            }
+
+            // Find the first symbol in the section whose offset is less than
+            // or equal to the target.
+            if (TargetSectionSymbols) {
+              auto TargetSym = std::upper_bound(
+                  TargetSectionSymbols->begin(), TargetSectionSymbols->end(),
+                  Target, [](uint64_t LHS,
+                             const std::pair<uint64_t, StringRef> &RHS) {
+                    return LHS < RHS.first;
+                  });
+              if (TargetSym != TargetSectionSymbols->begin()) {
+                --TargetSym;
+                uint64_t TargetAddress = std::get<0>(*TargetSym);
+                StringRef TargetName = std::get<1>(*TargetSym);
+                OS << " <" << TargetName;
+                uint64_t Disp = Target - TargetAddress;
+                if (Disp)
+                  OS << '+' << utohexstr(Disp);
+                OS << '>';
+              }
+            }
+          }
+        }
+        OS << "\n";
+      } else {
+        ErrOS << ToolName << ": warning: invalid instruction encoding\n";
+        if (Size == 0)
+          Size = 1; // skip illegible bytes
+      }
+
+      // Print relocation for instruction.
+      while (rel_cur != rel_end) {
+        bool hidden = getHidden(*rel_cur);
+        uint64_t addr = rel_cur->getOffset();
+        SmallString<16> name;
+        SmallString<32> val;
+
+        // If this relocation is hidden, skip it.
+        if (hidden) goto skip_print_rel;
+
+        // Stop when rel_cur's address is past the current instruction.
+        if (addr >= Index + Size) break;
+        rel_cur->getTypeName(name);
+        if (std::error_code EC = getRelocationValueString(*rel_cur, val))
+          return EC;
+        OS << format(SD.Fmt.data(), SectionAddr + addr) << name
+           << "\t" << val << "\n";
+
+      skip_print_rel:
+        ++rel_cur;
+      }
+    }
+  }
+  return std::error_code();
+}
+
 static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
   const Target *TheTarget = getTarget(Obj);
 
@@ -834,6 +1099,8 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
   std::unique_ptr<const MCObjectFileInfo> MOFI(new MCObjectFileInfo);
   MCContext Ctx(AsmInfo.get(), MRI.get(), MOFI.get());
 
+  // Each range of symbols gets its own disassembler and printer; check that
+  // the target has them once and for all.
   std::unique_ptr<MCDisassembler> DisAsm(
     TheTarget->createMCDisassembler(*STI, Ctx));
   if (!DisAsm)
@@ -848,7 +1115,6 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
   if (!IP)
     report_fatal_error("error: no instruction printer for target " +
                        TripleName);
-  IP->setPrintImmHex(PrintImmHex);
   PrettyPrinter &PIP = selectPrettyPrinter(Triple(TripleName));
 
   StringRef Fmt = Obj->getBytesInAddress() > 4 ? "\t\t%016" PRIx64 ":  " :
@@ -866,7 +1132,6 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
 
   // Create a mapping from virtual address to symbol name.  This is used to
   // pretty print the symbols while disassembling.
-  typedef std::vector<std::pair<uint64_t, StringRef>> SectionSymbolsTy;
   std::map<SectionRef, SectionSymbolsTy> AllSymbols;
   for (const SymbolRef &Symbol : Obj->symbols()) {
     ErrorOr<uint64_t> AddressOrErr = Symbol.getAddress();
@@ -925,6 +1190,38 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
   for (std::pair<const SectionRef, SectionSymbolsTy> &SecSyms : AllSymbols)
     array_pod_sort(SecSyms.second.begin(), SecSyms.second.end());
 
+  // Index the symbols of every section by the position of the section in
+  // SectionAddresses, for looking up branch targets.
+  std::vector<const SectionSymbolsTy *> SectionSymbols;
+  for (const std::pair<uint64_t, SectionRef> &SecAddr : SectionAddresses)
+    SectionSymbols.push_back(&AllSymbols[SecAddr.second]);
+
+  // Sections are split into ranges of whole symbols of at least this many
+  // bytes, which are disassembled in parallel and printed in order. The
+  // ranges do not depend on the number of threads, and neither does the
+  // output. Dumping debug output from several threads would mix it up.
+  const uint64_t RangeSize = 1 << 16;
+  unsigned NumThreads = DisassembleThreads;
+  if (!NumThreads)
+    NumThreads = std::max(1u, std::thread::hardware_concurrency());
+  if (DebugFlag)
+    NumThreads = 1;
+  std::unique_ptr<ThreadPool> Pool;
+
+  SectionDisassembly SD;
+  SD.Obj = Obj;
+  SD.TheTarget = TheTarget;
+  SD.AsmInfo = AsmInfo.get();
+  SD.MRI = MRI.get();
+  SD.MOFI = MOFI.get();
+  SD.STI = STI.get();
+  SD.MII = MII.get();
+  SD.MIA = MIA.get();
+  SD.PIP = &PIP;
+  SD.Fmt = Fmt;
+  SD.SectionAddresses = SectionAddresses;
+  SD.SectionSymbols = SectionSymbols;
+
   for (const SectionRef &Section : ToolSectionFilter(*Obj)) {
     if (!DisassembleAll && (!Section.isText() || Section.isVirtual()))
       continue;
@@ -981,171 +1278,59 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
     if (Symbols.empty() || Symbols[0].first != 0)
       Symbols.insert(Symbols.begin(), std::make_pair(SectionAddr, name));
 
-    SmallString<40> Comments;
-    raw_svector_ostream CommentStream(Comments);
-
     StringRef BytesStr;
     error(Section.getContents(BytesStr));
     ArrayRef<uint8_t> Bytes(reinterpret_cast<const uint8_t *>(BytesStr.data()),
                             BytesStr.size());
 
-    uint64_t Size;
-    uint64_t Index;
-
-    std::vector<RelocationRef>::const_iterator rel_cur = Rels.begin();
-    std::vector<RelocationRef>::const_iterator rel_end = Rels.end();
-    // Disassemble symbol by symbol.
+    SD.SectionAddr = SectionAddr;
+    SD.SectSize = SectSize;
+    SD.Bytes = Bytes;
+    SD.Symbols = &Symbols;
+    SD.DataMappingSymsAddr = DataMappingSymsAddr;
+    SD.TextMappingSymsAddr = TextMappingSymsAddr;
+    SD.Rels = Rels;
+
+    // Split the section into ranges of symbols.
+    std::vector<std::pair<unsigned, unsigned>> Ranges;
+    unsigned RangeBegin = 0;
     for (unsigned si = 0, se = Symbols.size(); si != se; ++si) {
-
-      uint64_t Start = Symbols[si].first - SectionAddr;
-      // The end is either the section end or the beginning of the next
-      // symbol.
       uint64_t End =
-          (si == se - 1) ? SectSize : Symbols[si + 1].first - SectionAddr;
-      // Don't try to disassemble beyond the end of section contents.
-      if (End > SectSize)
-        End = SectSize;
-      // If this symbol has the same address as the next symbol, then skip it.
-      if (Start >= End)
-        continue;
-
-      outs() << '\n' << Symbols[si].second << ":\n";
-
-#ifndef NDEBUG
-      raw_ostream &DebugOut = DebugFlag ? dbgs() : nulls();
-#else
-      raw_ostream &DebugOut = nulls();
-#endif
-
-      for (Index = Start; Index < End; Index += Size) {
-        MCInst Inst;
-
-        // AArch64 ELF binaries can interleave data and text in the
-        // same section. We rely on the markers introduced to
-        // understand what we need to dump.
-        if (Obj->isELF() && Obj->getArch() == Triple::aarch64) {
-          uint64_t Stride = 0;
-
-          auto DAI = std::lower_bound(DataMappingSymsAddr.begin(),
-                                      DataMappingSymsAddr.end(), Index);
-          if (DAI != DataMappingSymsAddr.end() && *DAI == Index) {
-            // Switch to data.
-            while (Index < End) {
-              outs() << format("%8" PRIx64 ":", SectionAddr + Index);
-              outs() << "\t";
-              if (Index + 4 <= End) {
-                Stride = 4;
-                dumpBytes(Bytes.slice(Index, 4), outs());
-                outs() << "\t.word";
-              } else if (Index + 2 <= End) {
-                Stride = 2;
-                dumpBytes(Bytes.slice(Index, 2), outs());
-                outs() << "\t.short";
-              } else {
-                Stride = 1;
-                dumpBytes(Bytes.slice(Index, 1), outs());
-                outs() << "\t.byte";
-              }
-              Index += Stride;
-              outs() << "\n";
-              auto TAI = std::lower_bound(TextMappingSymsAddr.begin(),
-                                          TextMappingSymsAddr.end(), Index);
-              if (TAI != TextMappingSymsAddr.end() && *TAI == Index)
-                break;
-            }
-          }
-        }
-
-        if (Index >= End)
-          break;
-
-        if (DisAsm->getInstruction(Inst, Size, Bytes.slice(Index),
-                                   SectionAddr + Index, DebugOut,
-                                   CommentStream)) {
-          PIP.printInst(*IP, &Inst,
-                        Bytes.slice(Index, Size),
-                        SectionAddr + Index, outs(), "", *STI);
-          outs() << CommentStream.str();
-          Comments.clear();
-
-          // Try to resolve the target of a call, tail call, etc. to a specific
-          // symbol.
-          if (MIA && (MIA->isCall(Inst) || MIA->isUnconditionalBranch(Inst) ||
-                      MIA->isConditionalBranch(Inst))) {
-            uint64_t Target;
-            if (MIA->evaluateBranch(Inst, SectionAddr + Index, Size, Target)) {
-              // In a relocatable object, the target's section must reside in
-              // the same section as the call instruction or it is accessed
-              // through a relocation.
-              //
-              // In a non-relocatable object, the target may be in any section.
-              //
-              // N.B. We don't walk the relocations in the relocatable case yet.
-              auto *TargetSectionSymbols = &Symbols;
-              if (!Obj->isRelocatableObject()) {
-                auto SectionAddress = std::upper_bound(
-                    SectionAddresses.begin(), SectionAddresses.end(), Target,
-                    [](uint64_t LHS,
-                       const std::pair<uint64_t, SectionRef> &RHS) {
-                      return LHS < RHS.first;
-                    });
-                if (SectionAddress != SectionAddresses.begin()) {
-                  --SectionAddress;
-                  TargetSectionSymbols = &AllSymbols[SectionAddress->second];
-                } else {
-                  TargetSectionSymbols = nullptr;
-                }
-              }
+          si == se - 1 ? SectionAddr + SectSize : Symbols[si + 1].first;
+      if (si == se - 1 || End - Symbols[RangeBegin].first >= RangeSize) {
+        Ranges.emplace_back(RangeBegin, si + 1);
+        RangeBegin = si + 1;
+      }
+    }
 
-              // Find the first symbol in the section whose offset is less than
-              // or equal to the target.
-              if (TargetSectionSymbols) {
-                auto TargetSym = std::upper_bound(
-                    TargetSectionSymbols->begin(), TargetSectionSymbols->end(),
-                    Target, [](uint64_t LHS,
-                               const std::pair<uint64_t, StringRef> &RHS) {
-                      return LHS < RHS.first;
-                    });
-                if (TargetSym != TargetSectionSymbols->begin()) {
-                  --TargetSym;
-                  uint64_t TargetAddress = std::get<0>(*TargetSym);
-                  StringRef TargetName = std::get<1>(*TargetSym);
-                  outs() << " <" << TargetName;
-                  uint64_t Disp = Target - TargetAddress;
-                  if (Disp)
-                    outs() << '+' << utohexstr(Disp);
-                  outs() << '>';
-                }
-              }
-            }
-          }
-          outs() << "\n";
-        } else {
-          errs() << ToolName << ": warning: invalid instruction encoding\n";
-          if (Size == 0)
-            Size = 1; // skip illegible bytes
-        }
+    if (NumThreads == 1 || Ranges.size() == 1) {
+      for (const std::pair<unsigned, unsigned> &Range : Ranges)
+        error(DisassembleSymbols(SD, Range.first, Range.second, outs(),
+                                 errs()));
+      continue;
+    }
 
-        // Print relocation for instruction.
-        while (rel_cur != rel_end) {
-          bool hidden = getHidden(*rel_cur);
-          uint64_t addr = rel_cur->getOffset();
-          SmallString<16> name;
-          SmallString<32> val;
-
-          // If this relocation is hidden, skip it.
-          if (hidden) goto skip_print_rel;
-
-          // Stop when rel_cur's address is past the current instruction.
-          if (addr >= Index + Size) break;
-          rel_cur->getTypeName(name);
-          error(getRelocationValueString(*rel_cur, val));
-          outs() << format(Fmt.data(), SectionAddr + addr) << name
-                 << "\t" << val << "\n";
-
-        skip_print_rel:
-          ++rel_cur;
-        }
+    // Disassemble a few ranges per thread at a time, so that the output
+    // buffered at any time stays bounded. Errors are collected per range and
+    // reported in order on this thread, after the output that preceded them.
+    if (!Pool)
+      Pool.reset(new ThreadPool(NumThreads));
+    size_t BatchSize = 4 * NumThreads;
+    for (size_t B = 0, E = Ranges.size(); B < E; B += BatchSize) {
+      size_t N = std::min(BatchSize, E - B);
+      std::vector<std::string> Out(N), Err(N);
+      std::vector<std::error_code> EC(N);
+      for (size_t I = 0; I != N; ++I)
+        Pool->async([&, I]() {
+          raw_string_ostream OS(Out[I]), ErrOS(Err[I]);
+          EC[I] = DisassembleSymbols(SD, Ranges[B + I].first,
+                                     Ranges[B + I].second, OS, ErrOS);
+        });
+      Pool->wait();
+      for (size_t I = 0; I != N; ++I) {
+        outs() << Out[I];
+        errs() << Err[I];
+        error(EC[I]);
       }
     }
   }
@@ -9,6 +9,7 @@
 
 #include "gtest/gtest.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SwissDenseMap.h"
 #include <map>
 #include <set>
 
@@ -104,7 +105,10 @@ typedef ::testing::Types<DenseMap<uint32_t, uint32_t>,
                          SmallDenseMap<uint32_t, uint32_t>,
                          SmallDenseMap<uint32_t *, uint32_t *>,
                          SmallDenseMap<CtorTester, CtorTester, 4,
-                                       CtorTesterMapInfo>
+                                       CtorTesterMapInfo>,
+                         SwissDenseMap<uint32_t, uint32_t>,
+                         SwissDenseMap<uint32_t *, uint32_t *>,
+                         SwissDenseMap<CtorTester, CtorTester, CtorTesterMapInfo>
                          > DenseMapTestTypes;
 TYPED_TEST_CASE(DenseMapTest, DenseMapTestTypes);
 
@@ -438,4 +442,70 @@ TEST(DenseMapCustomTest, SmallDenseMapGrowTest) {
   EXPECT_TRUE(map.find(32) == map.end());
 }
 
+// SwissDenseMap keeps its own control bytes, so keys need no reserved empty or
+// tombstone values and every value of the key type is usable.
+TEST(SwissDenseMapTest, NoReservedKeys) {
+  SwissDenseMap<unsigned, unsigned, ContiguousDenseMapInfo> Map;
+  Map[~0U] = 1;
+  Map[~0U - 1] = 2;
+  Map[0] = 3;
+  EXPECT_EQ(3u, Map.size());
+  EXPECT_EQ(1u, Map.lookup(~0U));
+  EXPECT_EQ(2u, Map.lookup(~0U - 1));
+  EXPECT_EQ(3u, Map.lookup(0));
+  EXPECT_TRUE(Map.erase(~0U));
+  EXPECT_EQ(0u, Map.count(~0U));
+  EXPECT_EQ(1u, Map.count(~0U - 1));
+}
+
+TEST(SwissDenseMapTest, FindAsTest) {
+  SwissDenseMap<unsigned, unsigned, TestDenseMapInfo> Map;
+  Map[0] = 1;
+  Map[1] = 2;
+  Map[2] = 3;
+  EXPECT_EQ(1u, Map.find_as("a")->second);
+  EXPECT_EQ(2u, Map.find_as("b")->second);
+  EXPECT_EQ(3u, Map.find_as("c")->second);
+  EXPECT_TRUE(Map.find_as("d") == Map.end());
+}
+
+// Mirror a long series of inserts and erases in a std::map. Heavy erase
+// traffic must neither lose entries nor let deleted markers grow the table.
+TEST(SwissDenseMapTest, EraseChurnTest) {
+  SwissDenseMap<unsigned, unsigned> Map;
+  std::map<unsigned, unsigned> Reference;
+  unsigned State = 1;
+  for (unsigned I = 0; I != 100000; ++I) {
+    State = State * 1103515245 + 12345;
+    unsigned Key = (State >> 8) % 3000;
+    if (State & 1) {
+      Map[Key] = I;
+      Reference[Key] = I;
+    } else {
+      EXPECT_EQ(Reference.erase(Key), (size_t)Map.erase(Key));
+    }
+  }
+  EXPECT_EQ(Reference.size(), Map.size());
+  for (const auto &KV : Reference)
+    EXPECT_EQ(KV.second, Map.lookup(KV.first));
+  for (const auto &KV : Map)
+    EXPECT_EQ(Reference[KV.first], KV.second);
+  // 3000 live keys at most fit in 4096 buckets under the 7/8 load factor.
+  EXPECT_GE(4096u, Map.getNumBuckets());
+}
+
+TEST(SwissDenseMapTest, ResizeTest) {
+  SwissDenseMap<unsigned, unsigned> Map(100);
+  unsigned NumBuckets = Map.getNumBuckets();
+  EXPECT_LE(100u * 8 / 7, NumBuckets);
+  for (unsigned I = 0; I != 100; ++I)
+    Map[I] = I;
+  EXPECT_EQ(NumBuckets, Map.getNumBuckets());
+
+  Map.resize(1000);
+  EXPECT_LE(1000u * 8 / 7, Map.getNumBuckets());
+  for (unsigned I = 0; I != 100; ++I)
+    EXPECT_EQ(I, Map.lookup(I));
+}
+
 }
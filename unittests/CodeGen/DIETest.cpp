@@ -0,0 +1,87 @@
+//===- llvm/unittest/CodeGen/DIETest.cpp ----------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/CodeGen/DIE.h"
+#include "llvm/Support/Dwarf.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+static SmallVector<uint64_t, 8> getIntegers(const DIEValueList &L) {
+  SmallVector<uint64_t, 8> Result;
+  for (const DIEValue &V : L.values())
+    Result.push_back(V.getDIEInteger().getValue());
+  return Result;
+}
+
+TEST(DIEValueListTest, Empty) {
+  BumpPtrAllocator Alloc;
+  DIE &Die = *DIE::get(Alloc, dwarf::DW_TAG_base_type);
+  EXPECT_TRUE(Die.values().begin() == Die.values().end());
+}
+
+TEST(DIEValueListTest, ConsecutiveValuesShareRun) {
+  BumpPtrAllocator Alloc;
+  DIE &Die = *DIE::get(Alloc, dwarf::DW_TAG_base_type);
+  size_t Before = Alloc.getBytesAllocated();
+  for (unsigned I = 0; I != 8; ++I)
+    Die.addValue(Alloc, dwarf::DW_AT_byte_size, dwarf::DW_FORM_data1,
+                 DIEInteger(I));
+
+  // One run header plus the values themselves.
+  EXPECT_EQ(9 * sizeof(DIEValue), Alloc.getBytesAllocated() - Before);
+  SmallVector<uint64_t, 8> Expected = {0, 1, 2, 3, 4, 5, 6, 7};
+  EXPECT_EQ(Expected, getIntegers(Die));
+}
+
+TEST(DIEValueListTest, InterleavedAllocations) {
+  BumpPtrAllocator Alloc;
+  DIE &Parent = *DIE::get(Alloc, dwarf::DW_TAG_structure_type);
+  DIE *Child = nullptr;
+  SmallVector<DIEValueList::value_iterator, 8> Its;
+  for (unsigned I = 0; I != 6; ++I) {
+    Its.push_back(Parent.addValue(Alloc, dwarf::DW_AT_byte_size,
+                                  dwarf::DW_FORM_data1, DIEInteger(I)));
+    // Allocating a child splits the parent's values into separate runs.
+    if (I % 2 == 0) {
+      Child = DIE::get(Alloc, dwarf::DW_TAG_member);
+      Parent.addChild(Child);
+      Child->addValue(Alloc, dwarf::DW_AT_byte_size, dwarf::DW_FORM_data1,
+                      DIEInteger(100 + I));
+    }
+  }
+
+  SmallVector<uint64_t, 8> Expected = {0, 1, 2, 3, 4, 5};
+  EXPECT_EQ(Expected, getIntegers(Parent));
+  SmallVector<uint64_t, 8> ChildExpected = {104};
+  EXPECT_EQ(ChildExpected, getIntegers(*Child));
+
+  // Iterators returned by addValue still point at their values.
+  for (unsigned I = 0; I != 6; ++I)
+    EXPECT_EQ(I, (*Its[I]).getDIEInteger().getValue());
+}
+
+TEST(DIEValueListTest, IteratorSurvivesGrowth) {
+  BumpPtrAllocator Alloc;
+  DIE &Die = *DIE::get(Alloc, dwarf::DW_TAG_base_type);
+  DIE::value_iterator It = Die.addValue(
+      Alloc, dwarf::DW_AT_byte_size, dwarf::DW_FORM_data1, DIEInteger(1));
+  Die.addValue(Alloc, dwarf::DW_AT_encoding, dwarf::DW_FORM_data1,
+               DIEInteger(2));
+  EXPECT_EQ(dwarf::DW_AT_byte_size, (*It).getAttribute());
+  ++It;
+  ASSERT_TRUE(It != Die.values().end());
+  EXPECT_EQ(dwarf::DW_AT_encoding, (*It).getAttribute());
+  ++It;
+  EXPECT_TRUE(It == Die.values().end());
+}
+
+} // end namespace
@@ -80,6 +80,36 @@ TEST(AllocatorTest, TestReset) {
   EXPECT_EQ(2U, Alloc.GetNumSlabs());
 }
 
+// Check that the byte accounting used by memory reports tracks allocations
+// and is cleared by Reset.
+TEST(AllocatorTest, TestBytesAllocated) {
+  BumpPtrAllocator Alloc;
+  EXPECT_EQ(0U, Alloc.getBytesAllocated());
+  EXPECT_EQ(0U, Alloc.getTotalMemory());
+
+  Alloc.Allocate(100, 1);
+  Alloc.Allocate(200, 8);
+  EXPECT_EQ(300U, Alloc.getBytesAllocated());
+  EXPECT_EQ(4096U, Alloc.getTotalMemory());
+
+  // A custom-sized slab is counted in both.
+  Alloc.Allocate(5000, 1);
+  EXPECT_EQ(5300U, Alloc.getBytesAllocated());
+  EXPECT_EQ(4096U + 5000U, Alloc.getTotalMemory());
+
+  Alloc.Reset();
+  EXPECT_EQ(0U, Alloc.getBytesAllocated());
+  EXPECT_EQ(4096U, Alloc.getTotalMemory());
+
+  // Resetting an allocator that only has custom-sized slabs clears the count
+  // as well.
+  BumpPtrAllocator BigAlloc;
+  BigAlloc.Allocate(5000, 1);
+  BigAlloc.Reset();
+  EXPECT_EQ(0U, BigAlloc.getBytesAllocated());
+  EXPECT_EQ(0U, BigAlloc.getTotalMemory());
+}
+
 // Test some allocations at varying alignments.
 TEST(AllocatorTest, TestAlignment) {
   BumpPtrAllocator Alloc;
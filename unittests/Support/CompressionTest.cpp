@@ -15,6 +15,7 @@
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Config/config.h"
+#include "llvm/Support/ThreadPool.h"
 #include "gtest/gtest.h"
 
 using namespace llvm;
@@ -59,6 +60,54 @@ TEST(CompressionTest, Zlib) {
   TestZlibCompression(BinaryDataStr, zlib::DefaultCompression);
 }
 
+void TestZlibParallelCompression(StringRef Input, zlib::CompressionLevel Level,
+                                 size_t ChunkSize) {
+  SmallString<32> Serial;
+  SmallString<32> Parallel;
+  SmallString<32> Pooled;
+  SmallString<32> Uncompressed;
+  EXPECT_EQ(zlib::StatusOK,
+            zlib::compressParallel(Input, Serial, Level, 1, ChunkSize));
+  EXPECT_EQ(zlib::StatusOK,
+            zlib::compressParallel(Input, Parallel, Level, 4, ChunkSize));
+  ThreadPool Pool(3);
+  EXPECT_EQ(zlib::StatusOK,
+            zlib::compressParallel(Input, Pooled, Pool, Level, ChunkSize));
+  // The output must not depend on the number of threads.
+  EXPECT_EQ(Serial, Parallel);
+  EXPECT_EQ(Serial, Pooled);
+  // It must be a single valid zlib stream.
+  EXPECT_EQ(zlib::StatusOK,
+            zlib::uncompress(Parallel, Uncompressed, Input.size()));
+  EXPECT_EQ(Input, Uncompressed);
+}
+
+TEST(CompressionTest, ZlibParallel) {
+  std::string Data;
+  uint32_t State = 1;
+  for (size_t I = 0; I < 100000; ++I) {
+    State = State * 1103515245 + 12345;
+    // Mix compressible runs with noise.
+    Data += (State >> 16) % 4 ? char('a' + I % 7) : char(State >> 24);
+  }
+
+  TestZlibParallelCompression(Data, zlib::DefaultCompression, 4096);
+  TestZlibParallelCompression(Data, zlib::BestSpeedCompression, 4096);
+  TestZlibParallelCompression(Data, zlib::BestSizeCompression, 10000);
+  TestZlibParallelCompression(Data, zlib::NoCompression, 4096);
+  // A chunk size that divides the input evenly.
+  TestZlibParallelCompression(Data, zlib::DefaultCompression, 25000);
+
+  // Inputs that fit in one chunk are compressed exactly as by compress().
+  SmallString<32> Chunked;
+  SmallString<32> Whole;
+  StringRef Small = StringRef(Data).substr(0, 4096);
+  EXPECT_EQ(zlib::StatusOK,
+            zlib::compressParallel(Small, Chunked, zlib::DefaultCompression));
+  EXPECT_EQ(zlib::StatusOK, zlib::compress(Small, Whole));
+  EXPECT_EQ(Whole, Chunked);
+}
+
 TEST(CompressionTest, ZlibCRC32) {
   EXPECT_EQ(
       0x414FA339U,
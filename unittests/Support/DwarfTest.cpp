@@ -138,4 +138,22 @@ TEST(DwarfTest, getVirtuality) {
   EXPECT_EQ(DW_VIRTUALITY_invalid, getVirtuality("something else"));
 }
 
+TEST(DwarfTest, NameIndexHash) {
+  // The Bernstein hash of the empty string is its seed.
+  EXPECT_EQ(5381u, NameIndexHash(""));
+  EXPECT_EQ(0x7c9a7f6au, NameIndexHash("main"));
+
+  // Names are hashed case-insensitively.
+  EXPECT_EQ(NameIndexHash("counter"), NameIndexHash("Counter"));
+  EXPECT_EQ(NameIndexHash("_Z3FOOv"), NameIndexHash("_z3foov"));
+  EXPECT_NE(NameIndexHash("main"), NameIndexHash("mains"));
+}
+
+TEST(DwarfTest, IndexString) {
+  EXPECT_EQ(StringRef("DW_IDX_compile_unit"),
+            IndexString(DW_IDX_compile_unit));
+  EXPECT_EQ(StringRef("DW_IDX_die_offset"), IndexString(DW_IDX_die_offset));
+  EXPECT_EQ(nullptr, IndexString(DW_IDX_lo_user));
+}
+
 } // end namespace
@@ -9,7 +9,9 @@
 
 #include "llvm/Support/Regex.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/ThreadPool.h"
 #include "gtest/gtest.h"
+#include <atomic>
 #include <cstring>
 
 using namespace llvm;
@@ -153,4 +155,142 @@ TEST_F(RegexTest, MoveAssign) {
   EXPECT_TRUE(r2.match("916"));
 }
 
+TEST_F(RegexTest, Anchors) {
+  EXPECT_TRUE(Regex("^b").match("b\na"));
+  EXPECT_FALSE(Regex("^b").match("a\nb"));
+  EXPECT_TRUE(Regex("^b", Regex::Newline).match("a\nb"));
+  EXPECT_FALSE(Regex("a$").match("a\nb"));
+  EXPECT_TRUE(Regex("a$", Regex::Newline).match("a\nb"));
+  EXPECT_TRUE(Regex("a$\n^b", Regex::Newline).match("xa\nby"));
+  EXPECT_FALSE(Regex("a$b", Regex::Newline).match("ab"));
+  EXPECT_TRUE(Regex("^$", Regex::Newline).match("a\n\nb"));
+  EXPECT_FALSE(Regex("^$", Regex::Newline).match("a\nb"));
+  EXPECT_TRUE(Regex("x|^a").match("abc"));
+  EXPECT_FALSE(Regex("x|^b").match("abc"));
+}
+
+TEST_F(RegexTest, Brackets) {
+  EXPECT_TRUE(Regex("^[]a]+$").match("]a]"));
+  EXPECT_TRUE(Regex("^[^]a]$").match("b"));
+  EXPECT_FALSE(Regex("^[^]a]$").match("]"));
+  EXPECT_TRUE(Regex("^[a-]+$").match("a-a"));
+  EXPECT_TRUE(Regex("^[-a]+$").match("-a-"));
+  EXPECT_TRUE(Regex("^[[:digit:][:upper:]]+$").match("A1B2"));
+  EXPECT_FALSE(Regex("^[[:digit:][:upper:]]+$").match("A1b2"));
+  EXPECT_TRUE(Regex("^[\\n]+$").match("\\n\\"));
+  EXPECT_TRUE(Regex("a.b").match("a\nb"));
+  EXPECT_FALSE(Regex("a.b", Regex::Newline).match("a\nb"));
+  EXPECT_TRUE(Regex("a[^x]b").match("a\nb"));
+  EXPECT_FALSE(Regex("a[^x]b", Regex::Newline).match("a\nb"));
+  EXPECT_TRUE(Regex("a[[:space:]]b", Regex::Newline).match("a\nb"));
+}
+
+TEST_F(RegexTest, IgnoreCase) {
+  EXPECT_TRUE(Regex("^abc$", Regex::IgnoreCase).match("AbC"));
+  EXPECT_TRUE(Regex("^[a-c]+$", Regex::IgnoreCase).match("AbC"));
+  EXPECT_FALSE(Regex("^[^a-c]$", Regex::IgnoreCase).match("B"));
+  EXPECT_FALSE(Regex("^abc$").match("AbC"));
+}
+
+TEST_F(RegexTest, Repetition) {
+  EXPECT_TRUE(Regex("^a{3}$").match("aaa"));
+  EXPECT_FALSE(Regex("^a{3}$").match("aaaa"));
+  EXPECT_TRUE(Regex("^a{2,}$").match("aaaa"));
+  EXPECT_FALSE(Regex("^a{2,}$").match("a"));
+  EXPECT_TRUE(Regex("^(ab){1,2}c$").match("ababc"));
+  EXPECT_FALSE(Regex("^(ab){1,2}c$").match("abababc"));
+  EXPECT_TRUE(Regex("^a{,2}$").match("a{,2}"));
+  EXPECT_TRUE(Regex("^(a*)*b$").match("aab"));
+  EXPECT_TRUE(Regex("^()$").match(""));
+  EXPECT_TRUE(Regex("^x?y+z*$").match("yy"));
+}
+
+TEST_F(RegexTest, MatchPositions) {
+  SmallVector<StringRef, 4> Matches;
+
+  // Leftmost-longest, even when a shorter match ends earlier.
+  Regex r1("b+|ab+c");
+  EXPECT_TRUE(r1.match("xabbbc", &Matches));
+  EXPECT_EQ("abbbc", Matches[0]);
+
+  // In newline-sensitive mode the match may be on any line.
+  StringRef Buffer = "foo 1\nbar 23 baz\nbar 456 qux\n";
+  Regex r2("bar ([0-9]+) qux", Regex::Newline);
+  EXPECT_TRUE(r2.match(Buffer, &Matches));
+  ASSERT_EQ(2u, Matches.size());
+  EXPECT_EQ("bar 456 qux", Matches[0]);
+  EXPECT_EQ("456", Matches[1]);
+  EXPECT_EQ(Buffer.data() + 17, Matches[0].data());
+
+  Regex r3("^[a-z]+ [0-9]{2,}", Regex::Newline);
+  EXPECT_TRUE(r3.match(Buffer, &Matches));
+  EXPECT_EQ("bar 23", Matches[0]);
+  EXPECT_EQ(Buffer.data() + 6, Matches[0].data());
+
+  Regex r4("[0-9]+$", Regex::Newline);
+  EXPECT_TRUE(r4.match(Buffer, &Matches));
+  EXPECT_EQ("1", Matches[0]);
+
+  // A match that spans lines.
+  Regex r5("1\nbar", Regex::Newline);
+  EXPECT_TRUE(r5.match(Buffer, &Matches));
+  EXPECT_EQ(Buffer.data() + 4, Matches[0].data());
+
+  EXPECT_FALSE(Regex("bar [0-9]+ quux", Regex::Newline).match(Buffer));
+  EXPECT_FALSE(Regex("baz$", Regex::Newline).match("baz \n"));
+}
+
+TEST_F(RegexTest, LargeAlternation) {
+  std::string Pattern = "^(";
+  for (unsigned I = 0; I != 2000; ++I) {
+    if (I)
+      Pattern += '|';
+    Pattern += "fn" + std::to_string(I) + "_.*";
+  }
+  Pattern += ")$";
+  Regex R(Pattern);
+  std::string Error;
+  ASSERT_TRUE(R.isValid(Error));
+  EXPECT_TRUE(R.match("fn0_main"));
+  EXPECT_TRUE(R.match("fn1999_"));
+  EXPECT_TRUE(R.match("fn1234_foo_bar"));
+  EXPECT_FALSE(R.match("fn2000_"));
+  EXPECT_FALSE(R.match("xfn12_"));
+  EXPECT_FALSE(R.match("fn12"));
+}
+
+TEST_F(RegexTest, ManyStates) {
+  // The DFA for this pattern has 2^15 states, more than are kept at once.
+  Regex R("a[ab]{15}$");
+  std::string Subject;
+  uint32_t Seed = 1;
+  for (unsigned I = 0; I != 200000; ++I) {
+    Seed = Seed * 1103515245 + 12345;
+    Subject += (Seed >> 16) & 1 ? 'a' : 'b';
+  }
+  Subject.replace(Subject.size() - 16, 16, std::string(16, 'b'));
+  EXPECT_FALSE(R.match(Subject));
+  Subject[Subject.size() - 16] = 'a';
+  EXPECT_TRUE(R.match(Subject));
+}
+
+TEST_F(RegexTest, SharedBetweenThreads) {
+  Regex R("^(foo|ba[rz])+[0-9]*$");
+  std::atomic<unsigned> Failures(0);
+  ThreadPool Pool(4);
+  for (unsigned I = 0; I != 64; ++I)
+    Pool.async([&R, &Failures, I] {
+      std::string Good = "foobarbaz" + std::to_string(I);
+      std::string Bad = "foobaq" + std::to_string(I);
+      for (unsigned J = 0; J != 100; ++J) {
+        SmallVector<StringRef, 2> Matches;
+        if (!R.match(Good, &Matches) || Matches[0] != Good ||
+            Matches[1] != "baz" || R.match(Bad))
+          ++Failures;
+      }
+    });
+  Pool.wait();
+  EXPECT_EQ(0u, Failures);
+}
+
 }
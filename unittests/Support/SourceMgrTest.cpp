@@ -138,6 +138,65 @@ TEST_F(SourceMgrTest, MultipleRanges) {
             Output);
 }
 
+// Line numbers come from a per-buffer newline index whose element width
+// depends on the buffer size; check every width with queries in random order.
+static void checkLineAndColumn(SourceMgr &SM, unsigned BufferID,
+                               StringRef Text) {
+  std::vector<std::pair<unsigned, unsigned>> Expected;
+  unsigned Line = 1, Col = 1;
+  for (char C : Text) {
+    Expected.push_back(std::make_pair(Line, Col));
+    if (C == '\n') {
+      ++Line;
+      Col = 1;
+    } else {
+      ++Col;
+    }
+  }
+  // The location one past the end is valid too.
+  Expected.push_back(std::make_pair(Line, Col));
+
+  const char *Start = SM.getMemoryBuffer(BufferID)->getBufferStart();
+  unsigned Offset = 0;
+  for (unsigned I = 0, E = Expected.size(); I != E; ++I) {
+    Offset = (Offset + 7919) % E;
+    EXPECT_EQ(Expected[Offset],
+              SM.getLineAndColumn(SMLoc::getFromPointer(Start + Offset),
+                                  BufferID));
+  }
+}
+
+TEST_F(SourceMgrTest, LineAndColumnIndexWidths) {
+  for (unsigned Size : {0u, 200u, 60000u, 70000u}) {
+    SourceMgr LocalSM;
+    std::string Text;
+    for (unsigned I = 0; Text.size() < Size; ++I)
+      Text += std::string(I % 13, 'x') + "\n";
+    Text.resize(Size);
+    unsigned ID = LocalSM.AddNewSourceBuffer(
+        MemoryBuffer::getMemBuffer(Text, "file.in"), SMLoc());
+    checkLineAndColumn(LocalSM, ID, Text);
+  }
+}
+
+TEST_F(SourceMgrTest, LineAndColumnMultipleBuffers) {
+  std::string First = "a\nbb\nccc\n";
+  std::string Second = "\n\nx";
+  unsigned FirstID = SM.AddNewSourceBuffer(
+      MemoryBuffer::getMemBuffer(First, "first.in"), SMLoc());
+  unsigned SecondID = SM.AddNewSourceBuffer(
+      MemoryBuffer::getMemBuffer(Second, "second.in"), SMLoc());
+  const char *SecondStart = SM.getMemoryBuffer(SecondID)->getBufferStart();
+  const char *FirstStart = SM.getMemoryBuffer(FirstID)->getBufferStart();
+
+  // Without a buffer ID the buffer is looked up from the location.
+  EXPECT_EQ(std::make_pair(3u, 1u),
+            SM.getLineAndColumn(SMLoc::getFromPointer(SecondStart + 2)));
+  EXPECT_EQ(std::make_pair(2u, 2u),
+            SM.getLineAndColumn(SMLoc::getFromPointer(FirstStart + 3)));
+  EXPECT_EQ(1u, SM.FindLineNumber(SMLoc::getFromPointer(SecondStart)));
+}
+
 TEST_F(SourceMgrTest, OverlappingRanges) {
   setMainBuffer("aaa bbb\nccc ddd\n", "file.in");
   SMRange Ranges[] = { getRange(0, 3), getRange(2, 4) };
@@ -132,4 +132,53 @@ TEST_F(SpecialCaseListTest, MultipleBlacklists) {
   EXPECT_TRUE(SCL->inSection("src", "tomfoglery"));
 }
 
+TEST_F(SpecialCaseListTest, LiteralGlobs) {
+  std::unique_ptr<SpecialCaseList> SCL = makeSpecialCaseList("fun:_ZN4base*\n"
+                                                             "fun:*_destroy\n"
+                                                             "fun:*subtle*\n"
+                                                             "fun:a*b\n"
+                                                             "src:*\n"
+                                                             "global:*=init\n");
+  EXPECT_TRUE(SCL->inSection("fun", "_ZN4base"));
+  EXPECT_TRUE(SCL->inSection("fun", "_ZN4base4Lock"));
+  EXPECT_FALSE(SCL->inSection("fun", "_ZN4bas"));
+  EXPECT_FALSE(SCL->inSection("fun", "x_ZN4base"));
+  EXPECT_TRUE(SCL->inSection("fun", "obj_destroy"));
+  EXPECT_TRUE(SCL->inSection("fun", "_destroy"));
+  EXPECT_FALSE(SCL->inSection("fun", "_destroyed"));
+  EXPECT_TRUE(SCL->inSection("fun", "subtle"));
+  EXPECT_TRUE(SCL->inSection("fun", "_ZN6subtle4Atomic"));
+  EXPECT_FALSE(SCL->inSection("fun", "subtl"));
+  EXPECT_TRUE(SCL->inSection("fun", "axxb"));
+  EXPECT_FALSE(SCL->inSection("fun", "axxbc"));
+  EXPECT_TRUE(SCL->inSection("src", ""));
+  EXPECT_TRUE(SCL->inSection("src", "anything.cc"));
+  EXPECT_TRUE(SCL->inSection("global", "g", "init"));
+  EXPECT_FALSE(SCL->inSection("global", "g"));
+}
+
+TEST_F(SpecialCaseListTest, ManyEntries) {
+  std::string List;
+  for (unsigned I = 0; I != 20000; ++I) {
+    std::string N = std::to_string(I);
+    List += "fun:exact" + N + "\n";
+    List += "fun:prefix" + N + "_*\n";
+    List += "fun:*_suffix" + N + "\n";
+    List += "fun:*infix" + N + "_*\n";
+    if (I % 100 == 0)
+      List += "fun:re" + N + "_[0-9]+\n";
+  }
+  std::unique_ptr<SpecialCaseList> SCL = makeSpecialCaseList(List);
+  EXPECT_TRUE(SCL->inSection("fun", "exact19999"));
+  EXPECT_FALSE(SCL->inSection("fun", "exact20000"));
+  EXPECT_TRUE(SCL->inSection("fun", "prefix123_foo"));
+  EXPECT_FALSE(SCL->inSection("fun", "prefix123foo"));
+  EXPECT_TRUE(SCL->inSection("fun", "foo_suffix77"));
+  EXPECT_FALSE(SCL->inSection("fun", "foo_suffix77x"));
+  EXPECT_TRUE(SCL->inSection("fun", "a_infix4567_b"));
+  EXPECT_FALSE(SCL->inSection("fun", "a_infix4567b"));
+  EXPECT_TRUE(SCL->inSection("fun", "re1900_42"));
+  EXPECT_FALSE(SCL->inSection("fun", "re1901_42"));
+}
+
 }
@@ -0,0 +1,54 @@
+//===- llvm/unittest/Support/xxhashTest.cpp -------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Support/xxhash.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+// The expected values are from the reference xxHash implementation. They must
+// never change, since clients are allowed to persist them.
+TEST(xxhashTest, Basic) {
+  EXPECT_EQ(0xef46db3751d8e999ULL, xxHash64(StringRef()));
+  EXPECT_EQ(0xd24ec4f1a98c6e5bULL, xxHash64("a"));
+  EXPECT_EQ(0x44bc2cf5ad770999ULL, xxHash64("abc"));
+  EXPECT_EQ(0x642a94958e71e6c5ULL,
+            xxHash64("0123456789abcdef0123456789abcdef"));
+  EXPECT_EQ(0x0b242d361fda71bcULL,
+            xxHash64("The quick brown fox jumps over the lazy dog"));
+}
+
+TEST(xxhashTest, Seed) {
+  EXPECT_EQ(0x13c1d910702770e6ULL, xxHash64("abc", 42));
+  EXPECT_EQ(0x450cddb8f2704428ULL,
+            xxHash64("0123456789abcdef0123456789abcdef", 0x0123456789abcdefULL));
+}
+
+TEST(xxhashTest, LongInput) {
+  // Exercise the 32-byte stripe loop as well as every tail length.
+  uint8_t Data[512];
+  for (unsigned I = 0; I != 512; ++I)
+    Data[I] = I & 0xff;
+  EXPECT_EQ(0x7b3bfcaac0348ac0ULL, xxHash64(makeArrayRef(Data)));
+}
+
+TEST(xxhashTest, Integer) {
+  EXPECT_EQ(0x34c96acdcadb1bbbULL, xxHash64(uint64_t(0)));
+  EXPECT_EQ(0x9f29cb17a2a49995ULL, xxHash64(uint64_t(1)));
+  EXPECT_EQ(0xea3c52081e9843ecULL, xxHash64(uint64_t(0x0123456789abcdefULL)));
+
+  // The integer form must agree with hashing the little-endian bytes.
+  const uint8_t Bytes[] = {0xef, 0xcd, 0xab, 0x89, 0x67, 0x45, 0x23, 0x01};
+  EXPECT_EQ(xxHash64(makeArrayRef(Bytes)),
+            xxHash64(uint64_t(0x0123456789abcdefULL)));
+}
+
+} // end anonymous namespace
@@ -1481,10 +1481,7 @@ void CodeGenSchedModels::collectProcResources() {
     if (!(*RI)->getValueInit("SchedModel")->isComplete())
       continue;
     CodeGenProcModel &PM = getProcModel((*RI)->getValueAsDef("SchedModel"));
-    RecIter I = std::find(PM.ProcResourceDefs.begin(),
-                          PM.ProcResourceDefs.end(), *RI);
-    if (I == PM.ProcResourceDefs.end())
-      PM.ProcResourceDefs.push_back(*RI);
+    addProcResource(*RI, PM);
   }
   // Finalize each ProcModel by sorting the record arrays.
   for (CodeGenProcModel &PM : ProcModels) {
@@ -1651,8 +1648,13 @@ void CodeGenSchedModels::addProcResource(Record *ProcResKind,
       return;
 
     PM.ProcResourceDefs.push_back(ProcResUnits);
-    if (ProcResUnits->isSubClassOf("ProcResGroup"))
+    if (ProcResUnits->isSubClassOf("ProcResGroup")) {
+      // A group is described by its units, so they need to be known even if
+      // no SchedWrite uses them directly.
+      for (Record *RUDef : ProcResUnits->getValueAsListOfDefs("Resources"))
+        addProcResource(RUDef, PM);
       return;
+    }
 
     if (!ProcResUnits->getValueInit("Super")->isComplete())
       return;
@@ -598,10 +598,31 @@ void SubtargetEmitter::EmitProcessorResources(const CodeGenProcModel &ProcModel,
                                               raw_ostream &OS) {
   char Sep = ProcModel.ProcResourceDefs.empty() ? ' ' : ',';
 
-  OS << "\n// {Name, NumUnits, SuperIdx, IsBuffered}\n";
+  // Emit the units of each group, so that tools working from the MC layer can
+  // tell which resources a group is made of.
+  OS << "\nstatic const unsigned " << ProcModel.ModelName
+     << "ProcResourceSubUnits[] = {\n"
+     << "  0,  // Invalid\n";
+  for (unsigned i = 0, e = ProcModel.ProcResourceDefs.size(); i < e; ++i) {
+    Record *PRDef = ProcModel.ProcResourceDefs[i];
+    if (!PRDef->isSubClassOf("ProcResGroup"))
+      continue;
+    OS << " ";
+    for (Record *RUDef : PRDef->getValueAsListOfDefs("Resources")) {
+      Record *RU = SchedModels.findProcResUnits(RUDef, ProcModel);
+      for (int J = 0, JE = RU->getValueAsInt("NumUnits"); J < JE; ++J)
+        OS << " " << ProcModel.getProcResourceIdx(RU) << ",";
+    }
+    OS << "  // " << PRDef->getName() << "\n";
+  }
+  OS << "};\n";
+
+  OS << "\n// {Name, NumUnits, SuperIdx, IsBuffered, SubUnitsIdxBegin}\n";
   OS << "static const llvm::MCProcResourceDesc "
      << ProcModel.ModelName << "ProcResources" << "[] = {\n"
-     << "  {DBGFIELD(\"InvalidUnit\")     0, 0, 0}" << Sep << "\n";
+     << "  {\"InvalidUnit\", 0, 0, 0, nullptr}" << Sep << "\n";
+
+  unsigned SubUnitsOffset = 1;
 
   for (unsigned i = 0, e = ProcModel.ProcResourceDefs.size(); i < e; ++i) {
     Record *PRDef = ProcModel.ProcResourceDefs[i];
@@ -629,11 +650,17 @@ void SubtargetEmitter::EmitProcessorResources(const CodeGenProcModel &ProcModel,
     // Emit the ProcResourceDesc
     if (i+1 == e)
       Sep = ' ';
-    OS << "  {DBGFIELD(\"" << PRDef->getName() << "\") ";
+    OS << "  {\"" << PRDef->getName() << "\", ";
     if (PRDef->getName().size() < 15)
       OS.indent(15 - PRDef->getName().size());
-    OS << NumUnits << ", " << SuperIdx << ", "
-       << BufferSize << "}" << Sep << " // #" << i+1;
+    OS << NumUnits << ", " << SuperIdx << ", " << BufferSize << ", ";
+    if (PRDef->isSubClassOf("ProcResGroup")) {
+      OS << ProcModel.ModelName << "ProcResourceSubUnits + " << SubUnitsOffset;
+      SubUnitsOffset += NumUnits;
+    } else {
+      OS << "nullptr";
+    }
+    OS << "}" << Sep << " // #" << i+1;
     if (SuperDef)
       OS << ", Super=" << SuperDef->getName();
     OS << "\n";